@@ -8,15 +8,76 @@
 
 #include <Renderer/World/LightingRenderer.h>
 #include <Renderer/World/WorldRenderer.h>
+#include <Renderer/World/WorldCullingRenderer.h>
 
 GameStateInWorld::GameStateInWorld(KalosEngine *enginePtr)
 {
 	engine = enginePtr;
 	lightingRenderer = std::unique_ptr<LightingRenderer>(new LightingRenderer(enginePtr));
-	worldRenderer = std::unique_ptr<WorldRenderer>(new WorldRenderer(enginePtr));
+	cullingRenderer = std::unique_ptr<WorldCullingRenderer>(new WorldCullingRenderer(enginePtr));
+	worldRenderer = std::unique_ptr<WorldRenderer>(new WorldRenderer(enginePtr, cullingRenderer.get()));
 
 	inWorldRenderGraph = engine->renderer->createRenderGraph();
 
+	// The cull passes only ever write these, the counters they read back are reset by their first dispatch every frame
+	auto &earlyCullingPass = inWorldRenderGraph->addRenderPass("worldCullingEarly", RENDER_GRAPH_PIPELINE_TYPE_COMPUTE);
+	earlyCullingPass.addStorageBuffer("worldOccluderDrawCommands", WORLD_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	earlyCullingPass.addStorageBuffer("worldOccluderDrawCounts", WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	earlyCullingPass.addStorageBuffer("worldOccluderInstances", WORLD_CULLING_INSTANCES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT, false, true);
+
+	earlyCullingPass.setInitFunction(std::bind(&WorldCullingRenderer::earlyCullPassInit, cullingRenderer.get(), std::placeholders::_1));
+	earlyCullingPass.setRenderFunction(std::bind(&WorldCullingRenderer::earlyCullPassRender, cullingRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	earlyCullingPass.setDescriptorUpdateFunction(std::bind(&WorldCullingRenderer::earlyCullPassDescriptorUpdate, cullingRenderer.get(), std::placeholders::_1));
+
+	RenderPassAttachment occluderDepth;
+	occluderDepth.format = RESOURCE_FORMAT_D32_SFLOAT;
+	occluderDepth.namedRelativeSize = "swapchain";
+
+	auto &occluderPass = inWorldRenderGraph->addRenderPass("worldOccluderDepth", RENDER_GRAPH_PIPELINE_TYPE_GRAPHICS);
+	occluderPass.setDepthStencilAttachmentOutput("worldOccluderDepth", occluderDepth, true, {0, 0});
+	occluderPass.addStorageBuffer("worldOccluderDrawCommands", WORLD_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	occluderPass.addStorageBuffer("worldOccluderDrawCounts", WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	occluderPass.addStorageBuffer("worldOccluderInstances", WORLD_CULLING_INSTANCES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT, true, false, BUFFER_LAYOUT_VERTEX_BUFFER, BUFFER_LAYOUT_VERTEX_BUFFER);
+
+	occluderPass.setInitFunction(std::bind(&WorldCullingRenderer::occluderPassInit, cullingRenderer.get(), std::placeholders::_1));
+	occluderPass.setRenderFunction(std::bind(&WorldCullingRenderer::occluderPassRender, cullingRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	occluderPass.setDescriptorUpdateFunction(std::bind(&WorldCullingRenderer::occluderPassDescriptorUpdate, cullingRenderer.get(), std::placeholders::_1));
+
+	RenderPassAttachment hiZ;
+	hiZ.format = RESOURCE_FORMAT_R32_SFLOAT;
+	hiZ.sizeX = WORLD_HIZ_WIDTH;
+	hiZ.sizeY = WORLD_HIZ_HEIGHT;
+	hiZ.mipLevels = WORLD_HIZ_MIP_LEVELS;
+
+	auto &hiZPass = inWorldRenderGraph->addRenderPass("worldHiZ", RENDER_GRAPH_PIPELINE_TYPE_COMPUTE);
+	hiZPass.addSampledTextureInput("worldOccluderDepth");
+	hiZPass.addStorageTexture("worldHiZ", hiZ, false, true);
+
+	hiZPass.setInitFunction(std::bind(&WorldCullingRenderer::hiZPassInit, cullingRenderer.get(), std::placeholders::_1));
+	hiZPass.setRenderFunction(std::bind(&WorldCullingRenderer::hiZPassRender, cullingRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	hiZPass.setDescriptorUpdateFunction(std::bind(&WorldCullingRenderer::hiZPassDescriptorUpdate, cullingRenderer.get(), std::placeholders::_1));
+
+	auto &cullingPass = inWorldRenderGraph->addRenderPass("worldCulling", RENDER_GRAPH_PIPELINE_TYPE_COMPUTE);
+	cullingPass.addSampledTextureInput("worldHiZ");
+	cullingPass.addStorageBuffer("worldDrawCommands", WORLD_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	cullingPass.addStorageBuffer("worldDrawCounts", WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	cullingPass.addStorageBuffer("worldInstances", WORLD_CULLING_INSTANCES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT, false, true);
+
+	cullingPass.setInitFunction(std::bind(&WorldCullingRenderer::cullPassInit, cullingRenderer.get(), std::placeholders::_1));
+	cullingPass.setRenderFunction(std::bind(&WorldCullingRenderer::cullPassRender, cullingRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	cullingPass.setDescriptorUpdateFunction(std::bind(&WorldCullingRenderer::cullPassDescriptorUpdate, cullingRenderer.get(), std::placeholders::_1));
+
+	auto &clusterCullingPass = inWorldRenderGraph->addRenderPass("worldClusterCulling", RENDER_GRAPH_PIPELINE_TYPE_COMPUTE);
+	clusterCullingPass.addStorageBuffer("worldDrawCounts", WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false);
+	clusterCullingPass.addStorageBuffer("worldInstances", WORLD_CULLING_INSTANCES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT, true, false);
+	clusterCullingPass.addStorageBuffer("worldClusterDrawCommands", WORLD_CLUSTER_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	clusterCullingPass.addStorageBuffer("worldClusterDrawCounts", WORLD_CLUSTER_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, false, true);
+	clusterCullingPass.addStorageBuffer("worldClusterIndices", WORLD_CLUSTER_CULLING_INDICES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDEX_BUFFER_BIT, false, true);
+
+	clusterCullingPass.setInitFunction(std::bind(&WorldCullingRenderer::clusterCullPassInit, cullingRenderer.get(), std::placeholders::_1));
+	clusterCullingPass.setRenderFunction(std::bind(&WorldCullingRenderer::clusterCullPassRender, cullingRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	clusterCullingPass.setDescriptorUpdateFunction(std::bind(&WorldCullingRenderer::clusterCullPassDescriptorUpdate, cullingRenderer.get(), std::placeholders::_1));
+
 	RenderPassAttachment gbuffer0;
 	gbuffer0.format = RESOURCE_FORMAT_R8G8B8A8_UNORM;
 	gbuffer0.namedRelativeSize = "swapchain";
@@ -32,10 +93,17 @@ GameStateInWorld::GameStateInWorld(KalosEngine *enginePtr)
 	auto &gbufferPass = inWorldRenderGraph->addRenderPass("gbufferPass", RENDER_GRAPH_PIPELINE_TYPE_GRAPHICS);
 	gbufferPass.addColorAttachmentOutput("gbuffer0", gbuffer0, true, {0.0f, 0.0f, 0.0f, 0.0f});
 	//gbufferPass.addColorAttachmentOutput("gbuffer1", gbuffer1, true, {0.0f, 0.0f, 0.0f, 0.0f});
-	gbufferPass.setDepthStencilAttachmentOutput("gbufferDepth", gbufferDepth, true, {1, 0});
+	gbufferPass.setDepthStencilAttachmentOutput("gbufferDepth", gbufferDepth, true, {0, 0});
+	gbufferPass.addStorageBuffer("worldDrawCommands", WORLD_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	gbufferPass.addStorageBuffer("worldDrawCounts", WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	gbufferPass.addStorageBuffer("worldInstances", WORLD_CULLING_INSTANCES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT, true, false, BUFFER_LAYOUT_VERTEX_BUFFER, BUFFER_LAYOUT_VERTEX_BUFFER);
+	gbufferPass.addStorageBuffer("worldClusterDrawCommands", WORLD_CLUSTER_CULLING_DRAW_COMMANDS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	gbufferPass.addStorageBuffer("worldClusterDrawCounts", WORLD_CLUSTER_CULLING_DRAW_COUNTS_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDIRECT_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDIRECT_BUFFER, BUFFER_LAYOUT_INDIRECT_BUFFER);
+	gbufferPass.addStorageBuffer("worldClusterIndices", WORLD_CLUSTER_CULLING_INDICES_BUFFER_SIZE, BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_INDEX_BUFFER_BIT, true, false, BUFFER_LAYOUT_INDEX_BUFFER, BUFFER_LAYOUT_INDEX_BUFFER);
 
 	gbufferPass.setInitFunction(std::bind(&WorldRenderer::gbufferPassInit, worldRenderer.get(), std::placeholders::_1));
 	gbufferPass.setRenderFunction(std::bind(&WorldRenderer::gbufferPassRender, worldRenderer.get(), std::placeholders::_1, std::placeholders::_2));
+	gbufferPass.setDescriptorUpdateFunction(std::bind(&WorldRenderer::gbufferPassDescriptorUpdate, worldRenderer.get(), std::placeholders::_1));
 
 	RenderPassAttachment lightingOutput;
 	lightingOutput.format = RESOURCE_FORMAT_R16G16B16A16_SFLOAT;
@@ -83,6 +151,7 @@ void GameStateInWorld::popped()
 	engine->renderer->destroyRenderGraph(inWorldRenderGraph);
 	lightingRenderer.reset();
 	worldRenderer.reset();
+	cullingRenderer.reset();
 }
 
 void GameStateInWorld::pause()
@@ -102,6 +171,7 @@ void GameStateInWorld::handleEvents()
 
 void GameStateInWorld::update(float delta)
 {
+	cullingRenderer->update(delta);
 	worldRenderer->update(delta);
 }
 
@@ -8,6 +8,7 @@
 class KalosEngine;
 class LightingRenderer;
 class WorldRenderer;
+class WorldCullingRenderer;
 
 class GameStateInWorld : public GameState
 {
@@ -33,6 +34,7 @@ private:
 
 	std::unique_ptr<LightingRenderer> lightingRenderer;
 	std::unique_ptr<WorldRenderer> worldRenderer;
+	std::unique_ptr<WorldCullingRenderer> cullingRenderer;
 
 	RenderGraph inWorldRenderGraph;
 };
@@ -14,6 +14,7 @@
 
 #include <Renderer/NuklearGUIRenderer.h>
 
+#include <RendererCore/UploadManager.h>
 #include <RendererCore/Tests/RenderTestHandler.h>
 
 #include <Resources/FileLoader.h>
@@ -47,7 +48,8 @@ KalosEngine::KalosEngine(const std::vector<std::string> &launchArgs, RendererBac
 
 	renderer = std::unique_ptr<Renderer>(Renderer::allocateRenderer(renderAlloc));
 
-	initCmdPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
+	uploadManager = std::unique_ptr<UploadManager>(new UploadManager(renderer.get()));
+
 	swapchainSampler = renderer->createSampler();
 
 	initColorTextures();
@@ -76,6 +78,12 @@ KalosEngine::KalosEngine(const std::vector<std::string> &launchArgs, RendererBac
 		renderTestHandler = std::unique_ptr<RenderTestHandler>(new RenderTestHandler(renderer.get(), mainWindow.get(), currentRenderingTest));
 
 	resourceManager = std::unique_ptr<ResourceManager>(new ResourceManager(this));
+
+	// The gbuffer shaders only read full vertices, so models stored in any other format would be drawn w/ garbage normals and uvs
+	for (const char *vertexFormatArg : {"-compressed_vertices", "-quantized_vertices"})
+		if (std::find(launchArgs.begin(), launchArgs.end(), vertexFormatArg) != launchArgs.end())
+			Log::get()->error("KalosEngine: {} isn't supported until the shaders can decode it, models will use full vertices", vertexFormatArg);
+
 	worldManager = std::unique_ptr<WorldManager>(new WorldManager());
 }
 
@@ -83,8 +91,16 @@ KalosEngine::~KalosEngine()
 {
 	renderer->waitForDeviceIdle();
 
+	// Game states hold onto resources, so they go before the resource manager
+	while (!gameStates.empty())
+	{
+		gameStates.back()->popped();
+		gameStates.pop_back();
+	}
+
 	nuklearRenderer.reset();
 	resourceManager.reset();
+	uploadManager.reset();
 
 	nk_free(nuklearCtx);
 	delete nuklearCtx;
@@ -98,19 +114,11 @@ KalosEngine::~KalosEngine()
 	renderer->destroyDescriptorPool(testFontAtlasDescriptrPool);
 	renderer->destroyDescriptorPool(quadPassthroughDescriptorPool);
 
-	renderer->destroyCommandPool(initCmdPool);
-
 	renderer->destroyRenderGraph(debugInfoRenderGraph);
 
 	renderer->destroyPipeline(debugInfoPassthroughPipeline);
 
 	renderer->destroySampler(swapchainSampler);
-
-	while (!gameStates.empty())
-	{
-		gameStates.back()->popped();
-		gameStates.pop_back();
-	}
 }
 
 void KalosEngine::setEngineMaxUpdateFrequency(uint32_t engineUpdateFrequencyCap)
@@ -197,9 +205,20 @@ void KalosEngine::update()
 
 		nk_layout_row_static(nuklearCtx, 30, 1920, 1);
 		nk_label(nuklearCtx, renderInfoCStr, NK_TEXT_ALIGN_LEFT);
+
+		UploadManagerStatistics uploadStats = uploadManager->getStatistics();
+
+		char uploadInfoCStr[512];
+		sprintf(uploadInfoCStr, "Uploads: %.1f MB/s, ring %.1f/%.1f MB, %llu stalls (%.3f ms total)", uploadStats.throughputMBPerSecond, uploadStats.ringBytesInUse / (1024.0 * 1024.0), uploadStats.ringSize / (1024.0 * 1024.0), (unsigned long long) uploadStats.stallCount, uploadStats.totalStallTime * 1000.0);
+
+		nk_layout_row_static(nuklearCtx, 30, 1920, 1);
+		nk_label(nuklearCtx, uploadInfoCStr, NK_TEXT_ALIGN_LEFT);
 	}
 	nk_end(nuklearCtx);
 
+	resourceManager->update();
+	uploadManager->update();
+
 	if (!gameStates.empty())
 		gameStates.back()->update(delta);
 }
@@ -372,12 +391,6 @@ void KalosEngine::initColorTextures()
 		255, 255, 255, 255
 	};
 
-	StagingTexture whiteTexture2DStaging = renderer->createStagingTexture({2, 2, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, 1, 1);
-	renderer->fillStagingTextureSubresource(whiteTexture2DStaging, whiteTexture2DData, 0, 0);
-
-	CommandBuffer fontAtlasUploadCommandBuffer = initCmdPool->allocateCommandBuffer();
-	fontAtlasUploadCommandBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
 	ResourceBarrier barrier0 = {};
 	barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
 	barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
@@ -392,20 +405,11 @@ void KalosEngine::initColorTextures()
 	barrier1.textureTransition.subresourceRange = {0, 1, 0, 1};
 	barrier1.textureTransition.texture = whiteTexture2D;
 
-	fontAtlasUploadCommandBuffer->resourceBarriers({barrier0});
-	fontAtlasUploadCommandBuffer->stageTextureSubresources(whiteTexture2DStaging, whiteTexture2D, {0, 1, 0, 1});
-	fontAtlasUploadCommandBuffer->resourceBarriers({barrier1});
-
-	fontAtlasUploadCommandBuffer->endCommands();
+	uploadManager->recordBarriers({barrier0});
+	uploadManager->uploadTexture(whiteTexture2D, 0, 0, whiteTexture2DData);
+	uploadManager->recordBarriers({barrier1});
 
-	Fence tempFence = renderer->createFence();
-	renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {fontAtlasUploadCommandBuffer}, {}, {}, {}, tempFence);
-
-	renderer->waitForFence(tempFence, 5);
-
-	initCmdPool->resetCommandPoolAndFreeCommandBuffer(fontAtlasUploadCommandBuffer);
-	renderer->destroyFence(tempFence);
-	renderer->destroyStagingTexture(whiteTexture2DStaging);
+	uploadManager->waitForBatch(uploadManager->submit());
 }
 
 void KalosEngine::setupDebugInfoRenderGraph()
@@ -451,12 +455,6 @@ void KalosEngine::setupDebugInfoRenderGraph()
 		testFontAtlas = renderer->createTexture({(uint32_t)atlasWidth, (uint32_t)atlasHeight, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false);
 		testFontAtlasView = renderer->createTextureView(testFontAtlas);
 
-		StagingTexture stagingTexture = renderer->createStagingTexture({(uint32_t)atlasWidth, (uint32_t)atlasHeight, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, 1, 1);
-		renderer->fillStagingTextureSubresource(stagingTexture, imageData, 0, 0);
-
-		CommandBuffer fontAtlasUploadCommandBuffer = initCmdPool->allocateCommandBuffer();
-		fontAtlasUploadCommandBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
 		ResourceBarrier barrier0 = {};
 		barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
 		barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
@@ -471,20 +469,11 @@ void KalosEngine::setupDebugInfoRenderGraph()
 		barrier1.textureTransition.subresourceRange = {0, 1, 0, 1};
 		barrier1.textureTransition.texture = testFontAtlas;
 
-		fontAtlasUploadCommandBuffer->resourceBarriers({barrier0});
-		fontAtlasUploadCommandBuffer->stageTextureSubresources(stagingTexture, testFontAtlas, {0, 1, 0, 1});
-		fontAtlasUploadCommandBuffer->resourceBarriers({barrier1});
-
-		fontAtlasUploadCommandBuffer->endCommands();
-
-		Fence tempFence = renderer->createFence();
-		renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {fontAtlasUploadCommandBuffer}, {}, {}, {}, tempFence);
-
-		renderer->waitForFence(tempFence, 5);
+		uploadManager->recordBarriers({barrier0});
+		uploadManager->uploadTexture(testFontAtlas, 0, 0, imageData);
+		uploadManager->recordBarriers({barrier1});
 
-		initCmdPool->resetCommandPoolAndFreeCommandBuffer(fontAtlasUploadCommandBuffer);
-		renderer->destroyFence(tempFence);
-		renderer->destroyStagingTexture(stagingTexture);
+		uploadManager->waitForBatch(uploadManager->submit());
 
 		defaultNKFontAtlasDescriptorSet = testFontAtlasDescriptrPool->allocateDescriptorSet();
 		atlasNullDrawDescriptorSet = testFontAtlasDescriptrPool->allocateDescriptorSet();
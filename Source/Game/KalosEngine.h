@@ -14,6 +14,7 @@
 class NuklearGUIRenderer;
 class WorldManager;
 class ResourceManager;
+class UploadManager;
 
 class KalosEngine
 {
@@ -23,6 +24,7 @@ class KalosEngine
 	std::unique_ptr<Window> mainWindow;
 	std::unique_ptr<WorldManager> worldManager;
 	std::unique_ptr<ResourceManager> resourceManager;
+	std::unique_ptr<UploadManager> uploadManager;
 
 	KalosEngine(const std::vector<std::string> &launchArgs, RendererBackend rendererBackendType, uint32_t engineUpdateFrequencyCap = 250);
 	virtual ~KalosEngine();
@@ -74,7 +76,6 @@ class KalosEngine
 	TextureView currentEngineTextureOutput;
 	Sampler swapchainSampler;
 
-	CommandPool initCmdPool;
 
 	Texture whiteTexture2D;
 	TextureView whiteTexture2DView;
@@ -11,6 +11,12 @@ Recognized launch args:
 
 -cube_test
 
+-compressed_vertices        Not supported yet, the shaders can't decode it. Logs an error and uses full vertices.
+-quantized_vertices         Not supported yet, the shaders can't decode it. Logs an error and uses full vertices.
+
+-occlusion_culling_test     Runs the software occlusion culler's visibility tests and exits
+-mipmap_generator_test      Checks the mipmap generator against it's scalar reference and exits
+
 */
 
 #include <iostream>
@@ -28,10 +34,13 @@ Recognized launch args:
 
 #include <RendererCore/Renderer.h>
 #include <Resources/FileLoader.h>
+#include <Resources/MipmapGenerator.h>
 #include <Resources/ResourceImporter.h>
 
 #include <World/WorldManager.h>
 
+#include <Renderer/World/SoftwareOcclusionCuller.h>
+
 
 int main(int argc, char * argv[]);
 
@@ -49,135 +58,6 @@ int main(int argc, char *argv[])
 		launchArgs.push_back(argv[i]);
 	}
 
-	if (true)
-	{
-		std::ofstream file("A:/Programming/KalosEngineDev-win/GameData/worlds/testworld.kew", std::ios::out | std::ios::binary);
-
-		if (!file.is_open())
-		{
-			return 0;
-		}
-
-		uint16_t fileVersion = 0;
-		std::string uniqueName = "testworld";
-		uint32_t uniqueNameStrLen = uniqueName.size();
-		uint8_t hasTerrain = 1;
-		uint32_t terrainSizeX = 4;
-		uint32_t terrainSizeY = 4;
-		int32_t terrainOffsetX = 0;
-		int32_t terrainOffsetY = 0;
-
-		// HEADER
-		file.write("KEW|", 4);
-		file.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
-
-		// WORLD INFO
-		file.write(reinterpret_cast<const char*>(&uniqueNameStrLen), sizeof(uniqueNameStrLen));
-		file.write(uniqueName.c_str(), uniqueNameStrLen);
-		file.write(reinterpret_cast<const char*>(&hasTerrain), sizeof(hasTerrain));
-		file.write(reinterpret_cast<const char*>(&terrainSizeX), sizeof(terrainSizeX));
-		file.write(reinterpret_cast<const char*>(&terrainSizeY), sizeof(terrainSizeY));
-		file.write(reinterpret_cast<const char*>(&terrainOffsetX), sizeof(terrainOffsetX));
-		file.write(reinterpret_cast<const char*>(&terrainOffsetY), sizeof(terrainOffsetY));
-
-		uint64_t zeroValue = 0;
-		std::map<sivec2, std::streampos> objectDataFilePos;
-
-		// LOOKUP TABLE
-		for (int64_t x = terrainOffsetX; x < int64_t(terrainSizeX) - terrainOffsetX; x++)
-		{
-			for (int64_t y = terrainOffsetY; y < int64_t(terrainSizeY) - terrainOffsetY; y++)
-			{
-				file.write(reinterpret_cast<const char*>(&zeroValue), sizeof(zeroValue));
-				objectDataFilePos[{int32_t(x), int32_t(y)}] = file.tellp();
-				file.write(reinterpret_cast<const char*>(&zeroValue), sizeof(zeroValue));
-			}
-		}
-
-		// HEIGHTMAP DATA
-
-		// STATIC OBJECT DATA
-		for (int64_t x = terrainOffsetX; x < int64_t(terrainSizeX) - terrainOffsetX; x++)
-		{
-			for (int64_t y = terrainOffsetY; y < int64_t(terrainSizeY) - terrainOffsetY; y++)
-			{
-				// Write the lookup table position
-				std::streampos currentPos = file.tellp();
-				uint64_t currentPos_u64 = uint64_t(currentPos);
-				file.seekp(objectDataFilePos[{int32_t(x), int32_t(y)}]);
-				file.write(reinterpret_cast<const char *>(&currentPos_u64), sizeof(currentPos_u64));
-				file.seekp(currentPos);
-			
-				AABB chunkAABB = {{0, 0, 0, 0}, {256.0f, 256.0f, 256.0f, 0}};
-				file.write(reinterpret_cast<const char *>(&chunkAABB), sizeof(chunkAABB));
-
-				// Generate a test octree with random shit in it
-				Octree<StaticObjectEntry> testOctree;
-				testOctree.boundingBox = chunkAABB;
-
-				std::vector<StaticObjectEntry> items;
-				for (uint32_t i = 0; i < 4096; i++)
-				{
-					StaticObjectEntry entry = {};
-					entry.objectUUID = rand();
-					entry.meshID = rand();
-					entry.materialID = rand();
-					entry.position = {(rand() / float(RAND_MAX)) * 256.0f, (rand() / float(RAND_MAX)) * 256.0f, (rand() / float(RAND_MAX)) * 256.0f};
-					entry.scale = 1.0f;
-					entry.orientation = {0, 0, 0, 1};
-					entry.boundingSphereRadius = rand() % 64;
-					entry.bitmask = 0;
-
-					items.push_back(entry);
-				}
-
-				insertItemsIntoOctree(&testOctree, items);
-
-				std::vector<Octree<StaticObjectEntry> *> octreeList;
-				std::map<Octree<StaticObjectEntry> *, uint32_t> octreeList_map;
-
-				std::function<void(Octree<StaticObjectEntry> *node)> recursiveAddOctreeToList = [&octreeList, &octreeList_map, &recursiveAddOctreeToList] (Octree<StaticObjectEntry> *node) -> void {
-					octreeList.push_back(node);
-					octreeList_map[node] = octreeList.size() - 1;
-
-					for (int child = 0; child < 8; child++)
-						if (node->children[child] != nullptr)
-							recursiveAddOctreeToList(node->children[child]);
-				};
-
-				recursiveAddOctreeToList(&testOctree);
-
-				uint32_t octreeArrayCount = octreeList.size();
-				file.write(reinterpret_cast<const char *>(&octreeArrayCount), sizeof(octreeArrayCount));
-
-				for (size_t n = 0; n < octreeList.size(); n++)
-				{
-					Octree<StaticObjectEntry> *node = octreeList[n];
-					uint32_t parentNodeIndex = node->parent == nullptr ? 0xFFFFFFFF : octreeList_map[node->parent];
-					file.write(reinterpret_cast<const char *>(&parentNodeIndex), sizeof(parentNodeIndex));
-
-					uint32_t childNodeIndex[8];
-
-					for (int child = 0; child < 8; child++)
-					{
-						childNodeIndex[child] = node->children[child] == nullptr ? 0xFFFFFFFF : octreeList_map[node->children[child]];
-						file.write(reinterpret_cast<const char *>(&childNodeIndex[child]), sizeof(childNodeIndex[0]));
-					}
-
-					file.write(reinterpret_cast<const char *>(&node->boundingBox), sizeof(node->boundingBox));
-					
-					uint32_t itemCount = node->items.size();
-					file.write(reinterpret_cast<const char *>(&itemCount), sizeof(itemCount));
-					
-					if (itemCount > 0)
-						file.write(reinterpret_cast<const char *>(node->items.data()), itemCount * sizeof(node->items[0]));
-				}
-			}
-		}
-
-		file.close();
-	}
-
 	if (true)
 	{
 		launchArgs.push_back("-force_vulkan");
@@ -204,6 +84,26 @@ int main(int argc, char *argv[])
 	
 	//JobSystem::get()->test();
 
+	if (std::find(launchArgs.begin(), launchArgs.end(), "-occlusion_culling_test") != launchArgs.end())
+	{
+		bool passed = SoftwareOcclusionCuller::test();
+
+		delete Log::getInstance();
+		delete JobSystem::get();
+
+		return passed ? 0 : 1;
+	}
+
+	if (std::find(launchArgs.begin(), launchArgs.end(), "-mipmap_generator_test") != launchArgs.end())
+	{
+		bool passed = testImageMipmapGenerator();
+
+		delete Log::getInstance();
+		delete JobSystem::get();
+
+		return passed ? 0 : 1;
+	}
+
 	std::string workingDir = std::string(getenv("DEV_WORKING_DIR")) + "/";
 
 	Log::get()->info("Current working directory: {}", workingDir);
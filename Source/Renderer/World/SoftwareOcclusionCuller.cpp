@@ -0,0 +1,546 @@
+#include "Renderer/World/SoftwareOcclusionCuller.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+struct SoftwareOcclusionTileJobData
+{
+	SoftwareOcclusionCuller *culler;
+	uint32_t tileIndex;
+};
+
+void softwareOcclusionTileJobFunction(Job *job)
+{
+	SoftwareOcclusionTileJobData *jobData = reinterpret_cast<SoftwareOcclusionTileJobData*>(job->usrData);
+
+	jobData->culler->rasterizeTile(jobData->tileIndex);
+}
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller(uint32_t width, uint32_t height)
+{
+	// Tiles are always full, which also keeps every tile row a multiple of 8 pixels for the AVX2 path
+	this->width = std::max<uint32_t>((width + SOFTWARE_OCCLUSION_TILE_SIZE - 1) / SOFTWARE_OCCLUSION_TILE_SIZE, 1) * SOFTWARE_OCCLUSION_TILE_SIZE;
+	this->height = std::max<uint32_t>((height + SOFTWARE_OCCLUSION_TILE_SIZE - 1) / SOFTWARE_OCCLUSION_TILE_SIZE, 1) * SOFTWARE_OCCLUSION_TILE_SIZE;
+
+	tileCountX = this->width / SOFTWARE_OCCLUSION_TILE_SIZE;
+	tileCountY = this->height / SOFTWARE_OCCLUSION_TILE_SIZE;
+	tileTriangleBins.resize(tileCountX * tileCountY);
+
+	size_t depthLevelsSize = 0;
+
+	for (uint32_t level = 0; ; level++)
+	{
+		uint32_t levelWidth = std::max(this->width >> level, 1u), levelHeight = std::max(this->height >> level, 1u);
+
+		depthLevelOffsets.push_back(depthLevelsSize);
+		depthLevelsSize += size_t(levelWidth) * levelHeight;
+
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+	}
+
+	depthLevels.resize(depthLevelsSize, 1.0f);
+	viewProjMatrix = glm::mat4(1.0f);
+}
+
+SoftwareOcclusionCuller::~SoftwareOcclusionCuller()
+{
+
+}
+
+void SoftwareOcclusionCuller::beginFrame(const glm::mat4 &viewProjMatrix)
+{
+	this->viewProjMatrix = viewProjMatrix;
+
+	triangles.clear();
+
+	for (std::vector<uint32_t> &bin : tileTriangleBins)
+		bin.clear();
+}
+
+void SoftwareOcclusionCuller::addOccluder(const glm::vec3 *vertices, const uint32_t *indices, size_t indexCount, const glm::mat4 &modelMatrix)
+{
+	glm::mat4 mvpMatrix = viewProjMatrix * modelMatrix;
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		glm::vec4 clipVerts[3] = {mvpMatrix * glm::vec4(vertices[indices[i + 0]], 1.0f), mvpMatrix * glm::vec4(vertices[indices[i + 1]], 1.0f), mvpMatrix * glm::vec4(vertices[indices[i + 2]], 1.0f)};
+
+		// Skip triangles that are completely outside of one of the side or far planes
+		if ((clipVerts[0].x > clipVerts[0].w && clipVerts[1].x > clipVerts[1].w && clipVerts[2].x > clipVerts[2].w) ||
+			(clipVerts[0].x < -clipVerts[0].w && clipVerts[1].x < -clipVerts[1].w && clipVerts[2].x < -clipVerts[2].w) ||
+			(clipVerts[0].y > clipVerts[0].w && clipVerts[1].y > clipVerts[1].w && clipVerts[2].y > clipVerts[2].w) ||
+			(clipVerts[0].y < -clipVerts[0].w && clipVerts[1].y < -clipVerts[1].w && clipVerts[2].y < -clipVerts[2].w) ||
+			(clipVerts[0].z > clipVerts[0].w && clipVerts[1].z > clipVerts[1].w && clipVerts[2].z > clipVerts[2].w))
+			continue;
+
+		// Clip against the near plane (z >= 0), a triangle becomes at most a quad
+		glm::vec4 clippedVerts[4];
+		uint32_t clippedVertCount = 0;
+
+		for (uint32_t v = 0; v < 3; v++)
+		{
+			const glm::vec4 &current = clipVerts[v], &next = clipVerts[(v + 1) % 3];
+
+			if (current.z >= 0.0f)
+				clippedVerts[clippedVertCount++] = current;
+
+			if ((current.z >= 0.0f) != (next.z >= 0.0f))
+				clippedVerts[clippedVertCount++] = glm::mix(current, next, current.z / (current.z - next.z));
+		}
+
+		for (uint32_t v = 1; v + 1 < clippedVertCount; v++)
+			binTriangle(clippedVerts[0], clippedVerts[v], clippedVerts[v + 1]);
+	}
+}
+
+void SoftwareOcclusionCuller::binTriangle(const glm::vec4 &clipV0, const glm::vec4 &clipV1, const glm::vec4 &clipV2)
+{
+	if (clipV0.w <= 0.0f || clipV1.w <= 0.0f || clipV2.w <= 0.0f)
+		return;
+
+	glm::vec3 screenVerts[3];
+	const glm::vec4 *clipVerts[3] = {&clipV0, &clipV1, &clipV2};
+
+	for (uint32_t v = 0; v < 3; v++)
+	{
+		float invW = 1.0f / clipVerts[v]->w;
+		screenVerts[v] = glm::vec3((clipVerts[v]->x * invW * 0.5f + 0.5f) * float(width), (0.5f - clipVerts[v]->y * invW * 0.5f) * float(height), clipVerts[v]->z * invW);
+
+		// Snap to 1/8th of a pixel so the edge functions are exact, and a shared edge gives both triangles the same values at pixel centers
+		screenVerts[v].x = std::round(screenVerts[v].x * 8.0f) * 0.125f;
+		screenVerts[v].y = std::round(screenVerts[v].y * 8.0f) * 0.125f;
+	}
+
+	// Twice the signed area, flip the winding so the edge functions are always positive inside
+	float area = (screenVerts[1].x - screenVerts[0].x) * (screenVerts[2].y - screenVerts[0].y) - (screenVerts[1].y - screenVerts[0].y) * (screenVerts[2].x - screenVerts[0].x);
+
+	if (area == 0.0f || !std::isfinite(area))
+		return;
+
+	if (area < 0.0f)
+	{
+		std::swap(screenVerts[1], screenVerts[2]);
+		area = -area;
+	}
+
+	SoftwareOcclusionTriangle tri = {};
+	tri.minX = std::max(int32_t(std::floor(std::min(std::min(screenVerts[0].x, screenVerts[1].x), screenVerts[2].x))), 0);
+	tri.minY = std::max(int32_t(std::floor(std::min(std::min(screenVerts[0].y, screenVerts[1].y), screenVerts[2].y))), 0);
+	tri.maxX = std::min(int32_t(std::ceil(std::max(std::max(screenVerts[0].x, screenVerts[1].x), screenVerts[2].x))), int32_t(width));
+	tri.maxY = std::min(int32_t(std::ceil(std::max(std::max(screenVerts[0].y, screenVerts[1].y), screenVerts[2].y))), int32_t(height));
+
+	if (tri.minX >= tri.maxX || tri.minY >= tri.maxY)
+		return;
+
+	// Edge i is opposite of vertex i, so edge i / area is vertex i's barycentric weight
+	for (uint32_t e = 0; e < 3; e++)
+	{
+		const glm::vec3 &a = screenVerts[(e + 1) % 3], &b = screenVerts[(e + 2) % 3];
+
+		tri.edgeA[e] = a.y - b.y;
+		tri.edgeB[e] = b.x - a.x;
+		tri.edgeC[e] = -(tri.edgeA[e] * a.x + tri.edgeB[e] * a.y);
+	}
+
+	float invArea = 1.0f / area;
+	tri.zA = (tri.edgeA[0] * screenVerts[0].z + tri.edgeA[1] * screenVerts[1].z + tri.edgeA[2] * screenVerts[2].z) * invArea;
+	tri.zB = (tri.edgeB[0] * screenVerts[0].z + tri.edgeB[1] * screenVerts[1].z + tri.edgeB[2] * screenVerts[2].z) * invArea;
+	tri.zC = (tri.edgeC[0] * screenVerts[0].z + tri.edgeC[1] * screenVerts[1].z + tri.edgeC[2] * screenVerts[2].z) * invArea;
+
+	uint32_t triangleIndex = uint32_t(triangles.size());
+	triangles.push_back(tri);
+
+	for (int32_t tileY = tri.minY / SOFTWARE_OCCLUSION_TILE_SIZE; tileY <= (tri.maxY - 1) / SOFTWARE_OCCLUSION_TILE_SIZE; tileY++)
+		for (int32_t tileX = tri.minX / SOFTWARE_OCCLUSION_TILE_SIZE; tileX <= (tri.maxX - 1) / SOFTWARE_OCCLUSION_TILE_SIZE; tileX++)
+			tileTriangleBins[tileY * tileCountX + tileX].push_back(triangleIndex);
+}
+
+void SoftwareOcclusionCuller::rasterizeTile(uint32_t tileIndex)
+{
+	const int32_t tileMinX = int32_t(tileIndex % tileCountX) * SOFTWARE_OCCLUSION_TILE_SIZE;
+	const int32_t tileMinY = int32_t(tileIndex / tileCountX) * SOFTWARE_OCCLUSION_TILE_SIZE;
+	const int32_t tileMaxX = tileMinX + SOFTWARE_OCCLUSION_TILE_SIZE;
+	const int32_t tileMaxY = tileMinY + SOFTWARE_OCCLUSION_TILE_SIZE;
+
+	float *depthBuffer = depthLevels.data();
+
+	for (int32_t y = tileMinY; y < tileMaxY; y++)
+		std::fill(depthBuffer + size_t(y) * width + tileMinX, depthBuffer + size_t(y) * width + tileMaxX, 1.0f);
+
+	for (uint32_t triangleIndex : tileTriangleBins[tileIndex])
+	{
+		const SoftwareOcclusionTriangle &tri = triangles[triangleIndex];
+
+		const int32_t minX = std::max(tri.minX, tileMinX) & ~7, maxX = std::min(tri.maxX, tileMaxX);
+		const int32_t minY = std::max(tri.minY, tileMinY), maxY = std::min(tri.maxY, tileMaxY);
+
+		for (int32_t y = minY; y < maxY; y++)
+		{
+			const float pixelY = float(y) + 0.5f;
+			float *depthRow = depthBuffer + size_t(y) * width;
+
+			float rowEdge0 = tri.edgeB[0] * pixelY + tri.edgeC[0];
+			float rowEdge1 = tri.edgeB[1] * pixelY + tri.edgeC[1];
+			float rowEdge2 = tri.edgeB[2] * pixelY + tri.edgeC[2];
+			float rowDepth = tri.zB * pixelY + tri.zC;
+
+#if defined(__AVX2__)
+			const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			const __m256 edgeA0 = _mm256_set1_ps(tri.edgeA[0]), edgeA1 = _mm256_set1_ps(tri.edgeA[1]), edgeA2 = _mm256_set1_ps(tri.edgeA[2]), zA = _mm256_set1_ps(tri.zA);
+			const __m256 row0 = _mm256_set1_ps(rowEdge0), row1 = _mm256_set1_ps(rowEdge1), row2 = _mm256_set1_ps(rowEdge2), rowZ = _mm256_set1_ps(rowDepth);
+
+			for (int32_t x = minX; x < maxX; x += 8)
+			{
+				__m256 pixelX = _mm256_add_ps(_mm256_set1_ps(float(x)), laneOffsets);
+
+				__m256 edge0 = _mm256_add_ps(_mm256_mul_ps(edgeA0, pixelX), row0);
+				__m256 edge1 = _mm256_add_ps(_mm256_mul_ps(edgeA1, pixelX), row1);
+				__m256 edge2 = _mm256_add_ps(_mm256_mul_ps(edgeA2, pixelX), row2);
+
+				__m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(edge0, zero, _CMP_GE_OQ), _mm256_cmp_ps(edge1, zero, _CMP_GE_OQ)), _mm256_cmp_ps(edge2, zero, _CMP_GE_OQ));
+
+				if (_mm256_movemask_ps(inside) == 0)
+					continue;
+
+				__m256 depth = _mm256_add_ps(_mm256_mul_ps(zA, pixelX), rowZ);
+				__m256 current = _mm256_loadu_ps(depthRow + x);
+
+				_mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), inside));
+			}
+#else
+			for (int32_t x = minX; x < maxX; x++)
+			{
+				const float pixelX = float(x) + 0.5f;
+
+				if (tri.edgeA[0] * pixelX + rowEdge0 >= 0.0f && tri.edgeA[1] * pixelX + rowEdge1 >= 0.0f && tri.edgeA[2] * pixelX + rowEdge2 >= 0.0f)
+					depthRow[x] = std::min(depthRow[x], tri.zA * pixelX + rowDepth);
+			}
+#endif
+		}
+	}
+
+	// Each tile builds the levels of the hierarchy that fall entirely inside of it
+	for (uint32_t level = 1; (SOFTWARE_OCCLUSION_TILE_SIZE >> level) > 0; level++)
+	{
+		const uint32_t levelWidth = width >> level, prevLevelWidth = width >> (level - 1);
+		const float *prevLevel = depthLevels.data() + depthLevelOffsets[level - 1];
+		float *currentLevel = depthLevels.data() + depthLevelOffsets[level];
+
+		for (uint32_t y = uint32_t(tileMinY) >> level; y < uint32_t(tileMaxY) >> level; y++)
+		{
+			for (uint32_t x = uint32_t(tileMinX) >> level; x < uint32_t(tileMaxX) >> level; x++)
+			{
+				const float *prevTexels = prevLevel + size_t(y * 2) * prevLevelWidth + x * 2;
+
+				currentLevel[size_t(y) * levelWidth + x] = std::max(std::max(prevTexels[0], prevTexels[1]), std::max(prevTexels[prevLevelWidth], prevTexels[prevLevelWidth + 1]));
+			}
+		}
+	}
+}
+
+void SoftwareOcclusionCuller::rasterizeOccluders()
+{
+	const uint32_t tileCount = tileCountX * tileCountY;
+
+	std::vector<SoftwareOcclusionTileJobData> tileJobData(tileCount);
+	std::vector<Job*> tileJobs;
+
+	Job *rasterizeJob = JobSystem::get()->allocateJob(nullptr);
+
+	for (uint32_t i = 0; i < tileCount; i++)
+	{
+		tileJobData[i].culler = this;
+		tileJobData[i].tileIndex = i;
+
+		Job *tileJob = JobSystem::get()->allocateJobAsChild(rasterizeJob, softwareOcclusionTileJobFunction);
+		tileJob->usrData = &tileJobData[i];
+
+		tileJobs.push_back(tileJob);
+	}
+
+	JobSystem::get()->runJobs(tileJobs);
+	JobSystem::get()->runJob(rasterizeJob);
+	JobSystem::get()->waitForJob(rasterizeJob);
+
+	// The rest of the levels span multiple tiles, they're tiny so just build them here
+	for (uint32_t level = 1; level < depthLevelOffsets.size(); level++)
+	{
+		if ((SOFTWARE_OCCLUSION_TILE_SIZE >> level) > 0)
+			continue;
+
+		const uint32_t levelWidth = std::max(width >> level, 1u), levelHeight = std::max(height >> level, 1u);
+		const uint32_t prevLevelWidth = std::max(width >> (level - 1), 1u), prevLevelHeight = std::max(height >> (level - 1), 1u);
+		const float *prevLevel = depthLevels.data() + depthLevelOffsets[level - 1];
+		float *currentLevel = depthLevels.data() + depthLevelOffsets[level];
+
+		for (uint32_t y = 0; y < levelHeight; y++)
+		{
+			for (uint32_t x = 0; x < levelWidth; x++)
+			{
+				uint32_t x0 = std::min(x * 2, prevLevelWidth - 1), x1 = std::min(x * 2 + 1, prevLevelWidth - 1);
+				uint32_t y0 = std::min(y * 2, prevLevelHeight - 1), y1 = std::min(y * 2 + 1, prevLevelHeight - 1);
+
+				currentLevel[size_t(y) * levelWidth + x] = std::max(std::max(prevLevel[size_t(y0) * prevLevelWidth + x0], prevLevel[size_t(y0) * prevLevelWidth + x1]), std::max(prevLevel[size_t(y1) * prevLevelWidth + x0], prevLevel[size_t(y1) * prevLevelWidth + x1]));
+			}
+		}
+	}
+}
+
+bool SoftwareOcclusionCuller::isScreenRectVisible(float minX, float minY, float maxX, float maxY, float minDepth) const
+{
+	int32_t texelMinX = std::max(int32_t(std::floor(minX)), 0), texelMaxX = std::min(int32_t(std::floor(maxX)), int32_t(width) - 1);
+	int32_t texelMinY = std::max(int32_t(std::floor(minY)), 0), texelMaxY = std::min(int32_t(std::floor(maxY)), int32_t(height) - 1);
+
+	if (texelMinX > texelMaxX || texelMinY > texelMaxY)
+		return false;
+
+	// Pick the finest level where the rect covers at most 4x4 texels
+	uint32_t level = 0;
+
+	while (level + 1 < depthLevelOffsets.size() && ((texelMaxX >> level) - (texelMinX >> level) >= 4 || (texelMaxY >> level) - (texelMinY >> level) >= 4))
+		level++;
+
+	const uint32_t levelWidth = std::max(width >> level, 1u);
+	const float *levelDepth = depthLevels.data() + depthLevelOffsets[level];
+
+	for (int32_t y = texelMinY >> level; y <= (texelMaxY >> level); y++)
+		for (int32_t x = texelMinX >> level; x <= (texelMaxX >> level); x++)
+			if (minDepth <= levelDepth[size_t(y) * levelWidth + x])
+				return true;
+
+	return false;
+}
+
+bool SoftwareOcclusionCuller::isAABBVisible(const AABB &aabb) const
+{
+	glm::vec4 clipCorners[8];
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 cornerPos = glm::vec3(corner & 1 ? aabb.aabbMax.x : aabb.aabbMin.x, corner & 2 ? aabb.aabbMax.y : aabb.aabbMin.y, corner & 4 ? aabb.aabbMax.z : aabb.aabbMin.z);
+		clipCorners[corner] = viewProjMatrix * glm::vec4(cornerPos, 1.0f);
+	}
+
+	// Frustum test, the box is hidden if all of it's corners are outside of the same plane
+	uint32_t outsideMasks = 0x3F;
+	bool crossesNearPlane = false;
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const glm::vec4 &c = clipCorners[corner];
+		uint32_t outsideMask = (c.x < -c.w ? 0x1 : 0) | (c.x > c.w ? 0x2 : 0) | (c.y < -c.w ? 0x4 : 0) | (c.y > c.w ? 0x8 : 0) | (c.z < 0.0f ? 0x10 : 0) | (c.z > c.w ? 0x20 : 0);
+
+		outsideMasks &= outsideMask;
+		crossesNearPlane |= c.z < 0.0f;
+	}
+
+	if (outsideMasks != 0)
+		return false;
+
+	// Can't project a box that goes behind the camera, and it's right in front of the camera anyway
+	if (crossesNearPlane)
+		return true;
+
+	float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max(), minDepth = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const glm::vec4 &c = clipCorners[corner];
+		float invW = 1.0f / c.w;
+		float screenX = (c.x * invW * 0.5f + 0.5f) * float(width), screenY = (0.5f - c.y * invW * 0.5f) * float(height);
+
+		minX = std::min(minX, screenX);
+		maxX = std::max(maxX, screenX);
+		minY = std::min(minY, screenY);
+		maxY = std::max(maxY, screenY);
+		minDepth = std::min(minDepth, c.z * invW);
+	}
+
+	return isScreenRectVisible(minX, minY, maxX, maxY, minDepth);
+}
+
+bool SoftwareOcclusionCuller::isSphereVisible(const BoundingSphere &sphere) const
+{
+	AABB sphereAABB = {{sphere.position.x - sphere.radius, sphere.position.y - sphere.radius, sphere.position.z - sphere.radius, 0}, {sphere.position.x + sphere.radius, sphere.position.y + sphere.radius, sphere.position.z + sphere.radius, 0}};
+
+	return isAABBVisible(sphereAABB);
+}
+
+static void cullOctreeNode(const SoftwareOcclusionCuller &culler, const Octree<StaticObjectEntry> *node, const glm::vec3 &chunkOrigin, bool isRoot, std::vector<const StaticObjectEntry*> &visibleObjects)
+{
+	if (!isRoot)
+	{
+		AABB nodeAABB = {{node->boundingBox.aabbMin.x + chunkOrigin.x, node->boundingBox.aabbMin.y + chunkOrigin.y, node->boundingBox.aabbMin.z + chunkOrigin.z, 0}, {node->boundingBox.aabbMax.x + chunkOrigin.x, node->boundingBox.aabbMax.y + chunkOrigin.y, node->boundingBox.aabbMax.z + chunkOrigin.z, 0}};
+
+		if (!culler.isAABBVisible(nodeAABB))
+			return;
+	}
+
+	for (const StaticObjectEntry &item : node->items)
+	{
+		BoundingSphere sphere = item.getBoundingSphere();
+		sphere.position = {sphere.position.x + chunkOrigin.x, sphere.position.y + chunkOrigin.y, sphere.position.z + chunkOrigin.z};
+
+		if (culler.isSphereVisible(sphere))
+			visibleObjects.push_back(&item);
+	}
+
+	for (int child = 0; child < 8; child++)
+		if (node->children[child] != nullptr)
+			cullOctreeNode(culler, node->children[child], chunkOrigin, false, visibleObjects);
+}
+
+void SoftwareOcclusionCuller::cullOctree(const Octree<StaticObjectEntry> *chunkOctree, const glm::vec3 &chunkOrigin, std::vector<const StaticObjectEntry*> &visibleObjects) const
+{
+	if (chunkOctree != nullptr)
+		cullOctreeNode(*this, chunkOctree, chunkOrigin, true, visibleObjects);
+}
+
+uint32_t SoftwareOcclusionCuller::getWidth() const
+{
+	return width;
+}
+
+uint32_t SoftwareOcclusionCuller::getHeight() const
+{
+	return height;
+}
+
+const float *SoftwareOcclusionCuller::getDepthLevel(uint32_t level, uint32_t &levelWidth, uint32_t &levelHeight) const
+{
+	level = std::min<uint32_t>(level, uint32_t(depthLevelOffsets.size() - 1));
+	levelWidth = std::max(width >> level, 1u);
+	levelHeight = std::max(height >> level, 1u);
+
+	return depthLevels.data() + depthLevelOffsets[level];
+}
+
+bool SoftwareOcclusionCuller::test()
+{
+	SoftwareOcclusionCuller culler(512, 256);
+
+	// Camera at the origin looking down -Z, w/ a 12x12 wall 10 units away and a 4x4x4 cube off to the right
+	glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projMatrix = glm::perspective(glm::radians(90.0f), 2.0f, 0.1f, 1000.0f);
+
+	const glm::vec3 wallVertices[4] = {{-6.0f, -6.0f, -10.0f}, {6.0f, -6.0f, -10.0f}, {6.0f, 6.0f, -10.0f}, {-6.0f, 6.0f, -10.0f}};
+	const uint32_t wallIndices[6] = {0, 1, 2, 2, 3, 0};
+
+	const glm::vec3 cubeVertices[8] = {{-1, -1, -1}, {1, -1, -1}, {-1, 1, -1}, {1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {-1, 1, 1}, {1, 1, 1}};
+	const uint32_t cubeIndices[36] = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+	glm::mat4 cubeModelMatrix = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(20.0f, 0.0f, -20.0f)), glm::vec3(2.0f));
+
+	culler.beginFrame(projMatrix * viewMatrix);
+	culler.addOccluder(wallVertices, wallIndices, 6, glm::mat4(1.0f));
+	culler.addOccluder(cubeVertices, cubeIndices, 36, cubeModelMatrix);
+	culler.rasterizeOccluders();
+
+	struct
+	{
+		const char *name;
+		AABB aabb;
+		bool visible;
+	} aabbCases[] = {
+		{"behind the wall", {{-1, -1, -21, 0}, {1, 1, -19, 0}}, false},
+		{"in front of the wall", {{-1, -1, -6, 0}, {1, 1, -4, 0}}, true},
+		{"beside the wall", {{11, -1, -21, 0}, {13, 1, -19, 0}}, true},
+		{"peeking out from behind the wall", {{8, -1, -21, 0}, {12, 1, -19, 0}}, true},
+		{"behind the cube", {{29.5f, -0.5f, -30.5f, 0}, {30.5f, 0.5f, -29.5f, 0}}, false},
+		{"behind the camera", {{-1, -1, 4, 0}, {1, 1, 6, 0}}, false},
+		{"crossing the near plane", {{-1, -1, -1, 0}, {1, 1, 1, 0}}, true},
+		{"past the far plane", {{-1, -1, -1100, 0}, {1, 1, -1050, 0}}, false},
+		{"outside the left plane", {{-50, -1, -11, 0}, {-48, 1, -9, 0}}, false},
+		{"far behind the wall", {{-8, -8, -100, 0}, {8, 8, -90, 0}}, false},
+		{"wide & far behind the wall", {{-30, -30, -100, 0}, {30, 30, -90, 0}}, false}
+	};
+
+	struct
+	{
+		const char *name;
+		BoundingSphere sphere;
+		bool visible;
+	} sphereCases[] = {
+		{"sphere behind the wall", {{0, 3, -30}, 2}, false},
+		{"sphere in front of the wall", {{0, 0, -9}, 0.5f}, true}
+	};
+
+	bool passed = true;
+
+	for (const auto &testCase : aabbCases)
+	{
+		if (culler.isAABBVisible(testCase.aabb) != testCase.visible)
+		{
+			Log::get()->error("SoftwareOcclusionCuller test: AABB {} should be {}", testCase.name, testCase.visible ? "visible" : "hidden");
+			passed = false;
+		}
+	}
+
+	for (const auto &testCase : sphereCases)
+	{
+		if (culler.isSphereVisible(testCase.sphere) != testCase.visible)
+		{
+			Log::get()->error("SoftwareOcclusionCuller test: {} should be {}", testCase.name, testCase.visible ? "visible" : "hidden");
+			passed = false;
+		}
+	}
+
+	// A chunk sitting behind the wall, only the objects that are off to the side of it should be visible
+	std::vector<StaticObjectEntry> items;
+	const svec3 itemPositions[4] = {{128, 128, 250}, {168, 128, 250}, {128, 128, 10}, {48, 128, 200}};
+	const float itemRadii[4] = {1.0f, 1.0f, 5.0f, 1.0f};
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		StaticObjectEntry entry = {};
+		entry.objectUUID = i + 1;
+		entry.position = itemPositions[i];
+		entry.scale = 1.0f;
+		entry.orientation = {0, 0, 0, 1};
+		entry.boundingSphereRadius = itemRadii[i];
+
+		items.push_back(entry);
+	}
+
+	Octree<StaticObjectEntry> chunkOctree;
+	chunkOctree.boundingBox = {{0, 0, 0, 0}, {float(WORLD_CHUNK_SIZE), float(WORLD_CHUNK_SIZE), float(WORLD_CHUNK_SIZE), 0}};
+	insertItemsIntoOctree(&chunkOctree, items);
+
+	std::vector<const StaticObjectEntry*> visibleObjects;
+	culler.cullOctree(&chunkOctree, glm::vec3(-128.0f, -128.0f, -300.0f), visibleObjects);
+
+	std::vector<uint64_t> visibleUUIDs;
+
+	for (const StaticObjectEntry *object : visibleObjects)
+		visibleUUIDs.push_back(object->objectUUID);
+
+	std::sort(visibleUUIDs.begin(), visibleUUIDs.end());
+
+	if (visibleUUIDs != std::vector<uint64_t>({2, 4}))
+	{
+		Log::get()->error("SoftwareOcclusionCuller test: Octree culling found {} visible objects, expected objects 2 & 4 to be the only visible ones", visibleUUIDs.size());
+		passed = false;
+	}
+
+	std::function<void(Octree<StaticObjectEntry>*)> deleteChildren = [&](Octree<StaticObjectEntry> *node) {
+		for (int child = 0; child < 8; child++)
+		{
+			if (node->children[child] != nullptr)
+			{
+				deleteChildren(node->children[child]);
+				delete node->children[child];
+			}
+		}
+	};
+
+	deleteChildren(&chunkOctree);
+
+	if (passed)
+		Log::get()->info("SoftwareOcclusionCuller test passed");
+
+	return passed;
+}
@@ -0,0 +1,87 @@
+#ifndef RENDERER_WORLD_SOFTWAREOCCLUSIONCULLER_H_
+#define RENDERER_WORLD_SOFTWAREOCCLUSIONCULLER_H_
+
+#include <common.h>
+
+#include <World/WorldManager.h>
+
+#define SOFTWARE_OCCLUSION_TILE_SIZE 64
+
+/*
+A triangle that's been transformed, clipped and projected, ready to be rasterized. Edge functions are A * x + B * y + C, all three are
+non-negative inside the triangle, and depth is the plane zA * x + zB * y + zC, all in pixel coordinates. Pixels exactly on an edge are
+covered by both of the triangles that share it, so there are never any gaps along the diagonals of a mesh.
+*/
+struct SoftwareOcclusionTriangle
+{
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	float zA, zB, zC;
+	int32_t minX, minY, maxX, maxY; // Pixel bounds, max is exclusive
+};
+
+/*
+Culls objects on the CPU against a small depth buffer of a few large occluders, before they're ever sent to the GPU.
+
+Each frame: beginFrame() w/ the camera's view projection matrix, addOccluder() for each occluder mesh, then rasterizeOccluders(), which
+rasterizes the occluders in parallel tiles on the job system (8 pixels at a time w/ AVX2 when it's available) and builds a max depth
+hierarchy. After that the visibility queries can be called from any thread. The depth buffer uses the same [0, 1] depth range as the
+renderer (GLM_FORCE_DEPTH_ZERO_TO_ONE) w/ the near plane at 0, and anything outside of the view frustum is reported as not visible.
+*/
+class SoftwareOcclusionCuller
+{
+public:
+	SoftwareOcclusionCuller(uint32_t width = 512, uint32_t height = 256);
+	virtual ~SoftwareOcclusionCuller();
+
+	void beginFrame(const glm::mat4 &viewProjMatrix);
+	void addOccluder(const glm::vec3 *vertices, const uint32_t *indices, size_t indexCount, const glm::mat4 &modelMatrix);
+	void rasterizeOccluders();
+
+	bool isAABBVisible(const AABB &aabb) const;
+	bool isSphereVisible(const BoundingSphere &sphere) const;
+
+	/*
+	Walks a chunk's octree, skipping any node whose AABB is hidden, and appends all of the objects whose bounding spheres are visible.
+	Octree bounds are chunk local, 'chunkOrigin' moves them into world space. The root node is never skipped since it holds any objects
+	that didn't fit inside of the chunk.
+	*/
+	void cullOctree(const Octree<StaticObjectEntry> *chunkOctree, const glm::vec3 &chunkOrigin, std::vector<const StaticObjectEntry*> &visibleObjects) const;
+
+	uint32_t getWidth() const;
+	uint32_t getHeight() const;
+
+	/*
+	Returns one of the depth hierarchy's levels, level 0 is the full res depth buffer, each level after that holds the max depth of 2x2 texels
+	*/
+	const float *getDepthLevel(uint32_t level, uint32_t &levelWidth, uint32_t &levelHeight) const;
+
+	/*
+	Checks the culler's results for a fixed scene against known visibility results, returns false and logs the cases that don't match
+	*/
+	static bool test();
+
+private:
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileCountX;
+	uint32_t tileCountY;
+
+	glm::mat4 viewProjMatrix;
+
+	std::vector<float> depthLevels; // All of the hierarchy's levels back to back
+	std::vector<size_t> depthLevelOffsets;
+
+	std::vector<SoftwareOcclusionTriangle> triangles;
+	std::vector<std::vector<uint32_t>> tileTriangleBins;
+
+	void binTriangle(const glm::vec4 &clipV0, const glm::vec4 &clipV1, const glm::vec4 &clipV2);
+	void rasterizeTile(uint32_t tileIndex);
+	bool isScreenRectVisible(float minX, float minY, float maxX, float maxY, float minDepth) const;
+
+	friend void softwareOcclusionTileJobFunction(Job *job);
+};
+
+#endif /* RENDERER_WORLD_SOFTWAREOCCLUSIONCULLER_H_ */
@@ -0,0 +1,1024 @@
+#include "WorldCullingRenderer.h"
+
+#include <Game/KalosEngine.h>
+
+#include <RendererCore/Renderer.h>
+#include <RendererCore/UploadManager.h>
+
+#include <Resources/ResourceManager.h>
+
+WorldCullingRenderer::WorldCullingRenderer(KalosEngine *enginePtr)
+{
+	engine = enginePtr;
+	renderer = engine->renderer.get();
+
+	currentWorld = nullptr;
+	currentCameraChunk = {0, 0};
+	viewProjMatrix = glm::mat4(1.0f);
+	cameraPosition = glm::vec3(0.0f);
+	lodScale = 1.0f;
+
+	objectCount = 0;
+
+	objectBuffer = nullptr;
+	drawGroupBuffer = nullptr;
+	drawCommandTemplateBuffer = nullptr;
+	objectVisibilityBuffer = nullptr;
+
+	graphOccluderDrawCommandsBuffer = nullptr;
+	graphOccluderDrawCountsBuffer = nullptr;
+	graphOccluderInstancesBuffer = nullptr;
+	graphDrawCountsBuffer = nullptr;
+	graphClusterDrawCountsBuffer = nullptr;
+	graphHiZTexture = nullptr;
+	occluderDepthSize = glm::uvec2(0);
+
+	resetDrawGroupsPipeline = nullptr;
+	cullObjectsEarlyPipeline = nullptr;
+	cullObjectsLatePipeline = nullptr;
+	buildDrawCommandsPipeline = nullptr;
+	occluderDepthPipeline = nullptr;
+	hiZBuildPipeline = nullptr;
+	resetClusterGroupsPipeline = nullptr;
+	cullClustersPipeline = nullptr;
+
+	cullDescriptorPool = nullptr;
+	earlyCullDescriptorSet = nullptr;
+	cullDescriptorSet = nullptr;
+
+	hiZDescriptorPool = nullptr;
+
+	clusterCullDescriptorPool = nullptr;
+	clusterModelDescriptorPool = nullptr;
+	clusterCullDescriptorSet = nullptr;
+}
+
+WorldCullingRenderer::~WorldCullingRenderer()
+{
+	destroyStaticObjectBuffers();
+
+	renderer->destroyPipeline(resetDrawGroupsPipeline);
+	renderer->destroyPipeline(cullObjectsEarlyPipeline);
+	renderer->destroyPipeline(cullObjectsLatePipeline);
+	renderer->destroyPipeline(buildDrawCommandsPipeline);
+	renderer->destroyPipeline(occluderDepthPipeline);
+	renderer->destroyPipeline(hiZBuildPipeline);
+	renderer->destroyPipeline(resetClusterGroupsPipeline);
+	renderer->destroyPipeline(cullClustersPipeline);
+
+	renderer->destroyDescriptorPool(cullDescriptorPool);
+	renderer->destroyDescriptorPool(hiZDescriptorPool);
+	renderer->destroyDescriptorPool(clusterCullDescriptorPool);
+	renderer->destroyDescriptorPool(clusterModelDescriptorPool);
+}
+
+void WorldCullingRenderer::update(float delta)
+{
+	const WorldInfo *activeWorld = engine->worldManager->getActiveWorld();
+	sivec2 cameraChunk = getWorldChunkAtPosition(cameraPosition);
+
+	// Only the chunks in view are uploaded, so they're rebuilt whenever the camera moves into another chunk
+	if (activeWorld != currentWorld || (activeWorld != nullptr && !(cameraChunk == currentCameraChunk)))
+	{
+		buildStaticObjectBuffers(activeWorld);
+		currentWorld = activeWorld;
+		currentCameraChunk = cameraChunk;
+	}
+}
+
+void WorldCullingRenderer::setCamera(const glm::mat4 &viewProjMatrix, const glm::vec3 &cameraPosition, float lodScale)
+{
+	this->viewProjMatrix = viewProjMatrix;
+	this->cameraPosition = cameraPosition;
+	this->lodScale = lodScale;
+}
+
+const std::vector<WorldDrawGroup> &WorldCullingRenderer::getDrawGroups() const
+{
+	return drawGroups;
+}
+
+const std::vector<WorldClusterGroup> &WorldCullingRenderer::getClusterGroups() const
+{
+	return clusterGroups;
+}
+
+void WorldCullingRenderer::getDrawGroupScreenCoverages(std::vector<float> &screenCoverages) const
+{
+	screenCoverages.assign(drawGroups.size(), 0.0f);
+
+	for (const WorldDrawGroupChunkBounds &bounds : drawGroupChunkBounds)
+	{
+		float distance = glm::length(glm::vec3(bounds.centerBounds) - cameraPosition) - bounds.centerBounds.w;
+		float screenCoverage = distance > bounds.maxObjectRadius ? bounds.maxObjectRadius * lodScale / distance : 1.0f;
+
+		screenCoverages[bounds.drawGroup] = std::max(screenCoverages[bounds.drawGroup], screenCoverage);
+	}
+}
+
+static void gatherModelDrawPrimitives(const std::vector<ModelMeshNode> &nodes, std::vector<ModelMeshDrawPrimitive> &drawPrimitives)
+{
+	for (const ModelMeshNode &node : nodes)
+	{
+		drawPrimitives.insert(drawPrimitives.end(), node.drawPrimitives.begin(), node.drawPrimitives.end());
+		gatherModelDrawPrimitives(node.children, drawPrimitives);
+	}
+}
+
+static void gatherOctreeObjects(const Octree<StaticObjectEntry> *node, std::vector<const StaticObjectEntry*> &objects)
+{
+	for (const StaticObjectEntry &item : node->items)
+		objects.push_back(&item);
+
+	for (int child = 0; child < 8; child++)
+		if (node->children[child] != nullptr)
+			gatherOctreeObjects(node->children[child], objects);
+}
+
+void WorldCullingRenderer::buildStaticObjectBuffers(const WorldInfo *world)
+{
+	// The old buffers (and the descriptor set that points to them) could still be in use by the last frame
+	renderer->waitForDeviceIdle();
+	destroyStaticObjectBuffers();
+
+	if (world == nullptr)
+		return;
+
+	std::vector<const StaticObjectEntry*> chunkObjects;
+	std::vector<glm::vec3> chunkObjectOrigins;
+
+	forEachWorldChunkInView(*world, cameraPosition, [&](int32_t chunkX, int32_t chunkY, size_t chunkIndex) {
+		const Octree<StaticObjectEntry> *chunkOctree = world->staticObjectData[chunkIndex].chunkOctree;
+
+		if (chunkOctree == nullptr)
+			return;
+
+		gatherOctreeObjects(chunkOctree, chunkObjects);
+
+		// Object positions are relative to the chunk on the XZ plane
+		chunkObjectOrigins.resize(chunkObjects.size(), glm::vec3(float(chunkX * WORLD_CHUNK_SIZE), 0.0f, float(chunkY * WORLD_CHUNK_SIZE)));
+	});
+
+	// Sort the objects into groups, the map keeps groups w/ the same mesh next to each other so the gbuffer pass rebinds the model buffer less
+	std::map<std::pair<uint64_t, uint64_t>, uint32_t> groupObjectCounts;
+	std::map<uint64_t, std::vector<ModelMeshDrawPrimitive>> modelDrawPrimitives;
+	std::map<uint64_t, ResourceHandle> modelHandles;
+	size_t objectsMissingModels = 0;
+
+	for (const StaticObjectEntry *object : chunkObjects)
+	{
+		if (modelDrawPrimitives.count(object->meshID) == 0)
+		{
+			ResourceHandle modelHandle = engine->resourceManager->findModel(object->meshID);
+			ModelResource *model = engine->resourceManager->getModel(modelHandle);
+			std::vector<ModelMeshDrawPrimitive> &primitives = modelDrawPrimitives[object->meshID];
+
+			if (model != nullptr)
+			{
+				gatherModelDrawPrimitives(model->meshNodes, primitives);
+				modelHandles[object->meshID] = modelHandle;
+			}
+		}
+
+		if (modelDrawPrimitives[object->meshID].size() == 0)
+		{
+			objectsMissingModels++;
+			continue;
+		}
+
+		groupObjectCounts[std::make_pair(object->meshID, object->materialID)]++;
+	}
+
+	if (objectsMissingModels > 0)
+		Log::get()->warn("WorldCullingRenderer: {} objects in world \"{}\" use meshes that aren't loaded, they won't be drawn", objectsMissingModels, world->uniqueName);
+
+	std::map<std::pair<uint64_t, uint64_t>, uint32_t> groupIndices;
+	std::vector<DrawIndexedIndirectCommand> drawCommandTemplates;
+	std::vector<WorldCullingGPUDrawGroup> gpuDrawGroups;
+	uint32_t instanceCount = 0;
+
+	for (auto groupIt = groupObjectCounts.begin(); groupIt != groupObjectCounts.end(); groupIt++)
+	{
+		const std::vector<ModelMeshDrawPrimitive> &primitives = modelDrawPrimitives[groupIt->first.first];
+		ResourceHandle modelHandle = modelHandles[groupIt->first.first];
+		ModelResource *model = engine->resourceManager->getModel(modelHandle);
+		uint32_t lodCount = std::max(std::min(model->lodCount, uint32_t(MODEL_MAX_LOD_LEVELS)), 1u);
+
+		if (drawGroups.size() + lodCount > WORLD_CULLING_MAX_DRAW_GROUPS || drawCommandTemplates.size() + lodCount * primitives.size() > WORLD_CULLING_MAX_DRAW_COMMANDS || instanceCount + lodCount * groupIt->second > WORLD_CULLING_MAX_OBJECTS)
+		{
+			Log::get()->warn("WorldCullingRenderer: World \"{}\" has more objects or mesh/material combinations than the culling pass can hold, some of them won't be drawn", world->uniqueName);
+			break;
+		}
+
+		groupIndices[groupIt->first] = uint32_t(drawGroups.size());
+
+		// The groups point straight at their model, so it can't be evicted while they're uploaded
+		engine->resourceManager->acquireModel(modelHandle);
+		drawGroupModelHandles.push_back(modelHandle);
+
+		// Any object could be at any LOD, so every LOD's group needs room for all of them
+		for (uint32_t lod = 0; lod < lodCount; lod++)
+		{
+			WorldDrawGroup group = {};
+			group.meshID = groupIt->first.first;
+			group.materialID = groupIt->first.second;
+			group.modelHandle = modelHandle;
+			group.model = model;
+			group.lod = lod;
+			group.firstDrawCommand = uint32_t(drawCommandTemplates.size());
+			group.drawCommandCount = uint32_t(primitives.size());
+			group.firstInstance = instanceCount;
+			group.instanceCapacity = groupIt->second;
+			group.clusterGroup = ~0u;
+
+			for (const ModelMeshDrawPrimitive &primitive : primitives)
+			{
+				ModelMeshLODRange lodRange = primitive.getLODRange(lod);
+
+				DrawIndexedIndirectCommand command = {};
+				command.indexCount = lodRange.indexCount;
+				command.instanceCount = 0;
+				command.firstIndex = lodRange.firstIndex;
+				command.vertexOffset = primitive.vertexOffset;
+				command.firstInstance = group.firstInstance;
+
+				drawCommandTemplates.push_back(command);
+			}
+
+			WorldCullingGPUDrawGroup gpuGroup = {};
+			gpuGroup.firstDrawCommand = group.firstDrawCommand;
+			gpuGroup.drawCommandCount = group.drawCommandCount;
+			gpuGroup.firstInstance = group.firstInstance;
+			gpuGroup.lodCount = lodCount;
+
+			for (uint32_t l = 1; l < lodCount; l++)
+				gpuGroup.lodScreenCoverages[l - 1] = model->lodScreenCoverages[l];
+
+			drawGroups.push_back(group);
+			gpuDrawGroups.push_back(gpuGroup);
+
+			instanceCount += group.instanceCapacity;
+		}
+	}
+
+	std::vector<WorldCullingObject> objects;
+	objects.reserve(instanceCount);
+
+	// Bounds of each draw group's object centers in the current chunk, a chunk's objects are next to each other in chunkObjects
+	typedef struct
+	{
+		glm::vec3 centerMin;
+		glm::vec3 centerMax;
+		float maxObjectRadius;
+		uint32_t drawGroup;
+	} DrawGroupChunkAABB;
+
+	std::vector<DrawGroupChunkAABB> chunkGroupAABBs;
+	std::map<uint32_t, size_t> currentChunkGroupAABBs;
+
+	for (size_t i = 0; i < chunkObjects.size(); i++)
+	{
+		const StaticObjectEntry &object = *chunkObjects[i];
+
+		if (i > 0 && chunkObjectOrigins[i] != chunkObjectOrigins[i - 1])
+			currentChunkGroupAABBs.clear();
+
+		auto groupIndexIt = groupIndices.find(std::make_pair(object.meshID, object.materialID));
+
+		if (groupIndexIt == groupIndices.end())
+			continue;
+
+		glm::vec3 position = chunkObjectOrigins[i] + glm::vec3(object.position.x, object.position.y, object.position.z);
+		glm::quat orientation = glm::quat(object.orientation.w, object.orientation.x, object.orientation.y, object.orientation.z);
+		BoundingSphere sphere = object.getBoundingSphere();
+
+		WorldCullingObject gpuObject = {};
+		gpuObject.position_scale = drawGroups[groupIndexIt->second].model->getInstancePositionScale(position, object.scale, orientation);
+		gpuObject.orientation = glm::vec4(object.orientation.x, object.orientation.y, object.orientation.z, object.orientation.w);
+		gpuObject.boundingSphere = glm::vec4(position, sphere.radius);
+		gpuObject.drawGroup = groupIndexIt->second;
+
+		objects.push_back(gpuObject);
+
+		auto aabbIt = currentChunkGroupAABBs.find(gpuObject.drawGroup);
+
+		if (aabbIt == currentChunkGroupAABBs.end())
+		{
+			aabbIt = currentChunkGroupAABBs.insert(std::make_pair(gpuObject.drawGroup, chunkGroupAABBs.size())).first;
+			chunkGroupAABBs.push_back({position, position, 0.0f, gpuObject.drawGroup});
+		}
+
+		DrawGroupChunkAABB &aabb = chunkGroupAABBs[aabbIt->second];
+		aabb.centerMin = glm::min(aabb.centerMin, position);
+		aabb.centerMax = glm::max(aabb.centerMax, position);
+		aabb.maxObjectRadius = std::max(aabb.maxObjectRadius, sphere.radius);
+	}
+
+	for (const DrawGroupChunkAABB &aabb : chunkGroupAABBs)
+	{
+		WorldDrawGroupChunkBounds bounds = {};
+		bounds.centerBounds = glm::vec4((aabb.centerMin + aabb.centerMax) * 0.5f, glm::length(aabb.centerMax - aabb.centerMin) * 0.5f);
+		bounds.maxObjectRadius = aabb.maxObjectRadius;
+		bounds.drawGroup = aabb.drawGroup;
+
+		drawGroupChunkBounds.push_back(bounds);
+	}
+
+	objectCount = uint32_t(objects.size());
+
+	if (objectCount == 0)
+	{
+		drawGroups.clear();
+
+		return;
+	}
+
+	// Everything starts out hidden, so the first frame's early phase draws no occluders and the late phase tests everything against an empty Hi-Z
+	std::vector<uint32_t> objectVisibility(objects.size(), 0);
+
+	objectBuffer = renderer->createBuffer(objects.size() * sizeof(objects[0]), BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY);
+	drawGroupBuffer = renderer->createBuffer(gpuDrawGroups.size() * sizeof(gpuDrawGroups[0]), BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY);
+	drawCommandTemplateBuffer = renderer->createBuffer(drawCommandTemplates.size() * sizeof(drawCommandTemplates[0]), BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY);
+	objectVisibilityBuffer = renderer->createBuffer(objectVisibility.size() * sizeof(objectVisibility[0]), BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY);
+
+	UploadManager *uploadManager = engine->uploadManager.get();
+	uploadManager->uploadBuffer(objectBuffer, 0, objects.data(), objects.size() * sizeof(objects[0]));
+	uploadManager->uploadBuffer(drawGroupBuffer, 0, gpuDrawGroups.data(), gpuDrawGroups.size() * sizeof(gpuDrawGroups[0]));
+	uploadManager->uploadBuffer(drawCommandTemplateBuffer, 0, drawCommandTemplates.data(), drawCommandTemplates.size() * sizeof(drawCommandTemplates[0]));
+	uploadManager->uploadBuffer(objectVisibilityBuffer, 0, objectVisibility.data(), objectVisibility.size() * sizeof(objectVisibility[0]));
+
+	std::vector<ResourceBarrier> barriers;
+
+	for (Buffer buffer : {objectBuffer, drawGroupBuffer, drawCommandTemplateBuffer, objectVisibilityBuffer})
+	{
+		ResourceBarrier barrier = {};
+		barrier.barrierType = RESOURCE_BARRIER_TYPE_BUFFER_TRANSITION;
+		barrier.bufferTransition.oldLayout = BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.bufferTransition.newLayout = BUFFER_LAYOUT_GENERAL;
+		barrier.bufferTransition.buffer = buffer;
+
+		barriers.push_back(barrier);
+	}
+
+	uploadManager->recordBarriers(barriers);
+
+	// This frame's batch was already submitted before the game state's update, so these uploads are submitted now to be on the queue ahead of the culling passes
+	uploadManager->submit();
+
+	if (earlyCullDescriptorSet != nullptr)
+		writeStaticObjectDescriptors(earlyCullDescriptorSet);
+
+	if (cullDescriptorSet != nullptr)
+		writeStaticObjectDescriptors(cullDescriptorSet);
+
+	buildClusterGroups();
+
+	Log::get()->info("WorldCullingRenderer: Uploaded {} objects in {} draw groups ({} cluster culled) w/ {} draw commands for world \"{}\"", objectCount, drawGroups.size(), clusterGroups.size(), drawCommandTemplates.size(), world->uniqueName);
+}
+
+void WorldCullingRenderer::buildClusterGroups()
+{
+	// The cluster culling pass hasn't been initialized, so nothing can be cluster culled
+	if (clusterModelDescriptorPool == nullptr)
+		return;
+
+	std::map<ModelResource*, DescriptorSet> modelDescriptorSets;
+	uint32_t clusterInstanceCount = 0;
+
+	for (uint32_t g = 0; g < uint32_t(drawGroups.size()); g++)
+	{
+		WorldDrawGroup &group = drawGroups[g];
+
+		if (group.lod != 0 || group.model->meshlets.size() < WORLD_CLUSTER_CULLING_MIN_MESHLETS)
+			continue;
+
+		if (clusterInstanceCount + group.instanceCapacity > WORLD_CLUSTER_CULLING_MAX_INSTANCES || (modelDescriptorSets.count(group.model) == 0 && modelDescriptorSets.size() == WORLD_CLUSTER_CULLING_MAX_MODELS))
+			continue;
+
+		auto modelSetIt = modelDescriptorSets.find(group.model);
+
+		if (modelSetIt == modelDescriptorSets.end())
+		{
+			DescriptorWriteInfo write = {};
+			write.descriptorType = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			write.dstBinding = 0;
+			write.dstArrayElement = 0;
+			write.bufferInfo = {{group.model->modelBuffer, 0, group.model->modelBuffer->bufferSize}};
+
+			DescriptorSet modelSet = clusterModelDescriptorPool->allocateDescriptorSet();
+			renderer->writeDescriptorSets(modelSet, {write});
+
+			modelSetIt = modelDescriptorSets.insert(std::make_pair(group.model, modelSet)).first;
+		}
+
+		WorldClusterGroup clusterGroup = {};
+		clusterGroup.drawGroup = g;
+		clusterGroup.model = group.model;
+		clusterGroup.firstDrawCommand = clusterInstanceCount;
+		clusterGroup.modelDescriptorSet = modelSetIt->second;
+
+		group.clusterGroup = uint32_t(clusterGroups.size());
+		clusterGroups.push_back(clusterGroup);
+
+		clusterInstanceCount += group.instanceCapacity;
+	}
+}
+
+void WorldCullingRenderer::destroyStaticObjectBuffers()
+{
+	if (objectBuffer != nullptr)
+		renderer->destroyBuffer(objectBuffer);
+
+	if (drawGroupBuffer != nullptr)
+		renderer->destroyBuffer(drawGroupBuffer);
+
+	if (drawCommandTemplateBuffer != nullptr)
+		renderer->destroyBuffer(drawCommandTemplateBuffer);
+
+	if (objectVisibilityBuffer != nullptr)
+		renderer->destroyBuffer(objectVisibilityBuffer);
+
+	objectBuffer = nullptr;
+	drawGroupBuffer = nullptr;
+	drawCommandTemplateBuffer = nullptr;
+	objectVisibilityBuffer = nullptr;
+
+	// Groups of the same model share a set
+	std::map<ModelResource*, DescriptorSet> clusterModelDescriptorSets;
+
+	for (const WorldClusterGroup &clusterGroup : clusterGroups)
+		clusterModelDescriptorSets[clusterGroup.model] = clusterGroup.modelDescriptorSet;
+
+	for (auto modelSetIt = clusterModelDescriptorSets.begin(); modelSetIt != clusterModelDescriptorSets.end(); modelSetIt++)
+		clusterModelDescriptorPool->freeDescriptorSet(modelSetIt->second);
+
+	for (ResourceHandle modelHandle : drawGroupModelHandles)
+		engine->resourceManager->releaseModel(modelHandle);
+
+	drawGroups.clear();
+	drawGroupModelHandles.clear();
+	clusterGroups.clear();
+	drawGroupChunkBounds.clear();
+	objectCount = 0;
+}
+
+void WorldCullingRenderer::writeStaticObjectDescriptors(DescriptorSet descriptorSet)
+{
+	if (objectBuffer == nullptr)
+		return;
+
+	Buffer staticBuffers[4] = {objectBuffer, drawGroupBuffer, drawCommandTemplateBuffer, objectVisibilityBuffer};
+	uint32_t staticBufferBindings[4] = {0, 1, 2, 6};
+
+	std::vector<DescriptorWriteInfo> writes(4);
+
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		writes[i].descriptorType = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].dstBinding = staticBufferBindings[i];
+		writes[i].dstArrayElement = 0;
+		writes[i].bufferInfo = {{staticBuffers[i], 0, staticBuffers[i]->bufferSize}};
+	}
+
+	renderer->writeDescriptorSets(descriptorSet, writes);
+}
+
+void WorldCullingRenderer::writeCullPassGraphDescriptors(DescriptorSet descriptorSet, const RenderGraphDescriptorUpdateFunctionData &data, const std::string &drawCommandsName, const std::string &drawCountsName, const std::string &instancesName)
+{
+	const std::string graphBufferNames[3] = {drawCommandsName, drawCountsName, instancesName};
+
+	std::vector<DescriptorWriteInfo> writes(4);
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		Buffer graphBuffer = data.graphBuffers.at(graphBufferNames[i]);
+
+		writes[i].descriptorType = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].dstBinding = 3 + i;
+		writes[i].dstArrayElement = 0;
+		writes[i].bufferInfo = {{graphBuffer, 0, graphBuffer->bufferSize}};
+	}
+
+	// The early phase never reads the Hi-Z, but the binding is still written so every descriptor in the set is valid
+	DescriptorTextureInfo hiZ = {};
+	hiZ.layout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	hiZ.view = data.graphTextureViews.at("worldHiZ");
+
+	writes[3].descriptorType = DESCRIPTOR_TYPE_SAMPLED_TEXTURE;
+	writes[3].dstBinding = 7;
+	writes[3].dstArrayElement = 0;
+	writes[3].textureInfo = {hiZ};
+
+	renderer->writeDescriptorSets(descriptorSet, writes);
+
+	writeStaticObjectDescriptors(descriptorSet);
+}
+
+void WorldCullingRenderer::recordCullDispatches(CommandBuffer cmdBuffer, DescriptorSet descriptorSet, Pipeline cullObjectsPipeline, Buffer drawCountsBuffer)
+{
+	WorldCullingPushConstants pushConstants = {};
+	pushConstants.viewProjMatrix = viewProjMatrix;
+	pushConstants.cameraPosition_lodScale = glm::vec4(cameraPosition, lodScale);
+	pushConstants.objectCount = objectCount;
+	pushConstants.drawGroupCount = uint32_t(drawGroups.size());
+	pushConstants.hiZWidth = WORLD_HIZ_WIDTH;
+	pushConstants.hiZHeight = WORLD_HIZ_HEIGHT;
+	pushConstants.hiZMipLevels = WORLD_HIZ_MIP_LEVELS;
+
+	uint32_t drawGroupWorkgroups = (pushConstants.drawGroupCount + WORLD_CULLING_WORKGROUP_SIZE - 1) / WORLD_CULLING_WORKGROUP_SIZE;
+	uint32_t objectWorkgroups = (pushConstants.objectCount + WORLD_CULLING_WORKGROUP_SIZE - 1) / WORLD_CULLING_WORKGROUP_SIZE;
+
+	// Each dispatch reads the counters the one before it wrote
+	ResourceBarrier countersBarrier = {};
+	countersBarrier.barrierType = RESOURCE_BARRIER_TYPE_BUFFER_TRANSITION;
+	countersBarrier.bufferTransition.oldLayout = BUFFER_LAYOUT_GENERAL;
+	countersBarrier.bufferTransition.newLayout = BUFFER_LAYOUT_GENERAL;
+	countersBarrier.bufferTransition.buffer = drawCountsBuffer;
+
+	/*
+	The visibility flags aren't a graph buffer, so the graph doesn't order them. The early phase reads what last frame's late phase
+	wrote, and the late phase overwrites what this frame's early phase read.
+	*/
+	ResourceBarrier visibilityBarrier = countersBarrier;
+	visibilityBarrier.bufferTransition.buffer = objectVisibilityBuffer;
+
+	cmdBuffer->resourceBarriers({visibilityBarrier});
+
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, resetDrawGroupsPipeline);
+	cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {descriptorSet});
+	cmdBuffer->pushConstants(0, sizeof(WorldCullingPushConstants), &pushConstants);
+	cmdBuffer->dispatch(drawGroupWorkgroups, 1, 1);
+
+	cmdBuffer->resourceBarriers({countersBarrier});
+
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, cullObjectsPipeline);
+	cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {descriptorSet});
+	cmdBuffer->pushConstants(0, sizeof(WorldCullingPushConstants), &pushConstants);
+	cmdBuffer->dispatch(objectWorkgroups, 1, 1);
+
+	cmdBuffer->resourceBarriers({countersBarrier});
+
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, buildDrawCommandsPipeline);
+	cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {descriptorSet});
+	cmdBuffer->pushConstants(0, sizeof(WorldCullingPushConstants), &pushConstants);
+	cmdBuffer->dispatch(drawGroupWorkgroups, 1, 1);
+}
+
+void WorldCullingRenderer::recordDrawGroupDraws(CommandBuffer cmdBuffer, Buffer drawCommandsBuffer, Buffer drawCountsBuffer, Buffer instancesBuffer, bool skipClusterGroups) const
+{
+	const ModelResource *boundModel = nullptr;
+
+	for (size_t g = 0; g < drawGroups.size(); g++)
+	{
+		const WorldDrawGroup &group = drawGroups[g];
+
+		if (skipClusterGroups && group.clusterGroup != ~0u)
+			continue;
+
+		// Groups are sorted by mesh, so consecutive groups usually share the same model buffer
+		if (group.model != boundModel)
+		{
+			cmdBuffer->bindIndexBuffer(group.model->modelBuffer, 0, group.model->uses32BitIndices);
+			cmdBuffer->bindVertexBuffers(0, {group.model->modelBuffer, instancesBuffer}, {group.model->vertexDataOffset, 0});
+
+			boundModel = group.model;
+		}
+
+		cmdBuffer->drawIndexedIndirectCount(drawCommandsBuffer, group.firstDrawCommand * sizeof(DrawIndexedIndirectCommand), drawCountsBuffer, g * sizeof(uint32_t), group.drawCommandCount);
+	}
+}
+
+void WorldCullingRenderer::recordClusterGroupDraws(CommandBuffer cmdBuffer, Buffer clusterDrawCommandsBuffer, Buffer clusterDrawCountsBuffer, Buffer clusterIndicesBuffer, Buffer instancesBuffer) const
+{
+	if (clusterGroups.size() == 0)
+		return;
+
+	// The copied indices already have the meshlet's vertexOffset added, so every group shares the one 32 bit index buffer
+	cmdBuffer->bindIndexBuffer(clusterIndicesBuffer, 0, true);
+
+	for (size_t c = 0; c < clusterGroups.size(); c++)
+	{
+		const WorldClusterGroup &clusterGroup = clusterGroups[c];
+
+		if (c == 0 || clusterGroup.model != clusterGroups[c - 1].model)
+			cmdBuffer->bindVertexBuffers(0, {clusterGroup.model->modelBuffer, instancesBuffer}, {clusterGroup.model->vertexDataOffset, 0});
+
+		cmdBuffer->drawIndexedIndirectCount(clusterDrawCommandsBuffer, clusterGroup.firstDrawCommand * sizeof(DrawIndexedIndirectCommand), clusterDrawCountsBuffer, c * sizeof(uint32_t), drawGroups[clusterGroup.drawGroup].instanceCapacity);
+	}
+}
+
+DescriptorSetLayoutDescription WorldCullingRenderer::getCullSetLayout() const
+{
+	std::vector<DescriptorSetBinding> bindings(8);
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		bindings[i].binding = i;
+		bindings[i].arrayCount = 1;
+		bindings[i].type = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	bindings[7].type = DESCRIPTOR_TYPE_SAMPLED_TEXTURE;
+
+	DescriptorSetLayoutDescription set0 = {};
+	set0.bindings = bindings;
+
+	return set0;
+}
+
+void WorldCullingRenderer::createCullPipelines()
+{
+	// Both cull passes share the pipelines and the descriptor pool, so only the first pass to be initialized creates them
+	if (cullDescriptorPool != nullptr)
+		return;
+
+	DescriptorSetLayoutDescription set0 = getCullSetLayout();
+
+	const char *entryPoints[4] = {"ResetDrawGroupsCS", "CullObjectsEarlyCS", "CullObjectsLateCS", "BuildDrawCommandsCS"};
+	Pipeline *pipelines[4] = {&resetDrawGroupsPipeline, &cullObjectsEarlyPipeline, &cullObjectsLatePipeline, &buildDrawCommandsPipeline};
+
+	for (int i = 0; i < 4; i++)
+	{
+		PipelineShaderStage compShaderStage = {};
+		compShaderStage.shaderModule = renderer->createShaderModule("GameData/shaders/world-culling.hlsl", SHADER_STAGE_COMPUTE_BIT, SHADER_LANGUAGE_HLSL, entryPoints[i]);
+
+		ComputePipelineInfo info = {};
+		info.shader = compShaderStage;
+		info.inputPushConstants = {sizeof(WorldCullingPushConstants), SHADER_STAGE_COMPUTE_BIT};
+		info.inputSetLayouts = {set0};
+
+		*pipelines[i] = renderer->createComputePipeline(info);
+
+		renderer->destroyShaderModule(compShaderStage.shaderModule);
+	}
+
+	cullDescriptorPool = renderer->createDescriptorPool(set0, 2);
+	earlyCullDescriptorSet = cullDescriptorPool->allocateDescriptorSet();
+	cullDescriptorSet = cullDescriptorPool->allocateDescriptorSet();
+}
+
+void WorldCullingRenderer::earlyCullPassInit(const RenderGraphInitFunctionData &data)
+{
+	createCullPipelines();
+}
+
+void WorldCullingRenderer::earlyCullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
+{
+	if (objectCount == 0)
+		return;
+
+	recordCullDispatches(cmdBuffer, earlyCullDescriptorSet, cullObjectsEarlyPipeline, graphOccluderDrawCountsBuffer);
+}
+
+void WorldCullingRenderer::earlyCullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	writeCullPassGraphDescriptors(earlyCullDescriptorSet, data, "worldOccluderDrawCommands", "worldOccluderDrawCounts", "worldOccluderInstances");
+}
+
+void WorldCullingRenderer::occluderPassInit(const RenderGraphInitFunctionData &data)
+{
+	PipelineShaderStage vertShaderStage = {};
+	vertShaderStage.shaderModule = renderer->createShaderModule("GameData/shaders/world-occluders.hlsl", SHADER_STAGE_VERTEX_BIT, SHADER_LANGUAGE_HLSL, "OccluderDepthVS");
+
+	// Same bindings as the gbuffer pass, but only the position is read
+	VertexInputBinding vertexMeshBinding = {};
+	std::vector<VertexInputAttribute> meshAttribs;
+
+	engine->resourceManager->getModelVertexInput(0, true, vertexMeshBinding, meshAttribs);
+
+	VertexInputBinding instanceBinding = {};
+	instanceBinding.binding = 1;
+	instanceBinding.stride = sizeof(WorldCullingInstance);
+	instanceBinding.inputRate = VERTEX_INPUT_RATE_INSTANCE;
+
+	VertexInputAttribute instancePositionScaleAttrib = {};
+	instancePositionScaleAttrib.binding = 1;
+	instancePositionScaleAttrib.location = 4;
+	instancePositionScaleAttrib.format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+	instancePositionScaleAttrib.offset = offsetof(WorldCullingInstance, position_scale);
+
+	VertexInputAttribute instanceQuatAttrib = {};
+	instanceQuatAttrib.binding = 1;
+	instanceQuatAttrib.location = 5;
+	instanceQuatAttrib.format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+	instanceQuatAttrib.offset = offsetof(WorldCullingInstance, orientation);
+
+	PipelineVertexInputInfo vertexInput = {};
+	vertexInput.vertexInputBindings = {vertexMeshBinding, instanceBinding};
+	vertexInput.vertexInputAttribs = meshAttribs;
+	vertexInput.vertexInputAttribs.push_back(instancePositionScaleAttrib);
+	vertexInput.vertexInputAttribs.push_back(instanceQuatAttrib);
+
+	PipelineInputAssemblyInfo inputAssembly = {};
+	inputAssembly.primitiveRestart = false;
+	inputAssembly.topology = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	PipelineRasterizationInfo rastInfo = {};
+	rastInfo.clockwiseFrontFace = false;
+	rastInfo.cullMode = POLYGON_CULL_MODE_BACK;
+	rastInfo.polygonMode = POLYGON_MODE_FILL;
+	rastInfo.enableOutOfOrderRasterization = true;
+
+	PipelineDepthStencilInfo depthInfo = {};
+	depthInfo.enableDepthTest = true;
+	depthInfo.enableDepthWrite = true;
+	depthInfo.depthCompareOp = COMPARE_OP_GREATER;
+
+	PipelineColorBlendInfo colorBlend = {};
+	colorBlend.logicOpEnable = false;
+
+	GraphicsPipelineInfo info = {};
+	info.stages = {vertShaderStage};
+	info.vertexInputInfo = vertexInput;
+	info.inputAssemblyInfo = inputAssembly;
+	info.rasterizationInfo = rastInfo;
+	info.depthStencilInfo = depthInfo;
+	info.colorBlendInfo = colorBlend;
+
+	info.inputPushConstants = {sizeof(glm::mat4), SHADER_STAGE_VERTEX_BIT};
+
+	occluderDepthPipeline = renderer->createGraphicsPipeline(info, data.renderPassHandle, data.baseSubpass);
+
+	renderer->destroyShaderModule(vertShaderStage.shaderModule);
+}
+
+void WorldCullingRenderer::occluderPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
+{
+	if (objectCount == 0)
+		return;
+
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_GRAPHICS, occluderDepthPipeline);
+	cmdBuffer->pushConstants(0, sizeof(glm::mat4), &viewProjMatrix);
+
+	recordDrawGroupDraws(cmdBuffer, graphOccluderDrawCommandsBuffer, graphOccluderDrawCountsBuffer, graphOccluderInstancesBuffer, false);
+}
+
+void WorldCullingRenderer::occluderPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	graphOccluderDrawCommandsBuffer = data.graphBuffers.at("worldOccluderDrawCommands");
+	graphOccluderDrawCountsBuffer = data.graphBuffers.at("worldOccluderDrawCounts");
+	graphOccluderInstancesBuffer = data.graphBuffers.at("worldOccluderInstances");
+}
+
+void WorldCullingRenderer::hiZPassInit(const RenderGraphInitFunctionData &data)
+{
+	PipelineShaderStage compShaderStage = {};
+	compShaderStage.shaderModule = renderer->createShaderModule("GameData/shaders/world-hiz.hlsl", SHADER_STAGE_COMPUTE_BIT, SHADER_LANGUAGE_HLSL, "HiZBuildCS");
+
+	DescriptorSetBinding occluderDepth = {};
+	occluderDepth.binding = 0;
+	occluderDepth.arrayCount = 1;
+	occluderDepth.type = DESCRIPTOR_TYPE_SAMPLED_TEXTURE;
+	occluderDepth.stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+
+	DescriptorSetBinding srcMip = {};
+	srcMip.binding = 1;
+	srcMip.arrayCount = 1;
+	srcMip.type = DESCRIPTOR_TYPE_STORAGE_TEXTURE;
+	srcMip.stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+
+	DescriptorSetBinding dstMip = {};
+	dstMip.binding = 2;
+	dstMip.arrayCount = 1;
+	dstMip.type = DESCRIPTOR_TYPE_STORAGE_TEXTURE;
+	dstMip.stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+
+	DescriptorSetLayoutDescription set0 = {};
+	set0.bindings = {occluderDepth, srcMip, dstMip};
+
+	ComputePipelineInfo info = {};
+	info.shader = compShaderStage;
+	info.inputPushConstants = {sizeof(WorldHiZPushConstants), SHADER_STAGE_COMPUTE_BIT};
+	info.inputSetLayouts = {set0};
+
+	hiZBuildPipeline = renderer->createComputePipeline(info);
+
+	renderer->destroyShaderModule(compShaderStage.shaderModule);
+
+	hiZDescriptorPool = renderer->createDescriptorPool(set0, WORLD_HIZ_MIP_LEVELS);
+	hiZDescriptorSets = hiZDescriptorPool->allocateDescriptorSets(WORLD_HIZ_MIP_LEVELS);
+}
+
+void WorldCullingRenderer::hiZPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
+{
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, hiZBuildPipeline);
+
+	WorldHiZPushConstants pushConstants = {};
+	pushConstants.srcWidth = occluderDepthSize.x;
+	pushConstants.srcHeight = occluderDepthSize.y;
+
+	for (uint32_t m = 0; m < WORLD_HIZ_MIP_LEVELS; m++)
+	{
+		pushConstants.dstWidth = std::max(WORLD_HIZ_WIDTH >> m, 1);
+		pushConstants.dstHeight = std::max(WORLD_HIZ_HEIGHT >> m, 1);
+		pushConstants.dstMipLevel = m;
+
+		cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {hiZDescriptorSets[m]});
+		cmdBuffer->pushConstants(0, sizeof(WorldHiZPushConstants), &pushConstants);
+		cmdBuffer->dispatch((pushConstants.dstWidth + WORLD_HIZ_WORKGROUP_SIZE - 1) / WORLD_HIZ_WORKGROUP_SIZE, (pushConstants.dstHeight + WORLD_HIZ_WORKGROUP_SIZE - 1) / WORLD_HIZ_WORKGROUP_SIZE, 1);
+
+		// The next mip reads this one
+		if (m < WORLD_HIZ_MIP_LEVELS - 1)
+		{
+			ResourceBarrier mipBarrier = {};
+			mipBarrier.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
+			mipBarrier.textureTransition.texture = graphHiZTexture;
+			mipBarrier.textureTransition.oldLayout = TEXTURE_LAYOUT_GENERAL;
+			mipBarrier.textureTransition.newLayout = TEXTURE_LAYOUT_GENERAL;
+			mipBarrier.textureTransition.subresourceRange = {m, 1, 0, 1};
+
+			cmdBuffer->resourceBarriers({mipBarrier});
+		}
+
+		pushConstants.srcWidth = pushConstants.dstWidth;
+		pushConstants.srcHeight = pushConstants.dstHeight;
+	}
+}
+
+void WorldCullingRenderer::hiZPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	graphHiZTexture = data.graphTextureViews.at("worldHiZ")->parentTexture;
+
+	// Mip 0 is built from the occluder depth, so it's source size is the depth's size
+	TextureView occluderDepthView = data.graphTextureViews.at("worldOccluderDepth");
+	occluderDepthSize = glm::uvec2(occluderDepthView->parentTexture->width, occluderDepthView->parentTexture->height);
+
+	for (uint32_t m = 0; m < WORLD_HIZ_MIP_LEVELS; m++)
+	{
+		DescriptorTextureInfo occluderDepth = {};
+		occluderDepth.layout = TEXTURE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		occluderDepth.view = occluderDepthView;
+
+		DescriptorTextureInfo srcMip = {};
+		srcMip.layout = TEXTURE_LAYOUT_GENERAL;
+		srcMip.view = data.graphTextureViews.at(getRenderGraphMipViewName("worldHiZ", m > 0 ? m - 1 : 0));
+
+		DescriptorTextureInfo dstMip = {};
+		dstMip.layout = TEXTURE_LAYOUT_GENERAL;
+		dstMip.view = data.graphTextureViews.at(getRenderGraphMipViewName("worldHiZ", m));
+
+		std::vector<DescriptorWriteInfo> writes(3);
+		writes[0].descriptorType = DESCRIPTOR_TYPE_SAMPLED_TEXTURE;
+		writes[0].dstBinding = 0;
+		writes[0].dstArrayElement = 0;
+		writes[0].textureInfo = {occluderDepth};
+
+		writes[1].descriptorType = DESCRIPTOR_TYPE_STORAGE_TEXTURE;
+		writes[1].dstBinding = 1;
+		writes[1].dstArrayElement = 0;
+		writes[1].textureInfo = {srcMip};
+
+		writes[2].descriptorType = DESCRIPTOR_TYPE_STORAGE_TEXTURE;
+		writes[2].dstBinding = 2;
+		writes[2].dstArrayElement = 0;
+		writes[2].textureInfo = {dstMip};
+
+		renderer->writeDescriptorSets(hiZDescriptorSets[m], writes);
+	}
+}
+
+void WorldCullingRenderer::cullPassInit(const RenderGraphInitFunctionData &data)
+{
+	createCullPipelines();
+}
+
+void WorldCullingRenderer::cullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
+{
+	if (objectCount == 0)
+		return;
+
+	recordCullDispatches(cmdBuffer, cullDescriptorSet, cullObjectsLatePipeline, graphDrawCountsBuffer);
+}
+
+void WorldCullingRenderer::cullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	graphDrawCountsBuffer = data.graphBuffers.at("worldDrawCounts");
+
+	writeCullPassGraphDescriptors(cullDescriptorSet, data, "worldDrawCommands", "worldDrawCounts", "worldInstances");
+}
+
+DescriptorSetLayoutDescription WorldCullingRenderer::getClusterModelSetLayout() const
+{
+	DescriptorSetBinding modelBufferBinding = {};
+	modelBufferBinding.binding = 0;
+	modelBufferBinding.arrayCount = 1;
+	modelBufferBinding.type = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	modelBufferBinding.stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+
+	DescriptorSetLayoutDescription set1 = {};
+	set1.bindings = {modelBufferBinding};
+
+	return set1;
+}
+
+void WorldCullingRenderer::clusterCullPassInit(const RenderGraphInitFunctionData &data)
+{
+	std::vector<DescriptorSetBinding> bindings(5);
+
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		bindings[i].binding = i;
+		bindings[i].arrayCount = 1;
+		bindings[i].type = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].stageAccessMask = SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	DescriptorSetLayoutDescription set0 = {};
+	set0.bindings = bindings;
+
+	DescriptorSetLayoutDescription set1 = getClusterModelSetLayout();
+
+	const char *entryPoints[2] = {"ResetClusterGroupsCS", "CullClustersCS"};
+	Pipeline *pipelines[2] = {&resetClusterGroupsPipeline, &cullClustersPipeline};
+
+	for (int i = 0; i < 2; i++)
+	{
+		PipelineShaderStage compShaderStage = {};
+		compShaderStage.shaderModule = renderer->createShaderModule("GameData/shaders/world-cluster-culling.hlsl", SHADER_STAGE_COMPUTE_BIT, SHADER_LANGUAGE_HLSL, entryPoints[i]);
+
+		ComputePipelineInfo info = {};
+		info.shader = compShaderStage;
+		info.inputPushConstants = {sizeof(WorldClusterCullingPushConstants), SHADER_STAGE_COMPUTE_BIT};
+		info.inputSetLayouts = {set0, set1};
+
+		*pipelines[i] = renderer->createComputePipeline(info);
+
+		renderer->destroyShaderModule(compShaderStage.shaderModule);
+	}
+
+	clusterCullDescriptorPool = renderer->createDescriptorPool(set0, 1);
+	clusterCullDescriptorSet = clusterCullDescriptorPool->allocateDescriptorSet();
+
+	clusterModelDescriptorPool = renderer->createDescriptorPool(set1, WORLD_CLUSTER_CULLING_MAX_MODELS);
+
+	// The world could've been uploaded before the pass existed
+	if (clusterGroups.size() == 0)
+		buildClusterGroups();
+}
+
+void WorldCullingRenderer::clusterCullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
+{
+	if (clusterGroups.size() == 0)
+		return;
+
+	WorldClusterCullingPushConstants pushConstants = {};
+	pushConstants.viewProjMatrix = viewProjMatrix;
+	pushConstants.cameraPosition = glm::vec4(cameraPosition, 0.0f);
+	pushConstants.clusterGroupCount = uint32_t(clusterGroups.size());
+
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, resetClusterGroupsPipeline);
+	cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {clusterCullDescriptorSet, clusterGroups[0].modelDescriptorSet});
+	cmdBuffer->pushConstants(0, sizeof(WorldClusterCullingPushConstants), &pushConstants);
+	cmdBuffer->dispatch((pushConstants.clusterGroupCount + WORLD_CULLING_WORKGROUP_SIZE - 1) / WORLD_CULLING_WORKGROUP_SIZE, 1, 1);
+
+	ResourceBarrier countersBarrier = {};
+	countersBarrier.barrierType = RESOURCE_BARRIER_TYPE_BUFFER_TRANSITION;
+	countersBarrier.bufferTransition.oldLayout = BUFFER_LAYOUT_GENERAL;
+	countersBarrier.bufferTransition.newLayout = BUFFER_LAYOUT_GENERAL;
+	countersBarrier.bufferTransition.buffer = graphClusterDrawCountsBuffer;
+
+	cmdBuffer->resourceBarriers({countersBarrier});
+
+	// The groups only share the index allocator and they only touch it w/ atomics, so they don't need barriers between them
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_COMPUTE, cullClustersPipeline);
+
+	for (uint32_t c = 0; c < uint32_t(clusterGroups.size()); c++)
+	{
+		const WorldClusterGroup &clusterGroup = clusterGroups[c];
+		const WorldDrawGroup &group = drawGroups[clusterGroup.drawGroup];
+
+		pushConstants.drawGroup = clusterGroup.drawGroup;
+		pushConstants.clusterGroup = c;
+		pushConstants.firstInstance = group.firstInstance;
+		pushConstants.firstDrawCommand = clusterGroup.firstDrawCommand;
+		pushConstants.meshletCount = uint32_t(clusterGroup.model->meshlets.size());
+		pushConstants.meshletDataOffset = uint32_t(clusterGroup.model->meshletDataOffset);
+		pushConstants.uses32BitIndices = clusterGroup.model->uses32BitIndices ? 1 : 0;
+
+		cmdBuffer->bindDescriptorSets(PIPELINE_BIND_POINT_COMPUTE, 0, {clusterCullDescriptorSet, clusterGroup.modelDescriptorSet});
+		cmdBuffer->pushConstants(0, sizeof(WorldClusterCullingPushConstants), &pushConstants);
+		cmdBuffer->dispatch(group.instanceCapacity, 1, 1);
+	}
+}
+
+void WorldCullingRenderer::clusterCullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	graphClusterDrawCountsBuffer = data.graphBuffers.at("worldClusterDrawCounts");
+
+	const std::string graphBufferNames[5] = {"worldDrawCounts", "worldInstances", "worldClusterDrawCommands", "worldClusterDrawCounts", "worldClusterIndices"};
+
+	std::vector<DescriptorWriteInfo> writes(5);
+
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		Buffer graphBuffer = data.graphBuffers.at(graphBufferNames[i]);
+
+		writes[i].descriptorType = DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[i].dstBinding = i;
+		writes[i].dstArrayElement = 0;
+		writes[i].bufferInfo = {{graphBuffer, 0, graphBuffer->bufferSize}};
+	}
+
+	renderer->writeDescriptorSets(clusterCullDescriptorSet, writes);
+}
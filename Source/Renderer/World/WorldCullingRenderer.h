@@ -0,0 +1,369 @@
+#ifndef RENDERER_WORLD_WORLDCULLINGRENDERER_H_
+#define RENDERER_WORLD_WORLDCULLINGRENDERER_H_
+
+#include <common.h>
+#include <RendererCore/RendererEnums.h>
+#include <RendererCore/RendererObjects.h>
+
+#include <Resources/ResourceSlotArray.h>
+
+#include <World/WorldManager.h>
+
+#define WORLD_CULLING_MAX_OBJECTS (1 << 20)
+#define WORLD_CULLING_MAX_DRAW_GROUPS (1 << 14)
+#define WORLD_CULLING_MAX_DRAW_COMMANDS (1 << 16)
+#define WORLD_CULLING_WORKGROUP_SIZE 64
+
+// The Hi-Z is a fixed size no matter the swapchain size, so it's mip count never changes w/ a resize
+#define WORLD_HIZ_WIDTH 512
+#define WORLD_HIZ_HEIGHT 256
+#define WORLD_HIZ_MIP_LEVELS 10
+#define WORLD_HIZ_WORKGROUP_SIZE 8
+
+// How far past a LOD's switch point an object has to go before it switches back, as a fraction of the switch point's screen coverage
+#define WORLD_LOD_HYSTERESIS 0.1f
+
+// Sizes of the render graph buffers written by the culling pass, any pass that reads them has to declare them w/ the same size
+#define WORLD_CULLING_DRAW_COMMANDS_BUFFER_SIZE (WORLD_CULLING_MAX_DRAW_COMMANDS * sizeof(DrawIndexedIndirectCommand))
+#define WORLD_CULLING_DRAW_COUNTS_BUFFER_SIZE (2 * WORLD_CULLING_MAX_DRAW_GROUPS * sizeof(uint32_t))
+#define WORLD_CULLING_INSTANCES_BUFFER_SIZE (WORLD_CULLING_MAX_OBJECTS * sizeof(WorldCullingInstance))
+
+// Models w/ fewer meshlets than this are drawn whole, cluster culling them wouldn't save enough to be worth a draw per instance
+#define WORLD_CLUSTER_CULLING_MIN_MESHLETS 8
+#define WORLD_CLUSTER_CULLING_MAX_INSTANCES (1 << 14)
+#define WORLD_CLUSTER_CULLING_MAX_INDICES (1 << 24)
+#define WORLD_CLUSTER_CULLING_MAX_MODELS 256
+
+// Sizes of the render graph buffers written by the cluster culling pass, the counts have an extra uint at the end for the index allocator
+#define WORLD_CLUSTER_CULLING_DRAW_COMMANDS_BUFFER_SIZE (WORLD_CLUSTER_CULLING_MAX_INSTANCES * sizeof(DrawIndexedIndirectCommand))
+#define WORLD_CLUSTER_CULLING_DRAW_COUNTS_BUFFER_SIZE ((WORLD_CULLING_MAX_DRAW_GROUPS + 1) * sizeof(uint32_t))
+#define WORLD_CLUSTER_CULLING_INDICES_BUFFER_SIZE (WORLD_CLUSTER_CULLING_MAX_INDICES * sizeof(uint32_t))
+
+class KalosEngine;
+class Renderer;
+struct ModelResource;
+
+/*
+A static object as the culling shader sees it, in world space
+*/
+struct WorldCullingObject
+{
+	glm::vec4 position_scale; // xyz - position, w - scale
+	glm::vec4 orientation;
+	glm::vec4 boundingSphere; // xyz - center, w - radius
+	uint32_t drawGroup;
+	uint32_t padding[3];
+};
+
+/*
+Per instance vertex data, matches the instance binding in WorldRenderer::gbufferPassInit()
+*/
+struct WorldCullingInstance
+{
+	glm::vec4 position_scale;
+	glm::vec4 orientation;
+};
+
+/*
+The LOD data is the same for each of a mesh/material's LOD groups, objects only ever point at LOD 0's group and the shader adds the LOD it picks
+*/
+struct WorldCullingGPUDrawGroup
+{
+	uint32_t firstDrawCommand;
+	uint32_t drawCommandCount;
+	uint32_t firstInstance;
+	uint32_t lodCount;
+	float lodScreenCoverages[MODEL_MAX_LOD_LEVELS - 1]; // ModelResource::lodScreenCoverages[1] and up
+};
+
+/*
+The shaders get the frustum planes from the rows of viewProjMatrix, it doesn't fit in the 128 bytes of push constants alongside the planes
+*/
+struct WorldCullingPushConstants
+{
+	glm::mat4 viewProjMatrix;
+	glm::vec4 cameraPosition_lodScale; // xyz - camera position, w - the projection matrix's [1][1], see getWorldLODScreenCoverage()
+	uint32_t objectCount;
+	uint32_t drawGroupCount;
+	uint32_t hiZWidth;
+	uint32_t hiZHeight;
+	uint32_t hiZMipLevels;
+	uint32_t padding[3];
+};
+
+struct WorldClusterCullingPushConstants
+{
+	glm::mat4 viewProjMatrix;
+	glm::vec4 cameraPosition;
+	uint32_t drawGroup; // The draw group's instance counter in worldDrawCounts has the number of instances to cull
+	uint32_t clusterGroup;
+	uint32_t clusterGroupCount;
+	uint32_t firstInstance; // The draw group's first instance in worldInstances
+	uint32_t firstDrawCommand;
+	uint32_t meshletCount;
+	uint32_t meshletDataOffset; // In bytes, ModelResource::meshletDataOffset
+	uint32_t uses32BitIndices;
+};
+
+struct WorldHiZPushConstants
+{
+	uint32_t srcWidth;
+	uint32_t srcHeight;
+	uint32_t dstWidth;
+	uint32_t dstHeight;
+	uint32_t dstMipLevel;
+};
+
+/*
+The fraction of the screen's height covered by the projected diameter of a bounding sphere, 'lodScale' is the projection matrix's [1][1]
+*/
+inline float getWorldLODScreenCoverage(const glm::vec3 &sphereCenter, float sphereRadius, const glm::vec3 &cameraPosition, float lodScale)
+{
+	float distance = glm::length(sphereCenter - cameraPosition);
+
+	return distance > sphereRadius ? sphereRadius * lodScale / distance : 1.0f;
+}
+
+/*
+Picks the coarsest LOD whose switch point the object has passed. A switch point is moved by WORLD_LOD_HYSTERESIS in favour of 'previousLOD',
+so an object sitting right on one doesn't flip between the two LODs every frame. The culling shaders do the same thing.
+*/
+inline uint32_t selectWorldLOD(float screenCoverage, const float *lodScreenCoverages, uint32_t lodCount, uint32_t previousLOD)
+{
+	uint32_t lod = 0;
+
+	while (lod + 1 < lodCount)
+	{
+		float switchCoverage = lodScreenCoverages[lod + 1] * (previousLOD > lod ? 1.0f + WORLD_LOD_HYSTERESIS : 1.0f - WORLD_LOD_HYSTERESIS);
+
+		if (screenCoverage >= switchCoverage)
+			break;
+
+		lod++;
+	}
+
+	return lod;
+}
+
+/*
+All of the objects that share a mesh and material. Each group has one draw command per draw primitive of it's model, and all of them
+share the group's range of instances, so the whole group is drawn w/ a single indirect multi-draw. A mesh w/ LODs has one group per LOD,
+next to each other in LOD order, and each of them has room for every object.
+*/
+struct WorldDrawGroup
+{
+	uint64_t meshID;
+	uint64_t materialID;
+	ResourceHandle modelHandle;
+	ModelResource *model; // Stays valid while the world is uploaded, the culling renderer holds a reference to each group's model
+	uint32_t lod;
+
+	uint32_t firstDrawCommand;
+	uint32_t drawCommandCount;
+	uint32_t firstInstance;
+	uint32_t instanceCapacity; // The number of objects in the group
+
+	uint32_t clusterGroup; // Index into the cluster groups if the gbuffer pass draws the group's meshlets instead, otherwise ~0u
+};
+
+/*
+A LOD 0 draw group of a model w/ at least WORLD_CLUSTER_CULLING_MIN_MESHLETS meshlets. Each of the group's visible instances gets it's
+own draw command, of the triangles of it's meshlets that passed the cluster culling.
+*/
+struct WorldClusterGroup
+{
+	uint32_t drawGroup;
+	ModelResource *model;
+	uint32_t firstDrawCommand; // Into worldClusterDrawCommands, the group has room for instanceCapacity commands
+	DescriptorSet modelDescriptorSet;
+};
+
+/*
+The objects of one draw group in one chunk, for estimating the group's screen coverage w/o going through every object
+*/
+struct WorldDrawGroupChunkBounds
+{
+	glm::vec4 centerBounds; // xyz - center, w - radius, a sphere around the center of every object's bounding sphere
+	float maxObjectRadius; // The largest of the objects' bounding sphere radii
+	uint32_t drawGroup;
+};
+
+/*
+Culls the active world's static objects on the GPU and writes the draw commands for the gbuffer pass.
+
+When the active world changes, or the camera moves into another chunk, the StaticObjectEntry lists of the chunks w/in WORLD_VIEW_DISTANCE
+(see forEachWorldChunkInView()) are flattened into world space WorldCullingObjects, sorted into draw groups, and uploaded into static
+storage buffers, along w/ a visibility flag for each object. Culling is done in two phases, each frame runs these passes in order:
+
+ - worldCullingEarly, the objects that were visible last frame and are inside the frustum are written to the worldOccluder* buffers
+ - worldOccluderDepth, draws those objects into a depth only target
+ - worldHiZ, reduces the occluder depth into a WORLD_HIZ_WIDTH x WORLD_HIZ_HEIGHT mip chain, where each texel has the farthest depth under it
+ - worldCulling, every object inside the frustum is tested against the Hi-Z, the ones that pass are written to the world* buffers for the
+   gbuffer pass, and every object's visibility flag is updated for the next frame
+
+Objects that become visible are drawn the same frame they appear, since the late phase tests everything and not just the last frame's
+visible set, the early phase only decides what the occluders are. Depth is reversed, so near is 1 and far is 0.
+
+The late phase also picks each object's LOD w/ selectWorldLOD() from the same bounding sphere it culls against, and adds it to the object's
+draw group. The visibility flags keep the picked LOD in bits 1-3 so the next frame can apply hysteresis, and so the early phase draws
+the occluders at the LOD they were last seen at.
+
+Both cull passes run three dispatches from GameData/shaders/world-culling.hlsl, all w/ the same set 0 layout and WorldCullingPushConstants:
+
+ - ResetDrawGroupsCS, one thread per draw group, zeroes the group's instance counter
+ - CullObjectsEarlyCS/CullObjectsLateCS, one thread per object, appends it's instance to it's group w/ an atomic add on the group's
+   counter if it passes the phase's tests
+ - BuildDrawCommandsCS, one thread per draw group, copies the group's command templates w/ the final instance count, and writes the
+   group's draw count (0 if nothing in it was visible)
+
+Set 0 bindings: 0 - objects, 1 - draw groups, 2 - draw command templates, 3 - draw commands, 4 - draw counts (draw counts for each
+group, followed by the instance counters at WORLD_CULLING_MAX_DRAW_GROUPS), 5 - instances, 6 - object visibility (a uint per object,
+bit 0 is set if it was visible and bits 1-3 are it's LOD), 7 - the Hi-Z as a sampled texture w/ all of it's mips. 0-6 are storage buffers.
+
+The Hi-Z pass runs HiZBuildCS once per mip w/ WorldHiZPushConstants, each mip has it's own set w/ 0 - the occluder depth as a sampled
+texture, 1 - the previous mip as a storage texture (mip 0 for mip 0, where it's unused), 2 - the mip being written as a storage texture.
+Mip 0 takes the min over every depth texel it covers, so it stays conservative for any swapchain size.
+
+After those, worldClusterCulling culls the meshlets of the visible instances of each cluster group (see WorldClusterGroup). It doesn't
+need mesh shaders, the surviving triangles are copied into worldClusterIndices and drawn w/ ordinary indexed indirect draws:
+
+ - ResetClusterGroupsCS, one thread per cluster group, zeroes the group's draw count, and the first thread zeroes the index allocator
+ - CullClustersCS, dispatched once per cluster group w/ one workgroup per instance the group has room for. Workgroups past the group's
+   visible instance count exit straight away. Each one tests every meshlet of it's instance against the frustum and the meshlet's normal
+   cone, allocates room for all the surviving triangles at once from the index allocator, copies their indices in w/ the meshlet's
+   vertexOffset added, and appends a draw command for them w/ the instance as it's firstInstance. If the indices wouldn't fit in
+   WORLD_CLUSTER_CULLING_MAX_INDICES the instance isn't drawn.
+
+Both use GameData/shaders/world-cluster-culling.hlsl and WorldClusterCullingPushConstants. Set 0 bindings: 0 - worldDrawCounts,
+1 - worldInstances, 2 - worldClusterDrawCommands, 3 - worldClusterDrawCounts (a count per cluster group, then the index allocator at
+WORLD_CULLING_MAX_DRAW_GROUPS), 4 - worldClusterIndices, all storage buffers. Set 1 has the model buffer as a storage buffer at binding 0,
+w/ the meshlets at meshletDataOffset. A meshlet's sphere and cone are transformed by the instance like the vertices are. The gbuffer pass
+draws cluster groups from the worldCluster* buffers instead of their draw group's commands, the occluder pass still draws them whole.
+
+The CPU cost per frame is a fixed number of dispatches plus two indirect draws per draw group, no matter how many objects there are,
+plus a dispatch per cluster group. Texture streaming still needs a screen coverage per model though, getDrawGroupScreenCoverages()
+gets it from a WorldDrawGroupChunkBounds for each draw group in each chunk, which are built along w/ the static object buffers.
+*/
+class WorldCullingRenderer
+{
+public:
+	WorldCullingRenderer(KalosEngine *enginePtr);
+	virtual ~WorldCullingRenderer();
+
+	/*
+	Rebuilds the static object buffers if the active world changed. Can't be called while the render graph is executing.
+	*/
+	void update(float delta);
+
+	/*
+	'lodScale' is the projection matrix's [1][1]
+	*/
+	void setCamera(const glm::mat4 &viewProjMatrix, const glm::vec3 &cameraPosition, float lodScale);
+
+	void earlyCullPassInit(const RenderGraphInitFunctionData &data);
+	void earlyCullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void earlyCullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
+
+	void occluderPassInit(const RenderGraphInitFunctionData &data);
+	void occluderPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void occluderPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
+
+	void hiZPassInit(const RenderGraphInitFunctionData &data);
+	void hiZPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void hiZPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
+
+	void cullPassInit(const RenderGraphInitFunctionData &data);
+	void cullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void cullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
+
+	void clusterCullPassInit(const RenderGraphInitFunctionData &data);
+	void clusterCullPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void clusterCullPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
+
+	/*
+	Records one indirect multi-draw per draw group from the draw commands/counts/instances written by one of the cull passes, leaving out
+	the cluster groups if 'skipClusterGroups'. The pipeline has to already be bound, and use the vertex layout from
+	WorldRenderer::gbufferPassInit().
+	*/
+	void recordDrawGroupDraws(CommandBuffer cmdBuffer, Buffer drawCommandsBuffer, Buffer drawCountsBuffer, Buffer instancesBuffer, bool skipClusterGroups) const;
+
+	/*
+	Records one indirect multi-draw per cluster group from the buffers written by the cluster culling pass, w/ the same pipeline requirements
+	as recordDrawGroupDraws()
+	*/
+	void recordClusterGroupDraws(CommandBuffer cmdBuffer, Buffer clusterDrawCommandsBuffer, Buffer clusterDrawCountsBuffer, Buffer clusterIndicesBuffer, Buffer instancesBuffer) const;
+
+	const std::vector<WorldDrawGroup> &getDrawGroups() const;
+	const std::vector<WorldClusterGroup> &getClusterGroups() const;
+
+	/*
+	Estimates each draw group's screen coverage from the camera, indexed like getDrawGroups(). For each chunk the group has objects in, the
+	largest of them is assumed to be at the closest point of the chunk's WorldDrawGroupChunkBounds, so it's never less than the
+	getWorldLODScreenCoverage() of any one object. Objects only point at LOD 0's group, so the other LODs' groups get 0. Nothing is culled
+	for this, so it's what the group's model could cover from where the camera is, not what's visible this frame.
+	*/
+	void getDrawGroupScreenCoverages(std::vector<float> &screenCoverages) const;
+
+private:
+	KalosEngine *engine;
+	Renderer *renderer;
+
+	const WorldInfo *currentWorld;
+	sivec2 currentCameraChunk; // The chunk the camera was in when the static object buffers were last built
+	glm::mat4 viewProjMatrix;
+	glm::vec3 cameraPosition;
+	float lodScale;
+
+	std::vector<WorldDrawGroup> drawGroups;
+	std::vector<ResourceHandle> drawGroupModelHandles; // Acquired for as long as the world's static object buffers are uploaded
+	std::vector<WorldClusterGroup> clusterGroups;
+	uint32_t objectCount;
+
+	std::vector<WorldDrawGroupChunkBounds> drawGroupChunkBounds;
+
+	Buffer objectBuffer;
+	Buffer drawGroupBuffer;
+	Buffer drawCommandTemplateBuffer;
+	Buffer objectVisibilityBuffer;
+
+	Buffer graphOccluderDrawCommandsBuffer;
+	Buffer graphOccluderDrawCountsBuffer;
+	Buffer graphOccluderInstancesBuffer;
+	Buffer graphDrawCountsBuffer;
+	Buffer graphClusterDrawCountsBuffer;
+	Texture graphHiZTexture;
+	glm::uvec2 occluderDepthSize;
+
+	Pipeline resetDrawGroupsPipeline;
+	Pipeline cullObjectsEarlyPipeline;
+	Pipeline cullObjectsLatePipeline;
+	Pipeline buildDrawCommandsPipeline;
+	Pipeline occluderDepthPipeline;
+	Pipeline hiZBuildPipeline;
+	Pipeline resetClusterGroupsPipeline;
+	Pipeline cullClustersPipeline;
+
+	DescriptorPool cullDescriptorPool;
+	DescriptorSet earlyCullDescriptorSet;
+	DescriptorSet cullDescriptorSet;
+
+	DescriptorPool hiZDescriptorPool;
+	std::vector<DescriptorSet> hiZDescriptorSets;
+
+	DescriptorPool clusterCullDescriptorPool;
+	DescriptorPool clusterModelDescriptorPool;
+	DescriptorSet clusterCullDescriptorSet;
+
+	DescriptorSetLayoutDescription getCullSetLayout() const;
+	void createCullPipelines();
+	void recordCullDispatches(CommandBuffer cmdBuffer, DescriptorSet descriptorSet, Pipeline cullObjectsPipeline, Buffer drawCountsBuffer);
+	void writeStaticObjectDescriptors(DescriptorSet descriptorSet);
+	void buildClusterGroups();
+	DescriptorSetLayoutDescription getClusterModelSetLayout() const;
+	void writeCullPassGraphDescriptors(DescriptorSet descriptorSet, const RenderGraphDescriptorUpdateFunctionData &data, const std::string &drawCommandsName, const std::string &drawCountsName, const std::string &instancesName);
+
+	void buildStaticObjectBuffers(const WorldInfo *world);
+	void destroyStaticObjectBuffers();
+};
+
+#endif /* RENDERER_WORLD_WORLDCULLINGRENDERER_H_ */
@@ -0,0 +1,297 @@
+#include "WorldDrawListBuilder.h"
+
+#include <RendererCore/Renderer.h>
+
+#include <Resources/ResourceManager.h>
+
+WorldDrawListBuilder::WorldDrawListBuilder(Renderer *rendererPtr, ResourceManager *resourceManagerPtr)
+{
+	renderer = rendererPtr;
+	resourceManager = resourceManagerPtr;
+
+	frameRegion = 0;
+	frameIndex = 0;
+
+	cameraPosition = glm::vec3(0.0f);
+	lodScale = 1.0f;
+
+	triangleCount = 0;
+	lod0TriangleCount = 0;
+	loggedInstanceOverflow = false;
+
+	instanceBuffer = renderer->createBuffer(WORLD_DRAW_LIST_FRAME_REGIONS * WORLD_DRAW_LIST_MAX_INSTANCES * sizeof(WorldCullingInstance), BUFFER_USAGE_VERTEX_BUFFER_BIT, BUFFER_LAYOUT_VERTEX_BUFFER, MEMORY_USAGE_CPU_TO_GPU, false);
+	instanceBufferData = reinterpret_cast<WorldCullingInstance*>(renderer->mapBuffer(instanceBuffer));
+}
+
+WorldDrawListBuilder::~WorldDrawListBuilder()
+{
+	renderer->unmapBuffer(instanceBuffer);
+	renderer->destroyBuffer(instanceBuffer);
+
+	for (ResourceHandle modelHandle : meshModelHandles)
+		if (!modelHandle.isNull())
+			resourceManager->releaseModel(modelHandle);
+}
+
+void WorldDrawListBuilder::beginFrame(const glm::vec3 &cameraPosition, float lodScale)
+{
+	this->cameraPosition = cameraPosition;
+	this->lodScale = lodScale;
+
+	triangleCount = 0;
+	lod0TriangleCount = 0;
+
+	objectKeys.clear();
+	objectIndices.clear();
+	objectInstances.clear();
+	objectEntries.clear();
+	buckets.clear();
+	meshScreenCoverages.assign(meshIndices.size(), 0.0f);
+
+	frameRegion = (frameRegion + 1) % WORLD_DRAW_LIST_FRAME_REGIONS;
+	frameIndex++;
+}
+
+static void gatherModelDrawPrimitives(const std::vector<ModelMeshNode> &nodes, std::vector<ModelMeshDrawPrimitive> &drawPrimitives)
+{
+	for (const ModelMeshNode &node : nodes)
+	{
+		drawPrimitives.insert(drawPrimitives.end(), node.drawPrimitives.begin(), node.drawPrimitives.end());
+		gatherModelDrawPrimitives(node.children, drawPrimitives);
+	}
+}
+
+ModelResource *WorldDrawListBuilder::getMeshModel(uint64_t meshID, uint32_t &meshIndex)
+{
+	auto meshIndexIt = meshIndices.find(meshID);
+
+	if (meshIndexIt == meshIndices.end())
+	{
+		meshIndexIt = meshIndices.insert(std::make_pair(meshID, uint32_t(meshIndices.size()))).first;
+
+		meshModelHandles.push_back({0, 0});
+		meshDrawPrimitives.emplace_back();
+		meshScreenCoverages.push_back(0.0f);
+	}
+
+	meshIndex = meshIndexIt->second;
+
+	if (!meshModelHandles[meshIndex].isNull())
+		return resourceManager->getModel(meshModelHandles[meshIndex]);
+
+	// Meshes that aren't loaded are looked up by ID again until they are, from then on it's just the handle
+	ResourceHandle modelHandle = resourceManager->findModel(meshID);
+	ModelResource *model = resourceManager->getModel(modelHandle);
+
+	if (model == nullptr)
+		return nullptr;
+
+	resourceManager->acquireModel(modelHandle);
+	meshModelHandles[meshIndex] = modelHandle;
+	gatherModelDrawPrimitives(model->meshNodes, meshDrawPrimitives[meshIndex]);
+
+	return model;
+}
+
+void WorldDrawListBuilder::addVisibleObjects(const std::vector<const StaticObjectEntry*> &visibleObjects, const glm::vec3 &chunkOrigin)
+{
+	for (const StaticObjectEntry *object : visibleObjects)
+	{
+		uint32_t meshIndex;
+		ModelResource *model = getMeshModel(object->meshID, meshIndex);
+
+		if (model == nullptr || meshDrawPrimitives[meshIndex].size() == 0)
+			continue;
+
+		glm::vec3 position = chunkOrigin + glm::vec3(object->position.x, object->position.y, object->position.z);
+		uint32_t lod = 0;
+
+		float screenCoverage = getWorldLODScreenCoverage(position, object->getBoundingSphere().radius, cameraPosition, lodScale);
+
+		if (model->lodCount > 1)
+		{
+			WorldDrawListObjectLOD &lastLOD = objectLastLODs[object->objectUUID];
+
+			lod = selectWorldLOD(screenCoverage, model->lodScreenCoverages, std::min(model->lodCount, uint32_t(MODEL_MAX_LOD_LEVELS)), lastLOD.lod);
+			lastLOD.lod = uint8_t(lod);
+			lastLOD.lastVisibleFrame = frameIndex;
+		}
+
+		auto materialIndexIt = materialIndices.find(object->materialID);
+
+		meshScreenCoverages[meshIndex] = std::max(meshScreenCoverages[meshIndex], screenCoverage);
+
+		if (materialIndexIt == materialIndices.end())
+			materialIndexIt = materialIndices.insert(std::make_pair(object->materialID, uint32_t(materialIndices.size()))).first;
+
+		WorldCullingInstance instance = {};
+		instance.position_scale = model->getInstancePositionScale(position, object->scale, glm::quat(object->orientation.w, object->orientation.x, object->orientation.y, object->orientation.z));
+		instance.orientation = glm::vec4(object->orientation.x, object->orientation.y, object->orientation.z, object->orientation.w);
+
+		objectKeys.push_back((uint64_t(meshIndex) << 32) | (uint64_t(materialIndexIt->second) << 3) | uint64_t(lod));
+		objectIndices.push_back(uint32_t(objectInstances.size()));
+		objectInstances.push_back(instance);
+		objectEntries.push_back(object);
+	}
+}
+
+void WorldDrawListBuilder::radixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &tempKeys, std::vector<uint32_t> &tempValues)
+{
+	size_t count = keys.size();
+
+	if (count < 2)
+		return;
+
+	tempKeys.resize(count);
+	tempValues.resize(count);
+
+	// Every digit's histogram is built in one read over the keys
+	std::vector<uint32_t> histograms(8 * 256, 0);
+
+	for (size_t i = 0; i < count; i++)
+		for (uint32_t digit = 0; digit < 8; digit++)
+			histograms[digit * 256 + ((keys[i] >> (digit * 8)) & 0xFF)]++;
+
+	uint64_t *srcKeys = keys.data();
+	uint32_t *srcValues = values.data();
+	uint64_t *dstKeys = tempKeys.data();
+	uint32_t *dstValues = tempValues.data();
+
+	for (uint32_t digit = 0; digit < 8; digit++)
+	{
+		uint32_t *histogram = &histograms[digit * 256];
+		uint32_t shift = digit * 8;
+
+		// If every key has the same value for this digit then this pass wouldn't move anything
+		if (histogram[(srcKeys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t offset = 0;
+
+		for (uint32_t bucket = 0; bucket < 256; bucket++)
+		{
+			uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t dst = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+
+			dstKeys[dst] = srcKeys[i];
+			dstValues[dst] = srcValues[i];
+		}
+
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcValues, dstValues);
+	}
+
+	// An odd number of passes leaves the results in the temp arrays
+	if (srcKeys != keys.data())
+	{
+		keys.swap(tempKeys);
+		values.swap(tempValues);
+	}
+}
+
+void WorldDrawListBuilder::build()
+{
+	if (frameIndex % WORLD_DRAW_LIST_LOD_HISTORY_FRAMES == 0)
+	{
+		for (auto it = objectLastLODs.begin(); it != objectLastLODs.end();)
+		{
+			if (frameIndex - it->second.lastVisibleFrame >= WORLD_DRAW_LIST_LOD_HISTORY_FRAMES)
+				it = objectLastLODs.erase(it);
+			else
+				it++;
+		}
+	}
+
+	if (objectKeys.size() > WORLD_DRAW_LIST_MAX_INSTANCES && !loggedInstanceOverflow)
+	{
+		Log::get()->warn("WorldDrawListBuilder: {} objects are visible but only {} instances fit in the instance buffer, some of them won't be drawn", objectKeys.size(), WORLD_DRAW_LIST_MAX_INSTANCES);
+		loggedInstanceOverflow = true;
+	}
+
+	radixSort(objectKeys, objectIndices, tempKeys, tempIndices);
+
+	WorldCullingInstance *regionInstances = instanceBufferData + frameRegion * WORLD_DRAW_LIST_MAX_INSTANCES;
+	uint32_t instanceCount = uint32_t(std::min<size_t>(objectKeys.size(), WORLD_DRAW_LIST_MAX_INSTANCES));
+
+	for (uint32_t i = 0; i < instanceCount; i++)
+	{
+		regionInstances[i] = objectInstances[objectIndices[i]];
+
+		if (i == 0 || objectKeys[i] != objectKeys[i - 1])
+		{
+			const StaticObjectEntry *object = objectEntries[objectIndices[i]];
+
+			WorldDrawListBucket bucket = {};
+			bucket.meshID = object->meshID;
+			bucket.materialID = object->materialID;
+			bucket.meshIndex = uint32_t(objectKeys[i] >> 32);
+			bucket.model = resourceManager->getModel(meshModelHandles[bucket.meshIndex]);
+			bucket.lod = uint32_t(objectKeys[i] & 0x7);
+			bucket.firstInstance = i;
+			bucket.instanceCount = 0;
+
+			buckets.push_back(bucket);
+		}
+
+		buckets.back().instanceCount++;
+	}
+
+	for (const WorldDrawListBucket &bucket : buckets)
+	{
+		for (const ModelMeshDrawPrimitive &primitive : meshDrawPrimitives[bucket.meshIndex])
+		{
+			triangleCount += uint64_t(primitive.getLODRange(bucket.lod).indexCount / 3) * bucket.instanceCount;
+			lod0TriangleCount += uint64_t(primitive.indexCount / 3) * bucket.instanceCount;
+		}
+	}
+
+	// Each visible mesh's textures are streamed in for the biggest any of it's objects are on screen
+	for (size_t m = 0; m < meshModelHandles.size(); m++)
+		if (meshScreenCoverages[m] > 0.0f)
+			resourceManager->requestModelTextureDetail(meshModelHandles[m], meshScreenCoverages[m]);
+}
+
+void WorldDrawListBuilder::recordDraws(CommandBuffer cmdBuffer) const
+{
+	size_t regionOffset = frameRegion * WORLD_DRAW_LIST_MAX_INSTANCES * sizeof(WorldCullingInstance);
+
+	for (size_t b = 0; b < buckets.size(); b++)
+	{
+		const WorldDrawListBucket &bucket = buckets[b];
+
+		// The mesh index is the upper half of the key, so buckets w/ the same mesh are always next to each other
+		if (b == 0 || bucket.model != buckets[b - 1].model)
+		{
+			cmdBuffer->bindIndexBuffer(bucket.model->modelBuffer, 0, bucket.model->uses32BitIndices);
+			cmdBuffer->bindVertexBuffers(0, {bucket.model->modelBuffer, instanceBuffer}, {bucket.model->vertexDataOffset, regionOffset});
+		}
+
+		for (const ModelMeshDrawPrimitive &primitive : meshDrawPrimitives[bucket.meshIndex])
+		{
+			ModelMeshLODRange lodRange = primitive.getLODRange(bucket.lod);
+
+			cmdBuffer->drawIndexed(lodRange.indexCount, bucket.instanceCount, lodRange.firstIndex, primitive.vertexOffset, bucket.firstInstance);
+		}
+	}
+}
+
+const std::vector<WorldDrawListBucket> &WorldDrawListBuilder::getBuckets() const
+{
+	return buckets;
+}
+
+uint64_t WorldDrawListBuilder::getTriangleCount() const
+{
+	return triangleCount;
+}
+
+uint64_t WorldDrawListBuilder::getLOD0TriangleCount() const
+{
+	return lod0TriangleCount;
+}
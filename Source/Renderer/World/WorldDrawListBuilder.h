@@ -0,0 +1,142 @@
+#ifndef RENDERER_WORLD_WORLDDRAWLISTBUILDER_H_
+#define RENDERER_WORLD_WORLDDRAWLISTBUILDER_H_
+
+#include <common.h>
+
+#include <unordered_map>
+#include <RendererCore/RendererEnums.h>
+#include <RendererCore/RendererObjects.h>
+
+#include <Renderer/World/WorldCullingRenderer.h>
+
+#define WORLD_DRAW_LIST_MAX_INSTANCES (1 << 16)
+
+// The instance buffer is split into this many regions and each frame writes the next one, so a frame never overwrites instances still in flight
+#define WORLD_DRAW_LIST_FRAME_REGIONS 3
+
+// An object's last LOD is forgotten once it hasn't been visible for this many frames, it's stale entries are pruned every this many frames as well
+#define WORLD_DRAW_LIST_LOD_HISTORY_FRAMES 256
+
+class Renderer;
+class ResourceManager;
+struct ModelResource;
+struct ModelMeshDrawPrimitive;
+
+/*
+The LOD an object was drawn at the last time it was visible, so selectWorldLOD() can keep it there until it's screen size has moved far enough
+*/
+struct WorldDrawListObjectLOD
+{
+	uint32_t lastVisibleFrame;
+	uint8_t lod;
+};
+
+/*
+All of this frame's visible objects that share a mesh and material, their instances are contiguous in the instance buffer
+*/
+struct WorldDrawListBucket
+{
+	uint64_t meshID;
+	uint64_t materialID;
+	ModelResource *model;
+	uint32_t meshIndex; // The builder's dense index for the mesh
+	uint32_t lod;
+
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+/*
+Builds the gbuffer pass's draw list on the CPU from the objects that were found visible this frame, for when the culling is done on the CPU
+instead of w/ WorldCullingRenderer.
+
+Each frame: beginFrame(), addVisibleObjects() for each chunk's visible objects, then build(). Each object's LOD is picked w/
+selectWorldLOD() from it's bounding sphere, and the LOD it had the last time it was visible. Every object gets a 64 bit sort key, the
+upper 32 bits are a dense index for it's mesh, then 29 bits of a dense index for it's material and 3 bits for it's LOD, and the keys are
+radix sorted so objects w/ the same mesh, material and LOD end up next to each other. The dense indices are handed out the first time a mesh or material is
+seen and kept for as long as the builder lives, so the key only ever needs a few of it's bytes, and the sort skips any byte that's the
+same for every key. The sorted instances are written straight into a persistently mapped instance buffer and split into buckets.
+An object's last LOD is dropped once it hasn't been visible for WORLD_DRAW_LIST_LOD_HISTORY_FRAMES frames, so only the objects that were
+recently in view are remembered.
+
+recordDraws() then issues one instanced drawIndexed per draw primitive of each bucket's model, so the number of draw calls follows the
+number of unique mesh/material pairs in view and not the number of objects.
+*/
+class WorldDrawListBuilder
+{
+public:
+	WorldDrawListBuilder(Renderer *rendererPtr, ResourceManager *resourceManagerPtr);
+	virtual ~WorldDrawListBuilder();
+
+	/*
+	'lodScale' is the projection matrix's [1][1]
+	*/
+	void beginFrame(const glm::vec3 &cameraPosition, float lodScale);
+
+	/*
+	Object positions are chunk local, 'chunkOrigin' moves them into world space
+	*/
+	void addVisibleObjects(const std::vector<const StaticObjectEntry*> &visibleObjects, const glm::vec3 &chunkOrigin);
+
+	void build();
+
+	/*
+	The pipeline has to already be bound, and use the vertex layout from WorldRenderer::gbufferPassInit()
+	*/
+	void recordDraws(CommandBuffer cmdBuffer) const;
+
+	const std::vector<WorldDrawListBucket> &getBuckets() const;
+
+	/*
+	Returns nullptr until the mesh's model is loaded
+	*/
+	ModelResource *getMeshModel(uint64_t meshID, uint32_t &meshIndex);
+
+	/*
+	The number of triangles in this frame's draw list, and the number there would be if every object was drawn at LOD 0
+	*/
+	uint64_t getTriangleCount() const;
+	uint64_t getLOD0TriangleCount() const;
+
+	/*
+	Sorts 'values' by 'keys' w/ an LSD radix sort on 8 bit digits, both arrays are sorted in place. The sort is stable, and any digit that's
+	the same for every key is skipped.
+	*/
+	static void radixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &tempKeys, std::vector<uint32_t> &tempValues);
+
+private:
+	Renderer *renderer;
+	ResourceManager *resourceManager;
+
+	Buffer instanceBuffer;
+	WorldCullingInstance *instanceBufferData;
+	uint32_t frameRegion;
+	uint32_t frameIndex;
+
+	glm::vec3 cameraPosition;
+	float lodScale;
+
+	std::map<uint64_t, uint32_t> meshIndices;
+	std::map<uint64_t, uint32_t> materialIndices;
+	std::unordered_map<uint64_t, WorldDrawListObjectLOD> objectLastLODs; // By objectUUID
+
+	// By dense mesh index. A mesh's model is acquired the first time it's seen loaded, and held for as long as the builder lives.
+	std::vector<ResourceHandle> meshModelHandles;
+	std::vector<std::vector<ModelMeshDrawPrimitive>> meshDrawPrimitives;
+	std::vector<float> meshScreenCoverages; // The biggest screen coverage of any of the mesh's objects this frame
+
+	std::vector<uint64_t> objectKeys;
+	std::vector<uint32_t> objectIndices;
+	std::vector<uint64_t> tempKeys;
+	std::vector<uint32_t> tempIndices;
+
+	std::vector<WorldCullingInstance> objectInstances;
+	std::vector<const StaticObjectEntry*> objectEntries;
+
+	std::vector<WorldDrawListBucket> buckets;
+	uint64_t triangleCount;
+	uint64_t lod0TriangleCount;
+	bool loggedInstanceOverflow;
+};
+
+#endif /* RENDERER_WORLD_WORLDDRAWLISTBUILDER_H_ */
@@ -1,42 +1,228 @@
 #include "WorldRenderer.h"
 
+#include <Renderer/World/WorldCullingRenderer.h>
+#include <Renderer/World/WorldDrawListBuilder.h>
+#include <Renderer/World/SoftwareOcclusionCuller.h>
+
 #include <Game/KalosEngine.h>
 
 #include <RendererCore/Renderer.h>
 
 #include <Resources/ResourceManager.h>
 
-WorldRenderer::WorldRenderer(KalosEngine *enginePtr)
+#include <World/WorldManager.h>
+
+WorldRenderer::WorldRenderer(KalosEngine *enginePtr, WorldCullingRenderer *cullingRendererPtr)
 {
 	engine = enginePtr;
 	renderer = enginePtr->renderer.get();
+	cullingRenderer = cullingRendererPtr;
+
+	drawListBuilder = std::unique_ptr<WorldDrawListBuilder>(new WorldDrawListBuilder(renderer, engine->resourceManager.get()));
+	occlusionCuller = std::unique_ptr<SoftwareOcclusionCuller>(new SoftwareOcclusionCuller());
+
+	viewProjMatrix = glm::mat4(1.0f);
+	cameraPosition = glm::vec3(0.0f);
+	lodScale = 1.0f;
+	useGPUCulling = true;
+	statsLogTimer = 0.0f;
+
+	graphDrawCommandsBuffer = nullptr;
+	graphDrawCountsBuffer = nullptr;
+	graphInstancesBuffer = nullptr;
+	graphClusterDrawCommandsBuffer = nullptr;
+	graphClusterDrawCountsBuffer = nullptr;
+	graphClusterIndicesBuffer = nullptr;
 
 	testMaterialPipeline = nullptr;
 
 	MaterialDefinition pavingStones36 = {};
 	pavingStones36.pipelineID = 0;
-	pavingStones36.textureFiles[0] = "GameData/textures/PavingStones36/PavingStones36_col.png";
-	//pavingStones36.textureFiles[1] = "GameData/textures/PavingStones36/PavingStones36_nrm.png";
-	//pavingStones36.textureFiles[2] = "GameData/textures/PavingStones36/PavingStones36_rgh.png";
+	pavingStones36.textureFiles[MATERIAL_TEXTURE_SLOT_ALBEDO] = "GameData/textures/PavingStones36/PavingStones36_col.png";
+	//pavingStones36.textureFiles[MATERIAL_TEXTURE_SLOT_NORMALS] = "GameData/textures/PavingStones36/PavingStones36_nrm.png";
+	//pavingStones36.textureFiles[MATERIAL_TEXTURE_SLOT_ROUGHNESS_METALNESS] = "GameData/textures/PavingStones36/PavingStones36_rgh.png";
 
-	engine->resourceManager->loadMaterial(pavingStones36);
-	//engine->resourceManager->importGLTFModel("GameData/meshes/glTF/SciFiHelmet.gltf");
-	//engine->resourceManager->importGLTFModel("GameData/meshes/test-bridge.glb");
+	testMaterial = engine->resourceManager->loadMaterialAsync(pavingStones36);
+	//engine->resourceManager->importGLTFModelAsync("GameData/meshes/glTF/SciFiHelmet.gltf");
+	//engine->resourceManager->importGLTFModelAsync("GameData/meshes/test-bridge.glb");
 }
 
 WorldRenderer::~WorldRenderer()
 {
 	renderer->destroyPipeline(testMaterialPipeline);
+
+	engine->resourceManager->releaseMaterial(testMaterial);
 }
 
 void WorldRenderer::update(float delta)
 {
+	if (useGPUCulling)
+	{
+		// GPU culled objects never have their screen size on the CPU, so each model's texture detail is estimated from it's objects' bounding spheres instead
+		const std::vector<WorldDrawGroup> &drawGroups = cullingRenderer->getDrawGroups();
+		cullingRenderer->getDrawGroupScreenCoverages(drawGroupScreenCoverages);
+
+		for (size_t g = 0; g < drawGroups.size(); g++)
+			if (drawGroupScreenCoverages[g] > 0.0f)
+				engine->resourceManager->requestModelTextureDetail(drawGroups[g].modelHandle, drawGroupScreenCoverages[g]);
+
+		return;
+	}
+
+	drawListBuilder->beginFrame(cameraPosition, lodScale);
+
+	const WorldInfo *world = engine->worldManager->getActiveWorld();
+
+	if (world == nullptr)
+	{
+		drawListBuilder->build();
+
+		return;
+	}
+
+	occlusionCuller->beginFrame(viewProjMatrix);
+	addOccluders(*world);
+	occlusionCuller->rasterizeOccluders();
+
+	forEachWorldChunkInView(*world, cameraPosition, [&](int32_t chunkX, int32_t chunkY, size_t chunkIndex) {
+		const Octree<StaticObjectEntry> *chunkOctree = world->staticObjectData[chunkIndex].chunkOctree;
+
+		if (chunkOctree == nullptr)
+			return;
+
+		glm::vec3 chunkOrigin = glm::vec3(float(chunkX * WORLD_CHUNK_SIZE), 0.0f, float(chunkY * WORLD_CHUNK_SIZE));
+
+		chunkVisibleObjects.clear();
+		occlusionCuller->cullOctree(chunkOctree, chunkOrigin, chunkVisibleObjects);
+		drawListBuilder->addVisibleObjects(chunkVisibleObjects, chunkOrigin);
+	});
+
+	drawListBuilder->build();
+
+	statsLogTimer += delta;
+
+	if (statsLogTimer >= WORLD_RENDERER_STATS_LOG_INTERVAL)
+	{
+		uint64_t triangleCount = drawListBuilder->getTriangleCount(), lod0TriangleCount = drawListBuilder->getLOD0TriangleCount();
+
+		Log::get()->info("WorldRenderer: CPU draw list has {} buckets, {} triangles, {} at LOD 0 ({:.1f}%)", drawListBuilder->getBuckets().size(), triangleCount, lod0TriangleCount, lod0TriangleCount > 0 ? 100.0 * double(triangleCount) / double(lod0TriangleCount) : 100.0);
+
+		statsLogTimer = 0.0f;
+	}
+}
+
+static void gatherOccluderCandidates(const Octree<StaticObjectEntry> *node, const glm::vec3 &chunkOrigin, const glm::vec3 &cameraPosition, float lodScale, std::vector<WorldOccluderCandidate> &candidates)
+{
+	glm::vec3 nodeMin = chunkOrigin + glm::vec3(node->boundingBox.aabbMin.x, node->boundingBox.aabbMin.y, node->boundingBox.aabbMin.z);
+	glm::vec3 nodeMax = chunkOrigin + glm::vec3(node->boundingBox.aabbMax.x, node->boundingBox.aabbMax.y, node->boundingBox.aabbMax.z);
+
+	if (glm::distance(glm::clamp(cameraPosition, nodeMin, nodeMax), cameraPosition) > float(WORLD_RENDERER_OCCLUDER_DISTANCE))
+		return;
+
+	for (const StaticObjectEntry &item : node->items)
+	{
+		BoundingSphere sphere = item.getBoundingSphere();
+		glm::vec3 center = chunkOrigin + glm::vec3(sphere.position.x, sphere.position.y, sphere.position.z);
+		float screenCoverage = getWorldLODScreenCoverage(center, sphere.radius, cameraPosition, lodScale);
+
+		if (screenCoverage >= WORLD_RENDERER_MIN_OCCLUDER_COVERAGE)
+			candidates.push_back({&item, chunkOrigin, screenCoverage});
+	}
+
+	for (int child = 0; child < 8; child++)
+		if (node->children[child] != nullptr)
+			gatherOccluderCandidates(node->children[child], chunkOrigin, cameraPosition, lodScale, candidates);
+}
+
+void WorldRenderer::addOccluders(const WorldInfo &world)
+{
+	occluderCandidates.clear();
+
+	forEachWorldChunkInRadius(world, glm::vec2(cameraPosition.x, cameraPosition.z), float(WORLD_RENDERER_OCCLUDER_DISTANCE), [&](int32_t chunkX, int32_t chunkY, size_t chunkIndex) {
+		const Octree<StaticObjectEntry> *chunkOctree = world.staticObjectData[chunkIndex].chunkOctree;
+
+		if (chunkOctree != nullptr)
+			gatherOccluderCandidates(chunkOctree, glm::vec3(float(chunkX * WORLD_CHUNK_SIZE), 0.0f, float(chunkY * WORLD_CHUNK_SIZE)), cameraPosition, lodScale, occluderCandidates);
+	});
+
+	std::sort(occluderCandidates.begin(), occluderCandidates.end(), [&](const WorldOccluderCandidate &a, const WorldOccluderCandidate &b) {
+		return a.screenCoverage > b.screenCoverage;
+	});
+
+	uint32_t occluderCount = 0;
+
+	for (const WorldOccluderCandidate &candidate : occluderCandidates)
+	{
+		if (occluderCount == WORLD_RENDERER_MAX_OCCLUDERS)
+			break;
+
+		const StaticObjectEntry *object = candidate.object;
+		glm::vec3 position = candidate.chunkOrigin + glm::vec3(object->position.x, object->position.y, object->position.z);
+
+		// Objects behind the camera would just be clipped away
+		glm::vec4 clipPosition = viewProjMatrix * glm::vec4(position, 1.0f);
+
+		if (clipPosition.w < -object->getBoundingSphere().radius)
+			continue;
+
+		uint32_t meshIndex;
+		ModelResource *model = drawListBuilder->getMeshModel(object->meshID, meshIndex);
 
+		// Only objects that are drawn at LOD 0 are used, so an occluder never covers more than what's actually drawn
+		if (model == nullptr || model->occluderIndices.size() == 0 || (model->lodCount > 1 && candidate.screenCoverage < model->lodScreenCoverages[1]))
+			continue;
+
+		glm::quat orientation = glm::quat(object->orientation.w, object->orientation.x, object->orientation.y, object->orientation.z);
+		glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(orientation) * glm::scale(glm::mat4(1.0f), glm::vec3(object->scale));
+
+		occlusionCuller->addOccluder(model->occluderVertices.data(), model->occluderIndices.data(), model->occluderIndices.size(), modelMatrix);
+		occluderCount++;
+	}
+}
+
+void WorldRenderer::setCamera(const glm::mat4 &viewProjMatrix, const glm::vec3 &cameraPosition, float lodScale)
+{
+	this->viewProjMatrix = viewProjMatrix;
+	this->cameraPosition = cameraPosition;
+	this->lodScale = lodScale;
+
+	cullingRenderer->setCamera(viewProjMatrix, cameraPosition, lodScale);
+}
+
+void WorldRenderer::setUseGPUCulling(bool useGPUCulling)
+{
+	this->useGPUCulling = useGPUCulling;
 }
 
 void WorldRenderer::gbufferPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data)
 {
+	if (useGPUCulling ? (cullingRenderer->getDrawGroups().size() == 0 || graphDrawCommandsBuffer == nullptr) : drawListBuilder->getBuckets().size() == 0)
+		return;
+
+	WorldRendererMaterialPushConstants pushConstants = {};
+	pushConstants.materialTextureIndex = 0;
+
+	// Everything is drawn w/ the test material until material pipelines are in
+	cmdBuffer->bindPipeline(PIPELINE_BIND_POINT_GRAPHICS, testMaterialPipeline);
+	cmdBuffer->pushConstants(0, sizeof(WorldRendererMaterialPushConstants), &pushConstants);
+
+	if (useGPUCulling)
+	{
+		cullingRenderer->recordDrawGroupDraws(cmdBuffer, graphDrawCommandsBuffer, graphDrawCountsBuffer, graphInstancesBuffer, true);
+		cullingRenderer->recordClusterGroupDraws(cmdBuffer, graphClusterDrawCommandsBuffer, graphClusterDrawCountsBuffer, graphClusterIndicesBuffer, graphInstancesBuffer);
+	}
+	else
+		drawListBuilder->recordDraws(cmdBuffer);
+}
 
+void WorldRenderer::gbufferPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data)
+{
+	graphDrawCommandsBuffer = data.graphBuffers.at("worldDrawCommands");
+	graphDrawCountsBuffer = data.graphBuffers.at("worldDrawCounts");
+	graphInstancesBuffer = data.graphBuffers.at("worldInstances");
+	graphClusterDrawCommandsBuffer = data.graphBuffers.at("worldClusterDrawCommands");
+	graphClusterDrawCountsBuffer = data.graphBuffers.at("worldClusterDrawCounts");
+	graphClusterIndicesBuffer = data.graphBuffers.at("worldClusterIndices");
 }
 
 void WorldRenderer::gbufferPassInit(const RenderGraphInitFunctionData &data)
@@ -51,39 +237,15 @@ void WorldRenderer::gbufferPassInit(const RenderGraphInitFunctionData &data)
 	fragShaderStage.shaderModule = fragShader;
 
 	VertexInputBinding vertexMeshBinding = {};
-	vertexMeshBinding.binding = 0;
-	vertexMeshBinding.stride = (3 + 2 + 3 + 3) * sizeof(float);
-	vertexMeshBinding.inputRate = VERTEX_INPUT_RATE_VERTEX;
+	std::vector<VertexInputAttribute> meshAttribs;
+
+	engine->resourceManager->getModelVertexInput(0, false, vertexMeshBinding, meshAttribs);
 
 	VertexInputBinding instanceBinding = {};
 	instanceBinding.binding = 1;
-	instanceBinding.stride = (4 + 4) * sizeof(float);
+	instanceBinding.stride = sizeof(WorldCullingInstance);
 	instanceBinding.inputRate = VERTEX_INPUT_RATE_INSTANCE;
 
-	VertexInputAttribute meshVertexAttrib = {};
-	meshVertexAttrib.binding = 0;
-	meshVertexAttrib.location = 0;
-	meshVertexAttrib.format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
-	meshVertexAttrib.offset = offsetof(NonSkinnedVertex, vertex);
-
-	VertexInputAttribute meshNormalAttrib = {};
-	meshNormalAttrib.binding = 0;
-	meshNormalAttrib.location = 2;
-	meshNormalAttrib.format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
-	meshNormalAttrib.offset = offsetof(NonSkinnedVertex, normal);
-
-	VertexInputAttribute meshTangentAttrib = {};
-	meshTangentAttrib.binding = 0;
-	meshTangentAttrib.location = 3;
-	meshTangentAttrib.format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
-	meshTangentAttrib.offset = offsetof(NonSkinnedVertex, tangent);
-
-	VertexInputAttribute meshUV0Attrib = {};
-	meshUV0Attrib.binding = 0;
-	meshUV0Attrib.location = 1;
-	meshUV0Attrib.format = RESOURCE_FORMAT_R32G32_SFLOAT;
-	meshUV0Attrib.offset = offsetof(NonSkinnedVertex, uv0);
-
 	VertexInputAttribute instancePositionScaleAttrib = {};
 	instancePositionScaleAttrib.binding = 1;
 	instancePositionScaleAttrib.location = 4;
@@ -98,7 +260,9 @@ void WorldRenderer::gbufferPassInit(const RenderGraphInitFunctionData &data)
 
 	PipelineVertexInputInfo vertexInput = {};
 	vertexInput.vertexInputBindings = {vertexMeshBinding, instanceBinding};
-	vertexInput.vertexInputAttribs = {meshVertexAttrib, meshUV0Attrib, meshNormalAttrib, meshTangentAttrib, instancePositionScaleAttrib, instanceQuatAttrib};
+	vertexInput.vertexInputAttribs = meshAttribs;
+	vertexInput.vertexInputAttribs.push_back(instancePositionScaleAttrib);
+	vertexInput.vertexInputAttribs.push_back(instanceQuatAttrib);
 
 	PipelineInputAssemblyInfo inputAssembly = {};
 	inputAssembly.primitiveRestart = false;
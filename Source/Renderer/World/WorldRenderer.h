@@ -4,9 +4,29 @@
 #include <common.h>
 #include <RendererCore/RendererEnums.h>
 #include <RendererCore/RendererObjects.h>
+#include <Resources/ResourceSlotArray.h>
+#include <World/WorldManager.h>
+
+#define WORLD_RENDERER_MAX_OCCLUDERS 16 // The most objects rasterized into SoftwareOcclusionCuller's depth buffer each frame
+#define WORLD_RENDERER_OCCLUDER_DISTANCE 384 // Only objects this close to the camera are considered as occluders, in world units
+#define WORLD_RENDERER_MIN_OCCLUDER_COVERAGE 0.1f // The smallest screen coverage (see getWorldLODScreenCoverage()) an occluder can have
+#define WORLD_RENDERER_STATS_LOG_INTERVAL 5.0f // Seconds between each log of the CPU draw list's triangle counts
 
 class KalosEngine;
 class Renderer;
+class WorldCullingRenderer;
+class WorldDrawListBuilder;
+class SoftwareOcclusionCuller;
+
+/*
+An object that could be rasterized as an occluder this frame
+*/
+struct WorldOccluderCandidate
+{
+	const StaticObjectEntry *object;
+	glm::vec3 chunkOrigin;
+	float screenCoverage;
+};
 
 struct WorldRendererMaterialPushConstants
 {
@@ -17,19 +37,57 @@ class WorldRenderer
 {
 public:
 
-	WorldRenderer(KalosEngine *enginePtr);
+	WorldRenderer(KalosEngine *enginePtr, WorldCullingRenderer *cullingRendererPtr);
 	virtual ~WorldRenderer();
 
 	void update(float delta);
 
+	/*
+	'lodScale' is the projection matrix's [1][1]
+	*/
+	void setCamera(const glm::mat4 &viewProjMatrix, const glm::vec3 &cameraPosition, float lodScale);
+
+	/*
+	Switches the gbuffer pass between the GPU culled indirect draws from WorldCullingRenderer and a draw list built on the CPU each
+	frame from the objects that pass SoftwareOcclusionCuller. GPU culling is used by default.
+	*/
+	void setUseGPUCulling(bool useGPUCulling);
+
 	void gbufferPassInit(const RenderGraphInitFunctionData &data);
 	void gbufferPassRender(CommandBuffer cmdBuffer, const RenderGraphRenderFunctionData &data);
+	void gbufferPassDescriptorUpdate(const RenderGraphDescriptorUpdateFunctionData &data);
 
 private:
 	KalosEngine *engine;
 	Renderer *renderer;
+	WorldCullingRenderer *cullingRenderer;
+
+	std::unique_ptr<WorldDrawListBuilder> drawListBuilder;
+	std::unique_ptr<SoftwareOcclusionCuller> occlusionCuller;
+	std::vector<const StaticObjectEntry*> chunkVisibleObjects;
+	std::vector<float> drawGroupScreenCoverages;
+	std::vector<WorldOccluderCandidate> occluderCandidates;
+
+	glm::mat4 viewProjMatrix;
+	glm::vec3 cameraPosition;
+	float lodScale;
+	bool useGPUCulling;
+	float statsLogTimer;
+
+	Buffer graphDrawCommandsBuffer;
+	Buffer graphDrawCountsBuffer;
+	Buffer graphInstancesBuffer;
+	Buffer graphClusterDrawCommandsBuffer;
+	Buffer graphClusterDrawCountsBuffer;
+	Buffer graphClusterIndicesBuffer;
 
 	Pipeline testMaterialPipeline;
+	ResourceHandle testMaterial;
+
+	/*
+	Picks the objects near the camera that cover the most of the screen and have an occluder mesh, and adds them to the occlusion culler
+	*/
+	void addOccluders(const WorldInfo &world);
 };
 
 #endif /* RENDERER_WORLD_WORLDRENDERER_H_ */
@@ -179,6 +179,26 @@ void D3D12CommandBuffer::drawIndexed(uint32_t indexCount, uint32_t instanceCount
 	cmdList->DrawIndexedInstanced(indexCount, instanceCount, firstIndex, firstVertex, firstInstance);
 }
 
+void D3D12CommandBuffer::drawIndirect(Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+	cmdList->ExecuteIndirect(renderer->getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW, stride), drawCount, static_cast<D3D12Buffer*>(buffer)->bufferResource, offset, nullptr, 0);
+}
+
+void D3D12CommandBuffer::drawIndexedIndirect(Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+	cmdList->ExecuteIndirect(renderer->getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, stride), drawCount, static_cast<D3D12Buffer*>(buffer)->bufferResource, offset, nullptr, 0);
+}
+
+void D3D12CommandBuffer::drawIndirectCount(Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	cmdList->ExecuteIndirect(renderer->getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW, stride), maxDrawCount, static_cast<D3D12Buffer*>(buffer)->bufferResource, offset, static_cast<D3D12Buffer*>(countBuffer)->bufferResource, countBufferOffset);
+}
+
+void D3D12CommandBuffer::drawIndexedIndirectCount(Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	cmdList->ExecuteIndirect(renderer->getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, stride), maxDrawCount, static_cast<D3D12Buffer*>(buffer)->bufferResource, offset, static_cast<D3D12Buffer*>(countBuffer)->bufferResource, countBufferOffset);
+}
+
 void D3D12CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
 {
 	cmdList->Dispatch(groupCountX, groupCountY, groupCountZ);
@@ -317,6 +337,20 @@ void D3D12CommandBuffer::resourceBarriers(const std::vector<ResourceBarrier> &ba
 				d3dbarrierInfo.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 				d3dbarrierInfo.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
 
+				// Same as w/ buffers below, UAV barriers always cover the whole resource
+				if (transitionBarrier.StateBefore == transitionBarrier.StateAfter)
+				{
+					if (transitionBarrier.StateAfter != D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+						break;
+
+					d3dbarrierInfo.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+					d3dbarrierInfo.UAV.pResource = transitionBarrier.pResource;
+
+					d3dbarriers.push_back(d3dbarrierInfo);
+
+					break;
+				}
+
 				if (subresource.baseMipLevel == 0 && subresource.baseArrayLayer == 0 && subresource.levelCount == texture->mipCount && subresource.layerCount == texture->layerCount)
 				{
 					transitionBarrier.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
@@ -330,7 +364,7 @@ void D3D12CommandBuffer::resourceBarriers(const std::vector<ResourceBarrier> &ba
 					{
 						for (uint32_t level = subresource.baseMipLevel; level < subresource.baseMipLevel + subresource.levelCount; level++)
 						{
-							transitionBarrier.Subresource = layer * subresource.levelCount + level;
+							transitionBarrier.Subresource = layer * texture->mipCount + level;
 							d3dbarrierInfo.Transition = transitionBarrier;
 
 							d3dbarriers.push_back(d3dbarrierInfo);
@@ -349,9 +383,22 @@ void D3D12CommandBuffer::resourceBarriers(const std::vector<ResourceBarrier> &ba
 				transitionBarrier.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
 				D3D12_RESOURCE_BARRIER d3dbarrierInfo = {};
-				d3dbarrierInfo.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 				d3dbarrierInfo.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-				d3dbarrierInfo.Transition = transitionBarrier;
+
+				// A GENERAL -> GENERAL barrier is how the API waits on writes to a storage buffer, which d3d12 does w/ a UAV barrier instead of a transition
+				if (transitionBarrier.StateBefore == transitionBarrier.StateAfter)
+				{
+					if (transitionBarrier.StateAfter != D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+						break;
+
+					d3dbarrierInfo.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+					d3dbarrierInfo.UAV.pResource = transitionBarrier.pResource;
+				}
+				else
+				{
+					d3dbarrierInfo.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+					d3dbarrierInfo.Transition = transitionBarrier;
+				}
 
 				d3dbarriers.push_back(d3dbarrierInfo);
 
@@ -360,7 +407,8 @@ void D3D12CommandBuffer::resourceBarriers(const std::vector<ResourceBarrier> &ba
 		}
 	}
 
-	cmdList->ResourceBarrier((UINT) d3dbarriers.size(), d3dbarriers.data());
+	if (d3dbarriers.size() > 0)
+		cmdList->ResourceBarrier((UINT) d3dbarriers.size(), d3dbarriers.data());
 }
 
 void D3D12CommandBuffer::stageBuffer(StagingBuffer stagingBuffer, Buffer dstBuffer)
@@ -397,6 +445,40 @@ void D3D12CommandBuffer::stageTextureSubresources(StagingTexture stagingTexture,
 	}
 }
 
+void D3D12CommandBuffer::stageBufferRegion(StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	D3D12StagingBuffer *d3dstagingBuffer = static_cast<D3D12StagingBuffer*>(stagingBuffer);
+	D3D12Buffer *d3ddstBuffer = static_cast<D3D12Buffer*>(dstBuffer);
+
+	cmdList->CopyBufferRegion(d3ddstBuffer->bufferResource, dstOffset, d3dstagingBuffer->bufferResource, stagingOffset, size);
+}
+
+void D3D12CommandBuffer::stageTextureSubresourceRegion(StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer)
+{
+	D3D12StagingBuffer *d3dstagingBuffer = static_cast<D3D12StagingBuffer*>(stagingBuffer);
+	D3D12Texture *d3ddstTexture = static_cast<D3D12Texture*>(dstTexture);
+
+	// Footprints of compressed formats are in texels, but always cover whole blocks
+	uint32_t blockSize = isCompressedFormat(d3ddstTexture->textureFormat) ? 4 : 1;
+
+	D3D12_TEXTURE_COPY_LOCATION dstCopyLoc = {};
+	dstCopyLoc.pResource = d3ddstTexture->textureResource;
+	dstCopyLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	dstCopyLoc.SubresourceIndex = arrayLayer * d3ddstTexture->mipCount + mipLevel;
+
+	D3D12_TEXTURE_COPY_LOCATION srcCopyLoc = {};
+	srcCopyLoc.pResource = d3dstagingBuffer->bufferResource;
+	srcCopyLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	srcCopyLoc.PlacedFootprint.Offset = stagingOffset;
+	srcCopyLoc.PlacedFootprint.Footprint.Format = ResourceFormatToDXGIFormat(d3ddstTexture->textureFormat);
+	srcCopyLoc.PlacedFootprint.Footprint.Width = (std::max<uint32_t>(d3ddstTexture->width >> mipLevel, 1) + blockSize - 1) / blockSize * blockSize;
+	srcCopyLoc.PlacedFootprint.Footprint.Height = (std::max<uint32_t>(d3ddstTexture->height >> mipLevel, 1) + blockSize - 1) / blockSize * blockSize;
+	srcCopyLoc.PlacedFootprint.Footprint.Depth = std::max<uint32_t>(d3ddstTexture->depth >> mipLevel, 1);
+	srcCopyLoc.PlacedFootprint.Footprint.RowPitch = rowPitch;
+
+	cmdList->CopyTextureRegion(&dstCopyLoc, 0, 0, 0, &srcCopyLoc, nullptr);
+}
+
 void D3D12CommandBuffer::setViewports(uint32_t firstViewport, const std::vector<Viewport>& viewports)
 {
 	std::vector<D3D12_VIEWPORT> d3dViewports;
@@ -437,6 +519,7 @@ void D3D12CommandBuffer::setScissors(uint32_t firstScissor, const std::vector<Sc
 
 void D3D12CommandBuffer::blitTexture(Texture src, TextureLayout srcLayout, Texture dst, TextureLayout dstLayout, std::vector<TextureBlitInfo> blitRegions, SamplerFilter filter)
 {
+	Log::get()->error("D3D12CommandBuffer: blitTexture() isn't supported by the D3D12 backend, check Renderer::supportsTextureBlits() before using it");
 }
 
 void D3D12CommandBuffer::beginDebugRegion(const std::string & regionName, glm::vec4 color)
@@ -71,6 +71,7 @@ struct D3D12StagingBuffer : public RendererStagingBuffer
 struct D3D12StagingTexture : public RendererStagingTexture
 {
 	ID3D12Resource *bufferResource;
+	char *mappedData; // Upload heaps can stay mapped, so it's mapped once when it's created
 	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> placedSubresourceFootprints;
 	std::vector<uint32_t> subresourceNumRows;
 	std::vector<uint64_t> subresourceRowSize;
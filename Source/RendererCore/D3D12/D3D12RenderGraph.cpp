@@ -220,9 +220,6 @@ TextureView D3D12RenderGraph::getRenderGraphOutputTextureView()
 	return graphTextureViews[outputAttachmentName];
 }
 
-const std::string viewSelectMipPostfix = "_fg_miplvl";
-const std::string viewSelectLayerPostfix = "_fg_layer";
-
 void D3D12RenderGraph::assignPhysicalResources(const std::vector<size_t>& passStack)
 {
 	typedef struct
@@ -416,7 +413,7 @@ void D3D12RenderGraph::assignPhysicalResources(const std::vector<size_t>& passSt
 			graphTextureView->baseLayer = 0;
 			graphTextureView->layerCount = data.attachment.arrayLayers;
 
-			graphTextureViews[it->first + viewSelectMipPostfix + toString(m)] = graphTextureView;
+			graphTextureViews[getRenderGraphMipViewName(it->first, m)] = graphTextureView;
 		}
 
 		for (uint32_t l = 0; l < data.attachment.arrayLayers; l++)
@@ -430,7 +427,7 @@ void D3D12RenderGraph::assignPhysicalResources(const std::vector<size_t>& passSt
 			graphTextureView->baseLayer = l;
 			graphTextureView->layerCount = 1;
 
-			graphTextureViews[it->first + viewSelectLayerPostfix + toString(l)] = graphTextureView;
+			graphTextureViews[getRenderGraphLayerViewName(it->first, l)] = graphTextureView;
 		}
 	}
 
@@ -717,6 +714,16 @@ void D3D12RenderGraph::buildBarrierLists(const std::vector<size_t> &passStack)
 
 				passData.beforeRenderBarriers.push_back(barrier);
 			}
+			else if (requiredState == D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+			{
+				// No transition between two passes that both use it as a UAV, but any writes from the last pass still have to finish first
+				D3D12_RESOURCE_BARRIER barrier = {};
+				barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+				barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+				barrier.UAV.pResource = static_cast<D3D12Buffer *>(graphBuffers[storageBuffer.bufferName])->bufferResource;
+
+				passData.beforeRenderBarriers.push_back(barrier);
+			}
 
 			resourceStates[storageBuffer.bufferName].currentState = BufferLayoutToD3D12ResourceStates(storageBuffer.passEndLayout);
 		}
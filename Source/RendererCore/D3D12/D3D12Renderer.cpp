@@ -101,6 +101,9 @@ D3D12Renderer::D3D12Renderer(const RendererAllocInfo& allocInfo)
 
 D3D12Renderer::~D3D12Renderer()
 {
+	for (auto signatureIt = indirectCommandSignatures.begin(); signatureIt != indirectCommandSignatures.end(); signatureIt++)
+		signatureIt->second->Release();
+
 	for (size_t i = 0; i < massDescriptorHeaps.size(); i++)
 		if (massDescriptorHeaps[i].heap != nullptr)
 			massDescriptorHeaps[i].heap->Release();
@@ -129,6 +132,33 @@ D3D12Renderer::~D3D12Renderer()
 	delete temp_mapBuffer;
 }
 
+ID3D12CommandSignature *D3D12Renderer::getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE argumentType, uint32_t stride)
+{
+	std::lock_guard<std::mutex> lock(indirectCommandSignatures_mutex);
+
+	auto signatureIt = indirectCommandSignatures.find(std::make_pair(argumentType, stride));
+
+	if (signatureIt != indirectCommandSignatures.end())
+		return signatureIt->second;
+
+	D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+	argumentDesc.Type = argumentType;
+
+	D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+	signatureDesc.ByteStride = stride;
+	signatureDesc.NumArgumentDescs = 1;
+	signatureDesc.pArgumentDescs = &argumentDesc;
+	signatureDesc.NodeMask = 0;
+
+	// Draw arguments don't change any root arguments, so the signature doesn't need a root signature
+	ID3D12CommandSignature *commandSignature = nullptr;
+	DX_CHECK_RESULT(device->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&commandSignature)));
+
+	indirectCommandSignatures[std::make_pair(argumentType, stride)] = commandSignature;
+
+	return commandSignature;
+}
+
 void D3D12Renderer::chooseDeviceAdapter()
 {
 	uint32_t adapterIndex = 0;
@@ -1064,6 +1094,9 @@ StagingTexture D3D12Renderer::createStagingTexture(suvec3 extent, ResourceFormat
 
 	DX_CHECK_RESULT(device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD), D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(totalSize), D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&stagingTexture->bufferResource)));
 
+	CD3DX12_RANGE readRange(0, 0);
+	DX_CHECK_RESULT(stagingTexture->bufferResource->Map(0, &readRange, reinterpret_cast<void**>(&stagingTexture->mappedData)));
+
 	return stagingTexture;
 }
 
@@ -1071,33 +1104,35 @@ void D3D12Renderer::fillStagingTextureSubresource(StagingTexture stagingTexture,
 {
 	D3D12StagingTexture *d3dstagingTexture = static_cast<D3D12StagingTexture*>(stagingTexture);
 
-	uint32_t subresourceIndex = arrayLayer * d3dstagingTexture->mipLevels + arrayLayer;
+	uint32_t subresourceIndex = arrayLayer * d3dstagingTexture->mipLevels + mipLevel;
 	uint32_t subresourceRows = d3dstagingTexture->subresourceNumRows[subresourceIndex];
 	uint64_t subresourceRowSize = d3dstagingTexture->subresourceRowSize[subresourceIndex];
 
 	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT &placedSubresourceFootprint = d3dstagingTexture->placedSubresourceFootprints[subresourceIndex];
 
-	uint32_t subresourceSlicePitch = placedSubresourceFootprint.Footprint.RowPitch * placedSubresourceFootprint.Footprint.Height;
+	uint64_t subresourceSlicePitch = uint64_t(placedSubresourceFootprint.Footprint.RowPitch) * subresourceRows;
 
-	D3D12_RANGE mapReadRange = {0, 0};
+	char *mappedMem = d3dstagingTexture->mappedData + placedSubresourceFootprint.Offset;
+	const char *srcData = reinterpret_cast<const char*>(textureData);
 
-	char *mappedMem = nullptr;
-	DX_CHECK_RESULT(d3dstagingTexture->bufferResource->Map(0, &mapReadRange, reinterpret_cast<void**>(&mappedMem)));
+	// Tightly packed rows can go in w/ a single copy
+	if (placedSubresourceFootprint.Footprint.RowPitch == subresourceRowSize)
+	{
+		memcpy(mappedMem, srcData, subresourceSlicePitch * placedSubresourceFootprint.Footprint.Depth);
 
-	mappedMem += placedSubresourceFootprint.Offset;
+		return;
+	}
 
 	for (uint32_t z = 0; z < placedSubresourceFootprint.Footprint.Depth; z++)
 	{
 		char *dstSlice = mappedMem + subresourceSlicePitch * z;
-		const char *srcSlice = reinterpret_cast<const char*>(textureData) + subresourceRowSize * placedSubresourceFootprint.Footprint.Height * z;
+		const char *srcSlice = srcData + subresourceRowSize * subresourceRows * z;
 
 		for (uint32_t y = 0; y < subresourceRows; y++)
 		{
 			memcpy(dstSlice + placedSubresourceFootprint.Footprint.RowPitch * y, srcSlice + subresourceRowSize * y, subresourceRowSize);
 		}
 	}
-
-	d3dstagingTexture->bufferResource->Unmap(0, nullptr);
 }
 
 void D3D12Renderer::destroyCommandPool(CommandPool pool)
@@ -1197,11 +1232,18 @@ void D3D12Renderer::destroyStagingTexture(StagingTexture stagingTexture)
 {
 	D3D12StagingTexture *d3d12StagingTexture = static_cast<D3D12StagingTexture*>(stagingTexture);
 
+	d3d12StagingTexture->bufferResource->Unmap(0, nullptr);
 	d3d12StagingTexture->bufferResource->Release();
 
 	delete d3d12StagingTexture;
 }
 
+bool D3D12Renderer::supportsTextureBlits()
+{
+	// D3D12 has no blit, it'd need a compute or draw based downsampler
+	return false;
+}
+
 void D3D12Renderer::setObjectDebugName(void *obj, RendererObjectType objType, const std::string & name)
 {
 	switch (objType)
@@ -43,6 +43,12 @@ class D3D12Renderer : public Renderer
 
 	void createNewDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, uint32_t numDescriptors = 1000000);
 
+	/*
+	Gets the command signature ExecuteIndirect needs for a single draw/draw indexed argument w/ the given stride. Signatures are created
+	the first time they're asked for and kept until the renderer is destroyed, so this is safe to call while recording.
+	*/
+	ID3D12CommandSignature *getIndirectCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE argumentType, uint32_t stride);
+
 	CommandPool createCommandPool(QueueType queue, CommandPoolFlags flags);
 
 	void submitToQueue(QueueType queue, const std::vector<CommandBuffer> &cmdBuffers, const std::vector<Semaphore> &waitSemaphores, const std::vector<PipelineStageFlags> &waitSemaphoreStages, const std::vector<Semaphore> &signalSemaphores, Fence fence);
@@ -100,6 +106,8 @@ class D3D12Renderer : public Renderer
 	void destroyFence(Fence fence);
 	void destroySemaphore(Semaphore sem);
 
+	bool supportsTextureBlits();
+
 	void setObjectDebugName(void *obj, RendererObjectType objType, const std::string &name);
 
 	void initSwapchain(Window *wnd);
@@ -123,6 +131,9 @@ class D3D12Renderer : public Renderer
 
 	char *temp_mapBuffer;
 
+	std::map<std::pair<D3D12_INDIRECT_ARGUMENT_TYPE, uint32_t>, ID3D12CommandSignature*> indirectCommandSignatures;
+	std::mutex indirectCommandSignatures_mutex;
+
 	void chooseDeviceAdapter();
 	void createLogicalDevice();
 };
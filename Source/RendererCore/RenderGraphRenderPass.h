@@ -76,6 +76,20 @@ typedef struct
 	uint32_t baseSubpass;
 } RenderGraphInitFunctionData;
 
+/*
+Besides a view of each whole texture, graphTextureViews has a view of every single mip (w/ all of the texture's layers) and of
+every single layer (w/ just the first mip), named by these
+*/
+inline std::string getRenderGraphMipViewName(const std::string &textureName, uint32_t mipLevel)
+{
+	return textureName + "_fg_miplvl" + toString(mipLevel);
+}
+
+inline std::string getRenderGraphLayerViewName(const std::string &textureName, uint32_t arrayLayer)
+{
+	return textureName + "_fg_layer" + toString(arrayLayer);
+}
+
 typedef struct
 {
 	std::map<std::string, TextureView> graphTextureViews;
@@ -90,6 +90,63 @@ RendererCommandBuffer::~RendererCommandBuffer()
 
 }
 
+void RendererCommandBuffer::generateMipmaps(Texture texture, TextureLayout baseMipLayout, TextureLayout finalLayout)
+{
+	ResourceBarrier barrier = {};
+	barrier.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
+	barrier.textureTransition.texture = texture;
+
+	for (uint32_t m = 1; m < texture->mipCount; m++)
+	{
+		// The mip above has to be finished before it's read
+		barrier.textureTransition.oldLayout = m == 1 ? baseMipLayout : TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.textureTransition.newLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.textureTransition.subresourceRange = {m - 1, 1, 0, texture->layerCount};
+
+		if (barrier.textureTransition.oldLayout != barrier.textureTransition.newLayout)
+			resourceBarriers({barrier});
+
+		TextureBlitInfo blitInfo = {};
+		blitInfo.srcSubresource = {m - 1, 0, texture->layerCount};
+		blitInfo.srcOffsets[0] = {0, 0, 0};
+		blitInfo.srcOffsets[1] = {int32_t(std::max(texture->width >> (m - 1), 1u)), int32_t(std::max(texture->height >> (m - 1), 1u)), int32_t(std::max(texture->depth >> (m - 1), 1u))};
+		blitInfo.dstSubresource = {m, 0, texture->layerCount};
+		blitInfo.dstOffsets[0] = {0, 0, 0};
+		blitInfo.dstOffsets[1] = {int32_t(std::max(texture->width >> m, 1u)), int32_t(std::max(texture->height >> m, 1u)), int32_t(std::max(texture->depth >> m, 1u))};
+
+		blitTexture(texture, TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, {blitInfo}, SAMPLER_FILTER_LINEAR);
+	}
+
+	// Every mip but the last one was read from, and the last one was only written to
+	std::vector<ResourceBarrier> finalBarriers;
+
+	if (texture->mipCount > 1)
+	{
+		barrier.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.textureTransition.newLayout = finalLayout;
+		barrier.textureTransition.subresourceRange = {0, texture->mipCount - 1, 0, texture->layerCount};
+		finalBarriers.push_back(barrier);
+
+		barrier.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.textureTransition.subresourceRange = {texture->mipCount - 1, 1, 0, texture->layerCount};
+		finalBarriers.push_back(barrier);
+	}
+	else
+	{
+		barrier.textureTransition.oldLayout = baseMipLayout;
+		barrier.textureTransition.newLayout = finalLayout;
+		barrier.textureTransition.subresourceRange = {0, 1, 0, texture->layerCount};
+		finalBarriers.push_back(barrier);
+	}
+
+	for (size_t i = finalBarriers.size(); i-- > 0;)
+		if (finalBarriers[i].textureTransition.oldLayout == finalBarriers[i].textureTransition.newLayout)
+			finalBarriers.erase(finalBarriers.begin() + i);
+
+	if (finalBarriers.size() > 0)
+		resourceBarriers(finalBarriers);
+}
+
 RendererDescriptorPool::~RendererDescriptorPool()
 {
 
@@ -79,6 +79,11 @@ class Renderer
 		virtual void destroyFence (Fence fence) = 0;
 		virtual void destroySemaphore (Semaphore sem) = 0;
 
+		/*
+		 * Whether CommandBuffer::blitTexture() (and so CommandBuffer::generateMipmaps()) does anything on this backend.
+		 */
+		virtual bool supportsTextureBlits () = 0;
+
 #if RENDER_DEBUG_MARKERS
 		virtual void setObjectDebugName (void *obj, RendererObjectType objType, const std::string &name) = 0;
 #else
@@ -37,6 +37,19 @@ class RendererCommandBuffer
 		virtual void draw (uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) = 0;
 		virtual void drawIndexed (uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t firstVertex = 0, uint32_t firstInstance = 0) = 0;
 
+		/*
+		 * Draws 'drawCount' DrawIndirectCommand/DrawIndexedIndirectCommand structs read from 'buffer', which has to be in BUFFER_LAYOUT_INDIRECT_BUFFER.
+		 */
+		virtual void drawIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride = sizeof(DrawIndirectCommand)) = 0;
+		virtual void drawIndexedIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) = 0;
+
+		/*
+		 * Same as above, but the number of draws is read as a uint32_t from 'countBuffer' on the GPU (also in BUFFER_LAYOUT_INDIRECT_BUFFER), clamped to 'maxDrawCount'. If the device
+		 * can't read the count from a buffer then all 'maxDrawCount' commands are drawn, so any unused commands should have an instanceCount of 0.
+		 */
+		virtual void drawIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(DrawIndirectCommand)) = 0;
+		virtual void drawIndexedIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(DrawIndexedIndirectCommand)) = 0;
+
 		virtual void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
 
 		virtual void resolveTexture(Texture srcTexture, Texture dstTexture, TextureSubresourceRange subresources) = 0;
@@ -56,11 +69,26 @@ class RendererCommandBuffer
 		virtual void stageBuffer (StagingBuffer stagingBuffer, Buffer dstBuffer) = 0;
 		virtual void stageTextureSubresources(StagingTexture stagingTexture, Texture dstTexture, TextureSubresourceRange subresources = {0, 1, 0, 1}) = 0;
 
+		/*
+		 * Copies part of a staging buffer into a buffer, or into one subresource of a texture. The texture data starts at stagingOffset
+		 * (a multiple of 512) w/ it's rows rowPitch bytes apart (a multiple of 256), each row being a row of blocks for compressed formats.
+		 */
+		virtual void stageBufferRegion (StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size) = 0;
+		virtual void stageTextureSubresourceRegion (StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer) = 0;
+
 		virtual void setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports) = 0;
 		virtual void setScissors (uint32_t firstScissor, const std::vector<Scissor> &scissors) = 0;
 
 		virtual void blitTexture (Texture src, TextureLayout srcLayout, Texture dst, TextureLayout dstLayout, std::vector<TextureBlitInfo> blitRegions, SamplerFilter filter = SAMPLER_FILTER_LINEAR) = 0;
 
+		/*
+		 * Fills every mip after the first w/ a chain of linear blits, each mip from the one above it, for every array layer. Mip 0 has to be in
+		 * baseMipLayout and the rest in TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, and every mip is left in finalLayout. The texture needs both transfer
+		 * usages and a format that can be linearly filtered, and the command buffer has to be on the graphics queue. Only valid if
+		 * Renderer::supportsTextureBlits() is true.
+		 */
+		void generateMipmaps (Texture texture, TextureLayout baseMipLayout, TextureLayout finalLayout);
+
 #if RENDER_DEBUG_MARKERS
 		virtual void beginDebugRegion (const std::string &regionName, glm::vec4 color = glm::vec4(1)) = 0;
 		virtual void endDebugRegion () = 0;
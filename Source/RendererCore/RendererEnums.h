@@ -643,6 +643,30 @@ inline bool isDepthFormat(ResourceFormat format)
 	}
 }
 
+inline bool isCompressedFormat(ResourceFormat format)
+{
+	switch (format)
+	{
+		case RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC2_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC2_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC3_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC3_SRGB_BLOCK:
+		case RESOURCE_FORMAT_BC4_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC4_SNORM_BLOCK:
+		case RESOURCE_FORMAT_BC5_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC5_SNORM_BLOCK:
+		case RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK:
+		case RESOURCE_FORMAT_BC6H_SFLOAT_BLOCK:
+		case RESOURCE_FORMAT_BC7_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC7_SRGB_BLOCK:
+			return true;
+		default:
+			return false;
+	}
+}
+
 inline float getResourceFormatBytesPerElement(ResourceFormat format)
 {
 	switch (format)
@@ -412,6 +412,27 @@ typedef struct TextureBlitInfo
 		sivec3 dstOffsets[2];
 } TextureBlitInfo;
 
+/*
+The layouts of the commands read by the indirect draws, they match VkDrawIndirectCommand/VkDrawIndexedIndirectCommand and
+D3D12_DRAW_ARGUMENTS/D3D12_DRAW_INDEXED_ARGUMENTS, so a buffer of them can be written by a compute shader and handed straight to either API.
+*/
+typedef struct DrawIndirectCommand
+{
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t firstVertex;
+	uint32_t firstInstance;
+} DrawIndirectCommand;
+
+typedef struct DrawIndexedIndirectCommand
+{
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+} DrawIndexedIndirectCommand;
+
 //f//
 
 typedef struct RendererFence
@@ -258,6 +258,12 @@ inline bool attachmentContainsPassInDependencyChain(const std::string &name, siz
 			if (writePassStorageTextures[st].canReadAsInput)
 				passInputs.push_back(writePassStorageTextures[st].textureName);
 
+		const std::vector<RenderPassStorageBuffer> &writePassStorageBuffers = writePass.getStorageBuffers();
+
+		for (size_t sb = 0; sb < writePassStorageBuffers.size(); sb++)
+			if (writePassStorageBuffers[sb].canReadAsInput && !writePassStorageBuffers[sb].canWriteAsOutput)
+				passInputs.push_back(writePassStorageBuffers[sb].bufferName);
+
 		for (size_t wi = 0; wi < passInputs.size(); wi++)
 			if (attachmentContainsPassInDependencyChain(passInputs[wi], pass, passes))
 				return true;
@@ -335,6 +341,13 @@ inline bool passContainsPassInDependencyChain(size_t passIndex, size_t writePass
 		if (writePassStorageTextures[st].canReadAsInput)
 			passInputs.push_back(writePassStorageTextures[st].textureName);
 
+	// Buffers that are read and written by the same pass aren't a dependency on any other pass
+	const std::vector<RenderPassStorageBuffer> &passStorageBuffers = pass.getStorageBuffers();
+
+	for (size_t sb = 0; sb < passStorageBuffers.size(); sb++)
+		if (passStorageBuffers[sb].canReadAsInput && !passStorageBuffers[sb].canWriteAsOutput)
+			passInputs.push_back(passStorageBuffers[sb].bufferName);
+
 	for (size_t i = 0; i < passInputs.size(); i++)
 	{
 		std::vector<size_t> writePasses = getPassesThatWriteToResource(passInputs[i], passes);
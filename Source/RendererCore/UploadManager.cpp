@@ -0,0 +1,507 @@
+#include "RendererCore/UploadManager.h"
+
+#include <RendererCore/Renderer.h>
+
+#include <chrono>
+
+UploadManager::UploadManager(Renderer *rendererPtr, size_t ringSize)
+{
+	renderer = rendererPtr;
+
+	this->ringSize = ringSize;
+	ringHead = 0;
+	ringBytesInUse = 0;
+
+	// The ring stays mapped for as long as it exists, staging memory is host coherent on every backend so nothing has to be flushed
+	ringBuffer = renderer->createStagingBuffer(ringSize);
+	ringBufferData = reinterpret_cast<uint8_t*>(renderer->mapStagingBuffer(ringBuffer));
+
+	for (uint32_t b = 0; b < UPLOAD_MANAGER_MAX_BATCHES; b++)
+	{
+		batches[b].cmdPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
+		batches[b].cmdBuffer = nullptr;
+		batches[b].fence = renderer->createFence();
+		batches[b].batchID = 0;
+		batches[b].recording = false;
+		batches[b].inFlight = false;
+		batches[b].ringBytes = 0;
+		batches[b].uploadedBytes = 0;
+	}
+
+	currentBatch = 0;
+	nextBatchID = 1;
+	lastFinishedBatchID = 0;
+
+	stats = {};
+	stats.ringSize = ringSize;
+
+	throughputWindowBytes = 0;
+	throughputWindowStart = getTime();
+
+	freePooledStagingBytes = 0;
+	pooledStagingBufferCreations = 0;
+}
+
+UploadManager::~UploadManager()
+{
+	waitForBatch(submit());
+
+	for (uint32_t b = 0; b < UPLOAD_MANAGER_MAX_BATCHES; b++)
+	{
+		renderer->destroyFence(batches[b].fence);
+		renderer->destroyCommandPool(batches[b].cmdPool);
+	}
+
+	renderer->unmapStagingBuffer(ringBuffer);
+	renderer->destroyStagingBuffer(ringBuffer);
+
+	for (auto pooledBufferIt : pooledStagingBufferData)
+	{
+		renderer->unmapStagingBuffer(pooledBufferIt.first);
+		renderer->destroyStagingBuffer(pooledBufferIt.first);
+	}
+}
+
+void *UploadManager::allocateBufferUpload(Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	StagingBuffer stagingBuffer;
+	uint8_t *mappedData;
+	size_t stagingOffset = allocate(size, UPLOAD_MANAGER_BUFFER_ALIGNMENT, stagingBuffer, mappedData);
+
+	// Allocating can submit the current batch to make room, so the copy goes into whichever one is recording now
+	UploadManagerBatch *batch = getRecordingBatch();
+	batch->cmdBuffer->stageBufferRegion(stagingBuffer, stagingOffset, dstBuffer, dstOffset, size);
+	batch->uploadedBytes += size;
+
+	return mappedData;
+}
+
+void UploadManager::uploadBuffer(Buffer dstBuffer, size_t dstOffset, const void *data, size_t size)
+{
+	memcpy(allocateBufferUpload(dstBuffer, dstOffset, size), data, size);
+}
+
+void *UploadManager::allocateTextureUpload(Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer, uint32_t &rowPitch)
+{
+	uint32_t rowSize, rowCount;
+	getTextureSubresourceSize(dstTexture->textureFormat, std::max<uint32_t>(dstTexture->width >> mipLevel, 1), std::max<uint32_t>(dstTexture->height >> mipLevel, 1), rowSize, rowCount);
+
+	uint32_t depth = std::max<uint32_t>(dstTexture->depth >> mipLevel, 1);
+	rowPitch = (rowSize + UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT - 1) / UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT * UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT;
+
+	size_t size = size_t(rowPitch) * rowCount * depth;
+
+	StagingBuffer stagingBuffer;
+	uint8_t *mappedData;
+	size_t stagingOffset = allocate(size, UPLOAD_MANAGER_TEXTURE_OFFSET_ALIGNMENT, stagingBuffer, mappedData);
+
+	UploadManagerBatch *batch = getRecordingBatch();
+	batch->cmdBuffer->stageTextureSubresourceRegion(stagingBuffer, stagingOffset, rowPitch, dstTexture, mipLevel, arrayLayer);
+	batch->uploadedBytes += size;
+
+	return mappedData;
+}
+
+void UploadManager::uploadTexture(Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer, const void *data)
+{
+	uint32_t rowSize, rowCount, rowPitch;
+	getTextureSubresourceSize(dstTexture->textureFormat, std::max<uint32_t>(dstTexture->width >> mipLevel, 1), std::max<uint32_t>(dstTexture->height >> mipLevel, 1), rowSize, rowCount);
+
+	rowCount *= std::max<uint32_t>(dstTexture->depth >> mipLevel, 1);
+
+	void *mappedData = allocateTextureUpload(dstTexture, mipLevel, arrayLayer, rowPitch);
+
+	copyTextureRows(mappedData, rowPitch, data, rowSize, rowCount);
+}
+
+void UploadManager::uploadTextureFromStaging(StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer)
+{
+	uint32_t rowSize, rowCount;
+	getTextureSubresourceSize(dstTexture->textureFormat, std::max<uint32_t>(dstTexture->width >> mipLevel, 1), std::max<uint32_t>(dstTexture->height >> mipLevel, 1), rowSize, rowCount);
+
+	UploadManagerBatch *batch = getRecordingBatch();
+	batch->cmdBuffer->stageTextureSubresourceRegion(stagingBuffer, stagingOffset, rowPitch, dstTexture, mipLevel, arrayLayer);
+	batch->uploadedBytes += size_t(rowPitch) * rowCount * std::max<uint32_t>(dstTexture->depth >> mipLevel, 1);
+}
+
+void UploadManager::uploadBufferFromStaging(StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	UploadManagerBatch *batch = getRecordingBatch();
+	batch->cmdBuffer->stageBufferRegion(stagingBuffer, stagingOffset, dstBuffer, dstOffset, size);
+	batch->uploadedBytes += size;
+}
+
+void UploadManager::releaseStagingBuffer(StagingBuffer stagingBuffer)
+{
+	getRecordingBatch()->dedicatedStagingBuffers.push_back(stagingBuffer);
+}
+
+static uint32_t getStagingPoolSizeClass(size_t size)
+{
+	uint32_t sizeClass = 0;
+
+	while (sizeClass < UPLOAD_MANAGER_STAGING_POOL_SIZE_CLASSES && (size_t(UPLOAD_MANAGER_STAGING_POOL_MIN_SIZE) << sizeClass) < size)
+		sizeClass++;
+
+	return sizeClass;
+}
+
+StagingBuffer UploadManager::acquirePooledStagingBuffer(size_t size, uint8_t *&mappedData)
+{
+	uint32_t sizeClass = getStagingPoolSizeClass(size);
+
+	// Too big for any size class, so the buffer is just made for it and destroyed like any other once it's released
+	if (sizeClass == UPLOAD_MANAGER_STAGING_POOL_SIZE_CLASSES)
+	{
+		StagingBuffer stagingBuffer = renderer->createStagingBuffer(size);
+		mappedData = reinterpret_cast<uint8_t*>(renderer->mapStagingBuffer(stagingBuffer));
+
+		return stagingBuffer;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(stagingPoolMutex);
+		std::vector<StagingBuffer> &freeBuffers = freePooledStagingBuffers[sizeClass];
+
+		if (freeBuffers.size() > 0)
+		{
+			StagingBuffer stagingBuffer = freeBuffers.back();
+			freeBuffers.pop_back();
+
+			freePooledStagingBytes -= stagingBuffer->bufferSize;
+			mappedData = pooledStagingBufferData[stagingBuffer];
+
+			return stagingBuffer;
+		}
+
+		pooledStagingBufferCreations++;
+	}
+
+	// Staging buffers are created and mapped outside of the lock, the allocators behind them are thread safe
+	StagingBuffer stagingBuffer = renderer->createStagingBuffer(size_t(UPLOAD_MANAGER_STAGING_POOL_MIN_SIZE) << sizeClass);
+	mappedData = reinterpret_cast<uint8_t*>(renderer->mapStagingBuffer(stagingBuffer));
+
+	std::lock_guard<std::mutex> lock(stagingPoolMutex);
+	pooledStagingBufferData[stagingBuffer] = mappedData;
+
+	return stagingBuffer;
+}
+
+void UploadManager::freePooledStagingBuffer(StagingBuffer stagingBuffer)
+{
+	{
+		std::lock_guard<std::mutex> lock(stagingPoolMutex);
+
+		if (pooledStagingBufferData.count(stagingBuffer) > 0)
+		{
+			if (freePooledStagingBytes + stagingBuffer->bufferSize <= UPLOAD_MANAGER_STAGING_POOL_MAX_FREE_BYTES)
+			{
+				freePooledStagingBuffers[getStagingPoolSizeClass(stagingBuffer->bufferSize)].push_back(stagingBuffer);
+				freePooledStagingBytes += stagingBuffer->bufferSize;
+
+				return;
+			}
+
+			pooledStagingBufferData.erase(stagingBuffer);
+		}
+	}
+
+	renderer->unmapStagingBuffer(stagingBuffer);
+	renderer->destroyStagingBuffer(stagingBuffer);
+}
+
+void UploadManager::recordBarriers(const std::vector<ResourceBarrier> &barriers)
+{
+	getRecordingBatch()->cmdBuffer->resourceBarriers(barriers);
+}
+
+void UploadManager::recordGenerateMipmaps(Texture texture, TextureLayout baseMipLayout, TextureLayout finalLayout)
+{
+	getRecordingBatch()->cmdBuffer->generateMipmaps(texture, baseMipLayout, finalLayout);
+}
+
+uint64_t UploadManager::submit()
+{
+	UploadManagerBatch *batch = &batches[currentBatch];
+
+	// Nothing was recorded since the last submit, so the last batch is the one everything went into
+	if (!batch->recording)
+		return nextBatchID - 1;
+
+	batch->cmdBuffer->endCommands();
+	renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {batch->cmdBuffer}, {}, {}, {}, batch->fence);
+
+	batch->recording = false;
+	batch->inFlight = true;
+
+	currentBatch = (currentBatch + 1) % UPLOAD_MANAGER_MAX_BATCHES;
+	stats.totalBatchesSubmitted++;
+
+	return batch->batchID;
+}
+
+uint64_t UploadManager::getCurrentBatchID() const
+{
+	const UploadManagerBatch *batch = &batches[currentBatch];
+
+	// If nothing's been recorded since the last submit then everything so far went into the last batch
+	return batch->recording ? batch->batchID : nextBatchID - 1;
+}
+
+bool UploadManager::isBatchFinished(uint64_t batchID)
+{
+	pollBatches();
+
+	return batchID <= lastFinishedBatchID;
+}
+
+void UploadManager::waitForBatch(uint64_t batchID)
+{
+	if (batchID >= getCurrentBatchID())
+		submit();
+
+	while (batchID > lastFinishedBatchID)
+	{
+		UploadManagerBatch *oldestBatch = nullptr;
+
+		for (uint32_t b = 0; b < UPLOAD_MANAGER_MAX_BATCHES; b++)
+			if (batches[b].inFlight && (oldestBatch == nullptr || batches[b].batchID < oldestBatch->batchID))
+				oldestBatch = &batches[b];
+
+		if (oldestBatch == nullptr)
+			break;
+
+		renderer->waitForFence(oldestBatch->fence, 5);
+		finishBatch(oldestBatch);
+	}
+}
+
+void UploadManager::update()
+{
+	submit();
+	pollBatches();
+
+	double time = getTime();
+
+	if (time - throughputWindowStart >= 1.0)
+	{
+		stats.throughputMBPerSecond = (throughputWindowBytes / (1024.0 * 1024.0)) / (time - throughputWindowStart);
+
+		throughputWindowBytes = 0;
+		throughputWindowStart = time;
+	}
+}
+
+UploadManagerStatistics UploadManager::getStatistics() const
+{
+	UploadManagerStatistics statistics = stats;
+	statistics.ringBytesInUse = ringBytesInUse;
+
+	// Pooled buffers can be created on any thread
+	std::lock_guard<std::mutex> lock(stagingPoolMutex);
+	statistics.pooledStagingBufferCreations = pooledStagingBufferCreations;
+
+	return statistics;
+}
+
+void UploadManager::getTextureSubresourceSize(ResourceFormat format, uint32_t width, uint32_t height, uint32_t &rowSize, uint32_t &rowCount)
+{
+	if (isCompressedFormat(format))
+	{
+		uint32_t bytesPerBlock = uint32_t(getResourceFormatBytesPerElement(format) * 16);
+
+		rowSize = ((width + 3) / 4) * bytesPerBlock;
+		rowCount = (height + 3) / 4;
+	}
+	else
+	{
+		rowSize = uint32_t(width * getResourceFormatBytesPerElement(format));
+		rowCount = height;
+	}
+}
+
+size_t UploadManager::getTextureStagingLayout(ResourceFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<size_t> &mipOffsets, std::vector<uint32_t> &mipRowPitches)
+{
+	size_t stagingSize = 0;
+
+	mipOffsets.resize(mipLevels);
+	mipRowPitches.resize(mipLevels);
+
+	for (uint32_t m = 0; m < mipLevels; m++)
+	{
+		uint32_t rowSize, rowCount;
+		getTextureSubresourceSize(format, std::max<uint32_t>(width >> m, 1), std::max<uint32_t>(height >> m, 1), rowSize, rowCount);
+
+		mipOffsets[m] = (stagingSize + UPLOAD_MANAGER_TEXTURE_OFFSET_ALIGNMENT - 1) / UPLOAD_MANAGER_TEXTURE_OFFSET_ALIGNMENT * UPLOAD_MANAGER_TEXTURE_OFFSET_ALIGNMENT;
+		mipRowPitches[m] = (rowSize + UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT - 1) / UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT * UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT;
+
+		stagingSize = mipOffsets[m] + size_t(mipRowPitches[m]) * rowCount;
+	}
+
+	return stagingSize;
+}
+
+void UploadManager::copyTextureRows(void *dst, uint32_t rowPitch, const void *src, uint32_t rowSize, uint32_t rowCount)
+{
+	uint8_t *dstData = reinterpret_cast<uint8_t*>(dst);
+	const uint8_t *srcData = reinterpret_cast<const uint8_t*>(src);
+
+	if (rowPitch == rowSize)
+	{
+		memcpy(dstData, srcData, size_t(rowSize) * rowCount);
+
+		return;
+	}
+
+	for (uint32_t row = 0; row < rowCount; row++)
+		memcpy(dstData + size_t(row) * rowPitch, srcData + size_t(row) * rowSize, rowSize);
+}
+
+UploadManagerBatch *UploadManager::getRecordingBatch()
+{
+	UploadManagerBatch *batch = &batches[currentBatch];
+
+	if (batch->recording)
+		return batch;
+
+	// Every batch is in flight, so this one has to finish before it's command buffer can be used again
+	if (batch->inFlight)
+	{
+		double stallStart = getTime();
+
+		renderer->waitForFence(batch->fence, 5);
+		finishBatch(batch);
+
+		stats.stallCount++;
+		stats.totalStallTime += getTime() - stallStart;
+	}
+
+	batch->cmdBuffer = batch->cmdPool->allocateCommandBuffer();
+	batch->cmdBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	batch->batchID = nextBatchID++;
+	batch->recording = true;
+
+	return batch;
+}
+
+void UploadManager::finishBatch(UploadManagerBatch *batch)
+{
+	// Buffers from the pool go back into it, the rest are destroyed
+	for (StagingBuffer stagingBuffer : batch->dedicatedStagingBuffers)
+		freePooledStagingBuffer(stagingBuffer);
+
+	batch->cmdPool->resetCommandPoolAndFreeCommandBuffer(batch->cmdBuffer);
+	renderer->resetFence(batch->fence);
+
+	ringBytesInUse -= batch->ringBytes;
+
+	// Once the ring is empty the next allocation can start from the beginning again instead of wrapping
+	if (ringBytesInUse == 0)
+		ringHead = 0;
+
+	stats.totalBytesUploaded += batch->uploadedBytes;
+	throughputWindowBytes += batch->uploadedBytes;
+	lastFinishedBatchID = std::max(lastFinishedBatchID, batch->batchID);
+
+	batch->cmdBuffer = nullptr;
+	batch->inFlight = false;
+	batch->ringBytes = 0;
+	batch->uploadedBytes = 0;
+	batch->dedicatedStagingBuffers.clear();
+}
+
+void UploadManager::pollBatches()
+{
+	// Batches finish in the order they were submitted, and the ring space has to be given back in that order too
+	while (true)
+	{
+		UploadManagerBatch *oldestBatch = nullptr;
+
+		for (uint32_t b = 0; b < UPLOAD_MANAGER_MAX_BATCHES; b++)
+			if (batches[b].inFlight && (oldestBatch == nullptr || batches[b].batchID < oldestBatch->batchID))
+				oldestBatch = &batches[b];
+
+		if (oldestBatch == nullptr || !renderer->getFenceStatus(oldestBatch->fence))
+			break;
+
+		finishBatch(oldestBatch);
+	}
+}
+
+size_t UploadManager::allocate(size_t size, size_t alignment, StagingBuffer &stagingBuffer, uint8_t *&mappedData)
+{
+	if (size > ringSize)
+	{
+		stagingBuffer = renderer->createStagingBuffer(size);
+		mappedData = reinterpret_cast<uint8_t*>(renderer->mapStagingBuffer(stagingBuffer));
+
+		getRecordingBatch()->dedicatedStagingBuffers.push_back(stagingBuffer);
+		stats.dedicatedAllocationCount++;
+
+		return 0;
+	}
+
+	double stallStart = 0.0;
+	bool stalled = false;
+
+	while (true)
+	{
+		UploadManagerBatch *batch = getRecordingBatch();
+
+		size_t offset = (ringHead + alignment - 1) / alignment * alignment;
+		size_t padding = offset - ringHead;
+
+		// Regions never wrap around the end of the ring, the rest of it is skipped instead
+		if (offset + size > ringSize)
+		{
+			padding = ringSize - ringHead;
+			offset = 0;
+		}
+
+		if (ringBytesInUse + padding + size <= ringSize)
+		{
+			batch->ringBytes += padding + size;
+
+			ringHead = offset + size;
+			ringBytesInUse += padding + size;
+
+			if (stalled)
+				stats.totalStallTime += getTime() - stallStart;
+
+			stagingBuffer = ringBuffer;
+			mappedData = ringBufferData + offset;
+
+			return offset;
+		}
+
+		if (!stalled)
+		{
+			stalled = true;
+			stallStart = getTime();
+			stats.stallCount++;
+		}
+
+		UploadManagerBatch *oldestBatch = nullptr;
+
+		for (uint32_t b = 0; b < UPLOAD_MANAGER_MAX_BATCHES; b++)
+			if (batches[b].inFlight && (oldestBatch == nullptr || batches[b].batchID < oldestBatch->batchID))
+				oldestBatch = &batches[b];
+
+		// If nothing is in flight then the batch being recorded is the one holding the ring, so it has to go first
+		if (oldestBatch == nullptr)
+		{
+			submit();
+
+			continue;
+		}
+
+		renderer->waitForFence(oldestBatch->fence, 5);
+		finishBatch(oldestBatch);
+	}
+}
+
+double UploadManager::getTime() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() / 1000000000.0;
+}
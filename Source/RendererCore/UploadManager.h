@@ -0,0 +1,179 @@
+#ifndef RENDERERCORE_UPLOADMANAGER_H_
+#define RENDERERCORE_UPLOADMANAGER_H_
+
+#include <RendererCore/renderer_common.h>
+#include <RendererCore/RendererEnums.h>
+#include <RendererCore/RendererObjects.h>
+
+#include <mutex>
+#include <unordered_map>
+
+class Renderer;
+
+#define UPLOAD_MANAGER_DEFAULT_RING_SIZE (64 * 1024 * 1024)
+#define UPLOAD_MANAGER_MAX_BATCHES 3
+
+// D3D12 has the strictest requirements for where texture data can be copied from, and they're multiples of every Vulkan texel block size
+#define UPLOAD_MANAGER_BUFFER_ALIGNMENT 16
+#define UPLOAD_MANAGER_TEXTURE_OFFSET_ALIGNMENT 512
+#define UPLOAD_MANAGER_TEXTURE_ROW_PITCH_ALIGNMENT 256
+
+#define UPLOAD_MANAGER_STAGING_POOL_MIN_SIZE (64 * 1024) // The smallest pooled staging buffer, each size class after it is twice as big
+#define UPLOAD_MANAGER_STAGING_POOL_SIZE_CLASSES 12 // So the biggest pooled buffer is 128 MB, anything bigger gets a staging buffer of it's own
+#define UPLOAD_MANAGER_STAGING_POOL_MAX_FREE_BYTES (256 * 1024 * 1024) // Free pooled buffers past this are destroyed instead of kept
+
+typedef struct UploadManagerStatistics
+{
+	uint64_t totalBytesUploaded;
+	uint64_t totalBatchesSubmitted;
+	double throughputMBPerSecond; // Averaged over about the last second
+
+	uint64_t stallCount; // How many times an allocation had to wait for an in flight batch to give back it's ring space
+	double totalStallTime; // In seconds
+	uint64_t dedicatedAllocationCount; // Uploads too big for the ring, which get their own staging buffer
+	uint64_t pooledStagingBufferCreations; // How many times acquirePooledStagingBuffer() had no free buffer of the right size class
+
+	size_t ringSize;
+	size_t ringBytesInUse;
+} UploadManagerStatistics;
+
+struct UploadManagerBatch
+{
+	CommandPool cmdPool;
+	CommandBuffer cmdBuffer;
+	Fence fence;
+
+	uint64_t batchID;
+	bool recording;
+	bool inFlight;
+
+	size_t ringBytes; // Everything the batch took from the ring, including alignment padding and any space skipped when it wrapped
+	size_t uploadedBytes;
+	std::vector<StagingBuffer> dedicatedStagingBuffers;
+};
+
+/*
+Copies data to the GPU through one big persistently mapped staging buffer. Every upload gets an aligned region of the ring and it's copy
+is recorded into the current batch's command buffer right away, so it's data just has to be written before the batch is submitted. One
+batch is submitted per frame by update(), and it's ring space is reused once it's fence has signaled. Uploads all go through the graphics
+queue, so textures can be transitioned in the same command buffer as their copies w/ recordBarriers().
+*/
+class UploadManager
+{
+	public:
+
+	UploadManager(Renderer *rendererPtr, size_t ringSize = UPLOAD_MANAGER_DEFAULT_RING_SIZE);
+	virtual ~UploadManager();
+
+	/*
+	Returns staging memory for 'size' bytes that will be copied to dstBuffer at dstOffset
+	*/
+	void *allocateBufferUpload(Buffer dstBuffer, size_t dstOffset, size_t size);
+	void uploadBuffer(Buffer dstBuffer, size_t dstOffset, const void *data, size_t size);
+
+	/*
+	Returns staging memory for one whole subresource of the texture, w/ it's rows (of blocks for compressed formats) rowPitch bytes apart. The
+	texture has to be in TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL when the copy executes. uploadTexture() takes tightly packed rows.
+	*/
+	void *allocateTextureUpload(Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer, uint32_t &rowPitch);
+	void uploadTexture(Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer, const void *data);
+
+	/*
+	Records copying one subresource from a staging buffer the caller filled itself, like one a decode job wrote straight into, w/ the same
+	alignment requirements as allocateTextureUpload(). Once all of it's copies are recorded the staging buffer is given to the current batch
+	w/ releaseStagingBuffer(), which unmaps and destroys it (or gives it back to the pool) once the batch has finished.
+	uploadBufferFromStaging() does the same for a range of a buffer.
+	*/
+	void uploadTextureFromStaging(StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer);
+	void uploadBufferFromStaging(StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size);
+	void releaseStagingBuffer(StagingBuffer stagingBuffer);
+
+	/*
+	Returns a mapped staging buffer w/ room for at least 'size' bytes, for callers that fill their own staging buffers. Buffers are pooled in
+	power of two size classes and stay mapped, so one is only created when it's class has none free. Can be called from any thread. A pooled
+	buffer is handed back w/ releaseStagingBuffer() like any other, and goes back into the pool once it's batch has finished, or straight
+	away w/ freePooledStagingBuffer() if none of it's copies were recorded.
+	*/
+	StagingBuffer acquirePooledStagingBuffer(size_t size, uint8_t *&mappedData);
+	void freePooledStagingBuffer(StagingBuffer stagingBuffer);
+
+	/*
+	Records barriers into the current batch, in order w/ the copies around them
+	*/
+	void recordBarriers(const std::vector<ResourceBarrier> &barriers);
+
+	/*
+	Records CommandBuffer::generateMipmaps() into the current batch, so mip 0 has to be uploaded before it's called
+	*/
+	void recordGenerateMipmaps(Texture texture, TextureLayout baseMipLayout, TextureLayout finalLayout);
+
+	/*
+	Submits the uploads recorded so far and returns the batch's ID. Uploads are finished once the batch they were recorded into has finished,
+	getCurrentBatchID() is the batch every upload recorded so far will have finished by.
+	*/
+	uint64_t submit();
+	uint64_t getCurrentBatchID() const;
+	bool isBatchFinished(uint64_t batchID);
+	void waitForBatch(uint64_t batchID);
+
+	/*
+	Submits this frame's batch and recycles the ring space of the batches that have finished
+	*/
+	void update();
+
+	UploadManagerStatistics getStatistics() const;
+
+	/*
+	The size of each row and the number of rows of one subresource, w/ compressed formats having a row for every row of blocks
+	*/
+	static void getTextureSubresourceSize(ResourceFormat format, uint32_t width, uint32_t height, uint32_t &rowSize, uint32_t &rowCount);
+
+	/*
+	Lays out every mip of a 2D texture in a staging buffer of it's own, aligned the same way as the ring, and returns the buffer's size
+	*/
+	static size_t getTextureStagingLayout(ResourceFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<size_t> &mipOffsets, std::vector<uint32_t> &mipRowPitches);
+
+	/*
+	Copies tightly packed rows to rows rowPitch bytes apart, w/ a single copy when there's no padding between them
+	*/
+	static void copyTextureRows(void *dst, uint32_t rowPitch, const void *src, uint32_t rowSize, uint32_t rowCount);
+
+	private:
+
+	Renderer *renderer;
+
+	StagingBuffer ringBuffer;
+	uint8_t *ringBufferData;
+	size_t ringSize;
+	size_t ringHead;
+	size_t ringBytesInUse;
+
+	UploadManagerBatch batches[UPLOAD_MANAGER_MAX_BATCHES];
+	uint32_t currentBatch;
+	uint64_t nextBatchID;
+	uint64_t lastFinishedBatchID;
+
+	UploadManagerStatistics stats;
+	uint64_t throughputWindowBytes;
+	double throughputWindowStart;
+
+	mutable std::mutex stagingPoolMutex;
+	std::vector<StagingBuffer> freePooledStagingBuffers[UPLOAD_MANAGER_STAGING_POOL_SIZE_CLASSES];
+	std::unordered_map<StagingBuffer, uint8_t*> pooledStagingBufferData; // Every pooled buffer, free or not, and where it's mapped
+	size_t freePooledStagingBytes;
+	uint64_t pooledStagingBufferCreations;
+
+	UploadManagerBatch *getRecordingBatch();
+	void finishBatch(UploadManagerBatch *batch);
+	void pollBatches();
+
+	/*
+	Returns the offset of a region of the ring, waiting on the oldest in flight batch for as long as there isn't enough space. Allocations
+	bigger than the whole ring get a dedicated staging buffer instead, the buffer to copy from is returned through stagingBuffer.
+	*/
+	size_t allocate(size_t size, size_t alignment, StagingBuffer &stagingBuffer, uint8_t *&mappedData);
+
+	double getTime() const;
+};
+
+#endif /* RENDERERCORE_UPLOADMANAGER_H_ */
@@ -83,6 +83,52 @@ void VulkanCommandBuffer::drawIndexed (uint32_t indexCount, uint32_t instanceCou
 	vkCmdDrawIndexed(bufferHandle, indexCount, instanceCount, firstIndex, firstVertex, firstInstance);
 }
 
+void VulkanCommandBuffer::drawIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+	VkBuffer indirectBuffer = static_cast<VulkanBuffer*>(buffer)->bufferHandle;
+
+	if (VulkanExtensions::enabled_multiDrawIndirect || drawCount <= 1)
+	{
+		vkCmdDrawIndirect(bufferHandle, indirectBuffer, static_cast<VkDeviceSize>(offset), drawCount, stride);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < drawCount; i++)
+			vkCmdDrawIndirect(bufferHandle, indirectBuffer, static_cast<VkDeviceSize>(offset + i * stride), 1, stride);
+	}
+}
+
+void VulkanCommandBuffer::drawIndexedIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+	VkBuffer indirectBuffer = static_cast<VulkanBuffer*>(buffer)->bufferHandle;
+
+	if (VulkanExtensions::enabled_multiDrawIndirect || drawCount <= 1)
+	{
+		vkCmdDrawIndexedIndirect(bufferHandle, indirectBuffer, static_cast<VkDeviceSize>(offset), drawCount, stride);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < drawCount; i++)
+			vkCmdDrawIndexedIndirect(bufferHandle, indirectBuffer, static_cast<VkDeviceSize>(offset + i * stride), 1, stride);
+	}
+}
+
+void VulkanCommandBuffer::drawIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	if (VulkanExtensions::enabled_VK_KHR_draw_indirect_count)
+		VulkanExtensions::CmdDrawIndirectCountKHR(bufferHandle, static_cast<VulkanBuffer*>(buffer)->bufferHandle, static_cast<VkDeviceSize>(offset), static_cast<VulkanBuffer*>(countBuffer)->bufferHandle, static_cast<VkDeviceSize>(countBufferOffset), maxDrawCount, stride);
+	else
+		drawIndirect(buffer, offset, maxDrawCount, stride);
+}
+
+void VulkanCommandBuffer::drawIndexedIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+{
+	if (VulkanExtensions::enabled_VK_KHR_draw_indirect_count)
+		VulkanExtensions::CmdDrawIndexedIndirectCountKHR(bufferHandle, static_cast<VulkanBuffer*>(buffer)->bufferHandle, static_cast<VkDeviceSize>(offset), static_cast<VulkanBuffer*>(countBuffer)->bufferHandle, static_cast<VkDeviceSize>(countBufferOffset), maxDrawCount, stride);
+	else
+		drawIndexedIndirect(buffer, offset, maxDrawCount, stride);
+}
+
 void VulkanCommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
 {
 	vkCmdDispatch(bufferHandle, groupCountX, groupCountY, groupCountZ);
@@ -256,6 +302,35 @@ void VulkanCommandBuffer::stageTextureSubresources(StagingTexture stagingTexture
 	vkCmdCopyBufferToImage(bufferHandle, vkStagingTexture->bufferHandle, vkDstTexture->imageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t) copyRegions.size(), copyRegions.data());
 }
 
+void VulkanCommandBuffer::stageBufferRegion (StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size)
+{
+	VkBufferCopy bufferCopyRegion = {};
+	bufferCopyRegion.dstOffset = dstOffset;
+	bufferCopyRegion.srcOffset = stagingOffset;
+	bufferCopyRegion.size = size;
+
+	vkCmdCopyBuffer(bufferHandle, static_cast<VulkanStagingBuffer*>(stagingBuffer)->bufferHandle, static_cast<VulkanBuffer*>(dstBuffer)->bufferHandle, 1, &bufferCopyRegion);
+}
+
+void VulkanCommandBuffer::stageTextureSubresourceRegion (StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer)
+{
+	VulkanTexture *vkDstTexture = static_cast<VulkanTexture*>(dstTexture);
+
+	// Vulkan wants the row length in texels rather than bytes, for compressed formats that's the number of blocks times the block width
+	uint32_t blockSize = isCompressedFormat(vkDstTexture->textureFormat) ? 4 : 1;
+	uint32_t bytesPerBlock = uint32_t(getResourceFormatBytesPerElement(vkDstTexture->textureFormat) * blockSize * blockSize);
+
+	VkBufferImageCopy copyInfo = {};
+	copyInfo.bufferOffset = stagingOffset;
+	copyInfo.bufferRowLength = (rowPitch / bytesPerBlock) * blockSize;
+	copyInfo.bufferImageHeight = 0;
+	copyInfo.imageSubresource = {(VkImageAspectFlags) (isDepthFormat(vkDstTexture->textureFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT), mipLevel, arrayLayer, 1};
+	copyInfo.imageOffset = {0, 0, 0};
+	copyInfo.imageExtent = {std::max<uint32_t>(vkDstTexture->width >> mipLevel, 1), std::max<uint32_t>(vkDstTexture->height >> mipLevel, 1), std::max<uint32_t>(vkDstTexture->depth >> mipLevel, 1)};
+
+	vkCmdCopyBufferToImage(bufferHandle, static_cast<VulkanStagingBuffer*>(stagingBuffer)->bufferHandle, vkDstTexture->imageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyInfo);
+}
+
 void VulkanCommandBuffer::setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports)
 {
 	std::vector<VkViewport> vulkanViewports;
@@ -27,6 +27,10 @@ class VulkanCommandBuffer : public RendererCommandBuffer
 
 		void draw (uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
 		void drawIndexed (uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t firstVertex, uint32_t firstInstance);
+		void drawIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride);
+		void drawIndexedIndirect (Buffer buffer, size_t offset, uint32_t drawCount, uint32_t stride);
+		void drawIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride);
+		void drawIndexedIndirectCount (Buffer buffer, size_t offset, Buffer countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride);
 		void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
 
 		void resolveTexture(Texture srcTexture, Texture dstTexture, TextureSubresourceRange subresources);
@@ -39,6 +43,8 @@ class VulkanCommandBuffer : public RendererCommandBuffer
 		void stageBuffer (StagingBuffer stagingBuffer, Texture dstTexture, TextureSubresourceLayers subresource, sivec3 offset, suvec3 extent);
 		void stageBuffer (StagingBuffer stagingBuffer, Buffer dstBuffer);
 		void stageTextureSubresources(StagingTexture stagingTexture, Texture dstTexture, TextureSubresourceRange subresources);
+		void stageBufferRegion (StagingBuffer stagingBuffer, size_t stagingOffset, Buffer dstBuffer, size_t dstOffset, size_t size);
+		void stageTextureSubresourceRegion (StagingBuffer stagingBuffer, size_t stagingOffset, uint32_t rowPitch, Texture dstTexture, uint32_t mipLevel, uint32_t arrayLayer);
 
 		void setViewports (uint32_t firstViewport, const std::vector<Viewport> &viewports);
 		void setScissors (uint32_t firstScissor, const std::vector<Scissor> &scissors);
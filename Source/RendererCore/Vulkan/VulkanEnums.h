@@ -26,7 +26,7 @@ inline VkBufferUsageFlags BufferUsageFlagsToVkBufferUsageFlags(BufferUsageFlags
 	if (usage & BUFFER_USAGE_VERTEX_BUFFER_BIT)
 		flags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 	if (usage & BUFFER_USAGE_INDIRECT_BUFFER_BIT)
-		flags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		flags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
 	return flags;
 }
@@ -11,8 +11,24 @@ void VulkanExtensions::getProcAddresses (VkDevice device)
 		CmdDebugMarkerEndEXT = (PFN_vkCmdDebugMarkerEndEXT) vkGetDeviceProcAddr(device, "vkCmdDebugMarkerEndEXT");
 		CmdDebugMarkerInsertEXT = (PFN_vkCmdDebugMarkerInsertEXT) vkGetDeviceProcAddr(device, "vkCmdDebugMarkerInsertEXT");
 	}
+
+	if (enabled_VK_KHR_draw_indirect_count)
+	{
+		CmdDrawIndirectCountKHR = (PFN_vkCmdDrawIndirectCountKHR) vkGetDeviceProcAddr(device, "vkCmdDrawIndirectCountKHR");
+		CmdDrawIndexedIndirectCountKHR = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+
+		// Fall back to drawing the max count if the driver doesn't actually give us the entry points
+		if (CmdDrawIndirectCountKHR == VK_NULL_HANDLE || CmdDrawIndexedIndirectCountKHR == VK_NULL_HANDLE)
+			enabled_VK_KHR_draw_indirect_count = false;
+	}
 }
 
+bool VulkanExtensions::enabled_VK_KHR_draw_indirect_count = false;
+bool VulkanExtensions::enabled_multiDrawIndirect = false;
+
+PFN_vkCmdDrawIndirectCountKHR VulkanExtensions::CmdDrawIndirectCountKHR = VK_NULL_HANDLE;
+PFN_vkCmdDrawIndexedIndirectCountKHR VulkanExtensions::CmdDrawIndexedIndirectCountKHR = VK_NULL_HANDLE;
+
 #if RENDER_DEBUG_MARKERS
 
 bool VulkanExtensions::enabled_VK_EXT_debug_marker = false;
@@ -74,6 +74,7 @@ struct VulkanStagingTexture : public RendererStagingTexture
 {
 	VkBuffer bufferHandle;
 	VmaAllocation bufferMemory;
+	char *mappedData; // Persistently mapped for as long as the staging texture exists
 
 	std::vector<uint64_t> subresourceOffets;
 	std::vector<uint64_t> subresourceRowSize;
@@ -228,9 +228,6 @@ void VulkanRenderGraph::resizeNamedSize(const std::string &sizeName, glm::uvec2
 	}
 }
 
-const std::string viewSelectMipPostfix = "_fg_miplvl";
-const std::string viewSelectLayerPostfix = "_fg_layer";
-
 void VulkanRenderGraph::assignPhysicalResources(const std::vector<size_t> &passStack)
 {
 	typedef struct
@@ -424,7 +421,7 @@ void VulkanRenderGraph::assignPhysicalResources(const std::vector<size_t> &passS
 
 		graphTextureViews[it->first] = graphTextureView;
 
-		imageViewCreateInfo.subresourceRange.layerCount = 1;
+		// Mip views cover every layer, and layer views cover only the first mip
 		imageViewCreateInfo.subresourceRange.levelCount = 1;
 
 		for (uint32_t m = 0; m < data.attachment.mipLevels; m++)
@@ -443,12 +440,14 @@ void VulkanRenderGraph::assignPhysicalResources(const std::vector<size_t> &passS
 
 			VK_CHECK_RESULT(vkCreateImageView(renderer->device, &imageViewCreateInfo, nullptr, &vulkanTextureView->imageView));
 
-			renderer->setObjectDebugName(vulkanTextureView, OBJECT_TYPE_TEXTURE_VIEW, it->first + viewSelectMipPostfix + toString(m));
+			renderer->setObjectDebugName(vulkanTextureView, OBJECT_TYPE_TEXTURE_VIEW, getRenderGraphMipViewName(it->first, m));
 
 			graphTextureView.textureView = vulkanTextureView;
-			graphTextureViews[it->first + viewSelectMipPostfix + toString(m)] = graphTextureView;
+			graphTextureViews[getRenderGraphMipViewName(it->first, m)] = graphTextureView;
 		}
 
+		imageViewCreateInfo.subresourceRange.layerCount = 1;
+
 		for (uint32_t l = 0; l < data.attachment.arrayLayers; l++)
 		{
 			vulkanTextureView = new VulkanTextureView();
@@ -465,10 +464,10 @@ void VulkanRenderGraph::assignPhysicalResources(const std::vector<size_t> &passS
 
 			VK_CHECK_RESULT(vkCreateImageView(renderer->device, &imageViewCreateInfo, nullptr, &vulkanTextureView->imageView));
 
-			renderer->setObjectDebugName(vulkanTextureView, OBJECT_TYPE_TEXTURE_VIEW, it->first + viewSelectLayerPostfix + toString(l));
+			renderer->setObjectDebugName(vulkanTextureView, OBJECT_TYPE_TEXTURE_VIEW, getRenderGraphLayerViewName(it->first, l));
 
 			graphTextureView.textureView = vulkanTextureView;
-			graphTextureViews[it->first + viewSelectLayerPostfix + toString(l)] = graphTextureView;
+			graphTextureViews[getRenderGraphLayerViewName(it->first, l)] = graphTextureView;
 		}
 	}
 
@@ -513,6 +512,7 @@ void VulkanRenderGraph::finishBuild(const std::vector<size_t> &passStack)
 	typedef struct
 	{
 		BufferLayout currentLayout;
+		bool writtenSinceLastBarrier;
 	} RenderPassBufferState;
 
 	std::map<std::string, RenderPassTextureState> textureStates;
@@ -535,10 +535,62 @@ void VulkanRenderGraph::finishBuild(const std::vector<size_t> &passStack)
 	{
 		RenderPassBufferState state = {};
 		state.currentLayout = BUFFER_LAYOUT_MAX_ENUM;
+		state.writtenSinceLastBarrier = false;
 
 		bufferStates[bufferIt->first] = state;
 	}
 
+	/*
+	Like the textures above, a buffer's first state in the graph is the state the previous frame's execution left it in, so seed it from
+	the last pass in the stack that uses it. This makes the first pass of a frame wait on the final writer of the frame before it. On the
+	very first frame there's no previous writer, the extra barrier that causes is harmless.
+	*/
+	for (size_t passStackIndex = 0; passStackIndex < passStack.size(); passStackIndex++)
+	{
+		const std::vector<RenderPassStorageBuffer> &storageBuffers = passes[passStack[passStackIndex]]->getStorageBuffers();
+
+		for (size_t sb = 0; sb < storageBuffers.size(); sb++)
+		{
+			bufferStates[storageBuffers[sb].bufferName].currentLayout = storageBuffers[sb].passEndLayout;
+			bufferStates[storageBuffers[sb].bufferName].writtenSinceLastBarrier = storageBuffers[sb].canWriteAsOutput;
+		}
+	}
+
+	/*
+	Buffers don't have layouts in vulkan, so a barrier is needed whenever the way a buffer is accessed changes, but also between two passes
+	that access it the same way if either of them writes to it (i.e. a compute pass that writes a buffer in BUFFER_LAYOUT_GENERAL followed by
+	another that reads it in BUFFER_LAYOUT_GENERAL). Graphics passes can't have these inside of their render pass, so all of the barriers for
+	the merged subpasses are put before it.
+	*/
+	auto addStorageBufferBarriers = [&](const RenderGraphRenderPass &pass, VulkanRenderGraphRenderPass &passData)
+	{
+		for (size_t sb = 0; sb < pass.getStorageBuffers().size(); sb++)
+		{
+			const RenderPassStorageBuffer &storageBuffer = pass.getStorageBuffers()[sb];
+			RenderPassBufferState &state = bufferStates[storageBuffer.bufferName];
+			BufferLayout requiredLayout = storageBuffer.passBeginLayout;
+
+			if (state.currentLayout != BUFFER_LAYOUT_MAX_ENUM && (state.currentLayout != requiredLayout || state.writtenSinceLastBarrier || storageBuffer.canWriteAsOutput))
+			{
+				VkBufferMemoryBarrier barrier = {};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.pNext = nullptr;
+				barrier.srcAccessMask = getAccessFlagsForBufferLayoutTransition(state.currentLayout);
+				barrier.dstAccessMask = getAccessFlagsForBufferLayoutTransition(requiredLayout);
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = graphBuffers[storageBuffer.bufferName]->bufferHandle;
+				barrier.offset = 0;
+				barrier.size = VK_WHOLE_SIZE;
+
+				passData.beforeRenderBufferBarriers.push_back(barrier);
+			}
+
+			state.currentLayout = storageBuffer.passEndLayout;
+			state.writtenSinceLastBarrier = storageBuffer.canWriteAsOutput;
+		}
+	};
+
 	for (size_t passStackIndex = 0; passStackIndex < passStack.size(); passStackIndex++)
 	{
 		VulkanRenderGraphRenderPass passData = {};
@@ -819,6 +871,9 @@ void VulkanRenderGraph::finishBuild(const std::vector<size_t> &passStack)
 
 			VK_CHECK_RESULT(vkCreateFramebuffer(renderer->device, &framebufferCreateInfo, nullptr, &passData.framebufferHandle));
 
+			for (size_t p = basePassStackIndex; p <= passStackIndex; p++)
+				addStorageBufferBarriers(*passes[passStack[p]], passData);
+
 			VulkanRenderPass tempRenderPass = {};
 			tempRenderPass.renderPassHandle = passData.renderPassHandle;
 
@@ -921,30 +976,7 @@ void VulkanRenderGraph::finishBuild(const std::vector<size_t> &passStack)
 				}
 			}
 
-			for (size_t sb = 0; sb < pass.getStorageBuffers().size(); sb++)
-			{
-				const RenderPassStorageBuffer &storageBuffer = pass.getStorageBuffers()[sb];
-				BufferLayout currentLayout = bufferStates[storageBuffer.bufferName].currentLayout;
-				BufferLayout requiredLayout = storageBuffer.passBeginLayout;
-
-				if (currentLayout != requiredLayout && currentLayout != BUFFER_LAYOUT_MAX_ENUM)
-				{
-					VkBufferMemoryBarrier barrier = {};
-					barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-					barrier.pNext = nullptr;
-					barrier.srcAccessMask = getAccessFlagsForBufferLayoutTransition(currentLayout);
-					barrier.dstAccessMask = getAccessFlagsForBufferLayoutTransition(requiredLayout);
-					barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-					barrier.buffer = graphBuffers[storageBuffer.bufferName]->bufferHandle;
-					barrier.offset = 0;
-					barrier.size = storageBuffer.size;
-
-					passData.beforeRenderBufferBarriers.push_back(barrier);
-
-					bufferStates[storageBuffer.bufferName].currentLayout = storageBuffer.passEndLayout;
-				}
-			}
+			addStorageBufferBarriers(pass, passData);
 
 			passData.passIndices.push_back(passStack[passStackIndex]);
 
@@ -894,7 +894,7 @@ Buffer VulkanRenderer::createBuffer(size_t size, BufferUsageFlags usage, BufferL
 	if (usage & BUFFER_USAGE_VERTEX_BUFFER_BIT)
 		bufferInfo.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
 	if (usage & BUFFER_USAGE_INDIRECT_BUFFER_BIT)
-		bufferInfo.usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		bufferInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
 #if VULKAN_DEBUG_COMPATIBILITY_CHECKS
 	switch (initialLayout)
@@ -1074,9 +1074,12 @@ StagingTexture VulkanRenderer::createStagingTexture(suvec3 extent, ResourceForma
 
 	VmaAllocationCreateInfo allocInfo = {};
 	allocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
-	allocInfo.flags = 0;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
-	VK_CHECK_RESULT(vmaCreateBuffer(memAllocator, &bufferCreateInfo, &allocInfo, &stagingTexture->bufferHandle, &stagingTexture->bufferMemory, nullptr));
+	VmaAllocationInfo stagingAllocInfo = {};
+	VK_CHECK_RESULT(vmaCreateBuffer(memAllocator, &bufferCreateInfo, &allocInfo, &stagingTexture->bufferHandle, &stagingTexture->bufferMemory, &stagingAllocInfo));
+
+	stagingTexture->mappedData = reinterpret_cast<char*>(stagingAllocInfo.pMappedData);
 
 	return stagingTexture;
 }
@@ -1086,25 +1089,32 @@ void VulkanRenderer::fillStagingTextureSubresource(StagingTexture stagingTexture
 	VulkanStagingTexture *vkStagingTexture = static_cast<VulkanStagingTexture*>(stagingTexture);
 	
 	uint32_t subresourceIndex = arrayLayer * vkStagingTexture->mipLevels + mipLevel;
-	uint32_t subresourceSlicePitch = vkStagingTexture->subresourceRowPitches[subresourceIndex] * std::max<uint32_t>(vkStagingTexture->height >> mipLevel, 1);
+	uint64_t rowSize = vkStagingTexture->subresourceRowSize[subresourceIndex];
+	uint64_t rowPitch = vkStagingTexture->subresourceRowPitches[subresourceIndex];
+	uint32_t mipHeight = std::max<uint32_t>(vkStagingTexture->height >> mipLevel, 1);
+	uint32_t mipDepth = std::max<uint32_t>(vkStagingTexture->depth >> mipLevel, 1);
+
+	char *mappedBufferMemory = vkStagingTexture->mappedData + vkStagingTexture->subresourceOffets[subresourceIndex];
+	const char *srcData = reinterpret_cast<const char*>(textureData);
 
-	char *mappedBufferMemory = nullptr;
-	VK_CHECK_RESULT(vmaMapMemory(memAllocator, vkStagingTexture->bufferMemory, reinterpret_cast<void**>(&mappedBufferMemory)));
+	// Tightly packed rows can go in w/ a single copy
+	if (rowPitch == rowSize)
+	{
+		memcpy(mappedBufferMemory, srcData, size_t(rowSize * mipHeight * mipDepth));
 
-	mappedBufferMemory += vkStagingTexture->subresourceOffets[subresourceIndex];
+		return;
+	}
 
-	for (uint32_t z = 0; z < std::max<uint32_t>(vkStagingTexture->depth >> mipLevel, 1); z++)
+	for (uint32_t z = 0; z < mipDepth; z++)
 	{
-		char *dstSlice = mappedBufferMemory + subresourceSlicePitch * z;
-		const char *srcSlice = reinterpret_cast<const char*>(textureData) + vkStagingTexture->subresourceRowSize[subresourceIndex] * std::max<uint32_t>(vkStagingTexture->height >> mipLevel, 1) * z;
+		char *dstSlice = mappedBufferMemory + rowPitch * mipHeight * z;
+		const char *srcSlice = srcData + rowSize * mipHeight * z;
 
-		for (uint32_t y = 0; y < std::max<uint32_t>(vkStagingTexture->width >> mipLevel, 1); y++)
+		for (uint32_t y = 0; y < mipHeight; y++)
 		{
-			memcpy(dstSlice + vkStagingTexture->subresourceRowPitches[subresourceIndex] * y, srcSlice + vkStagingTexture->subresourceRowSize[subresourceIndex] * y, vkStagingTexture->subresourceRowSize[subresourceIndex]);
+			memcpy(dstSlice + rowPitch * y, srcSlice + rowSize * y, size_t(rowSize));
 		}
 	}
-
-	vmaUnmapMemory(memAllocator, vkStagingTexture->bufferMemory);
 }
 
 void VulkanRenderer::destroyCommandPool (CommandPool pool)
@@ -1231,6 +1241,11 @@ void VulkanRenderer::destroyStagingTexture(StagingTexture stagingTexture)
 	delete vkStagingTexture;
 }
 
+bool VulkanRenderer::supportsTextureBlits ()
+{
+	return true;
+}
+
 void VulkanRenderer::setObjectDebugName (void *obj, RendererObjectType objType, const std::string &name)
 {
 #if RENDER_DEBUG_MARKERS
@@ -1359,6 +1374,12 @@ void VulkanRenderer::createLogicalDevice ()
 			VulkanExtensions::enabled_VK_AMD_rasterization_order = true;
 			Log::get()->info("Enabling the VK_AMD_rasterization_order extension");
 		}
+		else if (!VulkanExtensions::enabled_VK_KHR_draw_indirect_count && strcmp(ext.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+		{
+			enabledDeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			VulkanExtensions::enabled_VK_KHR_draw_indirect_count = true;
+			Log::get()->info("Enabling the VK_KHR_draw_indirect_count extension");
+		}
 	}
 
 	VkPhysicalDeviceFeatures enabledDeviceFeatures = {};
@@ -1369,6 +1390,13 @@ void VulkanRenderer::createLogicalDevice ()
 	enabledDeviceFeatures.fillModeNonSolid = true;
 	enabledDeviceFeatures.textureCompressionBC = true;
 	enabledDeviceFeatures.shaderImageGatherExtended = true;
+	enabledDeviceFeatures.multiDrawIndirect = deviceFeatures.multiDrawIndirect;
+	enabledDeviceFeatures.drawIndirectFirstInstance = deviceFeatures.drawIndirectFirstInstance;
+
+	VulkanExtensions::enabled_multiDrawIndirect = deviceFeatures.multiDrawIndirect == VK_TRUE;
+
+	if (!deviceFeatures.drawIndirectFirstInstance)
+		Log::get()->warn("VulkanRenderer: Device doesn't support drawIndirectFirstInstance, indirect draws will ignore their firstInstance");
 
 	VkDeviceCreateInfo deviceCreateInfo = {};
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
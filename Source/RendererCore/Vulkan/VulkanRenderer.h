@@ -101,6 +101,8 @@ class VulkanRenderer : public Renderer
 		void destroyFence (Fence fence);
 		void destroySemaphore (Semaphore sem);
 
+		bool supportsTextureBlits ();
+
 		void setObjectDebugName (void *obj, RendererObjectType objType, const std::string &name);
 
 		void initSwapchain (Window *wnd);
@@ -23,6 +23,10 @@ class VulkanExtensions
 
 		static bool enabled_VK_EXT_debug_marker;
 		static bool enabled_VK_AMD_rasterization_order;
+		static bool enabled_VK_KHR_draw_indirect_count;
+
+		// Device features that change how commands are recorded
+		static bool enabled_multiDrawIndirect;
 
 		static PFN_vkDebugMarkerSetObjectTagEXT DebugMarkerSetObjectTagEXT;
 		static PFN_vkDebugMarkerSetObjectNameEXT DebugMarkerSetObjectNameEXT;
@@ -30,6 +34,9 @@ class VulkanExtensions
 		static PFN_vkCmdDebugMarkerEndEXT CmdDebugMarkerEndEXT;
 		static PFN_vkCmdDebugMarkerInsertEXT CmdDebugMarkerInsertEXT;
 
+		static PFN_vkCmdDrawIndirectCountKHR CmdDrawIndirectCountKHR;
+		static PFN_vkCmdDrawIndexedIndirectCountKHR CmdDrawIndexedIndirectCountKHR;
+
 		static void getProcAddresses (VkDevice device);
 };
 
@@ -0,0 +1,122 @@
+#include "Resources/ImageDecoder.h"
+
+#include <lodepng.h>
+#include <stb_image.h>
+
+/*
+Both decoders below only decode into memory they allocate themselves, so the image is copied to imageData afterwards
+*/
+static void copyImageRows(uint8_t *imageData, uint32_t rowPitch, const uint8_t *decodedImage, uint32_t width, uint32_t height)
+{
+	uint32_t rowSize = width * 4;
+
+	if (rowPitch == rowSize)
+	{
+		memcpy(imageData, decodedImage, size_t(rowSize) * height);
+
+		return;
+	}
+
+	for (uint32_t row = 0; row < height; row++)
+		memcpy(imageData + size_t(row) * rowPitch, decodedImage + size_t(row) * rowSize, rowSize);
+}
+
+bool LodePNGImageDecoder::canDecode(const uint8_t *fileData, size_t fileSize) const
+{
+	const uint8_t pngSignature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+	return fileSize >= 8 && memcmp(fileData, pngSignature, 8) == 0;
+}
+
+bool LodePNGImageDecoder::readHeader(const uint8_t *fileData, size_t fileSize, uint32_t &width, uint32_t &height, std::string &error) const
+{
+	lodepng::State pngState;
+	unsigned pngWidth = 0, pngHeight = 0;
+	unsigned lodepngError = lodepng_inspect(&pngWidth, &pngHeight, &pngState, fileData, fileSize);
+
+	if (lodepngError != 0)
+	{
+		error = lodepng_error_text(lodepngError);
+
+		return false;
+	}
+
+	width = pngWidth;
+	height = pngHeight;
+
+	return true;
+}
+
+bool LodePNGImageDecoder::decode(const uint8_t *fileData, size_t fileSize, uint8_t *imageData, uint32_t rowPitch, std::string &error) const
+{
+	uint8_t *decodedImage = nullptr;
+	unsigned width = 0, height = 0;
+	unsigned lodepngError = lodepng_decode_memory(&decodedImage, &width, &height, fileData, fileSize, LCT_RGBA, 8);
+
+	if (lodepngError != 0)
+	{
+		error = lodepng_error_text(lodepngError);
+		free(decodedImage);
+
+		return false;
+	}
+
+	copyImageRows(imageData, rowPitch, decodedImage, width, height);
+	free(decodedImage);
+
+	return true;
+}
+
+const char *LodePNGImageDecoder::getName() const
+{
+	return "lodepng";
+}
+
+bool STBImageDecoder::canDecode(const uint8_t *fileData, size_t fileSize) const
+{
+	int width, height, components;
+
+	return stbi_info_from_memory(fileData, int(fileSize), &width, &height, &components) != 0;
+}
+
+bool STBImageDecoder::readHeader(const uint8_t *fileData, size_t fileSize, uint32_t &width, uint32_t &height, std::string &error) const
+{
+	int stbWidth = 0, stbHeight = 0, stbComponents = 0;
+
+	if (stbi_info_from_memory(fileData, int(fileSize), &stbWidth, &stbHeight, &stbComponents) == 0)
+	{
+		error = "unrecognized image header";
+
+		return false;
+	}
+
+	width = uint32_t(stbWidth);
+	height = uint32_t(stbHeight);
+
+	return true;
+}
+
+bool STBImageDecoder::decode(const uint8_t *fileData, size_t fileSize, uint8_t *imageData, uint32_t rowPitch, std::string &error) const
+{
+	int width = 0, height = 0, components = 0;
+	uint8_t *decodedImage = stbi_load_from_memory(fileData, int(fileSize), &width, &height, &components, 4);
+
+	if (decodedImage == nullptr)
+	{
+		// stb_image's failure reason is shared by every thread, so it could be from another decode
+		const char *failureReason = stbi_failure_reason();
+		error = failureReason != nullptr ? failureReason : "unknown error";
+
+		return false;
+	}
+
+	copyImageRows(imageData, rowPitch, decodedImage, uint32_t(width), uint32_t(height));
+	stbi_image_free(decodedImage);
+
+	return true;
+}
+
+const char *STBImageDecoder::getName() const
+{
+	return "stb_image";
+}
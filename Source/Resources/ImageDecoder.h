@@ -0,0 +1,62 @@
+#ifndef RESOURCES_IMAGEDECODER_H_
+#define RESOURCES_IMAGEDECODER_H_
+
+#include <common.h>
+
+/*
+Decodes one kind of image file to 8 bit RGBA. Images are decoded from many jobs at once, so a decoder can't keep any state between calls.
+The decoded image is written to memory the caller gives it, w/ it's rows rowPitch bytes apart, so a decoder that can write straight into
+staging memory doesn't need a copy in between.
+*/
+class ImageDecoder
+{
+	public:
+
+	virtual ~ImageDecoder() {}
+
+	/*
+	Whether the decoder can handle the file, decided from it's first few bytes
+	*/
+	virtual bool canDecode(const uint8_t *fileData, size_t fileSize) const = 0;
+
+	/*
+	Reads the image's size from it's header w/o decoding it
+	*/
+	virtual bool readHeader(const uint8_t *fileData, size_t fileSize, uint32_t &width, uint32_t &height, std::string &error) const = 0;
+
+	/*
+	Decodes the image into imageData, which has room for the number of rows readHeader() returned. Grayscale images are expanded to red,
+	green and blue, and images w/o alpha get an alpha of 255.
+	*/
+	virtual bool decode(const uint8_t *fileData, size_t fileSize, uint8_t *imageData, uint32_t rowPitch, std::string &error) const = 0;
+
+	virtual const char *getName() const = 0;
+};
+
+/*
+PNGs through lodepng
+*/
+class LodePNGImageDecoder : public ImageDecoder
+{
+	public:
+
+	bool canDecode(const uint8_t *fileData, size_t fileSize) const;
+	bool readHeader(const uint8_t *fileData, size_t fileSize, uint32_t &width, uint32_t &height, std::string &error) const;
+	bool decode(const uint8_t *fileData, size_t fileSize, uint8_t *imageData, uint32_t rowPitch, std::string &error) const;
+	const char *getName() const;
+};
+
+/*
+JPEGs (and anything else stb_image can read) through stb_image
+*/
+class STBImageDecoder : public ImageDecoder
+{
+	public:
+
+	bool canDecode(const uint8_t *fileData, size_t fileSize) const;
+	bool readHeader(const uint8_t *fileData, size_t fileSize, uint32_t &width, uint32_t &height, std::string &error) const;
+	bool decode(const uint8_t *fileData, size_t fileSize, uint8_t *imageData, uint32_t rowPitch, std::string &error) const;
+	const char *getName() const;
+};
+
+#endif /* RESOURCES_IMAGEDECODER_H_ */
@@ -0,0 +1,361 @@
+#include "Resources/MeshOptimizer.h"
+
+#include <cstring>
+
+#define MESH_NO_VERTEX (~0u)
+
+static uint32_t hashMeshVertex(const NonSkinnedVertex &vertex)
+{
+	// FNV-1a over the vertex a 32 bit word at a time
+	uint32_t words[sizeof(NonSkinnedVertex) / sizeof(uint32_t)];
+	memcpy(words, &vertex, sizeof(words));
+
+	uint32_t hash = 2166136261u;
+
+	for (uint32_t word : words)
+	{
+		hash ^= word;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+size_t weldMeshVertices(std::vector<NonSkinnedVertex> &vertices, std::vector<uint32_t> &indices)
+{
+	size_t tableSize = 1;
+
+	while (tableSize < vertices.size() * 2)
+		tableSize *= 2;
+
+	std::vector<uint32_t> table(tableSize, MESH_NO_VERTEX);
+	std::vector<uint32_t> remap(vertices.size());
+	size_t weldedVertexCount = 0;
+
+	for (size_t v = 0; v < vertices.size(); v++)
+	{
+		size_t slot = hashMeshVertex(vertices[v]) & (tableSize - 1);
+
+		// Linear probing, the table is never more than half full
+		while (table[slot] != MESH_NO_VERTEX && memcmp(&vertices[table[slot]], &vertices[v], sizeof(NonSkinnedVertex)) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == MESH_NO_VERTEX)
+		{
+			table[slot] = uint32_t(weldedVertexCount);
+			vertices[weldedVertexCount++] = vertices[v];
+		}
+
+		remap[v] = table[slot];
+	}
+
+	vertices.resize(weldedVertexCount);
+
+	for (uint32_t &index : indices)
+		index = remap[index];
+
+	return weldedVertexCount;
+}
+
+/*
+Simulates a FIFO cache, a vertex is in the cache if fewer than cacheSize misses happened since it was last added
+*/
+struct MeshVertexCacheSimulator
+{
+	std::vector<uint32_t> timestamps;
+	uint32_t time;
+	uint32_t cacheSize;
+
+	MeshVertexCacheSimulator(size_t vertexCount, uint32_t cacheSize) : timestamps(vertexCount, 0), time(cacheSize + 1), cacheSize(cacheSize)
+	{
+	}
+
+	uint32_t addTriangle(const uint32_t *triangle)
+	{
+		uint32_t misses = 0;
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (time - timestamps[triangle[k]] > cacheSize)
+			{
+				timestamps[triangle[k]] = time++;
+				misses++;
+			}
+		}
+
+		return misses;
+	}
+
+	void reset()
+	{
+		time += cacheSize + 1;
+	}
+};
+
+float calculateMeshACMR(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	if (indexCount == 0)
+		return 0.0f;
+
+	MeshVertexCacheSimulator cache(vertexCount, cacheSize);
+	uint64_t misses = 0;
+
+	for (size_t i = 0; i < indexCount; i += 3)
+		misses += cache.addTriangle(&indices[i]);
+
+	return float(misses) / float(indexCount / 3);
+}
+
+void optimizeMeshVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, std::vector<uint32_t> *clusters)
+{
+	const size_t triangleCount = indices.size() / 3;
+	const int64_t cacheSize = MESH_VERTEX_CACHE_SIZE;
+
+	if (clusters != nullptr)
+		clusters->clear();
+
+	if (triangleCount == 0)
+		return;
+
+	// The triangles around each vertex, and how many of them haven't been emitted yet
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	std::vector<uint32_t> adjacency(indices.size());
+
+	for (uint32_t index : indices)
+		liveTriangles[index]++;
+
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+
+	std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (size_t i = 0; i < indices.size(); i++)
+		adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+
+	std::vector<int64_t> cacheTimestamps(vertexCount, 0);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	int64_t time = cacheSize + 1;
+	size_t cursor = 0;
+	uint32_t fanVertex = indices[0];
+
+	if (clusters != nullptr)
+		clusters->push_back(0);
+
+	while (fanVertex != MESH_NO_VERTEX)
+	{
+		candidates.clear();
+
+		for (uint32_t a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; a++)
+		{
+			uint32_t triangle = adjacency[a];
+
+			if (emitted[triangle])
+				continue;
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[triangle * 3 + k];
+
+				output.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+
+				if (time - cacheTimestamps[v] > cacheSize)
+					cacheTimestamps[v] = time++;
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Pick the candidate that'll still be in the cache after it's remaining triangles are emitted, and that's been in it the longest
+		uint32_t nextVertex = MESH_NO_VERTEX;
+		int64_t bestPriority = -1;
+
+		for (uint32_t v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+				continue;
+
+			int64_t priority = 0;
+
+			if (time - cacheTimestamps[v] + 2 * int64_t(liveTriangles[v]) <= cacheSize)
+				priority = time - cacheTimestamps[v];
+
+			if (priority > bestPriority)
+			{
+				nextVertex = v;
+				bestPriority = priority;
+			}
+		}
+
+		if (nextVertex != MESH_NO_VERTEX)
+		{
+			fanVertex = nextVertex;
+
+			continue;
+		}
+
+		// A dead end, go back to the most recently used vertex that still has triangles, or else the next one in input order
+		while (!deadEnds.empty() && nextVertex == MESH_NO_VERTEX)
+		{
+			uint32_t v = deadEnds.back();
+			deadEnds.pop_back();
+
+			if (liveTriangles[v] > 0)
+				nextVertex = v;
+		}
+
+		while (nextVertex == MESH_NO_VERTEX && cursor < vertexCount)
+		{
+			if (liveTriangles[cursor] > 0)
+				nextVertex = uint32_t(cursor);
+
+			cursor++;
+		}
+
+		if (nextVertex != MESH_NO_VERTEX && clusters != nullptr)
+			clusters->push_back(uint32_t(output.size() / 3));
+
+		fanVertex = nextVertex;
+	}
+
+	indices.swap(output);
+}
+
+void optimizeMeshOverdraw(std::vector<uint32_t> &indices, const std::vector<NonSkinnedVertex> &vertices, const std::vector<uint32_t> &clusters, float threshold)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0 || clusters.size() == 0)
+		return;
+
+	// Split the hard clusters wherever the ACMR so far is already close enough to the whole mesh's, resetting the cache for each one
+	MeshVertexCacheSimulator cache(vertices.size(), MESH_VERTEX_CACHE_SIZE);
+	uint64_t meshMisses = 0;
+
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		size_t clusterEnd = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+		cache.reset();
+
+		for (size_t t = clusters[c]; t < clusterEnd; t++)
+			meshMisses += cache.addTriangle(&indices[t * 3]);
+	}
+
+	const float clusterThreshold = threshold * float(meshMisses) / float(triangleCount);
+	std::vector<uint32_t> softClusters;
+
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		size_t clusterStart = clusters[c];
+		size_t clusterEnd = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+		uint32_t clusterMisses = 0;
+
+		softClusters.push_back(uint32_t(clusterStart));
+		cache.reset();
+
+		for (size_t t = clusterStart; t < clusterEnd; t++)
+		{
+			clusterMisses += cache.addTriangle(&indices[t * 3]);
+
+			if (t + 1 < clusterEnd && float(clusterMisses) <= clusterThreshold * float(t + 1 - softClusters.back()))
+			{
+				softClusters.push_back(uint32_t(t + 1));
+				clusterMisses = 0;
+				cache.reset();
+			}
+		}
+	}
+
+	glm::vec3 meshCentroid = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+
+	std::vector<glm::vec3> clusterCentroids(softClusters.size(), glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(softClusters.size(), glm::vec3(0.0f));
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		size_t clusterEnd = c + 1 < softClusters.size() ? softClusters[c + 1] : triangleCount;
+		float clusterArea = 0.0f;
+
+		for (size_t t = softClusters[c]; t < clusterEnd; t++)
+		{
+			glm::vec3 p0 = vertices[indices[t * 3 + 0]].vertex;
+			glm::vec3 p1 = vertices[indices[t * 3 + 1]].vertex;
+			glm::vec3 p2 = vertices[indices[t * 3 + 2]].vertex;
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+			clusterNormals[c] += normal;
+			clusterArea += area;
+		}
+
+		meshCentroid += clusterCentroids[c];
+		meshArea += clusterArea;
+
+		clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] / clusterArea : glm::vec3(0.0f);
+	}
+
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+	std::vector<float> clusterSortKeys(softClusters.size());
+	std::vector<uint32_t> clusterOrder(softClusters.size());
+
+	for (size_t c = 0; c < softClusters.size(); c++)
+	{
+		float normalLength = glm::length(clusterNormals[c]);
+
+		clusterSortKeys[c] = normalLength > 0.0f ? glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / normalLength) : 0.0f;
+		clusterOrder[c] = uint32_t(c);
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) {
+		return clusterSortKeys[a] > clusterSortKeys[b];
+	});
+
+	std::vector<uint32_t> sortedIndices;
+	sortedIndices.reserve(indices.size());
+
+	for (uint32_t c : clusterOrder)
+	{
+		size_t clusterEnd = c + 1 < softClusters.size() ? softClusters[c + 1] : triangleCount;
+
+		sortedIndices.insert(sortedIndices.end(), indices.begin() + softClusters[c] * 3, indices.begin() + clusterEnd * 3);
+	}
+
+	indices.swap(sortedIndices);
+}
+
+size_t optimizeMeshVertexFetch(std::vector<NonSkinnedVertex> &vertices, std::vector<std::vector<uint32_t>*> indexLists)
+{
+	std::vector<uint32_t> remap(vertices.size(), MESH_NO_VERTEX);
+	std::vector<NonSkinnedVertex> fetchOrderVertices;
+	fetchOrderVertices.reserve(vertices.size());
+
+	for (std::vector<uint32_t> *indices : indexLists)
+	{
+		for (uint32_t &index : *indices)
+		{
+			if (remap[index] == MESH_NO_VERTEX)
+			{
+				remap[index] = uint32_t(fetchOrderVertices.size());
+				fetchOrderVertices.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+	}
+
+	vertices.swap(fetchOrderVertices);
+
+	return vertices.size();
+}
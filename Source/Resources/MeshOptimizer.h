@@ -0,0 +1,42 @@
+#ifndef RESOURCES_MESHOPTIMIZER_H_
+#define RESOURCES_MESHOPTIMIZER_H_
+
+#include <common.h>
+
+#include <Resources/ResourceManager.h>
+
+#define MESH_VERTEX_CACHE_SIZE 16 // The post transform cache size that triangles are ordered for, and that ACMR is measured w/
+#define MESH_OVERDRAW_THRESHOLD 1.05f // How much worse the ACMR is allowed to get to give the overdraw sort smaller clusters to work w/
+
+/*
+Merges vertices that are bit for bit identical, w/ a hash table over the whole NonSkinnedVertex. Each vertex is kept where it's first
+occurrence was, and 'indices' is remapped to match. Returns the new vertex count.
+*/
+size_t weldMeshVertices(std::vector<NonSkinnedVertex> &vertices, std::vector<uint32_t> &indices);
+
+/*
+Reorders the triangles for the post transform vertex cache w/ Tipsify (Sander et al. 2007). If 'clusters' isn't nullptr it gets the index
+of the first triangle of each run that Tipsify started from a dead end, which are the hard boundaries optimizeMeshOverdraw() needs.
+*/
+void optimizeMeshVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, std::vector<uint32_t> *clusters);
+
+/*
+Reorders the clusters from optimizeMeshVertexCache() so that the ones facing away from the center of the mesh are drawn first, which
+are the ones most likely to be in front of the rest of it. Clusters are split further wherever that keeps the ACMR within 'threshold'
+of the cache optimized order, so the cache order is mostly kept inside of each cluster.
+*/
+void optimizeMeshOverdraw(std::vector<uint32_t> &indices, const std::vector<NonSkinnedVertex> &vertices, const std::vector<uint32_t> &clusters, float threshold);
+
+/*
+Reorders the vertices in the order they're first used by the index lists, going through the lists in order, so vertex fetches walk
+forwards through memory. Vertices that aren't used by any of the lists are removed. Returns the new vertex count.
+*/
+size_t optimizeMeshVertexFetch(std::vector<NonSkinnedVertex> &vertices, std::vector<std::vector<uint32_t>*> indexLists);
+
+/*
+The average number of cache misses per triangle w/ a FIFO cache of 'cacheSize' vertices, 0.5 is the best possible for a large regular
+grid and 3 the worst
+*/
+float calculateMeshACMR(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = MESH_VERTEX_CACHE_SIZE);
+
+#endif /* RESOURCES_MESHOPTIMIZER_H_ */
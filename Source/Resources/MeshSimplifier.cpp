@@ -0,0 +1,520 @@
+#include "Resources/MeshSimplifier.h"
+
+#include <cfloat>
+#include <numeric>
+
+#define MESH_SIMPLIFY_BORDER_WEIGHT 10.0f // How much a border/seam edge's quadric counts for compared to a face's, keeps the outlines of a mesh in place
+#define MESH_SIMPLIFY_NORMAL_WEIGHT 0.5f
+#define MESH_SIMPLIFY_MIN_NORMAL_DOT 0.25f // The most a collapse can turn any triangle, about 75 degrees
+
+#define MESH_NO_VERTEX (~0u)
+#define MESH_MULTIPLE_VERTICES (~0u - 1)
+
+typedef enum MeshVertexKind
+{
+	MESH_VERTEX_KIND_MANIFOLD = 0, // Can collapse onto any of it's neighbours
+	MESH_VERTEX_KIND_BORDER = 1, // On a single mesh border, only collapses onto the next border vertex along it
+	MESH_VERTEX_KIND_SEAM = 2, // Has one twin w/ the same position, they both collapse along the seam together
+	MESH_VERTEX_KIND_LOCKED = 3, // Never collapses
+	MESH_VERTEX_KIND_MAX_ENUM = 0x7FFFFFFF
+} MeshVertexKind;
+
+/*
+A symmetric 3x3 matrix A, a vector b and a constant c, the error at point v is v^T A v + 2 b.v + c, ie the weighted sum of squared distances
+to every plane that was added to it
+*/
+struct MeshQuadric
+{
+	float a00, a11, a22;
+	float a10, a20, a21;
+	float b0, b1, b2;
+	float c;
+	float weight;
+};
+
+struct MeshCollapse
+{
+	uint32_t v0; // Collapses onto v1
+	uint32_t v1;
+	float cost;
+};
+
+/*
+The triangles around each vertex, triangles[offsets[v]] to triangles[offsets[v + 1]]
+*/
+struct MeshAdjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+};
+
+static MeshQuadric quadricFromPlane(const glm::vec3 &normal, float distance, float weight)
+{
+	MeshQuadric q = {};
+	q.a00 = normal.x * normal.x * weight;
+	q.a11 = normal.y * normal.y * weight;
+	q.a22 = normal.z * normal.z * weight;
+	q.a10 = normal.y * normal.x * weight;
+	q.a20 = normal.z * normal.x * weight;
+	q.a21 = normal.z * normal.y * weight;
+	q.b0 = normal.x * distance * weight;
+	q.b1 = normal.y * distance * weight;
+	q.b2 = normal.z * distance * weight;
+	q.c = distance * distance * weight;
+	q.weight = weight;
+
+	return q;
+}
+
+static void addQuadric(MeshQuadric &q, const MeshQuadric &r)
+{
+	q.a00 += r.a00;
+	q.a11 += r.a11;
+	q.a22 += r.a22;
+	q.a10 += r.a10;
+	q.a20 += r.a20;
+	q.a21 += r.a21;
+	q.b0 += r.b0;
+	q.b1 += r.b1;
+	q.b2 += r.b2;
+	q.c += r.c;
+	q.weight += r.weight;
+}
+
+/*
+The weighted mean squared distance from 'point' to the quadric's planes
+*/
+static float evaluateQuadric(const MeshQuadric &q, const glm::vec3 &point)
+{
+	float rx = q.b0 + q.a10 * point.y;
+	float ry = q.b1 + q.a21 * point.z;
+	float rz = q.b2 + q.a20 * point.x;
+
+	rx = rx * 2.0f + q.a00 * point.x;
+	ry = ry * 2.0f + q.a11 * point.y;
+	rz = rz * 2.0f + q.a22 * point.z;
+
+	float error = q.c + rx * point.x + ry * point.y + rz * point.z;
+
+	return std::fabs(error) / std::max(q.weight, FLT_MIN);
+}
+
+static void buildAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount, MeshAdjacency &adjacency)
+{
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	adjacency.triangles.resize(indices.size());
+
+	for (uint32_t index : indices)
+		adjacency.offsets[index + 1]++;
+
+	for (size_t v = 0; v < vertexCount; v++)
+		adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+	std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+
+	for (size_t i = 0; i < indices.size(); i++)
+		adjacency.triangles[fill[indices[i]]++] = uint32_t(i / 3);
+}
+
+/*
+Whether any triangle has the directed edge a -> b
+*/
+static bool hasEdge(const MeshAdjacency &adjacency, const std::vector<uint32_t> &indices, uint32_t a, uint32_t b)
+{
+	for (uint32_t t = adjacency.offsets[a]; t < adjacency.offsets[a + 1]; t++)
+	{
+		const uint32_t *triangle = &indices[adjacency.triangles[t] * 3];
+
+		for (int k = 0; k < 3; k++)
+			if (triangle[k] == a && triangle[(k + 1) % 3] == b)
+				return true;
+	}
+
+	return false;
+}
+
+/*
+For each vertex, the other end of it's open (only used by one triangle, in one direction) outgoing and incoming edges. MESH_NO_VERTEX if it
+doesn't have one, MESH_MULTIPLE_VERTICES if it has more than one.
+*/
+static void findOpenEdges(const MeshAdjacency &adjacency, const std::vector<uint32_t> &indices, size_t vertexCount, std::vector<uint32_t> &openOut, std::vector<uint32_t> &openIn)
+{
+	openOut.assign(vertexCount, MESH_NO_VERTEX);
+	openIn.assign(vertexCount, MESH_NO_VERTEX);
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		uint32_t a = indices[i];
+		uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+
+		if (hasEdge(adjacency, indices, b, a))
+			continue;
+
+		openOut[a] = openOut[a] == MESH_NO_VERTEX ? b : MESH_MULTIPLE_VERTICES;
+		openIn[b] = openIn[b] == MESH_NO_VERTEX ? a : MESH_MULTIPLE_VERTICES;
+	}
+}
+
+/*
+Whether moving v0 onto v1's position turns any of the triangles around v0 over (or close to it), triangles that use v1's position are skipped since the
+collapse removes them
+*/
+static bool collapseFlipsTriangles(const MeshAdjacency &adjacency, const std::vector<uint32_t> &indices, const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &remap, uint32_t v0, uint32_t v1)
+{
+	for (uint32_t t = adjacency.offsets[v0]; t < adjacency.offsets[v0 + 1]; t++)
+	{
+		const uint32_t *triangle = &indices[adjacency.triangles[t] * 3];
+
+		if (remap[triangle[0]] == remap[v1] || remap[triangle[1]] == remap[v1] || remap[triangle[2]] == remap[v1])
+			continue;
+
+		glm::vec3 p[3], q[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+			p[k] = positions[triangle[k]];
+			q[k] = triangle[k] == v0 ? positions[v1] : p[k];
+		}
+
+		glm::vec3 oldNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+		glm::vec3 newNormal = glm::cross(q[1] - q[0], q[2] - q[0]);
+
+		// Triangles can be turned a bit more by every pass, so a large turn is treated the same as a flip
+		if (glm::dot(oldNormal, newNormal) <= MESH_SIMPLIFY_MIN_NORMAL_DOT * glm::length(oldNormal) * glm::length(newNormal))
+			return true;
+	}
+
+	return false;
+}
+
+float simplifyMesh(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float maxError, std::vector<uint32_t> &simplifiedIndices)
+{
+	simplifiedIndices.assign(indices, indices + indexCount);
+
+	if (indexCount == 0 || targetIndexCount >= indexCount)
+		return 0.0f;
+
+	// Work in a unit box so the errors are relative to the size of the mesh
+	glm::vec3 minPosition = glm::vec3(FLT_MAX), maxPosition = glm::vec3(-FLT_MAX);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		minPosition = glm::min(minPosition, vertices[v].vertex);
+		maxPosition = glm::max(maxPosition, vertices[v].vertex);
+	}
+
+	glm::vec3 extents = maxPosition - minPosition;
+	float maxExtent = std::max(std::max(extents.x, extents.y), extents.z);
+	float positionScale = maxExtent > 0.0f ? 1.0f / maxExtent : 0.0f;
+
+	std::vector<glm::vec3> positions(vertexCount);
+	std::vector<glm::vec3> normals(vertexCount);
+
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		positions[v] = (vertices[v].vertex - minPosition) * positionScale;
+		normals[v] = glm::vec3(vertices[v].normal);
+
+		float normalLength = glm::length(normals[v]);
+		normals[v] = normalLength > 0.0f ? normals[v] / normalLength : glm::vec3(0.0f);
+	}
+
+	/*
+	Group the vertices that share a position, remap[v] is the lowest index w/ v's position, and wedge[v] is the next vertex in a loop of all
+	of the vertices w/ v's position
+	*/
+	std::vector<uint32_t> sortedVertices(vertexCount);
+	std::iota(sortedVertices.begin(), sortedVertices.end(), 0);
+
+	std::sort(sortedVertices.begin(), sortedVertices.end(), [&](uint32_t a, uint32_t b) {
+		const glm::vec3 &pa = vertices[a].vertex, &pb = vertices[b].vertex;
+
+		if (pa.x != pb.x)
+			return pa.x < pb.x;
+		if (pa.y != pb.y)
+			return pa.y < pb.y;
+		if (pa.z != pb.z)
+			return pa.z < pb.z;
+
+		return a < b;
+	});
+
+	std::vector<uint32_t> remap(vertexCount), wedge(vertexCount);
+
+	for (size_t start = 0; start < vertexCount;)
+	{
+		size_t end = start + 1;
+
+		while (end < vertexCount && vertices[sortedVertices[end]].vertex == vertices[sortedVertices[start]].vertex)
+			end++;
+
+		for (size_t i = start; i < end; i++)
+		{
+			remap[sortedVertices[i]] = sortedVertices[start];
+			wedge[sortedVertices[i]] = sortedVertices[i + 1 < end ? i + 1 : start];
+		}
+
+		start = end;
+	}
+
+	MeshAdjacency adjacency;
+	std::vector<uint32_t> openOut, openIn;
+
+	buildAdjacency(simplifiedIndices, vertexCount, adjacency);
+	findOpenEdges(adjacency, simplifiedIndices, vertexCount, openOut, openIn);
+
+	std::vector<MeshVertexKind> kinds(vertexCount, MESH_VERTEX_KIND_LOCKED);
+
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		if (wedge[v] == v)
+		{
+			if (openOut[v] == MESH_NO_VERTEX && openIn[v] == MESH_NO_VERTEX)
+				kinds[v] = MESH_VERTEX_KIND_MANIFOLD;
+			else if (openOut[v] < MESH_MULTIPLE_VERTICES && openIn[v] < MESH_MULTIPLE_VERTICES)
+				kinds[v] = MESH_VERTEX_KIND_BORDER;
+		}
+		else if (wedge[wedge[v]] == v)
+		{
+			uint32_t w = wedge[v];
+
+			// Each side of a simple seam has one open edge in and out, and they run along the same positions as the other side's in reverse
+			if (openOut[v] < MESH_MULTIPLE_VERTICES && openIn[v] < MESH_MULTIPLE_VERTICES && openOut[w] < MESH_MULTIPLE_VERTICES && openIn[w] < MESH_MULTIPLE_VERTICES)
+				if (remap[openOut[v]] == remap[openIn[w]] && remap[openIn[v]] == remap[openOut[w]])
+					kinds[v] = MESH_VERTEX_KIND_SEAM;
+		}
+	}
+
+	// Quadrics are kept per position, so both sides of a seam always agree on the error
+	std::vector<MeshQuadric> quadrics(vertexCount, MeshQuadric());
+
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		const uint32_t *triangle = &simplifiedIndices[i];
+		glm::vec3 p0 = positions[triangle[0]], p1 = positions[triangle[1]], p2 = positions[triangle[2]];
+
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float normalLength = glm::length(normal);
+
+		if (normalLength == 0.0f)
+			continue;
+
+		normal /= normalLength;
+
+		MeshQuadric faceQuadric = quadricFromPlane(normal, -glm::dot(normal, p0), normalLength * 0.5f);
+
+		for (int k = 0; k < 3; k++)
+		{
+			addQuadric(quadrics[remap[triangle[k]]], faceQuadric);
+
+			uint32_t a = triangle[k], b = triangle[(k + 1) % 3];
+
+			if (openOut[a] != b && openOut[a] != MESH_MULTIPLE_VERTICES)
+				continue;
+
+			if (hasEdge(adjacency, simplifiedIndices, b, a))
+				continue;
+
+			// Open edges get a plane through the edge that's perpendicular to the face, so collapses don't pull the border/seam inwards
+			glm::vec3 edge = positions[b] - positions[a];
+			float edgeLengthSqr = glm::dot(edge, edge);
+			glm::vec3 edgeNormal = glm::cross(edge, normal);
+			float edgeNormalLength = glm::length(edgeNormal);
+
+			if (edgeNormalLength == 0.0f)
+				continue;
+
+			edgeNormal /= edgeNormalLength;
+
+			MeshQuadric edgeQuadric = quadricFromPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), edgeLengthSqr * MESH_SIMPLIFY_BORDER_WEIGHT);
+
+			addQuadric(quadrics[remap[a]], edgeQuadric);
+			addQuadric(quadrics[remap[b]], edgeQuadric);
+		}
+	}
+
+	// For a seam vertex v0 collapsing onto v1, the twin of v0 that collapses onto the twin of v1, or MESH_NO_VERTEX if the seam doesn't line up
+	auto getSeamTwinTarget = [&](uint32_t v0, uint32_t v1) -> uint32_t {
+		uint32_t w0 = wedge[v0];
+		uint32_t w1 = openOut[v0] == v1 ? openIn[w0] : openOut[w0];
+
+		if (w1 >= MESH_MULTIPLE_VERTICES || w1 == v1 || remap[w1] != remap[v1])
+			return MESH_NO_VERTEX;
+
+		return w1;
+	};
+
+	auto canCollapse = [&](uint32_t v0, uint32_t v1) -> bool {
+		if (remap[v0] == remap[v1])
+			return false;
+
+		switch (kinds[v0])
+		{
+			case MESH_VERTEX_KIND_MANIFOLD:
+				return true;
+			case MESH_VERTEX_KIND_BORDER:
+				return kinds[v1] == MESH_VERTEX_KIND_BORDER && (openOut[v0] == v1 || openIn[v0] == v1);
+			case MESH_VERTEX_KIND_SEAM:
+				return kinds[v1] == MESH_VERTEX_KIND_SEAM && (openOut[v0] == v1 || openIn[v0] == v1) && getSeamTwinTarget(v0, v1) != MESH_NO_VERTEX;
+			default:
+				return false;
+		}
+	};
+
+	auto getCollapseCost = [&](uint32_t v0, uint32_t v1) -> float {
+		glm::vec3 edge = positions[v1] - positions[v0];
+		float normalCost = (1.0f - glm::dot(normals[v0], normals[v1])) * glm::dot(edge, edge) * MESH_SIMPLIFY_NORMAL_WEIGHT;
+
+		return evaluateQuadric(quadrics[remap[v0]], positions[v1]) + normalCost;
+	};
+
+	const float maxCost = maxError * maxError;
+	float largestCost = 0.0f;
+
+	std::vector<MeshCollapse> collapses;
+	std::vector<uint32_t> collapseRemap(vertexCount);
+	std::vector<uint8_t> collapseLocked(vertexCount);
+
+	while (simplifiedIndices.size() > targetIndexCount)
+	{
+		collapses.clear();
+
+		for (size_t i = 0; i < simplifiedIndices.size(); i++)
+		{
+			uint32_t a = simplifiedIndices[i];
+			uint32_t b = simplifiedIndices[i - i % 3 + (i + 1) % 3];
+
+			// Edges shared by two triangles are only looked at once
+			if (a > b && hasEdge(adjacency, simplifiedIndices, b, a))
+				continue;
+
+			bool canCollapseAB = canCollapse(a, b), canCollapseBA = canCollapse(b, a);
+
+			if (!canCollapseAB && !canCollapseBA)
+				continue;
+
+			float costAB = canCollapseAB ? getCollapseCost(a, b) : FLT_MAX;
+			float costBA = canCollapseBA ? getCollapseCost(b, a) : FLT_MAX;
+
+			collapses.push_back(costAB <= costBA ? MeshCollapse{a, b, costAB} : MeshCollapse{b, a, costBA});
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const MeshCollapse &a, const MeshCollapse &b) {
+			if (a.cost != b.cost)
+				return a.cost < b.cost;
+			if (a.v0 != b.v0)
+				return a.v0 < b.v0;
+
+			return a.v1 < b.v1;
+		});
+
+		// Each collapse removes about two triangles
+		size_t collapseGoal = std::max<size_t>((simplifiedIndices.size() - targetIndexCount) / 6, 1);
+		size_t collapseCount = 0;
+
+		std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+		std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+
+		for (const MeshCollapse &collapse : collapses)
+		{
+			if (collapse.cost > maxCost || collapseCount >= collapseGoal)
+				break;
+
+			uint32_t r0 = remap[collapse.v0], r1 = remap[collapse.v1];
+
+			if (collapseLocked[r0] || collapseLocked[r1])
+				continue;
+
+			uint32_t w0 = MESH_NO_VERTEX, w1 = MESH_NO_VERTEX;
+
+			if (kinds[collapse.v0] == MESH_VERTEX_KIND_SEAM)
+			{
+				w0 = wedge[collapse.v0];
+				w1 = getSeamTwinTarget(collapse.v0, collapse.v1);
+			}
+
+			if (collapseFlipsTriangles(adjacency, simplifiedIndices, positions, remap, collapse.v0, collapse.v1))
+				continue;
+
+			if (w0 != MESH_NO_VERTEX && collapseFlipsTriangles(adjacency, simplifiedIndices, positions, remap, w0, w1))
+				continue;
+
+			collapseRemap[collapse.v0] = collapse.v1;
+
+			if (w0 != MESH_NO_VERTEX)
+				collapseRemap[w0] = w1;
+
+			// The flip tests above only hold if none of the triangles around v0 are changed by another collapse in the same pass
+			for (uint32_t v : {collapse.v0, w0})
+			{
+				if (v == MESH_NO_VERTEX)
+					continue;
+
+				for (uint32_t t = adjacency.offsets[v]; t < adjacency.offsets[v + 1]; t++)
+					for (int k = 0; k < 3; k++)
+						collapseLocked[remap[simplifiedIndices[adjacency.triangles[t] * 3 + k]]] = 1;
+			}
+
+			collapseLocked[r1] = 1;
+
+			addQuadric(quadrics[r1], quadrics[r0]);
+			largestCost = std::max(largestCost, collapse.cost);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+			break;
+
+		size_t writeIndex = 0;
+
+		for (size_t i = 0; i < simplifiedIndices.size(); i += 3)
+		{
+			uint32_t a = collapseRemap[simplifiedIndices[i + 0]];
+			uint32_t b = collapseRemap[simplifiedIndices[i + 1]];
+			uint32_t c = collapseRemap[simplifiedIndices[i + 2]];
+
+			if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c])
+				continue;
+
+			simplifiedIndices[writeIndex++] = a;
+			simplifiedIndices[writeIndex++] = b;
+			simplifiedIndices[writeIndex++] = c;
+		}
+
+		simplifiedIndices.resize(writeIndex);
+
+		buildAdjacency(simplifiedIndices, vertexCount, adjacency);
+		findOpenEdges(adjacency, simplifiedIndices, vertexCount, openOut, openIn);
+	}
+
+	return std::sqrt(largestCost);
+}
+
+void generateMeshLODs(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, uint32_t maxLODCount, std::vector<std::vector<uint32_t>> &lodIndices, std::vector<float> &lodErrors)
+{
+	lodIndices.assign(1, std::vector<uint32_t>(indices, indices + indexCount));
+	lodErrors.assign(1, 0.0f);
+
+	float error = 0.0f;
+
+	for (uint32_t lod = 1; lod < maxLODCount; lod++)
+	{
+		const std::vector<uint32_t> &previousLOD = lodIndices.back();
+		size_t targetIndexCount = (previousLOD.size() / 6) * 3;
+
+		if (targetIndexCount == 0 || error >= MESH_LOD_MAX_ERROR)
+			break;
+
+		// Errors add up along the chain, so each LOD only gets what's left of the error budget
+		std::vector<uint32_t> simplifiedIndices;
+		float lodError = simplifyMesh(vertices, vertexCount, previousLOD.data(), previousLOD.size(), targetIndexCount, MESH_LOD_MAX_ERROR - error, simplifiedIndices);
+
+		if (simplifiedIndices.size() == 0 || float(simplifiedIndices.size()) > float(previousLOD.size()) * MESH_LOD_MIN_REDUCTION)
+			break;
+
+		error += lodError;
+
+		lodIndices.push_back(simplifiedIndices);
+		lodErrors.push_back(error);
+	}
+}
@@ -0,0 +1,34 @@
+#ifndef RESOURCES_MESHSIMPLIFIER_H_
+#define RESOURCES_MESHSIMPLIFIER_H_
+
+#include <common.h>
+
+#include <Resources/ResourceManager.h>
+
+#define MESH_LOD_MAX_ERROR 0.05f // The most a LOD's surface can move, relative to the largest side of the mesh's bounding box
+#define MESH_LOD_MIN_REDUCTION 0.85f // A LOD has to have at most this many of the previous LOD's triangles, otherwise the chain stops there
+
+/*
+Simplifies a triangle list by collapsing edges in order of their quadric error, writing the new index list to 'simplifiedIndices'. No new
+vertices are made, every collapse moves a vertex onto one of it's neighbours, so the result indexes into the same vertex data and the
+vertex normals/tangents/uvs are all left as they were.
+
+Vertices that share a position but have different attributes (uv seams, hard normal edges, mirrored tangents) are only collapsed along
+the seam, together w/ their twin on the other side of it, and vertices on a mesh border only slide along the border. Anything more complex
+(seams meeting at a corner, non-manifold edges) is locked in place. A collapse between two vertices w/ different normals costs more, and
+no collapse is allowed to flip a triangle.
+
+Stops once there are at most 'targetIndexCount' indices left, or once every collapse left would move the surface more than 'maxError'
+(relative to the largest side of the mesh's bounding box). Returns the largest error of any collapse that was made. The result only depends
+on the input, so the same mesh always simplifies to the same indices.
+*/
+float simplifyMesh(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float maxError, std::vector<uint32_t> &simplifiedIndices);
+
+/*
+Builds up to 'maxLODCount' LODs (including LOD 0, which is the input), each w/ about half the triangles of the one before it. Each LOD is
+simplified from the previous one, and the chain stops early if a LOD can't be made w/ less than MESH_LOD_MIN_REDUCTION of the previous
+one's triangles within MESH_LOD_MAX_ERROR. 'lodErrors' gets each LOD's error relative to the full mesh, LOD 0's is always 0.
+*/
+void generateMeshLODs(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, uint32_t maxLODCount, std::vector<std::vector<uint32_t>> &lodIndices, std::vector<float> &lodErrors);
+
+#endif /* RESOURCES_MESHSIMPLIFIER_H_ */
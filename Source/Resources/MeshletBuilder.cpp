@@ -0,0 +1,104 @@
+#include "Resources/MeshletBuilder.h"
+
+#define MESHLET_NO_MESHLET (~0u)
+
+// Cones w/ normals spread this close to 90 degrees from the axis are hardly ever back facing, so they aren't worth testing
+#define MESHLET_MIN_CONE_DOT 0.1f
+
+static ModelMeshlet computeMeshletBounds(const NonSkinnedVertex *vertices, const uint32_t *indices, uint32_t firstIndex, uint32_t triangleCount)
+{
+	glm::vec3 boundsMin = vertices[indices[firstIndex]].vertex;
+	glm::vec3 boundsMax = boundsMin;
+
+	for (uint32_t i = firstIndex; i < firstIndex + triangleCount * 3; i++)
+	{
+		boundsMin = glm::min(boundsMin, vertices[indices[i]].vertex);
+		boundsMax = glm::max(boundsMax, vertices[indices[i]].vertex);
+	}
+
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	float radius = 0.0f;
+
+	for (uint32_t i = firstIndex; i < firstIndex + triangleCount * 3; i++)
+		radius = std::max(radius, glm::length(vertices[indices[i]].vertex - center));
+
+	std::vector<glm::vec3> triangleNormals;
+	triangleNormals.reserve(triangleCount);
+
+	glm::vec3 normalSum = glm::vec3(0.0f);
+
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		const uint32_t *triangle = &indices[firstIndex + t * 3];
+		glm::vec3 normal = glm::cross(vertices[triangle[1]].vertex - vertices[triangle[0]].vertex, vertices[triangle[2]].vertex - vertices[triangle[0]].vertex);
+		float length = glm::length(normal);
+
+		// Degenerate triangles can't be seen from any side
+		if (length == 0.0f)
+			continue;
+
+		triangleNormals.push_back(normal / length);
+		normalSum += normal / length;
+	}
+
+	float normalSumLength = glm::length(normalSum);
+	glm::vec3 coneAxis = normalSumLength > 0.0f ? normalSum / normalSumLength : glm::vec3(0.0f, 0.0f, 1.0f);
+	float minDot = normalSumLength > 0.0f ? 1.0f : -1.0f;
+
+	for (const glm::vec3 &normal : triangleNormals)
+		minDot = std::min(minDot, glm::dot(coneAxis, normal));
+
+	ModelMeshlet meshlet = {};
+	meshlet.boundingSphere = glm::vec4(center, radius);
+	meshlet.coneAxis_cutoff = glm::vec4(coneAxis, minDot <= MESHLET_MIN_CONE_DOT ? 1.0f : std::sqrt(1.0f - minDot * minDot));
+	meshlet.firstIndex = firstIndex;
+	meshlet.triangleCount = triangleCount;
+	meshlet.vertexOffset = 0;
+
+	return meshlet;
+}
+
+void buildMeshlets(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, std::vector<ModelMeshlet> &meshlets)
+{
+	meshlets.clear();
+
+	// The last meshlet each vertex was added to, so checking if a vertex is already in the current meshlet is a single lookup
+	std::vector<uint32_t> vertexMeshlets(vertexCount, MESHLET_NO_MESHLET);
+
+	uint32_t meshletIndex = 0;
+	uint32_t meshletFirstIndex = 0;
+	uint32_t meshletTriangleCount = 0;
+	uint32_t meshletVertexCount = 0;
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const uint32_t *triangle = &indices[i];
+		uint32_t newVertexCount = 0;
+
+		for (int k = 0; k < 3; k++)
+			if (vertexMeshlets[triangle[k]] != meshletIndex && (k == 0 || triangle[k] != triangle[0]) && (k < 2 || triangle[k] != triangle[1]))
+				newVertexCount++;
+
+		if (meshletTriangleCount > 0 && (meshletVertexCount + newVertexCount > MODEL_MESHLET_MAX_VERTICES || meshletTriangleCount == MODEL_MESHLET_MAX_TRIANGLES))
+		{
+			meshlets.push_back(computeMeshletBounds(vertices, indices, meshletFirstIndex, meshletTriangleCount));
+
+			meshletIndex++;
+			meshletFirstIndex = uint32_t(i);
+			meshletTriangleCount = 0;
+			meshletVertexCount = 0;
+
+			// Every vertex is new to an empty meshlet
+			newVertexCount = 1 + (triangle[1] != triangle[0] ? 1 : 0) + (triangle[2] != triangle[0] && triangle[2] != triangle[1] ? 1 : 0);
+		}
+
+		for (int k = 0; k < 3; k++)
+			vertexMeshlets[triangle[k]] = meshletIndex;
+
+		meshletVertexCount += newVertexCount;
+		meshletTriangleCount++;
+	}
+
+	if (meshletTriangleCount > 0)
+		meshlets.push_back(computeMeshletBounds(vertices, indices, meshletFirstIndex, meshletTriangleCount));
+}
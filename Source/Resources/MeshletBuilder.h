@@ -0,0 +1,16 @@
+#ifndef RESOURCES_MESHLETBUILDER_H_
+#define RESOURCES_MESHLETBUILDER_H_
+
+#include <common.h>
+
+#include <Resources/ResourceManager.h>
+
+/*
+Splits a triangle list into meshlets of consecutive triangles, starting a new one whenever the next triangle would take it past
+MODEL_MESHLET_MAX_VERTICES unique vertices or MODEL_MESHLET_MAX_TRIANGLES triangles. The triangles aren't reordered, so the list should
+already be in vertex cache order (see optimizeMeshVertexCache()) for the meshlets to be compact. Each meshlet's firstIndex is relative to
+'indices' and it's vertexOffset is 0.
+*/
+void buildMeshlets(const NonSkinnedVertex *vertices, size_t vertexCount, const uint32_t *indices, size_t indexCount, std::vector<ModelMeshlet> &meshlets);
+
+#endif /* RESOURCES_MESHLETBUILDER_H_ */
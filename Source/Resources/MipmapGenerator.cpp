@@ -0,0 +1,614 @@
+#include "Resources/MipmapGenerator.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#define MIPMAP_GENERATOR_SSE2
+#endif
+
+// Roughly how many texels of a level each job filters
+#define MIPMAP_GENERATOR_BAND_TEXELS (64 * 1024)
+
+// Linear values are looked up in a table this big to convert them back to sRGB, which is fine enough to stay w/in one code of the exact value
+#define MIPMAP_GENERATOR_SRGB_TABLE_SIZE 16384
+
+#define MIPMAP_GENERATOR_KAISER_ALPHA 4.0
+#define MIPMAP_GENERATOR_KAISER_RADIUS 1.5 // In texels of the level being generated
+
+static double sRGBToLinearExact(double value)
+{
+	return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+}
+
+static double linearToSRGBExact(double value)
+{
+	return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+struct MipmapGeneratorTables
+{
+	float byteToLinear[256];
+	float byteToFloat[256];
+	uint8_t linearToSRGB[MIPMAP_GENERATOR_SRGB_TABLE_SIZE];
+
+	MipmapGeneratorTables()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			byteToLinear[i] = float(sRGBToLinearExact(i / 255.0));
+			byteToFloat[i] = float(i / 255.0);
+		}
+
+		for (uint32_t i = 0; i < MIPMAP_GENERATOR_SRGB_TABLE_SIZE; i++)
+			linearToSRGB[i] = uint8_t(std::floor(linearToSRGBExact(i / double(MIPMAP_GENERATOR_SRGB_TABLE_SIZE - 1)) * 255.0 + 0.5));
+	}
+};
+
+static const MipmapGeneratorTables &getMipmapGeneratorTables()
+{
+	static MipmapGeneratorTables tables;
+
+	return tables;
+}
+
+/*
+The source texels (clamped to the edge) and their weights for every texel along one axis of a level, tapCount for each texel
+*/
+struct MipmapFilterTaps
+{
+	uint32_t tapCount;
+	std::vector<uint32_t> indices;
+	std::vector<float> weights;
+};
+
+static double besselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+
+	for (int k = 1; k < 64; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+
+		if (term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+static void buildMipmapFilterTaps(uint32_t srcSize, uint32_t dstSize, MipmapFilter filter, MipmapFilterTaps &taps)
+{
+	if (srcSize == dstSize)
+	{
+		taps.tapCount = 1;
+		taps.indices.assign(dstSize, 0);
+		taps.weights.assign(dstSize, 1.0f);
+
+		for (uint32_t x = 0; x < dstSize; x++)
+			taps.indices[x] = x;
+
+		return;
+	}
+
+	if (filter == MIPMAP_FILTER_BOX)
+	{
+		bool oddSize = srcSize != dstSize * 2;
+
+		taps.tapCount = oddSize ? 3 : 2;
+		taps.indices.resize(dstSize * taps.tapCount);
+		taps.weights.resize(dstSize * taps.tapCount);
+
+		for (uint32_t x = 0; x < dstSize; x++)
+		{
+			for (uint32_t t = 0; t < taps.tapCount; t++)
+				taps.indices[x * taps.tapCount + t] = x * 2 + t;
+
+			// Each texel covers (2n + 1) / n texels of the level above, which overlaps 3 of them by different amounts
+			if (oddSize)
+			{
+				taps.weights[x * 3 + 0] = float(dstSize - x) / float(srcSize);
+				taps.weights[x * 3 + 1] = float(dstSize) / float(srcSize);
+				taps.weights[x * 3 + 2] = float(x + 1) / float(srcSize);
+			}
+			else
+			{
+				taps.weights[x * 2 + 0] = 0.5f;
+				taps.weights[x * 2 + 1] = 0.5f;
+			}
+		}
+
+		return;
+	}
+
+	const double scale = double(srcSize) / double(dstSize);
+	const double radius = MIPMAP_GENERATOR_KAISER_RADIUS * scale;
+	const double kaiserNormalize = 1.0 / besselI0(MIPMAP_GENERATOR_KAISER_ALPHA);
+
+	taps.tapCount = uint32_t(std::floor(radius * 2.0)) + 1;
+	taps.indices.resize(dstSize * taps.tapCount);
+	taps.weights.resize(dstSize * taps.tapCount);
+
+	for (uint32_t x = 0; x < dstSize; x++)
+	{
+		double center = (x + 0.5) * scale - 0.5;
+		int64_t first = int64_t(std::ceil(center - radius));
+
+		double weightSum = 0.0;
+		std::vector<double> weights(taps.tapCount);
+
+		for (uint32_t t = 0; t < taps.tapCount; t++)
+		{
+			double distance = double(first + t) - center;
+			double windowPos = distance / radius;
+
+			if (std::abs(windowPos) < 1.0)
+			{
+				double sincX = glm::pi<double>() * distance / scale;
+				double sinc = std::abs(sincX) < 1e-9 ? 1.0 : std::sin(sincX) / sincX;
+
+				weights[t] = sinc * besselI0(MIPMAP_GENERATOR_KAISER_ALPHA * std::sqrt(1.0 - windowPos * windowPos)) * kaiserNormalize;
+			}
+			else
+				weights[t] = 0.0;
+
+			weightSum += weights[t];
+		}
+
+		for (uint32_t t = 0; t < taps.tapCount; t++)
+		{
+			taps.indices[x * taps.tapCount + t] = uint32_t(glm::clamp<int64_t>(first + t, 0, int64_t(srcSize) - 1));
+			taps.weights[x * taps.tapCount + t] = float(weights[t] / weightSum);
+		}
+	}
+}
+
+/*
+Everything the band jobs of one level share, the level above is read straight from it's 8 bit data
+*/
+struct MipmapLevelJobData
+{
+	const MipmapGeneratorOptions *options;
+
+	const uint8_t *srcData;
+	uint32_t srcWidth;
+	uint32_t srcHeight;
+
+	uint8_t *dstData;
+	uint32_t dstWidth;
+	uint32_t dstHeight;
+
+	MipmapFilterTaps tapsX;
+	MipmapFilterTaps tapsY;
+};
+
+struct MipmapBandJobData
+{
+	const MipmapLevelJobData *level;
+	uint32_t firstRow;
+	uint32_t rowCount;
+};
+
+/*
+Converts a row to floats (and linear space), premultiplied by alpha if the texels are alpha weighted
+*/
+static void linearizeMipmapRow(const MipmapGeneratorOptions &options, const uint8_t *srcRow, uint32_t width, float *dstRow)
+{
+	const MipmapGeneratorTables &tables = getMipmapGeneratorTables();
+	const float *colorTable = options.sRGB ? tables.byteToLinear : tables.byteToFloat;
+
+	for (uint32_t x = 0; x < width; x++)
+	{
+		const uint8_t *texel = srcRow + x * 4;
+
+#ifdef MIPMAP_GENERATOR_SSE2
+		__m128 value = _mm_setr_ps(colorTable[texel[0]], colorTable[texel[1]], colorTable[texel[2]], tables.byteToFloat[texel[3]]);
+
+		if (options.alphaWeighted)
+			value = _mm_mul_ps(value, _mm_setr_ps(tables.byteToFloat[texel[3]], tables.byteToFloat[texel[3]], tables.byteToFloat[texel[3]], 1.0f));
+
+		_mm_storeu_ps(dstRow + x * 4, value);
+#else
+		float alpha = tables.byteToFloat[texel[3]];
+		float colorScale = options.alphaWeighted ? alpha : 1.0f;
+
+		dstRow[x * 4 + 0] = colorTable[texel[0]] * colorScale;
+		dstRow[x * 4 + 1] = colorTable[texel[1]] * colorScale;
+		dstRow[x * 4 + 2] = colorTable[texel[2]] * colorScale;
+		dstRow[x * 4 + 3] = alpha;
+#endif
+	}
+}
+
+/*
+Undoes the alpha weighting and converts a filtered row back to 8 bits
+*/
+static void encodeMipmapRow(const MipmapGeneratorOptions &options, const float *srcRow, uint32_t width, uint8_t *dstRow)
+{
+	const MipmapGeneratorTables &tables = getMipmapGeneratorTables();
+
+#ifdef MIPMAP_GENERATOR_SSE2
+	const float colorScale = options.sRGB ? float(MIPMAP_GENERATOR_SRGB_TABLE_SIZE - 1) : 255.0f;
+	const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	const __m128 alphaMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+	for (uint32_t x = 0; x < width; x++)
+	{
+		__m128 value = _mm_loadu_ps(srcRow + x * 4);
+
+		if (options.alphaWeighted)
+		{
+			__m128 alpha = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3));
+			__m128 hasAlpha = _mm_cmpgt_ps(alpha, zero);
+
+			// Texels w/ no alpha left have no color either
+			__m128 color = _mm_and_ps(_mm_div_ps(value, _mm_max_ps(alpha, _mm_set1_ps(1e-8f))), hasAlpha);
+			value = _mm_or_ps(_mm_andnot_ps(alphaMask, color), _mm_and_ps(alphaMask, value));
+		}
+
+		value = _mm_min_ps(_mm_max_ps(value, zero), one);
+
+		__m128i codes = _mm_cvtps_epi32(_mm_mul_ps(value, scale));
+
+		if (options.sRGB)
+		{
+			alignas(16) int32_t indices[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(indices), codes);
+
+			dstRow[x * 4 + 0] = tables.linearToSRGB[indices[0]];
+			dstRow[x * 4 + 1] = tables.linearToSRGB[indices[1]];
+			dstRow[x * 4 + 2] = tables.linearToSRGB[indices[2]];
+			dstRow[x * 4 + 3] = uint8_t(indices[3]);
+		}
+		else
+		{
+			codes = _mm_packs_epi32(codes, codes);
+			codes = _mm_packus_epi16(codes, codes);
+
+			int32_t texel = _mm_cvtsi128_si32(codes);
+			memcpy(dstRow + x * 4, &texel, 4);
+		}
+	}
+#else
+	for (uint32_t x = 0; x < width; x++)
+	{
+		const float *texel = srcRow + x * 4;
+		float alpha = glm::clamp(texel[3], 0.0f, 1.0f);
+		float colorScale = options.alphaWeighted ? (texel[3] > 0.0f ? 1.0f / std::max(texel[3], 1e-8f) : 0.0f) : 1.0f;
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			float color = glm::clamp(texel[c] * colorScale, 0.0f, 1.0f);
+
+			if (options.sRGB)
+				dstRow[x * 4 + c] = tables.linearToSRGB[uint32_t(color * float(MIPMAP_GENERATOR_SRGB_TABLE_SIZE - 1) + 0.5f)];
+			else
+				dstRow[x * 4 + c] = uint8_t(color * 255.0f + 0.5f);
+		}
+
+		dstRow[x * 4 + 3] = uint8_t(alpha * 255.0f + 0.5f);
+	}
+#endif
+}
+
+/*
+dstRow += rowWeight * srcRow, for 'count' floats
+*/
+static void accumulateMipmapRow(const float *srcRow, float rowWeight, size_t count, float *dstRow)
+{
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	const __m256 weight8 = _mm256_set1_ps(rowWeight);
+
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dstRow + i, _mm256_add_ps(_mm256_loadu_ps(dstRow + i), _mm256_mul_ps(_mm256_loadu_ps(srcRow + i), weight8)));
+#endif
+
+#ifdef MIPMAP_GENERATOR_SSE2
+	const __m128 weight4 = _mm_set1_ps(rowWeight);
+
+	// Rows are always whole RGBA texels, so there's never anything left over after this
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(dstRow + i, _mm_add_ps(_mm_loadu_ps(dstRow + i), _mm_mul_ps(_mm_loadu_ps(srcRow + i), weight4)));
+#endif
+
+	for (; i < count; i++)
+		dstRow[i] += srcRow[i] * rowWeight;
+}
+
+static void filterMipmapRowHorizontal(const float *srcRow, const MipmapFilterTaps &tapsX, uint32_t dstWidth, float *dstRow)
+{
+	for (uint32_t x = 0; x < dstWidth; x++)
+	{
+		const uint32_t *indices = tapsX.indices.data() + x * tapsX.tapCount;
+		const float *weights = tapsX.weights.data() + x * tapsX.tapCount;
+
+#ifdef MIPMAP_GENERATOR_SSE2
+		__m128 sum = _mm_setzero_ps();
+
+		for (uint32_t t = 0; t < tapsX.tapCount; t++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(srcRow + indices[t] * 4), _mm_set1_ps(weights[t])));
+
+		_mm_storeu_ps(dstRow + x * 4, sum);
+#else
+		float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+		for (uint32_t t = 0; t < tapsX.tapCount; t++)
+			for (uint32_t c = 0; c < 4; c++)
+				sum[c] += srcRow[indices[t] * 4 + c] * weights[t];
+
+		memcpy(dstRow + x * 4, sum, sizeof(sum));
+#endif
+	}
+}
+
+/*
+Filters a band of rows, vertically into a row as wide as the level above and then horizontally. The linearized rows of the level above
+are kept in a small ring, since each one is used by a few rows in a row.
+*/
+void mipmapBandJobFunction(Job *job)
+{
+	const MipmapBandJobData *band = reinterpret_cast<const MipmapBandJobData*>(job->usrData);
+	const MipmapLevelJobData &level = *band->level;
+
+	const uint32_t rowCacheSize = level.tapsY.tapCount + 1;
+	const size_t srcRowFloats = size_t(level.srcWidth) * 4;
+
+	std::vector<float> rowCache(rowCacheSize * srcRowFloats);
+	std::vector<int64_t> rowCacheRows(rowCacheSize, -1);
+	std::vector<float> verticalRow(srcRowFloats), filteredRow(size_t(level.dstWidth) * 4);
+
+	for (uint32_t y = band->firstRow; y < band->firstRow + band->rowCount; y++)
+	{
+		std::fill(verticalRow.begin(), verticalRow.end(), 0.0f);
+
+		for (uint32_t t = 0; t < level.tapsY.tapCount; t++)
+		{
+			uint32_t srcY = level.tapsY.indices[y * level.tapsY.tapCount + t];
+			float weight = level.tapsY.weights[y * level.tapsY.tapCount + t];
+
+			if (weight == 0.0f)
+				continue;
+
+			uint32_t cacheSlot = srcY % rowCacheSize;
+			float *linearRow = rowCache.data() + cacheSlot * srcRowFloats;
+
+			if (rowCacheRows[cacheSlot] != int64_t(srcY))
+			{
+				linearizeMipmapRow(*level.options, level.srcData + size_t(srcY) * level.srcWidth * 4, level.srcWidth, linearRow);
+				rowCacheRows[cacheSlot] = srcY;
+			}
+
+			accumulateMipmapRow(linearRow, weight, srcRowFloats, verticalRow.data());
+		}
+
+		filterMipmapRowHorizontal(verticalRow.data(), level.tapsX, level.dstWidth, filteredRow.data());
+		encodeMipmapRow(*level.options, filteredRow.data(), level.dstWidth, level.dstData + size_t(y) * level.dstWidth * 4);
+	}
+}
+
+/*
+The scalar reference, filters one level w/ doubles and the exact sRGB curves
+*/
+static void generateImageMipReference(const MipmapLevelJobData &level, std::vector<uint8_t> &dstData)
+{
+	const MipmapGeneratorOptions &options = *level.options;
+	std::vector<double> srcLinear(size_t(level.srcWidth) * level.srcHeight * 4);
+
+	for (size_t i = 0; i < size_t(level.srcWidth) * level.srcHeight; i++)
+	{
+		double alpha = level.srcData[i * 4 + 3] / 255.0;
+
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			double color = level.srcData[i * 4 + c] / 255.0;
+			srcLinear[i * 4 + c] = (options.sRGB ? sRGBToLinearExact(color) : color) * (options.alphaWeighted ? alpha : 1.0);
+		}
+
+		srcLinear[i * 4 + 3] = alpha;
+	}
+
+	dstData.resize(size_t(level.dstWidth) * level.dstHeight * 4);
+
+	for (uint32_t y = 0; y < level.dstHeight; y++)
+	{
+		for (uint32_t x = 0; x < level.dstWidth; x++)
+		{
+			double sum[4] = {0.0, 0.0, 0.0, 0.0};
+
+			for (uint32_t ty = 0; ty < level.tapsY.tapCount; ty++)
+			{
+				for (uint32_t tx = 0; tx < level.tapsX.tapCount; tx++)
+				{
+					double weight = double(level.tapsY.weights[y * level.tapsY.tapCount + ty]) * double(level.tapsX.weights[x * level.tapsX.tapCount + tx]);
+					size_t srcTexel = size_t(level.tapsY.indices[y * level.tapsY.tapCount + ty]) * level.srcWidth + level.tapsX.indices[x * level.tapsX.tapCount + tx];
+
+					for (uint32_t c = 0; c < 4; c++)
+						sum[c] += srcLinear[srcTexel * 4 + c] * weight;
+				}
+			}
+
+			uint8_t *dstTexel = &dstData[(size_t(y) * level.dstWidth + x) * 4];
+
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				double color = options.alphaWeighted ? (sum[3] > 0.0 ? sum[c] / sum[3] : 0.0) : sum[c];
+				color = glm::clamp(color, 0.0, 1.0);
+
+				dstTexel[c] = uint8_t(std::floor((options.sRGB ? linearToSRGBExact(color) : color) * 255.0 + 0.5));
+			}
+
+			dstTexel[3] = uint8_t(std::floor(glm::clamp(sum[3], 0.0, 1.0) * 255.0 + 0.5));
+		}
+	}
+}
+
+uint32_t getImageMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t mipLevelCount = 1;
+
+	while (width > 1 || height > 1)
+	{
+		width = std::max(width >> 1, 1u);
+		height = std::max(height >> 1, 1u);
+		mipLevelCount++;
+	}
+
+	return mipLevelCount;
+}
+
+void generateImageMipmaps(const uint8_t *imageData, uint32_t width, uint32_t height, const MipmapGeneratorOptions &options, std::vector<std::vector<uint8_t>> &mipmaps)
+{
+	uint32_t mipLevelCount = getImageMipLevelCount(width, height);
+
+	mipmaps.resize(mipLevelCount);
+	mipmaps[0].assign(imageData, imageData + size_t(width) * height * 4);
+
+	for (uint32_t m = 1; m < mipLevelCount; m++)
+	{
+		MipmapLevelJobData level = {};
+		level.options = &options;
+		level.srcData = mipmaps[m - 1].data();
+		level.srcWidth = std::max(width >> (m - 1), 1u);
+		level.srcHeight = std::max(height >> (m - 1), 1u);
+		level.dstWidth = std::max(width >> m, 1u);
+		level.dstHeight = std::max(height >> m, 1u);
+
+		mipmaps[m].resize(size_t(level.dstWidth) * level.dstHeight * 4);
+		level.dstData = mipmaps[m].data();
+
+		buildMipmapFilterTaps(level.srcWidth, level.dstWidth, options.filter, level.tapsX);
+		buildMipmapFilterTaps(level.srcHeight, level.dstHeight, options.filter, level.tapsY);
+
+		uint32_t bandRowCount = std::max<uint32_t>(MIPMAP_GENERATOR_BAND_TEXELS / level.dstWidth, 1);
+		std::vector<MipmapBandJobData> bands;
+
+		for (uint32_t row = 0; row < level.dstHeight; row += bandRowCount)
+			bands.push_back({&level, row, std::min(bandRowCount, level.dstHeight - row)});
+
+		std::vector<Job*> bandJobs;
+		Job *levelJob = JobSystem::get()->allocateJob(nullptr);
+
+		for (MipmapBandJobData &band : bands)
+		{
+			Job *bandJob = JobSystem::get()->allocateJobAsChild(levelJob, mipmapBandJobFunction);
+			bandJob->usrData = &band;
+
+			bandJobs.push_back(bandJob);
+		}
+
+		JobSystem::get()->runJobs(bandJobs);
+		JobSystem::get()->runJob(levelJob);
+		JobSystem::get()->waitForJob(levelJob);
+	}
+}
+
+bool testImageMipmapGenerator()
+{
+	typedef struct
+	{
+		const char *name;
+		uint32_t width;
+		uint32_t height;
+		MipmapGeneratorOptions options;
+	} MipmapGeneratorTestCase;
+
+	const MipmapGeneratorTestCase testCases[] = {
+		{"linear box", 64, 64, {MIPMAP_FILTER_BOX, false, false}},
+		{"sRGB box", 64, 64, {MIPMAP_FILTER_BOX, true, false}},
+		{"linear alpha weighted box", 64, 64, {MIPMAP_FILTER_BOX, false, true}},
+		{"sRGB alpha weighted box", 64, 64, {MIPMAP_FILTER_BOX, true, true}},
+		{"linear kaiser", 64, 64, {MIPMAP_FILTER_KAISER, false, false}},
+		{"sRGB alpha weighted kaiser", 64, 64, {MIPMAP_FILTER_KAISER, true, true}},
+		{"odd sized box", 37, 11, {MIPMAP_FILTER_BOX, true, true}},
+		{"odd sized kaiser", 45, 23, {MIPMAP_FILTER_KAISER, true, true}},
+		{"non square box", 128, 16, {MIPMAP_FILTER_BOX, true, false}},
+		{"single column", 1, 29, {MIPMAP_FILTER_BOX, false, true}},
+		{"single row", 77, 1, {MIPMAP_FILTER_KAISER, true, false}}
+	};
+
+	bool passed = true;
+
+	for (const MipmapGeneratorTestCase &testCase : testCases)
+	{
+		// A gradient w/ hashed noise on top, every 7th texel is fully transparent so alpha weighting has something to keep out of the lower mips
+		std::vector<uint8_t> imageData(size_t(testCase.width) * testCase.height * 4);
+
+		for (uint32_t y = 0; y < testCase.height; y++)
+		{
+			for (uint32_t x = 0; x < testCase.width; x++)
+			{
+				uint32_t hash = (x * 73856093u) ^ (y * 19349663u);
+				hash ^= hash >> 13;
+				hash *= 0x5bd1e995u;
+				hash ^= hash >> 15;
+
+				uint8_t *texel = &imageData[(size_t(y) * testCase.width + x) * 4];
+				texel[0] = uint8_t((x * 255) / std::max(testCase.width - 1, 1u)) ^ uint8_t(hash & 0x1F);
+				texel[1] = uint8_t((y * 255) / std::max(testCase.height - 1, 1u)) ^ uint8_t((hash >> 5) & 0x1F);
+				texel[2] = uint8_t(hash >> 8);
+				texel[3] = (size_t(y) * testCase.width + x) % 7 == 0 ? 0 : uint8_t(64 + (hash >> 16) % 192);
+			}
+		}
+
+		std::vector<std::vector<uint8_t>> mipmaps;
+		generateImageMipmaps(imageData.data(), testCase.width, testCase.height, testCase.options, mipmaps);
+
+		if (mipmaps.size() != getImageMipLevelCount(testCase.width, testCase.height))
+		{
+			Log::get()->error("MipmapGenerator test: \"{}\" generated {} mips, expected {}", testCase.name, mipmaps.size(), getImageMipLevelCount(testCase.width, testCase.height));
+			passed = false;
+
+			continue;
+		}
+
+		// Each level is checked against the reference filtering the generated level above it, so a bad level doesn't fail every level below it
+		for (uint32_t m = 1; m < uint32_t(mipmaps.size()); m++)
+		{
+			MipmapLevelJobData level = {};
+			level.options = &testCase.options;
+			level.srcData = mipmaps[m - 1].data();
+			level.srcWidth = std::max(testCase.width >> (m - 1), 1u);
+			level.srcHeight = std::max(testCase.height >> (m - 1), 1u);
+			level.dstWidth = std::max(testCase.width >> m, 1u);
+			level.dstHeight = std::max(testCase.height >> m, 1u);
+
+			buildMipmapFilterTaps(level.srcWidth, level.dstWidth, testCase.options.filter, level.tapsX);
+			buildMipmapFilterTaps(level.srcHeight, level.dstHeight, testCase.options.filter, level.tapsY);
+
+			std::vector<uint8_t> referenceData;
+			generateImageMipReference(level, referenceData);
+
+			if (mipmaps[m].size() != referenceData.size())
+			{
+				Log::get()->error("MipmapGenerator test: \"{}\" mip {} is {} bytes, expected {}x{} texels", testCase.name, m, mipmaps[m].size(), level.dstWidth, level.dstHeight);
+				passed = false;
+
+				break;
+			}
+
+			int maxDifference = 0;
+
+			for (size_t i = 0; i < referenceData.size(); i++)
+				maxDifference = std::max(maxDifference, std::abs(int(referenceData[i]) - int(mipmaps[m][i])));
+
+			// The sRGB encode table is only guaranteed to be w/in one code of the exact curve
+			if (maxDifference > 1)
+			{
+				Log::get()->error("MipmapGenerator test: \"{}\" mip {} ({}x{}) is off from the reference by up to {}", testCase.name, m, level.dstWidth, level.dstHeight, maxDifference);
+				passed = false;
+			}
+		}
+	}
+
+	if (passed)
+		Log::get()->info("MipmapGenerator test passed");
+
+	return passed;
+}
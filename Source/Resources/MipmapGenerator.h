@@ -0,0 +1,40 @@
+#ifndef RESOURCES_MIPMAPGENERATOR_H_
+#define RESOURCES_MIPMAPGENERATOR_H_
+
+#include <common.h>
+
+typedef enum MipmapFilter
+{
+	MIPMAP_FILTER_BOX = 0, // 2x2 average, or a 3 tap box on axes w/ an odd size
+	MIPMAP_FILTER_KAISER, // Kaiser windowed sinc, sharper w/o the aliasing of a plain box
+	MIPMAP_FILTER_MAX_ENUM
+} MipmapFilter;
+
+typedef struct MipmapGeneratorOptions
+{
+	MipmapFilter filter;
+	bool sRGB; // Red, green and blue are sRGB encoded, and are filtered in linear space
+	bool alphaWeighted; // Red, green and blue are weighted by alpha, so fully transparent texels don't bleed their color into the lower mips
+} MipmapGeneratorOptions;
+
+/*
+The number of mips in a full chain down to 1x1
+*/
+uint32_t getImageMipLevelCount(uint32_t width, uint32_t height);
+
+/*
+Generates a full mip chain for an 8 bit RGBA image, w/ each level tightly packed and mipmaps[0] a copy of the image. Each level is made
+from the one above it, every texel is converted to floats (and to linear space), filtered, and converted back. Sizes that aren't powers
+of 2 are halved and rounded down, the filter's taps are weighted so every texel of the level above still contributes evenly. Each level is
+split into bands of rows that are filtered in parallel on the job system.
+*/
+void generateImageMipmaps(const uint8_t *imageData, uint32_t width, uint32_t height, const MipmapGeneratorOptions &options, std::vector<std::vector<uint8_t>> &mipmaps);
+
+/*
+Generates the mips of a few synthetic images (sRGB & linear, alpha weighted, odd & non square sizes) w/ both filters, and checks every
+level against a slow scalar version of the filter that uses doubles and the exact sRGB curves. Logs an error for each level that's off
+by more than one code, and returns false if any were.
+*/
+bool testImageMipmapGenerator();
+
+#endif /* RESOURCES_MIPMAPGENERATOR_H_ */
@@ -3,784 +3,3115 @@
 #include <Game/KalosEngine.h>
 
 #include <RendererCore/Renderer.h>
+#include <RendererCore/UploadManager.h>
 
 #include <Resources/FileLoader.h>
 #include <Resources/ResourceImporter.h>
+#include <Resources/MeshSimplifier.h>
+#include <Resources/MeshOptimizer.h>
+#include <Resources/MeshletBuilder.h>
+#include <Resources/MipmapGenerator.h>
+#include <Resources/ImageDecoder.h>
 
-#include <lodepng.h>
 #include <picosha2.h>
 #include <Compressonator.h>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtc/packing.hpp>
 
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #define TINYGLTF_NO_INCLUDE_STB_IMAGE_WRITE
 
 #include <tiny_gltf.h>
 
+#include <filesystem>
+
+// A LOD is used once it's error would be less than MODEL_LOD_MAX_PIXEL_ERROR pixels on a MODEL_LOD_REFERENCE_SCREEN_HEIGHT pixel tall screen
+#define MODEL_LOD_REFERENCE_SCREEN_HEIGHT 1080.0f
+#define MODEL_LOD_MAX_PIXEL_ERROR 1.0f
+
+#define RESOURCE_TEXTURE_COMPRESSION_TILE_SIZE (64 * 1024) // Roughly how many bytes of blocks each compression job outputs
+#define RESOURCE_TEXTURE_COMPRESSION_MAX_TILE_JOBS 1024
+#define RESOURCE_TEXTURE_IMPORT_MAX_JOBS 1024
+
+/*
+A texture decoded on the job system, waiting to be uploaded
+*/
+struct TextureImportData
+{
+	ResourceFormat format;
+	uint32_t width;
+	uint32_t height;
+
+	std::vector<uint8_t> data; // Every mip one after the other, in the same layout as a KET file
+	std::vector<size_t> mipOffsets; // Empty if there's no texture
+
+	// Set when the decode job wrote the mips straight into staging memory instead of into data, mipOffsets are then offsets into it
+	StagingBuffer stagingBuffer = nullptr;
+	std::vector<uint32_t> mipRowPitches;
+
+	bool generateMipmaps; // Only mip 0 is imported, the rest are generated on the GPU after it's uploaded. Only set if the renderer can blit textures
+
+	// Set for a texture that's streamed from it's texture cache entry, only the mips from firstMip down are imported (width and height are firstMip's)
+	std::string streamingCacheFile;
+	uint32_t firstMip = 0;
+	uint32_t fullWidth = 0;
+	uint32_t fullHeight = 0;
+	uint32_t fullMipLevels = 0;
+
+	uint64_t cacheKey = 0; // The texture cache entry of a model texture, the model cache refers to it's textures by these
+};
+
+/*
+A model texture whose mips are streamed from it's texture cache entry. The texture only ever has the mips from residentMip down, changing
+which mips are resident reads them into a new texture that replaces the old one once it's upload has finished. Evicting is the same as
+streaming in, just w/ fewer mips, the smaller mips are read again instead of being copied over on the GPU.
+*/
+struct StreamedTexture
+{
+	MaterialResource *material;
+	uint32_t slot;
+
+	std::string cacheFile;
+	ResourceFormat format;
+	uint32_t width; // Of the whole texture
+	uint32_t height;
+	uint32_t mipLevels;
+	uint32_t minResidentMip; // The least detailed it's ever allowed to be
+	std::vector<size_t> mipChainSizes; // The size of the mips from each mip down
+
+	uint32_t residentMip;
+	uint32_t wantedMip;
+	uint64_t lastRequestFrame;
+
+	TextureStreamingLoad *load; // nullptr unless a load is in flight
+	bool streamingFailed; // A load failed, so the texture is left w/ the mips it has
+};
+
+struct TextureStreamingLoad
+{
+	ResourceManager *resourceManager;
+	StreamedTexture *texture;
+	uint32_t firstMip;
+
+	TextureImportData textureData; // Read straight into staging memory by the load's job
+	bool succeeded;
+	std::atomic<bool> readFinished;
+
+	Texture newTexture; // Once the read has finished
+	TextureView newTextureView;
+	uint64_t uploadBatchID;
+};
+
+/*
+Everything a material or model load needs between it's decode job and the end of it's upload. The decode job only writes to the request
+and the resource being loaded, everything else is done on the main thread by ResourceManager::update().
+*/
+struct ResourceLoadRequest
+{
+	ResourceManager *resourceManager;
+
+	MaterialResource *material; // Only one of these is set
+	ModelResource *model;
+
+	std::vector<MaterialResource*> materials; // The material being loaded, or the model's materials
+	std::vector<TextureImportData> textures; // MATERIAL_MAX_TEXTURE_COUNT for each of the materials
+	std::vector<Texture> uploadedTextures; // Given to the materials once the upload has finished
+	std::vector<TextureView> uploadedTextureViews;
+
+	std::vector<uint8_t> modelIndexBuffer;
+	std::vector<uint8_t> modelVertexBuffer;
+	bool use32bitIndices;
+
+	StagingBuffer modelStagingBuffer; // Set instead of the index and vertex buffers for a model from the model cache, laid out like it's model buffer
+
+	bool decodeSucceeded;
+	std::atomic<bool> decodeFinished;
+
+	uint64_t uploadBatchID; // The upload manager batch the last of it's uploads were recorded into
+
+	TextureCompressionTier textureCompressionTier; // The resource manager's tier when the load was made
+};
+
+/*
+A model cache file is laid out as:
+	ModelCacheHeader
+	ModelCacheNode[nodeCount] - every mesh node depth first, each one followed by it's children
+	ModelMeshDrawPrimitive[drawPrimitiveCount] - the draw primitives of each node, in the same order as the nodes
+	ModelCacheMaterial[materialCount]
+	ModelMeshlet[meshletCount]
+	glm::vec3[occluderVertexCount] - the model's occluder mesh, see ModelResource::occluderVertices
+	uint32_t[occluderIndexCount]
+	The model buffer up to meshletDataOffset, so the index data and the vertex data already in the model's vertex format
+Textures aren't in the model cache, it's materials only have the keys of their textures' texture cache entries.
+*/
+#define RESOURCE_MODEL_CACHE_MAGIC 0x20434d4b // "KMC "
+
+struct ModelCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceFileSize; // The model is imported again once it's source file's size or write time changes
+	int64_t sourceFileWriteTime;
+
+	uint32_t vertexFormat;
+	uint32_t textureCompressionTier;
+	uint32_t uses32BitIndices;
+	uint32_t lodCount;
+	float lodScreenCoverages[MODEL_MAX_LOD_LEVELS];
+	glm::vec4 vertexPositionOffset_scale;
+
+	uint32_t rootNodeCount;
+	uint32_t nodeCount;
+	uint32_t drawPrimitiveCount;
+	uint32_t materialCount;
+	uint64_t meshletCount;
+	uint32_t occluderVertexCount;
+	uint32_t occluderIndexCount;
+	uint64_t vertexDataOffset;
+	uint64_t meshletDataOffset;
+};
+
+struct ModelCacheNode
+{
+	glm::vec4 position_scale;
+	glm::quat orientation;
+	uint32_t drawPrimitiveCount;
+	uint32_t childCount;
+};
+
+struct ModelCacheMaterial
+{
+	uint64_t materialID;
+	uint64_t textureCacheKeys[MATERIAL_TEXTURE_SLOT_MAX_ENUM];
+	uint32_t textureFormats[MATERIAL_TEXTURE_SLOT_MAX_ENUM];
+};
+
+/*
+How a model texture is compressed for a material slot. The decoded image is always rearranged to RGBA before it's mips are generated
+and it's compressed, BC4 and BC5 only keep red or red and green.
+*/
+struct TextureCompressionPreset
+{
+	ResourceFormat format;
+	int sourceChannels[4]; // Which channel of the decoded image goes in each channel, -1 for the default value
+	uint8_t defaultValues[4]; // Also the color of the blank texture used when a material doesn't have a texture for the slot
+
+	bool sRGB; // Mips are filtered in linear space
+	bool alphaWeighted; // Mips are filtered w/ the color weighted by alpha
+};
+
+static const TextureCompressionPreset textureCompressionPresets[MATERIAL_TEXTURE_SLOT_MAX_ENUM] = {
+	{RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK, {0, 1, 2, -1}, {255, 255, 255, 255}, true, false},
+	{RESOURCE_FORMAT_BC7_UNORM_BLOCK, {0, 1, 2, -1}, {128, 128, 255, 255}, false, false},
+	{RESOURCE_FORMAT_BC5_UNORM_BLOCK, {1, 2, -1, -1}, {255, 255, 0, 255}, false, false},
+	{RESOURCE_FORMAT_BC4_UNORM_BLOCK, {0, -1, -1, -1}, {255, 255, 255, 255}, false, false}
+};
+
+// Albedo for materials that use alpha
+static const TextureCompressionPreset textureCompressionPresetAlbedoAlpha = {RESOURCE_FORMAT_BC7_UNORM_BLOCK, {0, 1, 2, 3}, {255, 255, 255, 255}, true, true};
+
+// Compressonator's quality and the mip filter for each tier, BC7 takes a lot longer w/ each step up
+static const float textureCompressionTierQualities[TEXTURE_COMPRESSION_TIER_MAX_ENUM] = {0.0f, 0.05f, 0.6f};
+static const MipmapFilter textureCompressionTierMipmapFilters[TEXTURE_COMPRESSION_TIER_MAX_ENUM] = {MIPMAP_FILTER_BOX, MIPMAP_FILTER_KAISER, MIPMAP_FILTER_KAISER};
+
+/*
+A texture that wasn't in the texture cache, w/ it's mips decoded and waiting to be compressed into texture->data
+*/
+struct TextureCompileData
+{
+	TextureImportData *texture;
+	std::string cacheFile;
+	int imageIndex;
+
+	float quality;
+	std::vector<std::vector<uint8_t>> imageMipmaps; // Always RGBA
+};
+
+struct MaterialTextureDecodeJobData
+{
+	ResourceManager *resourceManager;
+	ResourceLoadRequest *request;
+	int textureIndex;
+
+	bool succeeded;
+};
+
+struct GLTFTextureImportJobData
+{
+	ResourceManager *resourceManager;
+	tinygltf::Model *model;
+	const std::vector<uint64_t> *imageContentHashes;
+
+	int materialIndex;
+	int imageIndex;
+	MaterialTextureSlot slot;
+	bool usesAlpha;
+	TextureCompressionTier tier;
+	TextureImportData *texture;
+
+	std::vector<TextureCompileData> texturesToCompile; // Only has the texture if it wasn't in the texture cache
+	bool succeeded;
+};
+
+struct TextureCompressionTileJobData
+{
+	const uint8_t *srcData;
+	uint32_t width;
+	uint32_t height;
+	float quality;
+
+	CMP_FORMAT dstFormat;
+	uint8_t *dstData;
+	size_t dstDataSize;
+
+	CMP_ERROR status;
+};
+
+struct ModelPrimitiveJobData
+{
+	std::vector<NonSkinnedVertex> vertices;
+	std::vector<uint32_t> indices;
+	size_t importedVertexCount;
+
+	std::vector<std::vector<uint32_t>> lodIndices;
+	std::vector<float> lodErrors;
+	std::vector<ModelMeshlet> meshlets;
+
+	float importedACMR;
+	float optimizedACMR;
+};
+
+/*
+Welds the primitive's vertices, orders LOD 0 for the vertex cache and then overdraw, generates the LODs from that and orders them for
+the vertex cache too, puts the vertices in the order the LODs fetch them, and finally splits LOD 0 into meshlets
+*/
+void modelPrimitiveJobFunction(Job *job)
+{
+	ModelPrimitiveJobData *jobData = reinterpret_cast<ModelPrimitiveJobData*>(job->usrData);
+
+	jobData->importedVertexCount = jobData->vertices.size();
+	jobData->importedACMR = calculateMeshACMR(jobData->indices.data(), jobData->indices.size(), jobData->vertices.size());
+
+	weldMeshVertices(jobData->vertices, jobData->indices);
+
+	std::vector<uint32_t> clusters;
+	optimizeMeshVertexCache(jobData->indices, jobData->vertices.size(), &clusters);
+	optimizeMeshOverdraw(jobData->indices, jobData->vertices, clusters, MESH_OVERDRAW_THRESHOLD);
+
+	generateMeshLODs(jobData->vertices.data(), jobData->vertices.size(), jobData->indices.data(), jobData->indices.size(), MODEL_MAX_LOD_LEVELS, jobData->lodIndices, jobData->lodErrors);
+
+	std::vector<std::vector<uint32_t>*> indexLists = {&jobData->lodIndices[0]};
+
+	for (size_t lod = 1; lod < jobData->lodIndices.size(); lod++)
+	{
+		optimizeMeshVertexCache(jobData->lodIndices[lod], jobData->vertices.size(), nullptr);
+		indexLists.push_back(&jobData->lodIndices[lod]);
+	}
+
+	optimizeMeshVertexFetch(jobData->vertices, indexLists);
+
+	jobData->optimizedACMR = calculateMeshACMR(jobData->lodIndices[0].data(), jobData->lodIndices[0].size(), jobData->vertices.size());
+
+	buildMeshlets(jobData->vertices.data(), jobData->vertices.size(), jobData->lodIndices[0].data(), jobData->lodIndices[0].size(), jobData->meshlets);
+}
+
+/*
+Fills in the offset of each mip of a texture laid out like a KET file, and returns the size of all of them together
+*/
+static size_t getTextureMipOffsets(ResourceFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, std::vector<size_t> &mipOffsets)
+{
+	size_t textureDataSize = 0;
+	mipOffsets.clear();
+
+	for (uint32_t m = 0; m < mipLevels; m++)
+	{
+		uint32_t rowSize, rowCount;
+		UploadManager::getTextureSubresourceSize(format, std::max(width >> m, 1u), std::max(height >> m, 1u), rowSize, rowCount);
+
+		mipOffsets.push_back(textureDataSize);
+		textureDataSize += size_t(rowSize) * rowCount;
+	}
+
+	return textureDataSize;
+}
+
+/*
+The least detailed mip a streamed texture is ever left w/, the first one no bigger than RESOURCE_TEXTURE_STREAMING_MIN_SIZE. Block
+compressed textures have to start at a mip whose size is a multiple of the block size, so those stop at a more detailed mip if needed.
+*/
+static uint32_t getTextureStreamingMinMip(ResourceFormat format, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	uint32_t minMip = 0;
+
+	while (minMip + 1 < mipLevels && std::max(width >> minMip, height >> minMip) > RESOURCE_TEXTURE_STREAMING_MIN_SIZE)
+		minMip++;
+
+	if (isCompressedFormat(format))
+		while (minMip > 0 && ((std::max(width >> minMip, 1u) % 4) != 0 || (std::max(height >> minMip, 1u) % 4) != 0))
+			minMip--;
+
+	return minMip;
+}
+
+static size_t getTextureMemorySize(Texture texture)
+{
+	std::vector<size_t> mipOffsets;
+
+	return getTextureMipOffsets(texture->textureFormat, texture->width, texture->height, texture->mipCount, mipOffsets);
+}
+
+static size_t getModelMeshNodesSize(const std::vector<ModelMeshNode> &nodes)
+{
+	size_t size = nodes.size() * sizeof(ModelMeshNode);
+
+	for (const ModelMeshNode &node : nodes)
+		size += node.drawPrimitives.size() * sizeof(ModelMeshDrawPrimitive) + getModelMeshNodesSize(node.children);
+
+	return size;
+}
+
+/*
+A material of an imported model, it's textures are the engine's white texture until the model is loaded
+*/
+static MaterialResource *createModelMaterial(uint64_t materialID, TextureView whiteTextureView)
+{
+	MaterialResource *material = new MaterialResource();
+	material->materialID = materialID;
+	material->pipelineID = 0;
+	material->loadState = RESOURCE_LOAD_STATE_LOADING;
+	material->gpuMemorySize = 0;
+
+	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+	{
+		material->materialTextures[i] = nullptr;
+		material->materialTextureViews[i] = whiteTextureView;
+		material->materialTexturesLowestLoadedLevel[i] = 0;
+	}
+
+	material->requestedScreenSize = 0.0f;
+
+	return material;
+}
+
+/*
+Takes a staging buffer w/ room for the texture's mips from the upload manager's pool, laid out the same way the upload manager lays out
+it's own texture uploads, so a decode job can write straight into it. The pool can be used from the job system.
+*/
+static uint8_t *allocateTextureImportStaging(UploadManager *uploadManager, TextureImportData &textureData, uint32_t mipLevels)
+{
+	size_t stagingSize = UploadManager::getTextureStagingLayout(textureData.format, textureData.width, textureData.height, mipLevels, textureData.mipOffsets, textureData.mipRowPitches);
+	uint8_t *stagingData;
+
+	textureData.stagingBuffer = uploadManager->acquirePooledStagingBuffer(stagingSize, stagingData);
+
+	return stagingData;
+}
+
+static void freeTextureImportStaging(UploadManager *uploadManager, TextureImportData &textureData)
+{
+	if (textureData.stagingBuffer == nullptr)
+		return;
+
+	uploadManager->freePooledStagingBuffer(textureData.stagingBuffer);
+
+	textureData.stagingBuffer = nullptr;
+	textureData.mipOffsets.clear();
+	textureData.mipRowPitches.clear();
+}
+
+/*
+Records copying every mip of the texture through the upload manager, leaving it in TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. A texture
+that's already in it's own staging buffer is copied from there, and the buffer is handed over to the upload manager.
+*/
+static Texture recordTextureUpload(Renderer *renderer, UploadManager *uploadManager, TextureImportData &textureData)
+{
+	uint32_t mipLevelCount = textureData.generateMipmaps ? getImageMipLevelCount(textureData.width, textureData.height) : uint32_t(textureData.mipOffsets.size());
+	TextureUsageFlags usage = TEXTURE_USAGE_SAMPLED_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT | (textureData.generateMipmaps ? TEXTURE_USAGE_TRANSFER_SRC_BIT : 0);
+
+	Texture texture = renderer->createTexture({textureData.width, textureData.height, 1}, textureData.format, usage, MEMORY_USAGE_GPU_ONLY, false, mipLevelCount, 1, 1);
+
+	ResourceBarrier barrier0 = {};
+	barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
+	barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
+	barrier0.textureTransition.newLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier0.textureTransition.subresourceRange = {0, mipLevelCount, 0, 1};
+	barrier0.textureTransition.texture = texture;
+
+	ResourceBarrier barrier1 = {};
+	barrier1.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
+	barrier1.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier1.textureTransition.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier1.textureTransition.subresourceRange = {0, mipLevelCount, 0, 1};
+	barrier1.textureTransition.texture = texture;
+
+	uploadManager->recordBarriers({barrier0});
+
+	if (textureData.stagingBuffer != nullptr)
+	{
+		for (uint32_t m = 0; m < textureData.mipOffsets.size(); m++)
+			uploadManager->uploadTextureFromStaging(textureData.stagingBuffer, textureData.mipOffsets[m], textureData.mipRowPitches[m], texture, m, 0);
+
+		uploadManager->releaseStagingBuffer(textureData.stagingBuffer);
+		textureData.stagingBuffer = nullptr;
+	}
+	else
+	{
+		for (uint32_t m = 0; m < textureData.mipOffsets.size(); m++)
+			uploadManager->uploadTexture(texture, m, 0, textureData.data.data() + textureData.mipOffsets[m]);
+	}
+
+	if (textureData.generateMipmaps)
+		uploadManager->recordGenerateMipmaps(texture, TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL, TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	else
+		uploadManager->recordBarriers({barrier1});
+
+	return texture;
+}
+
 ResourceManager::ResourceManager(KalosEngine *enginePtr)
 {
 	engine = enginePtr;
 	renderer = engine->renderer.get();
+	uploadManager = engine->uploadManager.get();
+
+	modelVertexFormat = MODEL_VERTEX_FORMAT_FULL;
+	textureCompressionTier = TEXTURE_COMPRESSION_TIER_NORMAL;
+
+	textureStreamingBudget = RESOURCE_TEXTURE_STREAMING_DEFAULT_BUDGET;
+	textureStreamingResidentSize = 0;
+	frameIndex = 0;
+
+	cpuMemoryBudget = RESOURCE_DEFAULT_CPU_MEMORY_BUDGET;
+	gpuMemoryBudget = RESOURCE_DEFAULT_GPU_MEMORY_BUDGET;
+	cpuMemoryUsage = 0;
+	gpuMemoryUsage = 0;
+
+	// stb_image reads PNGs too, lodepng is added after it so it's tried first for them
+	addImageDecoder(std::unique_ptr<ImageDecoder>(new STBImageDecoder()));
+	addImageDecoder(std::unique_ptr<ImageDecoder>(new LodePNGImageDecoder()));
+
+	std::error_code createDirectoryError;
+	std::filesystem::create_directories(FileLoader::instance()->getWorkingDir() + RESOURCE_TEXTURE_CACHE_DIRECTORY, createDirectoryError);
+
+	if (createDirectoryError)
+		Log::get()->warn("ResourceManager: Couldn't create the texture cache directory, compiled textures won't be cached. Error: {}", createDirectoryError.message());
+
+	std::filesystem::create_directories(FileLoader::instance()->getWorkingDir() + RESOURCE_MODEL_CACHE_DIRECTORY, createDirectoryError);
+
+	if (createDirectoryError)
+		Log::get()->warn("ResourceManager: Couldn't create the model cache directory, models will be imported every time. Error: {}", createDirectoryError.message());
+}
+
+ResourceManager::~ResourceManager()
+{
+	// The decode jobs still write to their requests, so they have to finish before anything is freed
+	for (ResourceLoadRequest *request : pendingLoadRequests)
+	{
+		while (!request->decodeFinished)
+			std::this_thread::yield();
+
+		for (TextureImportData &textureData : request->textures)
+			freeTextureImportStaging(uploadManager, textureData);
+
+		// Only the materials of a model that was never uploaded aren't registered
+		if (request->model != nullptr)
+			for (MaterialResource *material : request->materials)
+				delete material;
+
+		delete request;
+	}
+
+	pendingLoadRequests.clear();
+
+	// Their textures and buffers can't be destroyed while they're still being copied to
+	if (uploadingLoadRequests.size() > 0)
+		uploadManager->waitForBatch(uploadingLoadRequests.back()->uploadBatchID);
+
+	for (ResourceLoadRequest *request : uploadingLoadRequests)
+		finishLoadRequest(request, true);
+
+	uploadingLoadRequests.clear();
+
+	// Same goes for streaming loads, the streamed textures themselves are destroyed w/ their materials below
+	for (TextureStreamingLoad *load : textureStreamingLoads)
+	{
+		while (!load->readFinished)
+			std::this_thread::yield();
+
+		if (load->newTexture != nullptr)
+			uploadManager->waitForBatch(load->uploadBatchID);
+
+		freeTextureImportStaging(uploadManager, load->textureData);
+
+		if (load->newTexture != nullptr)
+		{
+			renderer->destroyTexture(load->newTexture);
+			renderer->destroyTextureView(load->newTextureView);
+		}
+
+		delete load;
+	}
+
+	for (StreamedTexture *texture : streamedTextures)
+		delete texture;
+
+	textureStreamingLoads.clear();
+	streamedTextures.clear();
+
+	// The engine waits for the device to be idle before destroying the resource manager, so nothing has to be retired anymore
+	destroyRetiredGPUResources(true);
+
+	materialResources.forEach([&](ResourceHandle, MaterialResource *material) {
+		for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+		{
+			if (material->materialTextures[i] != nullptr)
+			{
+				renderer->destroyTexture(material->materialTextures[i]);
+				renderer->destroyTextureView(material->materialTextureViews[i]);
+			}
+		}
+
+		delete material;
+	});
+
+	modelResources.forEach([&](ResourceHandle, ModelResource *model) {
+		if (model->modelBuffer != nullptr)
+			renderer->destroyBuffer(model->modelBuffer);
+
+		delete model;
+	});
+}
+
+/*
+Projects a unit vector onto an octahedron and unfolds it into a square, w/ the lower half folded over the diagonals
+*/
+glm::vec2 encodeOctahedral(glm::vec3 normal)
+{
+	normal /= (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+
+	glm::vec2 encoded = glm::vec2(normal.x, normal.y);
+
+	if (normal.z < 0.0f)
+	{
+		encoded.x = (1.0f - glm::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+		encoded.y = (1.0f - glm::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return encoded;
+}
+
+static void encodeOctahedralSnorm16(const glm::vec4 &vector, int16_t *encoded)
+{
+	glm::vec3 direction = glm::vec3(vector);
+	glm::vec2 octahedral = glm::dot(direction, direction) > 0.0f ? encodeOctahedral(direction) : glm::vec2(0.0f);
+
+	encoded[0] = int16_t(glm::packSnorm1x16(octahedral.x));
+	encoded[1] = int16_t(glm::packSnorm1x16(octahedral.y));
+}
+
+static void encodeHalf2(const glm::vec2 &value, uint16_t *encoded)
+{
+	encoded[0] = glm::packHalf1x16(value.x);
+	encoded[1] = glm::packHalf1x16(value.y);
+}
+
+void ResourceManager::loadRequestJobFunction(Job *job)
+{
+	ResourceLoadRequest *request = reinterpret_cast<ResourceLoadRequest*>(job->usrData);
+
+	if (request->model != nullptr)
+		request->decodeSucceeded = request->resourceManager->decodeGLTFModel(request);
+	else
+		request->decodeSucceeded = request->resourceManager->decodeMaterial(request);
+
+	request->decodeFinished = true;
+}
+
+void ResourceManager::runLoadRequest(ResourceLoadRequest *request)
+{
+	request->resourceManager = this;
+	request->use32bitIndices = false;
+	request->modelStagingBuffer = nullptr;
+	request->decodeSucceeded = false;
+	request->decodeFinished = false;
+
+	// The request keeps the resource from being evicted until it's finished
+	if (request->model != nullptr)
+		modelResources.acquire(request->model->handle);
+	else
+		materialResources.acquire(request->material->handle);
+
+	pendingLoadRequests.push_back(request);
+
+	Job *job = JobSystem::get()->allocateJob(&ResourceManager::loadRequestJobFunction);
+	job->usrData = request;
+
+	JobSystem::get()->runJob(job);
+}
+
+void ResourceManager::waitForLoadRequest(ResourceLoadState *loadState)
+{
+	// The decode job is already running, so this only has to keep the uploads going until the resource is finished
+	while (*loadState == RESOURCE_LOAD_STATE_LOADING)
+	{
+		update();
+
+		if (*loadState != RESOURCE_LOAD_STATE_LOADING)
+			break;
+
+		if (uploadingLoadRequests.size() > 0)
+			uploadManager->waitForBatch(uploadingLoadRequests.front()->uploadBatchID);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void ResourceManager::update()
+{
+	// Requests are recorded in order, so they finish in order too
+	size_t finishedRequestCount = 0;
+
+	while (finishedRequestCount < uploadingLoadRequests.size() && uploadManager->isBatchFinished(uploadingLoadRequests[finishedRequestCount]->uploadBatchID))
+		finishLoadRequest(uploadingLoadRequests[finishedRequestCount++], true);
+
+	uploadingLoadRequests.erase(uploadingLoadRequests.begin(), uploadingLoadRequests.begin() + finishedRequestCount);
+
+	for (auto requestIt = pendingLoadRequests.begin(); requestIt != pendingLoadRequests.end();)
+	{
+		ResourceLoadRequest *request = *requestIt;
+
+		if (!request->decodeFinished)
+		{
+			requestIt++;
+
+			continue;
+		}
+
+		if (!request->decodeSucceeded)
+		{
+			finishLoadRequest(request, false);
+			requestIt = pendingLoadRequests.erase(requestIt);
+
+			continue;
+		}
+
+		recordLoadRequestUploads(request);
+		uploadingLoadRequests.push_back(request);
+		requestIt = pendingLoadRequests.erase(requestIt);
+	}
+
+	frameIndex++;
+
+	updateTextureStreaming();
+	evictUnusedResources();
+	destroyRetiredGPUResources(false);
+}
+
+uint32_t ResourceManager::getPendingLoadCount() const
+{
+	return uint32_t(pendingLoadRequests.size() + uploadingLoadRequests.size());
+}
+
+void ResourceManager::requestModelTextureDetail(ResourceHandle modelHandle, float screenCoverage)
+{
+	ModelResource *model = getModel(modelHandle);
+
+	if (model == nullptr)
+		return;
+
+	float screenSize = screenCoverage * float(engine->mainWindow->getHeight());
+
+	for (MaterialResource *material : model->materials)
+		material->requestedScreenSize = std::max(material->requestedScreenSize, screenSize);
+}
+
+void ResourceManager::setTextureStreamingBudget(size_t budget)
+{
+	textureStreamingBudget = budget;
+}
+
+size_t ResourceManager::getTextureStreamingBudget() const
+{
+	return textureStreamingBudget;
+}
+
+size_t ResourceManager::getTextureStreamingResidentSize() const
+{
+	return textureStreamingResidentSize;
+}
+
+void ResourceManager::registerStreamedTexture(MaterialResource *material, uint32_t slot, const TextureImportData &textureData)
+{
+	StreamedTexture *texture = new StreamedTexture();
+	texture->material = material;
+	texture->slot = slot;
+	texture->cacheFile = textureData.streamingCacheFile;
+	texture->format = textureData.format;
+	texture->width = textureData.fullWidth;
+	texture->height = textureData.fullHeight;
+	texture->mipLevels = textureData.fullMipLevels;
+	texture->minResidentMip = getTextureStreamingMinMip(texture->format, texture->width, texture->height, texture->mipLevels);
+	texture->residentMip = textureData.firstMip;
+	texture->wantedMip = textureData.firstMip;
+	texture->lastRequestFrame = frameIndex;
+	texture->load = nullptr;
+	texture->streamingFailed = false;
+
+	std::vector<size_t> mipOffsets;
+	size_t textureDataSize = getTextureMipOffsets(texture->format, texture->width, texture->height, texture->mipLevels, mipOffsets);
+
+	for (uint32_t m = 0; m < texture->mipLevels; m++)
+		texture->mipChainSizes.push_back(textureDataSize - mipOffsets[m]);
+
+	textureStreamingResidentSize += texture->mipChainSizes[texture->residentMip];
+	streamedTextures.push_back(texture);
+}
+
+void ResourceManager::startTextureStreamingLoad(StreamedTexture *texture, uint32_t firstMip)
+{
+	TextureStreamingLoad *load = new TextureStreamingLoad();
+	load->resourceManager = this;
+	load->texture = texture;
+	load->firstMip = firstMip;
+	load->textureData.generateMipmaps = false;
+	load->succeeded = false;
+	load->readFinished = false;
+	load->newTexture = nullptr;
+	load->newTextureView = nullptr;
+	load->uploadBatchID = 0;
+
+	texture->load = load;
+	textureStreamingLoads.push_back(load);
+
+	Job *job = JobSystem::get()->allocateJob(&ResourceManager::textureStreamingLoadJobFunction);
+	job->usrData = load;
+
+	JobSystem::get()->runJob(job);
+}
+
+void ResourceManager::textureStreamingLoadJobFunction(Job *job)
+{
+	TextureStreamingLoad *load = reinterpret_cast<TextureStreamingLoad*>(job->usrData);
+	StreamedTexture *texture = load->texture;
+
+	// The cache entry could have been replaced since the texture was first loaded, so it has to still start at the same mip
+	load->succeeded = load->resourceManager->loadKETTexture(texture->cacheFile, texture->format, load->textureData, load->firstMip) && load->textureData.firstMip == load->firstMip && load->textureData.fullMipLevels == texture->mipLevels;
+
+	if (!load->succeeded)
+		freeTextureImportStaging(load->resourceManager->uploadManager, load->textureData);
+
+	load->readFinished = true;
+}
+
+void ResourceManager::updateTextureStreaming()
+{
+	// Loads are recorded into the upload batch once their read has finished, and swapped in once the batch has
+	for (auto loadIt = textureStreamingLoads.begin(); loadIt != textureStreamingLoads.end();)
+	{
+		TextureStreamingLoad *load = *loadIt;
+		StreamedTexture *texture = load->texture;
+
+		if (!load->readFinished)
+		{
+			loadIt++;
+
+			continue;
+		}
+
+		if (!load->succeeded)
+		{
+			Log::get()->warn("ResourceManager: Couldn't stream mip {} of texture cache entry \"{}\", leaving it w/ mip {}", load->firstMip, texture->cacheFile, texture->residentMip);
+
+			texture->load = nullptr;
+			texture->streamingFailed = true;
+
+			delete load;
+			loadIt = textureStreamingLoads.erase(loadIt);
+
+			continue;
+		}
+
+		if (load->newTexture == nullptr)
+		{
+			load->newTexture = recordTextureUpload(renderer, uploadManager, load->textureData);
+			load->newTextureView = renderer->createTextureView(load->newTexture, TEXTURE_VIEW_TYPE_2D, {0, load->newTexture->mipCount, 0, 1});
+			load->uploadBatchID = uploadManager->getCurrentBatchID();
+
+			loadIt++;
+
+			continue;
+		}
+
+		if (!uploadManager->isBatchFinished(load->uploadBatchID))
+		{
+			loadIt++;
+
+			continue;
+		}
+
+		// The old texture could still be used by a frame in flight
+		MaterialResource *material = texture->material;
+		retiredGPUResources.push_back({material->materialTextures[texture->slot], material->materialTextureViews[texture->slot], nullptr, frameIndex});
+
+		size_t residentSizeChange = texture->mipChainSizes[load->firstMip] - texture->mipChainSizes[texture->residentMip];
+		material->gpuMemorySize += residentSizeChange;
+		gpuMemoryUsage += residentSizeChange;
+
+		material->materialTextures[texture->slot] = load->newTexture;
+		material->materialTextureViews[texture->slot] = load->newTextureView;
+		material->materialTexturesLowestLoadedLevel[texture->slot] = load->firstMip;
+
+		textureStreamingResidentSize = textureStreamingResidentSize - texture->mipChainSizes[texture->residentMip] + texture->mipChainSizes[load->firstMip];
+		texture->residentMip = load->firstMip;
+		texture->load = nullptr;
+
+		delete load;
+		loadIt = textureStreamingLoads.erase(loadIt);
+	}
+
+	// The mip that has about one texel per pixel when the texture's stretched once across it's material's screen size
+	for (StreamedTexture *texture : streamedTextures)
+	{
+		float screenSize = texture->material->requestedScreenSize;
+
+		if (screenSize > 0.0f)
+		{
+			float texelsPerPixel = float(std::max(texture->width, texture->height)) / screenSize;
+			uint32_t mip = texelsPerPixel > 1.0f ? uint32_t(std::floor(std::log2(texelsPerPixel))) : 0;
+
+			texture->wantedMip = std::min(mip, texture->minResidentMip);
+			texture->lastRequestFrame = frameIndex;
+		}
+		else if (frameIndex - texture->lastRequestFrame > RESOURCE_TEXTURE_STREAMING_REQUEST_FRAMES)
+			texture->wantedMip = texture->minResidentMip;
+	}
+
+	materialResources.forEach([](ResourceHandle, MaterialResource *material) {
+		material->requestedScreenSize = 0.0f;
+	});
+
+	// What every texture will take up once the loads in flight have been swapped in
+	size_t projectedResidentSize = textureStreamingResidentSize;
+
+	for (TextureStreamingLoad *load : textureStreamingLoads)
+		projectedResidentSize = projectedResidentSize - load->texture->mipChainSizes[load->texture->residentMip] + load->texture->mipChainSizes[load->firstMip];
+
+	std::vector<StreamedTexture*> upgradeTextures;
+	std::vector<StreamedTexture*> evictableTextures;
+
+	for (StreamedTexture *texture : streamedTextures)
+	{
+		if (texture->load != nullptr || texture->streamingFailed)
+			continue;
+
+		if (texture->wantedMip < texture->residentMip)
+			upgradeTextures.push_back(texture);
+		else if (texture->residentMip < texture->minResidentMip)
+			evictableTextures.push_back(texture);
+	}
+
+	// Evicting first frees up room in the budget for the upgrades below
+	for (StreamedTexture *texture : evictableTextures)
+	{
+		if (textureStreamingLoads.size() >= RESOURCE_TEXTURE_STREAMING_MAX_LOADS)
+			return;
+
+		if (texture->residentMip >= texture->wantedMip)
+			continue;
+
+		projectedResidentSize -= texture->mipChainSizes[texture->residentMip] - texture->mipChainSizes[texture->wantedMip];
+		startTextureStreamingLoad(texture, texture->wantedMip);
+	}
+
+	// The textures that were asked for most recently come first, then the ones missing the most mips
+	std::sort(upgradeTextures.begin(), upgradeTextures.end(), [](const StreamedTexture *a, const StreamedTexture *b) {
+		if (a->lastRequestFrame != b->lastRequestFrame)
+			return a->lastRequestFrame > b->lastRequestFrame;
+
+		return a->residentMip - a->wantedMip > b->residentMip - b->wantedMip;
+	});
+
+	// The ones asked for the longest time ago are evicted first when the upgrades don't fit
+	std::sort(evictableTextures.begin(), evictableTextures.end(), [](const StreamedTexture *a, const StreamedTexture *b) {
+		return a->lastRequestFrame < b->lastRequestFrame;
+	});
+
+	size_t nextEvictableTexture = 0;
+
+	for (StreamedTexture *texture : upgradeTextures)
+	{
+		if (textureStreamingLoads.size() >= RESOURCE_TEXTURE_STREAMING_MAX_LOADS)
+			return;
+
+		size_t residentSize = texture->mipChainSizes[texture->residentMip];
+
+		while (projectedResidentSize - residentSize + texture->mipChainSizes[texture->wantedMip] > textureStreamingBudget && nextEvictableTexture < evictableTextures.size() && textureStreamingLoads.size() + 1 < RESOURCE_TEXTURE_STREAMING_MAX_LOADS)
+		{
+			StreamedTexture *evictedTexture = evictableTextures[nextEvictableTexture++];
+
+			// Textures asked for at the same time are never evicted for one another
+			if (evictedTexture->lastRequestFrame >= texture->lastRequestFrame)
+			{
+				nextEvictableTexture = evictableTextures.size();
+
+				break;
+			}
+
+			if (evictedTexture->load != nullptr || evictedTexture->residentMip >= evictedTexture->minResidentMip)
+				continue;
+
+			projectedResidentSize -= evictedTexture->mipChainSizes[evictedTexture->residentMip] - evictedTexture->mipChainSizes[evictedTexture->minResidentMip];
+			evictedTexture->wantedMip = evictedTexture->minResidentMip;
+			startTextureStreamingLoad(evictedTexture, evictedTexture->minResidentMip);
+		}
+
+		// Whatever still doesn't fit is streamed in only as far as it does
+		uint32_t firstMip = texture->wantedMip;
+
+		while (firstMip < texture->residentMip && projectedResidentSize - residentSize + texture->mipChainSizes[firstMip] > textureStreamingBudget)
+			firstMip++;
+
+		if (firstMip == texture->residentMip)
+			continue;
+
+		projectedResidentSize = projectedResidentSize - residentSize + texture->mipChainSizes[firstMip];
+		startTextureStreamingLoad(texture, firstMip);
+	}
+}
+
+void ResourceManager::recordLoadRequestUploads(ResourceLoadRequest *request)
+{
+	request->uploadedTextures.assign(request->textures.size(), nullptr);
+	request->uploadedTextureViews.assign(request->textures.size(), nullptr);
+
+	for (size_t t = 0; t < request->textures.size(); t++)
+	{
+		TextureImportData &textureData = request->textures[t];
+
+		if (textureData.mipOffsets.size() == 0)
+			continue;
+
+		request->uploadedTextures[t] = recordTextureUpload(renderer, uploadManager, textureData);
+		request->uploadedTextureViews[t] = renderer->createTextureView(request->uploadedTextures[t], TEXTURE_VIEW_TYPE_2D, {0, request->uploadedTextures[t]->mipCount, 0, 1});
+
+		// The upload ring has it's own copy now
+		std::vector<uint8_t>().swap(textureData.data);
+	}
+
+	if (request->model != nullptr)
+	{
+		ModelResource *modelResource = request->model;
+
+		// A model's materials are only registered once it's decoded, until then they're placeholders like any other loading material
+		for (MaterialResource *material : request->materials)
+		{
+			registerMaterial(material);
+			materialResources.acquire(material->handle);
+		}
+
+		// The cluster culling shader reads the index data and meshlets straight out of the model buffer, w/ 16 byte loads for the meshlets
+		size_t meshletDataSize = modelResource->meshlets.size() * sizeof(ModelMeshlet);
+
+		// A model from the model cache already has it's offsets, and the whole buffer in a staging buffer of it's own
+		if (request->modelStagingBuffer == nullptr)
+		{
+			modelResource->vertexDataOffset = request->modelIndexBuffer.size();
+			modelResource->meshletDataOffset = (request->modelIndexBuffer.size() + request->modelVertexBuffer.size() + 15) & ~size_t(15);
+		}
+
+		modelResource->uses32BitIndices = request->use32bitIndices;
+		modelResource->modelBuffer = renderer->createBuffer(modelResource->meshletDataOffset + meshletDataSize, BUFFER_USAGE_INDEX_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT | BUFFER_USAGE_STORAGE_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY, false);
+
+		if (request->modelStagingBuffer != nullptr)
+		{
+			uploadManager->uploadBufferFromStaging(request->modelStagingBuffer, 0, modelResource->modelBuffer, 0, modelResource->meshletDataOffset + meshletDataSize);
+			uploadManager->releaseStagingBuffer(request->modelStagingBuffer);
+			request->modelStagingBuffer = nullptr;
+		}
+		else
+		{
+			uint8_t *modelStagingData = reinterpret_cast<uint8_t*>(uploadManager->allocateBufferUpload(modelResource->modelBuffer, 0, modelResource->meshletDataOffset + meshletDataSize));
+			memcpy(modelStagingData, request->modelIndexBuffer.data(), request->modelIndexBuffer.size());
+			memcpy(modelStagingData + modelResource->vertexDataOffset, request->modelVertexBuffer.data(), request->modelVertexBuffer.size());
+			memcpy(modelStagingData + modelResource->meshletDataOffset, modelResource->meshlets.data(), meshletDataSize);
+
+			std::vector<uint8_t>().swap(request->modelIndexBuffer);
+			std::vector<uint8_t>().swap(request->modelVertexBuffer);
+		}
+	}
+
+	// Uploads are only ever submitted after they're recorded, so this batch finishes after all of the request's copies
+	request->uploadBatchID = uploadManager->getCurrentBatchID();
+}
+
+void ResourceManager::finishLoadRequest(ResourceLoadRequest *request, bool succeeded)
+{
+	ResourceLoadState loadState = succeeded ? RESOURCE_LOAD_STATE_LOADED : RESOURCE_LOAD_STATE_FAILED;
+
+	// A request that failed to decode can still have staging buffers for the textures that did decode
+	for (TextureImportData &textureData : request->textures)
+		freeTextureImportStaging(uploadManager, textureData);
+
+	if (request->modelStagingBuffer != nullptr)
+	{
+		renderer->unmapStagingBuffer(request->modelStagingBuffer);
+		renderer->destroyStagingBuffer(request->modelStagingBuffer);
+	}
+
+	for (size_t m = 0; m < request->materials.size(); m++)
+	{
+		MaterialResource *material = request->materials[m];
+
+		if (material == nullptr)
+			continue;
+
+		// A failed model's materials were never registered
+		if (!succeeded && request->model != nullptr)
+		{
+			delete material;
+
+			continue;
+		}
+
+		if (succeeded)
+		{
+			for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+			{
+				if (request->uploadedTextures[m * MATERIAL_MAX_TEXTURE_COUNT + i] != nullptr)
+				{
+					const TextureImportData &textureData = request->textures[m * MATERIAL_MAX_TEXTURE_COUNT + i];
+
+					material->materialTextures[i] = request->uploadedTextures[m * MATERIAL_MAX_TEXTURE_COUNT + i];
+					material->materialTextureViews[i] = request->uploadedTextureViews[m * MATERIAL_MAX_TEXTURE_COUNT + i];
+					material->materialTexturesLowestLoadedLevel[i] = textureData.firstMip;
+
+					if (!textureData.streamingCacheFile.empty())
+						registerStreamedTexture(material, uint32_t(i), textureData);
+
+					material->gpuMemorySize += getTextureMemorySize(material->materialTextures[i]);
+				}
+			}
+
+			gpuMemoryUsage += material->gpuMemorySize;
+		}
+
+		material->loadState = loadState;
+	}
+
+	if (request->model != nullptr)
+	{
+		ModelResource *model = request->model;
+		model->loadState = loadState;
+
+		if (succeeded)
+		{
+			model->materials = request->materials;
+			model->cpuMemorySize = sizeof(ModelResource) + getModelMeshNodesSize(model->meshNodes) + model->meshlets.size() * sizeof(ModelMeshlet) + model->occluderVertices.size() * sizeof(glm::vec3) + model->occluderIndices.size() * sizeof(uint32_t);
+			model->gpuMemorySize = model->modelBuffer->bufferSize;
+
+			cpuMemoryUsage += model->cpuMemorySize;
+			gpuMemoryUsage += model->gpuMemorySize;
+		}
+		else
+			Log::get()->error("ResourceManager: Failed to import model \"{}\"", model->sourceFile);
+
+		delete request;
+		releaseModel(model->handle);
+	}
+	else
+	{
+		MaterialResource *material = request->material;
+
+		if (!succeeded)
+			Log::get()->error("ResourceManager: Failed to load material {}", material->materialID);
+
+		delete request;
+		releaseMaterial(material->handle);
+	}
+}
+
+ResourceHandle ResourceManager::loadMaterial(const MaterialDefinition &definition)
+{
+	ResourceHandle handle = loadMaterialAsync(definition);
+	waitForLoadRequest(&materialResources.get(handle)->loadState);
+
+	return handle;
+}
+
+bool ResourceManager::importGLTFModel(const std::string &file)
+{
+	// A model that fails is freed as soon as nothing references it, so it's handle is held onto until it's finished
+	ResourceHandle handle = importGLTFModelAsync(file);
+
+	if (handle.isNull())
+		return false;
+
+	ModelResource *modelResource = modelResources.get(handle);
+	waitForLoadRequest(&modelResource->loadState);
+
+	bool loaded = modelResource->loadState == RESOURCE_LOAD_STATE_LOADED;
+	releaseModel(handle);
+
+	return loaded;
+}
+
+ResourceHandle ResourceManager::loadMaterialAsync(const MaterialDefinition &definition)
+{
+	uint64_t materialID = 0;
+	std::string hashString = "";
+
+	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+		hashString += definition.textureFiles[i];
+
+	std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
+	picosha2::hash256(hashString.begin(), hashString.end(), hashStringHash.begin(), hashStringHash.end());
+
+	for (uint64_t i = 0; i < 8; i++)
+		materialID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+
+	ResourceHandle existingHandle = acquireMaterial(materialID);
+
+	if (!existingHandle.isNull())
+		return existingHandle;
+
+	MaterialResource *material = new MaterialResource();
+	material->materialID = materialID;
+	material->pipelineID = definition.pipelineID;
+	material->loadState = RESOURCE_LOAD_STATE_LOADING;
+	material->gpuMemorySize = 0;
+
+	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+	{
+		material->textureFiles[i] = definition.textureFiles[i];
+		material->materialTextures[i] = nullptr;
+		material->materialTextureViews[i] = engine->get2DWhiteTextureView();
+		material->materialTexturesLowestLoadedLevel[i] = 0;
+	}
+
+	material->requestedScreenSize = 0.0f;
+
+	registerMaterial(material);
+
+	ResourceLoadRequest *request = new ResourceLoadRequest();
+	request->material = material;
+	request->model = nullptr;
+	request->materials = {material};
+
+	runLoadRequest(request);
+	materialResources.acquire(material->handle);
+
+	return material->handle;
+}
+
+ResourceHandle ResourceManager::importGLTFModelAsync(const std::string &file)
+{
+	uint64_t modelID = 0;
+
+	std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
+	picosha2::hash256(file.begin(), file.end(), hashStringHash.begin(), hashStringHash.end());
+
+	for (uint64_t i = 0; i < 8; i++)
+		modelID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+
+	ResourceHandle existingHandle = acquireModel(modelID);
+
+	if (!existingHandle.isNull())
+		return existingHandle;
+
+	ModelResource *modelResource = new ModelResource();
+	modelResource->modelID = modelID;
+	modelResource->sourceFile = file;
+	modelResource->loadState = RESOURCE_LOAD_STATE_LOADING;
+	modelResource->cpuMemorySize = 0;
+	modelResource->gpuMemorySize = 0;
+	modelResource->modelBuffer = nullptr;
+	modelResource->lodCount = 1;
+	modelResource->lodScreenCoverages[0] = 1.0f;
+
+	registerModel(modelResource);
+
+	ResourceLoadRequest *request = new ResourceLoadRequest();
+	request->material = nullptr;
+	request->model = modelResource;
+	request->textureCompressionTier = textureCompressionTier;
+
+	// Acquired before the load starts, so a load that fails can't free the model before the caller has it's handle
+	modelResources.acquire(modelResource->handle);
+	runLoadRequest(request);
+
+	return modelResource->handle;
+}
+
+bool ResourceManager::decodeMaterial(ResourceLoadRequest *request)
+{
+	MaterialResource *material = request->material;
+	request->textures.resize(MATERIAL_MAX_TEXTURE_COUNT);
+
+	double startTime = engine->getTime();
+
+	std::vector<MaterialTextureDecodeJobData> decodeJobDatas;
+	decodeJobDatas.reserve(MATERIAL_MAX_TEXTURE_COUNT);
+
+	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+		if (!material->textureFiles[i].empty())
+			decodeJobDatas.push_back({this, request, i, false});
+
+	Job *decodeTexturesJob = JobSystem::get()->allocateJob(nullptr);
+	std::vector<Job*> decodeJobs;
+
+	for (MaterialTextureDecodeJobData &jobData : decodeJobDatas)
+	{
+		Job *decodeJob = JobSystem::get()->allocateJobAsChild(decodeTexturesJob, &ResourceManager::materialTextureDecodeJobFunction);
+		decodeJob->usrData = &jobData;
+
+		decodeJobs.push_back(decodeJob);
+	}
+
+	JobSystem::get()->runJobs(decodeJobs);
+	JobSystem::get()->runJob(decodeTexturesJob);
+	JobSystem::get()->waitForJob(decodeTexturesJob);
+
+	for (const MaterialTextureDecodeJobData &jobData : decodeJobDatas)
+		if (!jobData.succeeded)
+			return false;
+
+	Log::get()->info("ResourceManager: Decoded the {} textures of material {} in {:.3f} ms", decodeJobDatas.size(), material->materialID, (engine->getTime() - startTime) * 1000.0);
+
+	return true;
+}
+
+void ResourceManager::materialTextureDecodeJobFunction(Job *job)
+{
+	MaterialTextureDecodeJobData *jobData = reinterpret_cast<MaterialTextureDecodeJobData*>(job->usrData);
+
+	jobData->succeeded = jobData->resourceManager->decodeMaterialTexture(jobData->request->material->textureFiles[jobData->textureIndex], jobData->request->textures[jobData->textureIndex]);
+}
+
+bool ResourceManager::decodeMaterialTexture(const std::string &file, TextureImportData &textureData)
+{
+	std::vector<char> fileData = FileLoader::instance()->readFileBuffer(file);
+	const uint8_t *encodedImage = reinterpret_cast<const uint8_t*>(fileData.data());
+
+	const ImageDecoder *decoder = getImageDecoder(encodedImage, fileData.size());
+
+	if (decoder == nullptr)
+	{
+		Log::get()->error("ResourceManager: Failed to decode texture \"{}\", it's empty or isn't a format any image decoder can read", file);
+
+		return false;
+	}
+
+	textureData.format = RESOURCE_FORMAT_R8G8B8A8_UNORM;
+
+	// W/o blits the texture (and it's views) only get mip 0
+	textureData.generateMipmaps = renderer->supportsTextureBlits();
+
+	std::string error;
+
+	if (!decoder->readHeader(encodedImage, fileData.size(), textureData.width, textureData.height, error))
+	{
+		Log::get()->error("ResourceManager: Failed to decode texture \"{}\" w/ {}, error: {}", file, decoder->getName(), error);
+
+		return false;
+	}
+
+	// If the decode fails the staging buffer is freed along w/ the rest of the request
+	uint8_t *stagingData = allocateTextureImportStaging(uploadManager, textureData, 1);
+
+	if (!decoder->decode(encodedImage, fileData.size(), stagingData + textureData.mipOffsets[0], textureData.mipRowPitches[0], error))
+	{
+		Log::get()->error("ResourceManager: Failed to decode texture \"{}\" w/ {}, error: {}", file, decoder->getName(), error);
+
+		return false;
+	}
+
+	return true;
+}
+
+const ImageDecoder *ResourceManager::getImageDecoder(const uint8_t *fileData, size_t fileSize) const
+{
+	for (auto decoderIt = imageDecoders.rbegin(); decoderIt != imageDecoders.rend(); decoderIt++)
+		if ((*decoderIt)->canDecode(fileData, fileSize))
+			return decoderIt->get();
+
+	return nullptr;
+}
+
+void ResourceManager::addImageDecoder(std::unique_ptr<ImageDecoder> decoder)
+{
+	imageDecoders.push_back(std::move(decoder));
+}
+
+bool ResourceManager::decodeGLTFModel(ResourceLoadRequest *request)
+{
+	ModelResource *modelResource = request->model;
+	const std::string &file = modelResource->sourceFile;
+	double loadStartTime = engine->getTime();
+
+	if (loadModelCache(request))
+	{
+		Log::get()->info("ResourceManager: Loaded \"{}\" from the model cache in {:.3f} ms", file, (engine->getTime() - loadStartTime) * 1000.0);
+
+		return true;
+	}
+
+	// Each job gets it's own loader, TinyGLTF keeps state between loads
+	tinygltf::TinyGLTF gltfLoader;
+	std::vector<uint64_t> imageContentHashes;
+	gltfLoader.SetImageLoader(&ResourceManager::gltfImageLoadingFunction, &imageContentHashes);
+
+	tinygltf::Model model;
+	std::string err, warn;
+
+	std::vector<char> modelFileData = FileLoader::instance()->readFileBuffer(file);
+	std::string modelFileBaseDirectory = FileLoader::instance()->getWorkingDir() + file.substr(0, file.find_last_of('/'));
+
+	bool ret = false;
+
+	if (file.substr(file.size() - 3, 3) == "glb")
+		ret = gltfLoader.LoadBinaryFromMemory(&model, &err, &warn, reinterpret_cast<uint8_t *>(modelFileData.data()), modelFileData.size(), modelFileBaseDirectory);
+	else if (file.substr(file.size() - 4, 4) == "gltf")
+		ret = gltfLoader.LoadASCIIFromString(&model, &err, &warn, modelFileData.data(), modelFileData.size(), modelFileBaseDirectory, 1);
+	else
+	{
+		Log::get()->error("ResourceManager: Cannot load file \"{}\" because it is not a .glb or .gltf file!");
+		return false;
+	}
+
+	if (!warn.empty())
+		Log::get()->warn("ResourceManager: Warning while loading glTF file \"{}\": \"{}\"", file, warn);
+
+	if (!err.empty())
+		Log::get()->warn("ResourceManager: Error while loading glTF file \"{}\": \"{}\"", file, err);
+
+	if (!ret)
+	{
+		Log::get()->error("ResourceManager: Failed to load glTF file \"{}\"", file);
+		return false;
+	}
+
+	if (!importGLTFMaterials(request, model, imageContentHashes))
+		return false;
+
+	bool use32bitIndices = false;
+
+	for (size_t i = 0; i < model.nodes.size(); i++)
+	{
+		const tinygltf::Node &gltfNode = model.nodes[i];
+		
+		if (gltfNode.mesh >= 0)
+		{
+			const tinygltf::Mesh &nodeMesh = model.meshes[gltfNode.mesh];
+
+			for (size_t p = 0; p < nodeMesh.primitives.size(); p++)
+			{
+				const tinygltf::Primitive &primitive = nodeMesh.primitives[p];
+
+				if (model.accessors[primitive.indices].componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
+				{
+					use32bitIndices = true;
+					break;
+				}
+			}
+		}
+
+		if (use32bitIndices)
+			break;
+	}
+
+	std::vector<uint8_t> &modelIndexBuffer = request->modelIndexBuffer;
+	std::vector<uint8_t> &modelVertexBuffer = request->modelVertexBuffer;
+
+	std::vector<ModelMeshNode> meshNodes(model.nodes.size());
+	std::vector<bool> meshNodesHasNoParent(model.nodes.size());
+
+	std::vector<std::pair<int, int>> modelPrimitives; // Node and draw primitive index
+	std::vector<size_t> modelPrimitiveVertexCounts;
+
+	for (size_t n = 0; n < model.nodes.size(); n++)
+	{
+		const tinygltf::Node &gltfNode = model.nodes[n];
+
+		ModelMeshNode &node = meshNodes[n];
+		node = ModelMeshNode();
+
+		meshNodesHasNoParent[n] = true;
+
+		if (gltfNode.matrix.size() > 0)
+		{
+			glm::mat4 gltfNodeMatrix;
+
+			for (int x = 0; x < 4; x++)
+				for (int y = 0; y < 4; y++)
+					gltfNodeMatrix[x][y] = gltfNode.matrix[y * 4 + x];
+
+			glm::vec3 scale, translation, skew;
+			glm::quat orientation;
+			glm::vec4 perspective;
+
+			glm::decompose(gltfNodeMatrix, scale, orientation, translation, skew, perspective);
+
+			node.orientation = orientation;
+			node.position_scale = glm::vec4(translation.x, translation.y, translation.z, (scale.x + scale.y + scale.z) / 3.0f);
+		}
+		else
+		{
+			if (gltfNode.rotation.size() > 0)
+				node.orientation = glm::quat(gltfNode.rotation[0], gltfNode.rotation[1], gltfNode.rotation[2], gltfNode.rotation[3]);
+
+			if (gltfNode.translation.size() > 0)
+				node.position_scale = glm::vec4(gltfNode.translation[0], gltfNode.translation[1], gltfNode.translation[2], 1);
+
+			if (gltfNode.scale.size() > 0)
+				node.position_scale.w = (gltfNode.scale[0] + gltfNode.scale[1] + gltfNode.scale[2]) / 3.0f;
+		}
+
+		if (gltfNode.mesh >= 0)
+		{
+			const tinygltf::Mesh &mesh = model.meshes[gltfNode.mesh];
+
+			for (size_t p = 0; p < mesh.primitives.size(); p++)
+			{
+				const tinygltf::Primitive &primitive = mesh.primitives[p];
+				const tinygltf::Accessor &primitiveIndexAccessor = model.accessors[primitive.indices];
+
+				ModelMeshDrawPrimitive drawPrimitive = {};
+				drawPrimitive.materialID = request->materials[primitive.material]->materialID;
+				drawPrimitive.indexCount = primitiveIndexAccessor.count;
+				drawPrimitive.firstIndex = uint32_t(modelIndexBuffer.size() / (use32bitIndices ? 4 : 2));
+				drawPrimitive.vertexOffset = int32_t(modelVertexBuffer.size() / sizeof(NonSkinnedVertex));
+
+				node.drawPrimitives.push_back(drawPrimitive);
+
+				// Append the index data to our global model index buffer
+				const tinygltf::BufferView &indexBufferView = model.bufferViews[primitiveIndexAccessor.bufferView];
+				uint8_t *meshIndexBuffer = model.buffers[indexBufferView.buffer].data.data() + indexBufferView.byteOffset + primitiveIndexAccessor.byteOffset;
+
+				uint32_t indexSize = primitiveIndexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? 2 : 4;
+
+				if ((!use32bitIndices && indexSize == 2) || (use32bitIndices && indexSize == 4))
+				{
+					modelIndexBuffer.insert(modelIndexBuffer.end(), meshIndexBuffer, meshIndexBuffer + primitiveIndexAccessor.count * indexSize);
+				}
+				else if (use32bitIndices && indexSize == 2)
+				{
+					size_t prevSize = modelIndexBuffer.size();
+					modelIndexBuffer.resize(prevSize + primitiveIndexAccessor.count * 4);
+
+					for (size_t index = 0; index < primitiveIndexAccessor.count; index++)
+					{
+						uint16_t indexValue16;
+						memcpy(&indexValue16, meshIndexBuffer + index * 2, 2);
+
+						uint32_t indexValue = indexValue16;
+						memcpy(&modelIndexBuffer[prevSize + index * 4], &indexValue, 4);
+					}
+				}
+
+				if (primitive.attributes.count("POSITION") == 0)
+				{
+					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex position data! File: \"{}\"", file);
+					return false;
+				}
+
+				if (primitive.attributes.count("NORMAL") == 0)
+				{
+					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex normal data! File: \"{}\"", file);
+					return false;
+				}
+
+				if (primitive.attributes.count("TANGENT") == 0)
+				{
+					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex tangent data! File: \"{}\"", file);
+					return false;
+				}
+
+				if (primitive.attributes.count("TEXCOORD_0") == 0)
+				{
+					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex texcoord/uv data! File: \"{}\"", file);
+					return false;
+				}
+
+
+				// Append the vertex data to our global model vertex buffer
+				if (primitive.attributes.count("POSITION") > 0)
+				{
+					const tinygltf::Accessor &vertexAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
+					const tinygltf::Accessor &normalAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
+					const tinygltf::Accessor &tangentAccessor = model.accessors[primitive.attributes.find("TANGENT")->second];
+					const tinygltf::Accessor &texcoord0Accessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
+
+					tinygltf::Accessor *texcoord1Accessor = primitive.attributes.count("TEXCOORD_1") > 0 ? &model.accessors[primitive.attributes.find("TEXCOORD_1")->second] : nullptr;
+
+					if (vertexAccessor.count != normalAccessor.count || normalAccessor.count != tangentAccessor.count || tangentAccessor.count != texcoord0Accessor.count || (texcoord1Accessor == nullptr ? false : texcoord0Accessor.count != texcoord1Accessor->count))
+					{
+						Log::get()->error("ResourceManager: Cannot load mesh primitive that has inconsistent attribute counts! File: \"{}\"", file);
+						return false;
+					}
+
+					uint8_t *vertexDataPtr = model.buffers[model.bufferViews[vertexAccessor.bufferView].buffer].data.data() + model.bufferViews[vertexAccessor.bufferView].byteOffset + vertexAccessor.byteOffset;
+					uint8_t *normalDataPtr = model.buffers[model.bufferViews[normalAccessor.bufferView].buffer].data.data() + model.bufferViews[normalAccessor.bufferView].byteOffset + normalAccessor.byteOffset;
+					uint8_t *tangentDataPtr = model.buffers[model.bufferViews[tangentAccessor.bufferView].buffer].data.data() + model.bufferViews[tangentAccessor.bufferView].byteOffset + tangentAccessor.byteOffset;
+					uint8_t *texcoord0DataPtr = model.buffers[model.bufferViews[texcoord0Accessor.bufferView].buffer].data.data() + model.bufferViews[texcoord0Accessor.bufferView].byteOffset + texcoord0Accessor.byteOffset;
+					uint8_t *texcoord1DataPtr = texcoord1Accessor == nullptr ? nullptr : model.buffers[model.bufferViews[texcoord1Accessor->bufferView].buffer].data.data() + model.bufferViews[texcoord1Accessor->bufferView].byteOffset + texcoord1Accessor->byteOffset;
+
+					size_t prevSize = modelVertexBuffer.size();
+					modelVertexBuffer.resize(modelVertexBuffer.size() + vertexAccessor.count * sizeof(NonSkinnedVertex));
+					NonSkinnedVertex *vertexBufferDataPtr = reinterpret_cast<NonSkinnedVertex*>(&modelVertexBuffer[prevSize]);
+
+					for (size_t i = 0; i < vertexAccessor.count; i++)
+					{
+						glm::vec4 tangent;
+						glm::vec3 vertex, normal;
+						glm::vec2 uv0, uv1;
+
+						memcpy(&tangent, &tangentDataPtr[i * 4], sizeof(tangent));
+						memcpy(&vertex, &vertexDataPtr[i * 3], sizeof(vertex));
+						memcpy(&normal, &normalDataPtr[i * 3], sizeof(normal));
+						memcpy(&uv0, &texcoord0DataPtr[i * 2], sizeof(uv0));
+						
+						if (texcoord1DataPtr != nullptr)
+							memcpy(&uv1, &texcoord1DataPtr[i * 2], sizeof(uv1));
+
+						vertexBufferDataPtr[i].vertex = vertex;
+						vertexBufferDataPtr[i].tangentHandedness = tangent.w;
+						vertexBufferDataPtr[i].normal = glm::vec4(normal.x, normal.y, normal.z, 0.0f);
+						vertexBufferDataPtr[i].tangent = tangent;
+						vertexBufferDataPtr[i].uv0 = uv0;
+						vertexBufferDataPtr[i].uv1 = uv1;
+					}
+
+					modelPrimitives.push_back(std::make_pair(int(n), int(node.drawPrimitives.size() - 1)));
+					modelPrimitiveVertexCounts.push_back(vertexAccessor.count);
+				}
+				else
+				{
+					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex position data! File: \"{}\"", file);
+					return false;
+				}
+			}
+		}
+	}
+
+	optimizeModelPrimitives(modelResource, meshNodes.data(), modelPrimitives, modelPrimitiveVertexCounts, modelIndexBuffer, modelVertexBuffer, use32bitIndices);
+	encodeModelVertices(modelResource, modelVertexBuffer);
+
+	for (size_t n = 0; n < model.nodes.size(); n++)
+	{
+		const tinygltf::Node &gltfNode = model.nodes[n];
+
+		for (size_t c = 0; c < gltfNode.children.size(); c++)
+		{
+			meshNodes[n].children.push_back(meshNodes[gltfNode.children[c]]);
+			meshNodesHasNoParent[gltfNode.children[c]] = false;
+		}
+	}
+
+	for (size_t n = 0; n < model.nodes.size(); n++)
+		if (meshNodesHasNoParent[n] && (meshNodes[n].children.size() > 0 ? true : meshNodes[n].drawPrimitives.size() > 0)) // If this mesh node has no parent (aka it's a top node) and it's actually rendering something (aka it has draw primitives or it's children have draw primitives) then add it
+			modelResource->meshNodes.push_back(meshNodes[n]);
+
+	request->use32bitIndices = use32bitIndices;
+
+	Log::get()->info("ResourceManager: Imported \"{}\" in {:.3f} ms", file, (engine->getTime() - loadStartTime) * 1000.0);
+
+	saveModelCache(request);
+
+	return true;
+}
+
+static void appendModelIndices(std::vector<uint8_t> &modelIndexBuffer, const std::vector<uint32_t> &indices, bool use32bitIndices)
+{
+	if (indices.size() == 0)
+		return;
+
+	size_t prevSize = modelIndexBuffer.size();
+
+	if (use32bitIndices)
+	{
+		modelIndexBuffer.resize(prevSize + indices.size() * 4);
+		memcpy(&modelIndexBuffer[prevSize], indices.data(), indices.size() * 4);
+
+		return;
+	}
+
+	modelIndexBuffer.resize(prevSize + indices.size() * 2);
+	uint16_t *indices16 = reinterpret_cast<uint16_t*>(&modelIndexBuffer[prevSize]);
+
+	for (size_t i = 0; i < indices.size(); i++)
+		indices16[i] = uint16_t(indices[i]);
+}
+
+void ResourceManager::optimizeModelPrimitives(ModelResource *modelResource, ModelMeshNode *meshNodes, const std::vector<std::pair<int, int>> &primitives, const std::vector<size_t> &primitiveVertexCounts, std::vector<uint8_t> &modelIndexBuffer, std::vector<uint8_t> &modelVertexBuffer, bool use32bitIndices)
+{
+	std::vector<ModelPrimitiveJobData> primitiveJobData(primitives.size());
+	std::vector<Job*> primitiveJobs;
+
+	Job *optimizePrimitivesJob = JobSystem::get()->allocateJob(nullptr);
+
+	for (size_t p = 0; p < primitives.size(); p++)
+	{
+		const ModelMeshDrawPrimitive &drawPrimitive = meshNodes[primitives[p].first].drawPrimitives[primitives[p].second];
+		const NonSkinnedVertex *primitiveVertices = reinterpret_cast<const NonSkinnedVertex*>(modelVertexBuffer.data()) + drawPrimitive.vertexOffset;
+
+		ModelPrimitiveJobData &jobData = primitiveJobData[p];
+		jobData.vertices.assign(primitiveVertices, primitiveVertices + primitiveVertexCounts[p]);
+		jobData.indices.resize(drawPrimitive.indexCount);
+
+		for (uint32_t i = 0; i < drawPrimitive.indexCount; i++)
+		{
+			if (use32bitIndices)
+				jobData.indices[i] = reinterpret_cast<const uint32_t*>(modelIndexBuffer.data())[drawPrimitive.firstIndex + i];
+			else
+				jobData.indices[i] = reinterpret_cast<const uint16_t*>(modelIndexBuffer.data())[drawPrimitive.firstIndex + i];
+		}
+
+		Job *primitiveJob = JobSystem::get()->allocateJobAsChild(optimizePrimitivesJob, modelPrimitiveJobFunction);
+		primitiveJob->usrData = &jobData;
+
+		primitiveJobs.push_back(primitiveJob);
+	}
+
+	JobSystem::get()->runJobs(primitiveJobs);
+	JobSystem::get()->runJob(optimizePrimitivesJob);
+	JobSystem::get()->waitForJob(optimizePrimitivesJob);
+
+	// Every primitive in a model needs the same number of LODs, the ones that couldn't be simplified as far just repeat their last LOD
+	uint32_t lodCount = 1;
+	float lodErrors[MODEL_MAX_LOD_LEVELS] = {};
+
+	for (const ModelPrimitiveJobData &jobData : primitiveJobData)
+	{
+		lodCount = std::max(lodCount, uint32_t(jobData.lodIndices.size()));
+
+		for (size_t lod = 0; lod < jobData.lodErrors.size(); lod++)
+			lodErrors[lod] = std::max(lodErrors[lod], jobData.lodErrors[lod]);
+	}
+
+	// The welded vertices and reordered indices replace what was imported, LOD 0 of every primitive first and then the rest of the LODs
+	modelIndexBuffer.clear();
+	modelVertexBuffer.clear();
+
+	size_t importedVertexCount = 0, optimizedVertexCount = 0;
+	double importedMisses = 0.0, optimizedMisses = 0.0;
+
+	for (size_t p = 0; p < primitives.size(); p++)
+	{
+		ModelMeshDrawPrimitive &drawPrimitive = meshNodes[primitives[p].first].drawPrimitives[primitives[p].second];
+		const ModelPrimitiveJobData &jobData = primitiveJobData[p];
+
+		drawPrimitive.firstIndex = uint32_t(modelIndexBuffer.size() / (use32bitIndices ? 4 : 2));
+		drawPrimitive.vertexOffset = int32_t(modelVertexBuffer.size() / sizeof(NonSkinnedVertex));
+		drawPrimitive.firstMeshlet = uint32_t(modelResource->meshlets.size());
+		drawPrimitive.meshletCount = uint32_t(jobData.meshlets.size());
+
+		for (ModelMeshlet meshlet : jobData.meshlets)
+		{
+			meshlet.firstIndex += drawPrimitive.firstIndex;
+			meshlet.vertexOffset = drawPrimitive.vertexOffset;
+
+			modelResource->meshlets.push_back(meshlet);
+		}
+
+		appendModelIndices(modelIndexBuffer, jobData.lodIndices[0], use32bitIndices);
+		modelVertexBuffer.insert(modelVertexBuffer.end(), reinterpret_cast<const uint8_t*>(jobData.vertices.data()), reinterpret_cast<const uint8_t*>(jobData.vertices.data() + jobData.vertices.size()));
+
+		importedVertexCount += jobData.importedVertexCount;
+		optimizedVertexCount += jobData.vertices.size();
+		importedMisses += double(jobData.importedACMR) * (drawPrimitive.indexCount / 3);
+		optimizedMisses += double(jobData.optimizedACMR) * (drawPrimitive.indexCount / 3);
+	}
+
+	// Small models keep LOD 0 on the CPU as well so they can be used as occluders
+	size_t occluderIndexCount = 0;
+
+	for (const ModelPrimitiveJobData &jobData : primitiveJobData)
+		occluderIndexCount += jobData.lodIndices[0].size();
+
+	if (occluderIndexCount / 3 <= MODEL_MAX_OCCLUDER_TRIANGLES)
+	{
+		for (const ModelPrimitiveJobData &jobData : primitiveJobData)
+		{
+			uint32_t baseVertex = uint32_t(modelResource->occluderVertices.size());
+
+			for (const NonSkinnedVertex &vertex : jobData.vertices)
+				modelResource->occluderVertices.push_back(vertex.vertex);
+
+			for (uint32_t index : jobData.lodIndices[0])
+				modelResource->occluderIndices.push_back(baseVertex + index);
+		}
+	}
+
+	size_t lod0IndexCount = 0, lodIndexCount = 0;
+
+	for (size_t p = 0; p < primitives.size(); p++)
+	{
+		ModelMeshDrawPrimitive &drawPrimitive = meshNodes[primitives[p].first].drawPrimitives[primitives[p].second];
+		const std::vector<std::vector<uint32_t>> &lodIndices = primitiveJobData[p].lodIndices;
+
+		lod0IndexCount += drawPrimitive.indexCount;
+
+		for (uint32_t lod = 1; lod < lodCount; lod++)
+		{
+			if (lod >= lodIndices.size())
+			{
+				drawPrimitive.lodRanges[lod - 1] = drawPrimitive.getLODRange(lod - 1);
+
+				continue;
+			}
+
+			drawPrimitive.lodRanges[lod - 1].indexCount = uint32_t(lodIndices[lod].size());
+			drawPrimitive.lodRanges[lod - 1].firstIndex = uint32_t(modelIndexBuffer.size() / (use32bitIndices ? 4 : 2));
+
+			appendModelIndices(modelIndexBuffer, lodIndices[lod], use32bitIndices);
+		}
+
+		lodIndexCount += drawPrimitive.getLODRange(lodCount - 1).indexCount;
+	}
+
+	modelResource->lodCount = lodCount;
+	modelResource->lodScreenCoverages[0] = 1.0f;
+
+	for (uint32_t lod = 1; lod < lodCount; lod++)
+	{
+		float coverage = lodErrors[lod] > 0.0f ? MODEL_LOD_MAX_PIXEL_ERROR / (lodErrors[lod] * MODEL_LOD_REFERENCE_SCREEN_HEIGHT) : 1.0f;
+
+		modelResource->lodScreenCoverages[lod] = std::min(coverage, modelResource->lodScreenCoverages[lod - 1]);
+	}
+
+	if (lod0IndexCount > 0)
+		Log::get()->info("ResourceManager: Optimized \"{}\", {} -> {} vertices, ACMR {:.3f} -> {:.3f}, {} meshlets", modelResource->sourceFile, importedVertexCount, optimizedVertexCount, importedMisses / (lod0IndexCount / 3), optimizedMisses / (lod0IndexCount / 3), modelResource->meshlets.size());
+
+	if (lodCount > 1)
+		Log::get()->info("ResourceManager: Generated {} LODs for \"{}\", the last one has {} of {} triangles", lodCount, modelResource->sourceFile, lodIndexCount / 3, lod0IndexCount / 3);
+}
+
+void ResourceManager::encodeModelVertices(ModelResource *modelResource, std::vector<uint8_t> &modelVertexBuffer)
+{
+	const NonSkinnedVertex *vertices = reinterpret_cast<const NonSkinnedVertex*>(modelVertexBuffer.data());
+	size_t vertexCount = modelVertexBuffer.size() / sizeof(NonSkinnedVertex);
+
+	modelResource->vertexFormat = modelVertexFormat;
+	modelResource->vertexPositionOffset_scale = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	if (modelVertexFormat == MODEL_VERTEX_FORMAT_FULL || vertexCount == 0)
+		return;
+
+	std::vector<uint8_t> encodedVertexBuffer;
+
+	if (modelVertexFormat == MODEL_VERTEX_FORMAT_COMPRESSED)
+	{
+		encodedVertexBuffer.resize(vertexCount * sizeof(CompressedNonSkinnedVertex));
+		CompressedNonSkinnedVertex *encodedVertices = reinterpret_cast<CompressedNonSkinnedVertex*>(encodedVertexBuffer.data());
+
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			encodedVertices[v].vertex = vertices[v].vertex;
+			encodedVertices[v].tangentHandedness = vertices[v].tangent.w < 0.0f ? -1.0f : 1.0f;
+			encodeOctahedralSnorm16(vertices[v].normal, encodedVertices[v].normal);
+			encodeOctahedralSnorm16(vertices[v].tangent, encodedVertices[v].tangent);
+			encodeHalf2(vertices[v].uv0, encodedVertices[v].uv0);
+			encodeHalf2(vertices[v].uv1, encodedVertices[v].uv1);
+		}
+	}
+	else
+	{
+		// The same scale on every axis, so it can be folded into the uniform scale of each object's transform
+		glm::vec3 boundsMin = vertices[0].vertex, boundsMax = vertices[0].vertex;
+
+		for (size_t v = 1; v < vertexCount; v++)
+		{
+			boundsMin = glm::min(boundsMin, vertices[v].vertex);
+			boundsMax = glm::max(boundsMax, vertices[v].vertex);
+		}
+
+		glm::vec3 boundsCenter = (boundsMin + boundsMax) * 0.5f;
+		glm::vec3 boundsHalfExtent = (boundsMax - boundsMin) * 0.5f;
+		float positionScale = std::max(boundsHalfExtent.x, std::max(boundsHalfExtent.y, boundsHalfExtent.z));
+
+		if (positionScale <= 0.0f)
+			positionScale = 1.0f;
+
+		modelResource->vertexPositionOffset_scale = glm::vec4(boundsCenter, positionScale);
+
+		// Meshlet bounds have to be in the same space as the positions
+		for (ModelMeshlet &meshlet : modelResource->meshlets)
+			meshlet.boundingSphere = glm::vec4((glm::vec3(meshlet.boundingSphere) - boundsCenter) / positionScale, meshlet.boundingSphere.w / positionScale);
+
+		encodedVertexBuffer.resize(vertexCount * sizeof(QuantizedNonSkinnedVertex));
+		QuantizedNonSkinnedVertex *encodedVertices = reinterpret_cast<QuantizedNonSkinnedVertex*>(encodedVertexBuffer.data());
+
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			glm::vec3 position = (vertices[v].vertex - boundsCenter) / positionScale;
+
+			encodedVertices[v].vertex[0] = int16_t(glm::packSnorm1x16(position.x));
+			encodedVertices[v].vertex[1] = int16_t(glm::packSnorm1x16(position.y));
+			encodedVertices[v].vertex[2] = int16_t(glm::packSnorm1x16(position.z));
+			encodedVertices[v].vertex[3] = int16_t(glm::packSnorm1x16(vertices[v].tangent.w < 0.0f ? -1.0f : 1.0f));
+			encodeOctahedralSnorm16(vertices[v].normal, encodedVertices[v].normal);
+			encodeOctahedralSnorm16(vertices[v].tangent, encodedVertices[v].tangent);
+			encodeHalf2(vertices[v].uv0, encodedVertices[v].uv0);
+			encodeHalf2(vertices[v].uv1, encodedVertices[v].uv1);
+		}
+	}
+
+	modelVertexBuffer.swap(encodedVertexBuffer);
+}
+
+ResourceHandle ResourceManager::findMaterial(uint64_t materialID) const
+{
+	auto handleIt = materialHandles.find(materialID);
+
+	return handleIt != materialHandles.end() ? handleIt->second : ResourceHandle{0, 0};
+}
+
+ResourceHandle ResourceManager::findModel(uint64_t modelID) const
+{
+	auto handleIt = modelHandles.find(modelID);
+
+	return handleIt != modelHandles.end() ? handleIt->second : ResourceHandle{0, 0};
+}
+
+ResourceHandle ResourceManager::acquireMaterial(uint64_t materialID)
+{
+	ResourceHandle handle = findMaterial(materialID);
+	materialResources.acquire(handle);
+
+	return handle;
+}
+
+ResourceHandle ResourceManager::acquireModel(uint64_t modelID)
+{
+	ResourceHandle handle = findModel(modelID);
+	modelResources.acquire(handle);
+
+	return handle;
+}
+
+void ResourceManager::acquireMaterial(ResourceHandle handle)
+{
+	materialResources.acquire(handle);
+}
+
+void ResourceManager::acquireModel(ResourceHandle handle)
+{
+	modelResources.acquire(handle);
+}
+
+void ResourceManager::releaseMaterial(ResourceHandle handle)
+{
+	MaterialResource *material = materialResources.get(handle);
+
+	if (material == nullptr)
+		return;
+
+	if (materialResources.getRefCount(handle) == 0)
+	{
+		Log::get()->error("ResourceManager: Material {} was released more times than it was acquired", material->materialID);
+
+		return;
+	}
+
+	// A failed material can't ever be used, so there's no point keeping it around until it's evicted
+	if (materialResources.release(handle, frameIndex) == 0 && material->loadState == RESOURCE_LOAD_STATE_FAILED)
+		freeMaterial(material);
+}
+
+void ResourceManager::releaseModel(ResourceHandle handle)
+{
+	ModelResource *model = modelResources.get(handle);
+
+	if (model == nullptr)
+		return;
+
+	if (modelResources.getRefCount(handle) == 0)
+	{
+		Log::get()->error("ResourceManager: Model \"{}\" was released more times than it was acquired", model->sourceFile);
+
+		return;
+	}
+
+	if (modelResources.release(handle, frameIndex) == 0 && model->loadState == RESOURCE_LOAD_STATE_FAILED)
+		freeModel(model);
+}
+
+MaterialResource *ResourceManager::getMaterial(ResourceHandle handle) const
+{
+	return materialResources.get(handle);
+}
+
+ModelResource *ResourceManager::getModel(ResourceHandle handle) const
+{
+	ModelResource *model = modelResources.get(handle);
+
+	return model != nullptr && model->loadState == RESOURCE_LOAD_STATE_LOADED ? model : nullptr;
+}
+
+MaterialResource *ResourceManager::getMaterial(uint64_t materialID) const
+{
+	return getMaterial(findMaterial(materialID));
+}
+
+ModelResource *ResourceManager::getModel(uint64_t modelID) const
+{
+	return getModel(findModel(modelID));
+}
+
+ResourceLoadState ResourceManager::getModelLoadState(uint64_t modelID) const
+{
+	ModelResource *model = modelResources.get(findModel(modelID));
+
+	// Models that were never imported (or failed, or were evicted since) aren't going to finish loading
+	return model != nullptr ? model->loadState : RESOURCE_LOAD_STATE_FAILED;
+}
+
+ResourceHandle ResourceManager::registerMaterial(MaterialResource *material)
+{
+	// A model imported again after it was evicted can find it's old materials still waiting to be evicted, they're replaced. One that's still
+	// referenced stays alive for it's references, the ID just resolves to the new one.
+	MaterialResource *oldMaterial = materialResources.get(findMaterial(material->materialID));
+
+	if (oldMaterial != nullptr && materialResources.getRefCount(oldMaterial->handle) == 0 && canFreeMaterial(oldMaterial))
+		freeMaterial(oldMaterial);
+
+	material->handle = materialResources.allocate(material, frameIndex);
+	materialHandles[material->materialID] = material->handle;
+
+	return material->handle;
+}
+
+ResourceHandle ResourceManager::registerModel(ModelResource *model)
+{
+	model->handle = modelResources.allocate(model, frameIndex);
+	modelHandles[model->modelID] = model->handle;
+
+	return model->handle;
+}
+
+bool ResourceManager::canFreeMaterial(const MaterialResource *material) const
+{
+	for (const StreamedTexture *texture : streamedTextures)
+		if (texture->material == material && texture->load != nullptr)
+			return false;
+
+	return true;
+}
+
+void ResourceManager::freeMaterial(MaterialResource *material)
+{
+	for (auto textureIt = streamedTextures.begin(); textureIt != streamedTextures.end();)
+	{
+		if ((*textureIt)->material != material)
+		{
+			textureIt++;
+
+			continue;
+		}
+
+		textureStreamingResidentSize -= (*textureIt)->mipChainSizes[(*textureIt)->residentMip];
+
+		delete *textureIt;
+		textureIt = streamedTextures.erase(textureIt);
+	}
+
+	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+		if (material->materialTextures[i] != nullptr)
+			retiredGPUResources.push_back({material->materialTextures[i], material->materialTextureViews[i], nullptr, frameIndex});
+
+	gpuMemoryUsage -= material->gpuMemorySize;
+
+	auto handleIt = materialHandles.find(material->materialID);
+
+	if (handleIt != materialHandles.end() && handleIt->second == material->handle)
+		materialHandles.erase(handleIt);
+
+	materialResources.free(material->handle);
+	delete material;
+}
+
+void ResourceManager::freeModel(ModelResource *model)
+{
+	if (model->modelBuffer != nullptr)
+		retiredGPUResources.push_back({nullptr, nullptr, model->modelBuffer, frameIndex});
+
+	cpuMemoryUsage -= model->cpuMemorySize;
+	gpuMemoryUsage -= model->gpuMemorySize;
+
+	auto handleIt = modelHandles.find(model->modelID);
+
+	if (handleIt != modelHandles.end() && handleIt->second == model->handle)
+		modelHandles.erase(handleIt);
+
+	modelResources.free(model->handle);
+
+	for (MaterialResource *material : model->materials)
+		if (material != nullptr)
+			releaseMaterial(material->handle);
+
+	delete model;
+}
+
+void ResourceManager::evictUnusedResources()
+{
+	ResourceHandle model = modelResources.getLeastRecentlyReleased();
+	ResourceHandle material = materialResources.getLeastRecentlyReleased();
+
+	while ((cpuMemoryUsage > cpuMemoryBudget || gpuMemoryUsage > gpuMemoryBudget) && (!model.isNull() || !material.isNull()))
+	{
+		// Both released lists are in the order their resources were released in, so they're walked together like a merge
+		if (!model.isNull() && (material.isNull() || modelResources.getReleasedFrame(model) <= materialResources.getReleasedFrame(material)))
+		{
+			ResourceHandle nextModel = modelResources.getNextReleased(model);
+			freeModel(modelResources.get(model));
+			model = nextModel;
+
+			// The model's materials were just released, so there could be more to evict
+			if (material.isNull())
+				material = materialResources.getLeastRecentlyReleased();
+		}
+		else
+		{
+			ResourceHandle nextMaterial = materialResources.getNextReleased(material);
+			MaterialResource *materialResource = materialResources.get(material);
+
+			if (canFreeMaterial(materialResource))
+				freeMaterial(materialResource);
+
+			material = nextMaterial;
+		}
+	}
+}
+
+void ResourceManager::destroyRetiredGPUResources(bool destroyAll)
+{
+	// Retired resources are in the order they were retired in
+	size_t destroyedCount = 0;
+
+	while (destroyedCount < retiredGPUResources.size() && (destroyAll || frameIndex - retiredGPUResources[destroyedCount].retiredFrame > uint64_t(renderer->getMaxFramesInFlight())))
+	{
+		const RetiredGPUResource &retiredResource = retiredGPUResources[destroyedCount++];
+
+		if (retiredResource.texture != nullptr)
+			renderer->destroyTexture(retiredResource.texture);
 
-	gltfLoader = std::unique_ptr<tinygltf::TinyGLTF>(new tinygltf::TinyGLTF());
+		if (retiredResource.textureView != nullptr)
+			renderer->destroyTextureView(retiredResource.textureView);
 
-	gltfLoader->SetImageLoader(&ResourceManager::gltfImageLoadingFunction, nullptr);
+		if (retiredResource.buffer != nullptr)
+			renderer->destroyBuffer(retiredResource.buffer);
+	}
 
-	importResourceCmdPool = renderer->createCommandPool(QUEUE_TYPE_TRANSFER, COMMAND_POOL_TRANSIENT_BIT);
+	retiredGPUResources.erase(retiredGPUResources.begin(), retiredGPUResources.begin() + destroyedCount);
 }
 
-ResourceManager::~ResourceManager()
+void ResourceManager::setMemoryBudgets(size_t cpuBudget, size_t gpuBudget)
 {
-	for (auto &materialIt : materialResources)
-	{
-		for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
-		{
-			if (materialIt.second->materialTextures[i] != nullptr)
-			{
-				renderer->destroyTexture(materialIt.second->materialTextures[i]);
-				renderer->destroyTextureView(materialIt.second->materialTextureViews[i]);
+	cpuMemoryBudget = cpuBudget;
+	gpuMemoryBudget = gpuBudget;
+}
 
-				materialIt.second->materialTextures[i] = nullptr;
-				materialIt.second->materialTextureViews[i] = nullptr;
-			}
-		}
-	}
+size_t ResourceManager::getCPUMemoryUsage() const
+{
+	return cpuMemoryUsage;
+}
+
+size_t ResourceManager::getGPUMemoryUsage() const
+{
+	return gpuMemoryUsage;
+}
 
-	for (auto &modelIt : modelResources)
+void ResourceManager::setModelVertexFormat(ModelVertexFormat format)
+{
+	if (modelResources.size() > 0)
 	{
-		if (modelIt.second->modelBuffer != nullptr)
-		{
-			renderer->destroyBuffer(modelIt.second->modelBuffer);
-			modelIt.second->modelBuffer = nullptr;
-		}
+		Log::get()->error("ResourceManager: The model vertex format can't be changed once models have been imported");
+
+		return;
 	}
 
-	renderer->destroyCommandPool(importResourceCmdPool);
+	modelVertexFormat = format;
 }
 
-glm::vec2 encodeNormalSpheremap(glm::vec3 normal)
+ModelVertexFormat ResourceManager::getModelVertexFormat() const
 {
-	normal /= (abs(normal.x) + abs(normal.y) + abs(normal.z));
+	return modelVertexFormat;
+}
 
-	normal.x = normal.z >= 0.0f ? normal.x : ((1.0f - glm::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f));
-	normal.y = normal.z >= 0.0f ? normal.y : ((1.0f - glm::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f));
+void ResourceManager::setTextureCompressionTier(TextureCompressionTier tier)
+{
+	textureCompressionTier = tier;
+}
 
-	return glm::vec2(normal.x, normal.y);
+TextureCompressionTier ResourceManager::getTextureCompressionTier() const
+{
+	return textureCompressionTier;
 }
 
-MaterialResource *ResourceManager::loadMaterial(const MaterialDefinition &definition)
+void ResourceManager::getModelVertexInput(uint32_t binding, bool positionOnly, VertexInputBinding &vertexBinding, std::vector<VertexInputAttribute> &vertexAttribs) const
 {
-	MaterialResource *material = new MaterialResource();
-	material->materialID = 0;
-	material->pipelineID = definition.pipelineID;
+	vertexBinding = {};
+	vertexBinding.binding = binding;
+	vertexBinding.inputRate = VERTEX_INPUT_RATE_VERTEX;
 
-	std::string hashString = "";
+	VertexInputAttribute positionAttrib = {};
+	positionAttrib.binding = binding;
+	positionAttrib.location = 0;
 
-	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+	VertexInputAttribute uv0Attrib = {};
+	uv0Attrib.binding = binding;
+	uv0Attrib.location = 1;
+
+	VertexInputAttribute normalAttrib = {};
+	normalAttrib.binding = binding;
+	normalAttrib.location = 2;
+
+	VertexInputAttribute tangentAttrib = {};
+	tangentAttrib.binding = binding;
+	tangentAttrib.location = 3;
+
+	switch (modelVertexFormat)
 	{
-		material->textureFiles[i] = definition.textureFiles[i];
-		hashString += definition.textureFiles[i];
+		case MODEL_VERTEX_FORMAT_COMPRESSED:
+			vertexBinding.stride = sizeof(CompressedNonSkinnedVertex);
+			positionAttrib.format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+			positionAttrib.offset = offsetof(CompressedNonSkinnedVertex, vertex);
+			uv0Attrib.format = RESOURCE_FORMAT_R16G16_SFLOAT;
+			uv0Attrib.offset = offsetof(CompressedNonSkinnedVertex, uv0);
+			normalAttrib.format = RESOURCE_FORMAT_R16G16_SNORM;
+			normalAttrib.offset = offsetof(CompressedNonSkinnedVertex, normal);
+			tangentAttrib.format = RESOURCE_FORMAT_R16G16_SNORM;
+			tangentAttrib.offset = offsetof(CompressedNonSkinnedVertex, tangent);
+			break;
+		case MODEL_VERTEX_FORMAT_QUANTIZED:
+			vertexBinding.stride = sizeof(QuantizedNonSkinnedVertex);
+			positionAttrib.format = RESOURCE_FORMAT_R16G16B16A16_SNORM;
+			positionAttrib.offset = offsetof(QuantizedNonSkinnedVertex, vertex);
+			uv0Attrib.format = RESOURCE_FORMAT_R16G16_SFLOAT;
+			uv0Attrib.offset = offsetof(QuantizedNonSkinnedVertex, uv0);
+			normalAttrib.format = RESOURCE_FORMAT_R16G16_SNORM;
+			normalAttrib.offset = offsetof(QuantizedNonSkinnedVertex, normal);
+			tangentAttrib.format = RESOURCE_FORMAT_R16G16_SNORM;
+			tangentAttrib.offset = offsetof(QuantizedNonSkinnedVertex, tangent);
+			break;
+		case MODEL_VERTEX_FORMAT_FULL:
+		default:
+			vertexBinding.stride = sizeof(NonSkinnedVertex);
+			positionAttrib.format = RESOURCE_FORMAT_R32G32B32A32_SFLOAT;
+			positionAttrib.offset = offsetof(NonSkinnedVertex, vertex);
+			uv0Attrib.format = RESOURCE_FORMAT_R32G32_SFLOAT;
+			uv0Attrib.offset = offsetof(NonSkinnedVertex, uv0);
+			normalAttrib.format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
+			normalAttrib.offset = offsetof(NonSkinnedVertex, normal);
+			tangentAttrib.format = RESOURCE_FORMAT_R32G32B32_SFLOAT;
+			tangentAttrib.offset = offsetof(NonSkinnedVertex, tangent);
+			break;
 	}
 
-	std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
-	picosha2::hash256(hashString.begin(), hashString.end(), hashStringHash.begin(), hashStringHash.end());
+	if (positionOnly)
+		vertexAttribs = {positionAttrib};
+	else
+		vertexAttribs = {positionAttrib, uv0Attrib, normalAttrib, tangentAttrib};
+}
 
-	for (uint64_t i = 0; i < 8; i++)
-		material->materialID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+bool ResourceManager::importGLTFMaterials(ResourceLoadRequest *request, tinygltf::Model &model, const std::vector<uint64_t> &imageContentHashes)
+{
+	const std::string &file = request->model->sourceFile;
 
-	StagingTexture materialStagingTextures[MATERIAL_MAX_TEXTURE_COUNT];
+	request->materials.resize(model.materials.size());
+	request->textures.resize(model.materials.size() * MATERIAL_MAX_TEXTURE_COUNT);
 
-	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+	std::vector<TextureCompileData> texturesToCompile;
+	std::vector<GLTFTextureImportJobData> importJobDatas;
+
+	for (int m = 0; m < model.materials.size(); m++)
 	{
-		material->materialTextures[i] = nullptr;
-		material->materialTextureViews[i] = nullptr;
-		materialStagingTextures[i] = nullptr;
+		const tinygltf::Material &material = model.materials[m];
 
-		if (material->textureFiles[i].empty())
-			continue;
+		printf("Material #%i - %s\n", m, material.name.c_str());
+
+		int albedoImage = -1, normalsImage = -1, roughnessMetalnessImage = -1, AOImage = -1;
+
+		for (auto &param : material.values)
+		{
+			// Factors are in here too
+			if (param.second.TextureIndex() < 0)
+				continue;
+
+			if (param.second.TextureTexCoord() != 0)
+				Log::get()->warn("ResourceManager: Multiple texcoord/uv indices aren't supported yet! Your model \"{}\" probably won't render correctly\n", file);
+
+			int imageIndex = model.textures[param.second.TextureIndex()].source;
+
+			if (model.images[imageIndex].as_is)
+			{
+				Log::get()->error("ResourceManager: Cannot load material for model \"{}\", texture data is provided \"as is\" and is not supported!", file);
+				return false;
+			}
 
-		std::vector<char> textureFileData = FileLoader::instance()->readFileBuffer(material->textureFiles[i]);
-		std::vector<uint8_t> textureData;
-		uint32_t width, height;
+			if (param.first == "baseColorTexture")
+				albedoImage = imageIndex;
+			else if (param.first == "metallicRoughnessTexture")
+				roughnessMetalnessImage = imageIndex;
+		}
+
+		for (auto &param : material.additionalValues)
+		{
+			if (param.second.TextureIndex() < 0)
+				continue;
+
+			if (param.second.TextureTexCoord() != 0)
+				Log::get()->warn("ResourceManager: Multiple texcoord/uv indices aren't supported yet! Your model \"{}\" probably won't render correctly\n", file);
+
+			int imageIndex = model.textures[param.second.TextureIndex()].source;
+
+			if (model.images[imageIndex].as_is)
+			{
+				Log::get()->error("ResourceManager: Cannot load material for model \"{}\", texture data is provided \"as is\" and is not supported!", file);
+				return false;
+			}
+
+			if (param.first == "normalTexture")
+				normalsImage = imageIndex;
+			else if (param.first == "occlusionTexture")
+				AOImage = imageIndex;
+		}
+
+		uint64_t materialID = 0;
+		std::string hashString = file + "\\material#" + toString(m);
+
+		std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
+		picosha2::hash256(hashString.begin(), hashString.end(), hashStringHash.begin(), hashStringHash.end());
 
-		lodepng::decode(textureData, width, height, reinterpret_cast<uint8_t *>(textureFileData.data()), textureFileData.size(), LCT_RGBA);
+		for (uint64_t i = 0; i < 8; i++)
+			materialID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+
+		request->materials[m] = createModelMaterial(materialID, engine->get2DWhiteTextureView());
 
-		materialStagingTextures[i] = renderer->createStagingTexture({width, height, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, 1, 1);
-		renderer->fillStagingTextureSubresource(materialStagingTextures[i], textureData.data(), 0, 0);
+		const int materialTextureImages[MATERIAL_TEXTURE_SLOT_MAX_ENUM] = {albedoImage, normalsImage, roughnessMetalnessImage, AOImage};
 
-		material->materialTextures[i] = renderer->createTexture({width, height, 1}, RESOURCE_FORMAT_R8G8B8A8_UNORM, TEXTURE_USAGE_TRANSFER_DST_BIT | TEXTURE_USAGE_SAMPLED_BIT, MEMORY_USAGE_GPU_ONLY, false, 1, 1, 1);
-		material->materialTextureViews[i] = renderer->createTextureView(material->materialTextures[i]);
+		// glTF materials are opaque unless their alphaMode says otherwise
+		auto alphaModeIt = material.additionalValues.find("alphaMode");
+		bool usesAlpha = alphaModeIt != material.additionalValues.end() && alphaModeIt->second.string_value != "OPAQUE";
+
+		for (int t = 0; t < MATERIAL_TEXTURE_SLOT_MAX_ENUM; t++)
+		{
+			GLTFTextureImportJobData jobData = {};
+			jobData.resourceManager = this;
+			jobData.model = &model;
+			jobData.imageContentHashes = &imageContentHashes;
+			jobData.materialIndex = m;
+			jobData.imageIndex = materialTextureImages[t];
+			jobData.slot = MaterialTextureSlot(t);
+			jobData.usesAlpha = usesAlpha;
+			jobData.tier = request->textureCompressionTier;
+			jobData.texture = &request->textures[m * MATERIAL_MAX_TEXTURE_COUNT + t];
+
+			importJobDatas.push_back(std::move(jobData));
+		}
 	}
 
-	CommandPool tempCmdPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
-	Fence tempFence = renderer->createFence();
-	CommandBuffer tempCmdBuffer = tempCmdPool->allocateCommandBuffer();
-	tempCmdBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	// Every texture is read from the texture cache, or decoded and has it's mips generated, in a job of it's own
+	double importStartTime = engine->getTime();
 
-	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
+	for (size_t firstJob = 0; firstJob < importJobDatas.size(); firstJob += RESOURCE_TEXTURE_IMPORT_MAX_JOBS)
 	{
-		if (materialStagingTextures[i] != nullptr)
+		Job *importTexturesJob = JobSystem::get()->allocateJob(nullptr);
+		std::vector<Job*> importJobs;
+
+		for (size_t j = firstJob; j < std::min(firstJob + RESOURCE_TEXTURE_IMPORT_MAX_JOBS, importJobDatas.size()); j++)
 		{
-			ResourceBarrier barrier0 = {};
-			barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
-			barrier0.textureTransition.newLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier0.textureTransition.subresourceRange = {0, 1, 0, 1};
-			barrier0.textureTransition.texture = material->materialTextures[i];
+			Job *importJob = JobSystem::get()->allocateJobAsChild(importTexturesJob, &ResourceManager::gltfTextureImportJobFunction);
+			importJob->usrData = &importJobDatas[j];
+
+			importJobs.push_back(importJob);
+		}
 
-			ResourceBarrier barrier1 = {};
-			barrier1.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier1.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier1.textureTransition.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier1.textureTransition.subresourceRange = {0, 1, 0, 1};
-			barrier1.textureTransition.texture = material->materialTextures[i];
+		JobSystem::get()->runJobs(importJobs);
+		JobSystem::get()->runJob(importTexturesJob);
+		JobSystem::get()->waitForJob(importTexturesJob);
+	}
 
-			tempCmdBuffer->resourceBarriers({barrier0});
-			tempCmdBuffer->stageTextureSubresources(materialStagingTextures[i], material->materialTextures[i]);
-			tempCmdBuffer->resourceBarriers({barrier1});
+	for (GLTFTextureImportJobData &jobData : importJobDatas)
+	{
+		if (!jobData.succeeded)
+		{
+			Log::get()->error("ResourceManager: Failed to import texture #{} of material #{}, model \"{}\"", int(jobData.slot), jobData.materialIndex, file);
+			return false;
 		}
+
+		for (TextureCompileData &compileData : jobData.texturesToCompile)
+			texturesToCompile.push_back(std::move(compileData));
 	}
 
-	tempCmdBuffer->endCommands();
-	renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {tempCmdBuffer}, {}, {}, {}, tempFence);
+	double importTime = engine->getTime() - importStartTime;
+	double compileTime = 0.0;
 
-	renderer->waitForFence(tempFence, 5);
+	if (texturesToCompile.size() > 0)
+	{
+		double compileStartTime = engine->getTime();
 
-	renderer->destroyFence(tempFence);
-	renderer->destroyCommandPool(tempCmdPool);
+		if (!compileGLTFTextures(texturesToCompile))
+		{
+			Log::get()->error("ResourceManager: Failed to compile the textures of model \"{}\"", file);
+			return false;
+		}
 
-	for (int i = 0; i < MATERIAL_MAX_TEXTURE_COUNT; i++)
-		if (materialStagingTextures[i] != nullptr)
-			renderer->destroyStagingTexture(materialStagingTextures[i]);
+		compileTime = engine->getTime() - compileStartTime;
+	}
 
-	materialResources[material->materialID] = material;
+	Log::get()->info("ResourceManager: Loaded the {} textures of \"{}\", {} from the texture cache, imported in {:.3f} ms, {} compressed in {:.3f} ms", importJobDatas.size(), file, importJobDatas.size() - texturesToCompile.size(), importTime * 1000.0, texturesToCompile.size(), compileTime * 1000.0);
 
-	return material;
+	return true;
 }
 
-bool ResourceManager::importGLTFModel(const std::string &file)
+void ResourceManager::gltfTextureImportJobFunction(Job *job)
 {
-	ModelResource *modelResource = new ModelResource();
-
-	modelResource->sourceFile = file;
+	GLTFTextureImportJobData *jobData = reinterpret_cast<GLTFTextureImportJobData*>(job->usrData);
 
-	std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
-	picosha2::hash256(file.begin(), file.end(), hashStringHash.begin(), hashStringHash.end());
+	jobData->succeeded = jobData->resourceManager->importGLTFTexture(*jobData->model, *jobData->imageContentHashes, jobData->imageIndex, jobData->slot, jobData->usesAlpha, jobData->tier, *jobData->texture, jobData->texturesToCompile);
+}
 
-	for (uint64_t i = 0; i < 8; i++)
-		modelResource->modelID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+static CMP_FORMAT getCompressonatorFormat(ResourceFormat format)
+{
+	switch (format)
+	{
+		case RESOURCE_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			return CMP_FORMAT_BC1;
+		case RESOURCE_FORMAT_BC2_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC2_SRGB_BLOCK:
+			return CMP_FORMAT_BC2;
+		case RESOURCE_FORMAT_BC3_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC3_SRGB_BLOCK:
+			return CMP_FORMAT_BC3;
+		case RESOURCE_FORMAT_BC4_UNORM_BLOCK:
+			return CMP_FORMAT_BC4;
+		case RESOURCE_FORMAT_BC5_UNORM_BLOCK:
+			return CMP_FORMAT_BC5;
+		case RESOURCE_FORMAT_BC6H_UFLOAT_BLOCK:
+			return CMP_FORMAT_BC6H;
+		case RESOURCE_FORMAT_BC7_UNORM_BLOCK:
+		case RESOURCE_FORMAT_BC7_SRGB_BLOCK:
+			return CMP_FORMAT_BC7;
+		default:
+			return CMP_FORMAT_Unknown;
+	}
+}
 
-	tinygltf::Model model;
-	std::string err, warn;
+/*
+Compresses a tile of block rows w/ Compressonator. Every tile is it's own job, so Compressonator only gets one thread.
+*/
+static void textureCompressionTileJobFunction(Job *job)
+{
+	TextureCompressionTileJobData *tile = reinterpret_cast<TextureCompressionTileJobData*>(job->usrData);
+
+	CMP_CompressOptions options = {0};
+	options.dwSize = sizeof(options);
+	options.fquality = tile->quality;
+	options.dwnumThreads = 1;
+
+	CMP_Texture srcTexture;
+	srcTexture.dwSize = sizeof(CMP_Texture);
+	srcTexture.dwWidth = tile->width;
+	srcTexture.dwHeight = tile->height;
+	srcTexture.dwPitch = tile->width * sizeof(uint8_t) * 4;
+	srcTexture.dwDataSize = tile->width * tile->height * sizeof(uint8_t) * 4;
+	srcTexture.pData = const_cast<uint8_t*>(tile->srcData);
+	srcTexture.format = CMP_FORMAT_RGBA_8888;
+
+	CMP_Texture dstTexture;
+	dstTexture.dwSize = sizeof(CMP_Texture);
+	dstTexture.dwWidth = tile->width;
+	dstTexture.dwHeight = tile->height;
+	dstTexture.dwPitch = 0;
+	dstTexture.format = tile->dstFormat;
+	dstTexture.nBlockWidth = 4;
+	dstTexture.nBlockHeight = 4;
+	dstTexture.nBlockDepth = 1;
+	dstTexture.dwDataSize = uint32_t(tile->dstDataSize);
+	dstTexture.pData = tile->dstData;
+
+	tile->status = CMP_ConvertTexture(&srcTexture, &dstTexture, &options, nullptr, NULL, NULL);
+}
 
-	std::vector<char> modelFileData = FileLoader::instance()->readFileBuffer(file);
-	std::string modelFileBaseDirectory = FileLoader::instance()->getWorkingDir() + file.substr(0, file.find_last_of('/'));
+/*
+A fast 64 bit hash for texture and model cache keys, w/ xxHash64's round and avalanche functions
+*/
+static uint64_t hashTextureCacheData(const void *data, size_t size, uint64_t seed)
+{
+	const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+	const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+	const uint64_t prime3 = 0x165667B19E3779F9ull;
 
-	bool ret = false;
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>(data);
+	uint64_t hash = seed + prime3 + uint64_t(size);
+	size_t i = 0;
 
-	if (file.substr(file.size() - 3, 3) == "glb")
-		ret = gltfLoader->LoadBinaryFromMemory(&model, &err, &warn, reinterpret_cast<uint8_t *>(modelFileData.data()), modelFileData.size(), modelFileBaseDirectory);
-	else if (file.substr(file.size() - 4, 4) == "gltf")
-		ret = gltfLoader->LoadASCIIFromString(&model, &err, &warn, modelFileData.data(), modelFileData.size(), modelFileBaseDirectory, 1);
-	else
+	for (; i + 8 <= size; i += 8)
 	{
-		Log::get()->error("ResourceManager: Cannot load file \"{}\" because it is not a .glb or .gltf file!");
-		return false;
-	}
+		uint64_t lane;
+		memcpy(&lane, bytes + i, sizeof(lane));
 
-	if (!warn.empty())
-		Log::get()->warn("ResourceManager: Warning while loading glTF file \"{}\": \"{}\"", file, warn);
+		lane *= prime2;
+		lane = (lane << 31) | (lane >> 33);
+		lane *= prime1;
 
-	if (!err.empty())
-		Log::get()->warn("ResourceManager: Error while loading glTF file \"{}\": \"{}\"", file, err);
+		hash ^= lane;
+		hash = ((hash << 27) | (hash >> 37)) * prime1 + prime3;
+	}
 
-	if (!ret)
+	for (; i < size; i++)
 	{
-		Log::get()->error("ResourceManager: Failed to load glTF file \"{}\"", file);
-		return false;
+		hash ^= uint64_t(bytes[i]) * prime3;
+		hash = ((hash << 11) | (hash >> 53)) * prime1;
 	}
 
-	MaterialResource *modelMaterialResources = new MaterialResource[model.materials.size()];
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
 
-	if (!importGLTFMaterials(modelMaterialResources, model, file))
-		return false;
+	return hash;
+}
 
-	bool use32bitIndices = false;
+bool ResourceManager::importGLTFTexture(tinygltf::Model &model, const std::vector<uint64_t> &imageContentHashes, int imageIndex, MaterialTextureSlot slot, bool usesAlpha, TextureCompressionTier tier, TextureImportData &texture, std::vector<TextureCompileData> &texturesToCompile)
+{
+	const TextureCompressionPreset &preset = (slot == MATERIAL_TEXTURE_SLOT_ALBEDO && usesAlpha) ? textureCompressionPresetAlbedoAlpha : textureCompressionPresets[slot];
+	float quality = textureCompressionTierQualities[tier];
+	MipmapFilter mipmapFilter = textureCompressionTierMipmapFilters[tier];
+
+	// A missing texture is just the preset's default values, so every blank texture of a slot shares one cache entry
+	uint64_t sourceHash = imageIndex >= 0 ? imageContentHashes[imageIndex] : hashTextureCacheData(preset.defaultValues, sizeof(preset.defaultValues), 0);
+
+	// The same image compiled to another format or w/ other settings is a different entry
+	uint32_t cacheKeySettings[] = {RESOURCE_TEXTURE_CACHE_VERSION, uint32_t(preset.format), uint32_t(preset.sourceChannels[0]), uint32_t(preset.sourceChannels[1]), uint32_t(preset.sourceChannels[2]), uint32_t(preset.sourceChannels[3]), uint32_t(quality * 1000.0f), uint32_t(mipmapFilter)};
+	texture.cacheKey = hashTextureCacheData(cacheKeySettings, sizeof(cacheKeySettings), sourceHash);
+	std::string cacheFile = getTextureCacheFile(texture.cacheKey);
 
-	for (int i = 0; i < model.nodes.size(); i++)
+	// Cached textures are loaded w/ just their smallest mips, the rest are streamed in once they're needed
+	if (loadKETTexture(cacheFile, preset.format, texture, ~0u))
+		return true;
+
+	uint32_t width = 16, height = 16;
+	std::vector<uint8_t> imageData;
+
+	if (imageIndex >= 0)
 	{
-		const tinygltf::Node &gltfNode = model.nodes[i];
-		
-		if (gltfNode.mesh >= 0)
+		const tinygltf::Image &image = model.images[imageIndex];
+		const ImageDecoder *decoder = getImageDecoder(image.image.data(), image.image.size());
+		std::string error;
+
+		if (decoder == nullptr)
 		{
-			const tinygltf::Mesh &nodeMesh = model.meshes[gltfNode.mesh];
+			Log::get()->error("ResourceManager: Failed to decode image {}, it isn't a format any image decoder can read", imageIndex);
+			return false;
+		}
 
-			for (int p = 0; p < nodeMesh.primitives.size(); p++)
-			{
-				const tinygltf::Primitive &primitive = nodeMesh.primitives[p];
+		if (!decoder->readHeader(image.image.data(), image.image.size(), width, height, error))
+		{
+			Log::get()->error("ResourceManager: Failed to decode image {} w/ {}, error: {}", imageIndex, decoder->getName(), error);
+			return false;
+		}
 
-				if (model.accessors[primitive.indices].componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-				{
-					use32bitIndices = true;
-					break;
-				}
-			}
+		imageData.resize(size_t(width) * height * 4);
+
+		if (!decoder->decode(image.image.data(), image.image.size(), imageData.data(), width * 4, error))
+		{
+			Log::get()->error("ResourceManager: Failed to decode image {} w/ {}, error: {}", imageIndex, decoder->getName(), error);
+			return false;
 		}
 
-		if (use32bitIndices)
-			break;
+		// Decoders always give RGBA, grayscale images already have their luminance in red, green and blue
+		for (size_t p = 0; p < size_t(width) * height; p++)
+		{
+			uint8_t *texel = &imageData[p * 4];
+			uint8_t decodedTexel[4] = {texel[0], texel[1], texel[2], texel[3]};
+
+			for (uint32_t c = 0; c < 4; c++)
+				texel[c] = preset.sourceChannels[c] >= 0 ? decodedTexel[preset.sourceChannels[c]] : preset.defaultValues[c];
+		}
 	}
+	else
+	{
+		imageData.resize(size_t(width) * height * 4);
 
-	std::vector<uint8_t> modelIndexBuffer;
-	std::vector<uint8_t> modelVertexBuffer;
+		for (size_t p = 0; p < size_t(width) * height; p++)
+			memcpy(&imageData[p * 4], preset.defaultValues, 4);
+	}
+
+	texturesToCompile.push_back(TextureCompileData());
+	TextureCompileData &compileData = texturesToCompile.back();
+	compileData.texture = &texture;
+	compileData.cacheFile = cacheFile;
+	compileData.imageIndex = imageIndex;
+	compileData.quality = quality;
+
+	MipmapGeneratorOptions mipmapOptions = {};
+	mipmapOptions.filter = mipmapFilter;
+	mipmapOptions.sRGB = preset.sRGB;
+	mipmapOptions.alphaWeighted = preset.alphaWeighted;
+
+	generateImageMipmaps(imageData.data(), width, height, mipmapOptions, compileData.imageMipmaps);
+
+	texture.format = preset.format;
+	texture.width = width;
+	texture.height = height;
+	texture.data.resize(getTextureMipOffsets(preset.format, width, height, uint32_t(compileData.imageMipmaps.size()), texture.mipOffsets));
+
+	return true;
+}
 
-	ModelMeshNode *meshNodes = new ModelMeshNode[model.nodes.size()];
-	bool *meshNodesHasNoParent = new bool[model.nodes.size()];
+bool ResourceManager::compileGLTFTextures(std::vector<TextureCompileData> &texturesToCompile)
+{
+	std::vector<TextureCompressionTileJobData> tiles;
+	std::vector<size_t> textureFirstTiles;
 
-	for (int n = 0; n < model.nodes.size(); n++)
+	for (TextureCompileData &compileData : texturesToCompile)
 	{
-		const tinygltf::Node &gltfNode = model.nodes[n];
+		TextureImportData &texture = *compileData.texture;
+		CMP_FORMAT dstFormat = getCompressonatorFormat(texture.format);
 
-		ModelMeshNode &node = meshNodes[n];
-		node = ModelMeshNode();
+		textureFirstTiles.push_back(tiles.size());
 
-		meshNodesHasNoParent[n] = true;
+		for (uint32_t m = 0; m < compileData.imageMipmaps.size(); m++)
+		{
+			uint32_t mipWidth = std::max(texture.width >> m, 1u), mipHeight = std::max(texture.height >> m, 1u);
+			uint32_t rowSize, rowCount;
+			UploadManager::getTextureSubresourceSize(texture.format, mipWidth, mipHeight, rowSize, rowCount);
 
-		if (gltfNode.matrix.size() > 0)
+			uint32_t tileRowCount = std::max<uint32_t>(RESOURCE_TEXTURE_COMPRESSION_TILE_SIZE / rowSize, 1);
+
+			for (uint32_t row = 0; row < rowCount; row += tileRowCount)
+			{
+				TextureCompressionTileJobData tile = {};
+				tile.srcData = compileData.imageMipmaps[m].data() + size_t(row) * 4 * mipWidth * 4;
+				tile.width = mipWidth;
+				tile.height = std::min(tileRowCount * 4, mipHeight - row * 4);
+				tile.quality = compileData.quality;
+				tile.dstFormat = dstFormat;
+				tile.dstData = texture.data.data() + texture.mipOffsets[m] + size_t(row) * rowSize;
+				tile.dstDataSize = size_t(std::min(tileRowCount, rowCount - row)) * rowSize;
+				tile.status = CMP_OK;
+
+				tiles.push_back(tile);
+			}
+		}
+	}
+
+	textureFirstTiles.push_back(tiles.size());
+
+	// Jobs are allocated from a fixed size pool on each worker, so a model w/ lots of big textures has it's tiles run in a few rounds
+	for (size_t firstTile = 0; firstTile < tiles.size(); firstTile += RESOURCE_TEXTURE_COMPRESSION_MAX_TILE_JOBS)
+	{
+		size_t tileCount = std::min<size_t>(tiles.size() - firstTile, RESOURCE_TEXTURE_COMPRESSION_MAX_TILE_JOBS);
+		std::vector<Job*> tileJobs;
+
+		Job *compressTilesJob = JobSystem::get()->allocateJob(nullptr);
+
+		for (size_t t = firstTile; t < firstTile + tileCount; t++)
 		{
-			glm::mat4 gltfNodeMatrix;
+			Job *tileJob = JobSystem::get()->allocateJobAsChild(compressTilesJob, textureCompressionTileJobFunction);
+			tileJob->usrData = &tiles[t];
 
-			for (int x = 0; x < 4; x++)
-				for (int y = 0; y < 4; y++)
-					gltfNodeMatrix[x][y] = gltfNode.matrix[y * 4 + x];
+			tileJobs.push_back(tileJob);
+		}
 
-			glm::vec3 scale, translation, skew;
-			glm::quat orientation;
-			glm::vec4 perspective;
+		JobSystem::get()->runJobs(tileJobs);
+		JobSystem::get()->runJob(compressTilesJob);
+		JobSystem::get()->waitForJob(compressTilesJob);
+	}
 
-			glm::decompose(gltfNodeMatrix, scale, orientation, translation, skew, perspective);
+	for (size_t i = 0; i < texturesToCompile.size(); i++)
+	{
+		TextureCompileData &compileData = texturesToCompile[i];
+		TextureImportData &texture = *compileData.texture;
 
-			node.orientation = orientation;
-			node.position_scale = glm::vec4(translation.x, translation.y, translation.z, (scale.x + scale.y + scale.z) / 3.0f);
+		for (size_t t = textureFirstTiles[i]; t < textureFirstTiles[i + 1]; t++)
+		{
+			if (tiles[t].status != CMP_OK)
+			{
+				Log::get()->error("ResourceManager: Couldn't compress image {}! Error: {}", compileData.imageIndex, tiles[t].status);
+				return false;
+			}
 		}
-		else
+
+		// The decoded mips aren't needed anymore
+		compileData.imageMipmaps.clear();
+		compileData.imageMipmaps.shrink_to_fit();
+
+		uint32_t mipLevels = uint32_t(texture.mipOffsets.size());
+
+		if (!saveKETTexture(compileData.cacheFile, texture.format, texture.width, texture.height, 1, mipLevels, 1, texture.data.data(), texture.data.size()))
+			continue;
+
+		// Now that the texture's in the cache it can be streamed from there, so only it's smallest mips are kept just like a cache hit
+		uint32_t minMip = getTextureStreamingMinMip(texture.format, texture.width, texture.height, mipLevels);
+
+		if (minMip > 0)
 		{
-			if (gltfNode.rotation.size() > 0)
-				node.orientation = glm::quat(gltfNode.rotation[0], gltfNode.rotation[1], gltfNode.rotation[2], gltfNode.rotation[3]);
+			size_t minMipOffset = texture.mipOffsets[minMip];
 
-			if (gltfNode.translation.size() > 0)
-				node.position_scale = glm::vec4(gltfNode.translation[0], gltfNode.translation[1], gltfNode.translation[2], 1);
+			texture.data.erase(texture.data.begin(), texture.data.begin() + minMipOffset);
+			texture.mipOffsets.erase(texture.mipOffsets.begin(), texture.mipOffsets.begin() + minMip);
 
-			if (gltfNode.scale.size() > 0)
-				node.position_scale.w = (gltfNode.scale[0] + gltfNode.scale[1] + gltfNode.scale[2]) / 3.0f;
+			for (size_t &mipOffset : texture.mipOffsets)
+				mipOffset -= minMipOffset;
+
+			texture.streamingCacheFile = compileData.cacheFile;
+			texture.firstMip = minMip;
+			texture.fullWidth = texture.width;
+			texture.fullHeight = texture.height;
+			texture.fullMipLevels = mipLevels;
+			texture.width = std::max(texture.width >> minMip, 1u);
+			texture.height = std::max(texture.height >> minMip, 1u);
 		}
+	}
 
-		if (gltfNode.mesh >= 0)
-		{
-			const tinygltf::Mesh &mesh = model.meshes[gltfNode.mesh];
+	return true;
+}
 
-			for (int p = 0; p < mesh.primitives.size(); p++)
-			{
-				const tinygltf::Primitive &primitive = mesh.primitives[p];
-				const tinygltf::Accessor &primitiveIndexAccessor = model.accessors[primitive.indices];
+std::string ResourceManager::getTextureCacheFile(uint64_t cacheKey)
+{
+	char cacheKeyStr[17];
+	sprintf(cacheKeyStr, "%016llx", (unsigned long long) cacheKey);
 
-				ModelMeshDrawPrimitive drawPrimitive = {};
-				drawPrimitive.materialID = modelMaterialResources[primitive.material].materialID;
-				drawPrimitive.indexCount = primitiveIndexAccessor.count;
-				drawPrimitive.firstIndex = primitiveIndexAccessor.byteOffset / (use32bitIndices ? 4 : 2);
+	return FileLoader::instance()->getWorkingDir() + RESOURCE_TEXTURE_CACHE_DIRECTORY + cacheKeyStr + ".ket";
+}
 
-				node.drawPrimitives.push_back(drawPrimitive);
+bool ResourceManager::saveKETTexture(const std::string &filename, ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevels, uint32_t arrayLayers, const void *textureData, size_t textureDataSize)
+{
+	// Written to a temporary file first, so a load running at the same time never sees half of a texture
+	std::string tempFilename = filename + ".tmp" + toString(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	std::ofstream file(tempFilename, std::ios::out | std::ios::binary);
+
+	if (!file.is_open())
+	{
+		Log::get()->error("Failed to open file: {} for writing", tempFilename);
+
+		return false;
+	}
+	
+	KETHeader header = {};
+	header.magic = 0x2054454b;
+	header.format = uint32_t(format);
+	header.width = width;
+	header.height = height;
+	header.depth = depth;
+	header.mipLevels = mipLevels;
+	header.arrayLayers = arrayLayers;
+	
+	file.write(reinterpret_cast<const char*>(&header), sizeof(KETHeader));
+	file.write(reinterpret_cast<const char*>(textureData), textureDataSize);
 
-				// Append the index data to our global model index buffer
-				const tinygltf::BufferView &indexBufferView = model.bufferViews[primitiveIndexAccessor.bufferView];
-				uint8_t *meshIndexBuffer = model.buffers[indexBufferView.buffer].data.data() + indexBufferView.byteOffset + primitiveIndexAccessor.byteOffset;
+	file.close();
 
-				uint32_t indexSize = primitiveIndexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? 2 : 4;
+	std::error_code renameError;
+	std::filesystem::rename(tempFilename, filename, renameError);
 
-				if ((!use32bitIndices && indexSize == 2) || (use32bitIndices && indexSize == 4))
-				{
-					modelIndexBuffer.insert(modelIndexBuffer.end(), meshIndexBuffer, meshIndexBuffer + primitiveIndexAccessor.count * indexSize);
-				}
-				else if (use32bitIndices && indexSize == 2)
-				{
-					for (size_t index = 0; index < primitiveIndexAccessor.count; index++)
-					{
-						uint32_t indiceValue = meshIndexBuffer[index * indexSize] + (meshIndexBuffer[index * indexSize + 1] << 8);
-						modelIndexBuffer.insert(modelIndexBuffer.end(), reinterpret_cast<uint8_t *>(&indiceValue), reinterpret_cast<uint8_t *>(&indiceValue) + 4);
-					}
-				}
+	if (renameError)
+	{
+		std::filesystem::remove(tempFilename, renameError);
 
-				if (primitive.attributes.count("POSITION") == 0)
-				{
-					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex position data! File: \"{}\"", file);
-					return false;
-				}
+		return false;
+	}
 
-				if (primitive.attributes.count("NORMAL") == 0)
-				{
-					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex normal data! File: \"{}\"", file);
-					return false;
-				}
+	return true;
+}
 
-				if (primitive.attributes.count("TANGENT") == 0)
-				{
-					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex tangent data! File: \"{}\"", file);
-					return false;
-				}
+bool ResourceManager::loadKETTexture(const std::string &filename, ResourceFormat expectedFormat, TextureImportData &texture, uint32_t firstMip)
+{
+	std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
 
-				if (primitive.attributes.count("TEXCOORD_0") == 0)
-				{
-					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex texcoord/uv data! File: \"{}\"", file);
-					return false;
-				}
+	if (!file.is_open())
+		return false;
 
+	size_t fileSize = size_t(file.tellg());
+	file.seekg(0, std::ios::beg);
 
-				// Append the vertex data to our global model vertex buffer
-				if (primitive.attributes.count("POSITION") > 0)
-				{
-					const tinygltf::Accessor &vertexAccessor = model.accessors[primitive.attributes.find("POSITION")->second];
-					const tinygltf::Accessor &normalAccessor = model.accessors[primitive.attributes.find("NORMAL")->second];
-					const tinygltf::Accessor &tangentAccessor = model.accessors[primitive.attributes.find("TANGENT")->second];
-					const tinygltf::Accessor &texcoord0Accessor = model.accessors[primitive.attributes.find("TEXCOORD_0")->second];
+	KETHeader header = {};
 
-					tinygltf::Accessor *texcoord1Accessor = primitive.attributes.count("TEXCOORD_1") > 0 ? &model.accessors[primitive.attributes.find("TEXCOORD_1")->second] : nullptr;
+	if (fileSize < sizeof(KETHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(KETHeader)))
+		return false;
 
-					if (vertexAccessor.count != normalAccessor.count || normalAccessor.count != tangentAccessor.count || tangentAccessor.count != texcoord0Accessor.count || (texcoord1Accessor == nullptr ? false : texcoord0Accessor.count != texcoord1Accessor->count))
-					{
-						Log::get()->error("ResourceManager: Cannot load mesh primitive that has inconsistent attribute counts! File: \"{}\"", file);
-						return false;
-					}
+	if (header.magic != 0x2054454b || header.format != uint32_t(expectedFormat) || header.depth != 1 || header.arrayLayers != 1 || header.mipLevels == 0)
+		return false;
 
-					uint8_t *vertexDataPtr = model.buffers[model.bufferViews[vertexAccessor.bufferView].buffer].data.data() + model.bufferViews[vertexAccessor.bufferView].byteOffset + vertexAccessor.byteOffset;
-					uint8_t *normalDataPtr = model.buffers[model.bufferViews[normalAccessor.bufferView].buffer].data.data() + model.bufferViews[normalAccessor.bufferView].byteOffset + normalAccessor.byteOffset;
-					uint8_t *tangentDataPtr = model.buffers[model.bufferViews[tangentAccessor.bufferView].buffer].data.data() + model.bufferViews[tangentAccessor.bufferView].byteOffset + tangentAccessor.byteOffset;
-					uint8_t *texcoord0DataPtr = model.buffers[model.bufferViews[texcoord0Accessor.bufferView].buffer].data.data() + model.bufferViews[texcoord0Accessor.bufferView].byteOffset + texcoord0Accessor.byteOffset;
-					uint8_t *texcoord1DataPtr = texcoord1Accessor == nullptr ? nullptr : model.buffers[model.bufferViews[texcoord1Accessor->bufferView].buffer].data.data() + model.bufferViews[texcoord1Accessor->bufferView].byteOffset + texcoord1Accessor->byteOffset;
+	std::vector<size_t> fileMipOffsets;
+	size_t textureDataSize = getTextureMipOffsets(expectedFormat, header.width, header.height, header.mipLevels, fileMipOffsets);
 
-					size_t prevSize = modelVertexBuffer.size();
-					modelVertexBuffer.resize(modelVertexBuffer.size() + vertexAccessor.count * sizeof(NonSkinnedVertex));
-					NonSkinnedVertex *vertexBufferDataPtr = reinterpret_cast<NonSkinnedVertex*>(&modelVertexBuffer[prevSize]);
+	// Anything that doesn't add up is treated as a miss, and gets overwritten once the texture is compiled again
+	if (fileSize != sizeof(KETHeader) + textureDataSize)
+	{
+		Log::get()->warn("ResourceManager: Texture cache entry \"{}\" is the wrong size, ignoring it", filename);
 
-					for (size_t i = 0; i < vertexAccessor.count; i++)
-					{
-						glm::vec4 tangent;
-						glm::vec3 vertex, normal;
-						glm::vec2 uv0, uv1;
+		return false;
+	}
 
-						memcpy(&tangent, &tangentDataPtr[i * 4], sizeof(tangent));
-						memcpy(&vertex, &vertexDataPtr[i * 3], sizeof(vertex));
-						memcpy(&normal, &normalDataPtr[i * 3], sizeof(normal));
-						memcpy(&uv0, &texcoord0DataPtr[i * 2], sizeof(uv0));
-						
-						if (texcoord1DataPtr != nullptr)
-							memcpy(&uv1, &texcoord1DataPtr[i * 2], sizeof(uv1));
+	uint32_t minMip = getTextureStreamingMinMip(expectedFormat, header.width, header.height, header.mipLevels);
+	firstMip = std::min(firstMip, minMip);
 
-						vertexBufferDataPtr[i].vertex = vertex;
-						vertexBufferDataPtr[i].tangentHandedness = tangent.w;
-						vertexBufferDataPtr[i].normal = glm::vec4(normal.x, normal.y, normal.z, 0.0f);
-						vertexBufferDataPtr[i].tangent = tangent;
-						vertexBufferDataPtr[i].uv0 = uv0;
-						vertexBufferDataPtr[i].uv1 = uv1;
-					}
-				}
-				else
-				{
-					Log::get()->error("ResourceManager: Cannot load a mesh primitive that has no vertex position data! File: \"{}\"", file);
-					return false;
-				}
-			}
-		}
-	}
+	texture.format = expectedFormat;
+	texture.width = std::max(header.width >> firstMip, 1u);
+	texture.height = std::max(header.height >> firstMip, 1u);
 
-	for (int n = 0; n < model.nodes.size(); n++)
+	if (minMip > 0)
 	{
-		const tinygltf::Node &gltfNode = model.nodes[n];
-
-		for (int c = 0; c < gltfNode.children.size(); c++)
-		{
-			meshNodes[n].children.push_back(meshNodes[gltfNode.children[c]]);
-			meshNodesHasNoParent[gltfNode.children[c]] = false;
-		}
+		texture.streamingCacheFile = filename;
+		texture.firstMip = firstMip;
+		texture.fullWidth = header.width;
+		texture.fullHeight = header.height;
+		texture.fullMipLevels = header.mipLevels;
 	}
 
-	for (int n = 0; n < model.nodes.size(); n++)
-		if (meshNodesHasNoParent[n] && (meshNodes[n].children.size() > 0 ? true : meshNodes[n].drawPrimitives.size() > 0)) // If this mesh node has no parent (aka it's a top node) and it's actually rendering something (aka it has draw primitives or it's children have draw primitives) then add it
-			modelResource->meshNodes.push_back(meshNodes[n]);
+	// Mips are read straight from the file into staging memory, a mip w/o any padding between it's rows in a single read
+	uint32_t mipLevels = header.mipLevels - firstMip;
+	uint8_t *stagingData = allocateTextureImportStaging(uploadManager, texture, mipLevels);
 
-	printf("%u - %u\n", modelIndexBuffer.size(), modelVertexBuffer.size());
+	file.seekg(sizeof(KETHeader) + fileMipOffsets[firstMip], std::ios::beg);
 
-	delete[] meshNodes;
-	delete[] meshNodesHasNoParent;
+	for (uint32_t m = 0; m < mipLevels; m++)
+	{
+		uint32_t rowSize, rowCount;
+		UploadManager::getTextureSubresourceSize(expectedFormat, std::max(texture.width >> m, 1u), std::max(texture.height >> m, 1u), rowSize, rowCount);
 
-	//importResourceCmdPool
+		char *mipStagingData = reinterpret_cast<char*>(stagingData + texture.mipOffsets[m]);
+		bool readSucceeded = true;
 
-	modelResource->modelBuffer = renderer->createBuffer(modelIndexBuffer.size() + modelVertexBuffer.size(), BUFFER_USAGE_INDEX_BUFFER_BIT | BUFFER_USAGE_VERTEX_BUFFER_BIT | BUFFER_USAGE_TRANSFER_DST_BIT, BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL, MEMORY_USAGE_GPU_ONLY, false);
+		if (texture.mipRowPitches[m] == rowSize)
+			readSucceeded = bool(file.read(mipStagingData, size_t(rowSize) * rowCount));
+		else
+			for (uint32_t row = 0; row < rowCount && readSucceeded; row++)
+				readSucceeded = bool(file.read(mipStagingData + size_t(row) * texture.mipRowPitches[m], rowSize));
 
-	StagingBuffer modelStagingBuffer = renderer->createStagingBuffer(modelIndexBuffer.size() + modelVertexBuffer.size());
-	
-	uint8_t *modelStagingBufferData = reinterpret_cast<uint8_t *>(renderer->mapStagingBuffer(modelStagingBuffer));
-	memcpy(modelStagingBufferData, modelIndexBuffer.data(), modelIndexBuffer.size() * sizeof(modelIndexBuffer[0]));
-	memcpy(modelStagingBufferData + modelIndexBuffer.size() * sizeof(modelIndexBuffer[0]), modelVertexBuffer.data(), modelVertexBuffer.size() * sizeof(modelVertexBuffer[0]));
-	renderer->unmapStagingBuffer(modelStagingBuffer);
+		if (!readSucceeded)
+		{
+			freeTextureImportStaging(uploadManager, texture);
 
-	Fence tempFence = renderer->createFence();
-	CommandBuffer tempCmdBuffer = importResourceCmdPool->allocateCommandBuffer();
-	tempCmdBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			return false;
+		}
+	}
 
-	ResourceBarrier barrier0 = {};
-	barrier0.barrierType = RESOURCE_BARRIER_TYPE_BUFFER_TRANSITION;
-	barrier0.bufferTransition.oldLayout = BUFFER_LAYOUT_TRANSFER_DST_OPTIMAL;
-	barrier0.bufferTransition.newLayout = BUFFER_LAYOUT_VERTEX_INDEX_BUFFER;
-	barrier0.bufferTransition.buffer = modelResource->modelBuffer;
+	return true;
+}
 
-	tempCmdBuffer->endCommands();
-	renderer->submitToQueue(QUEUE_TYPE_TRANSFER, {tempCmdBuffer}, {}, {}, {}, tempFence);
+bool ResourceManager::gltfImageLoadingFunction(tinygltf::Image *image, const int image_idx, std::string *err, std::string *warn, int req_width, int req_height, const unsigned char *bytes, int size, void *user_data)
+{
+	std::vector<uint64_t> *imageContentHashes = reinterpret_cast<std::vector<uint64_t>*>(user_data);
 
-	renderer->waitForFence(tempFence, 5);
-	renderer->destroyFence(tempFence);
-	renderer->destroyStagingBuffer(modelStagingBuffer);
-	importResourceCmdPool->resetCommandPoolAndFreeCommandBuffer(tempCmdBuffer);
+	if (imageContentHashes->size() <= size_t(image_idx))
+		imageContentHashes->resize(image_idx + 1);
 
-	modelResources[modelResource->modelID] = modelResource;
+	(*imageContentHashes)[image_idx] = hashTextureCacheData(bytes, size_t(size), 0);
+	image->image.assign(bytes, bytes + size);
 
 	return true;
 }
 
-MaterialResource *ResourceManager::getMaterial(uint64_t materialID)
+/*
+Only the model's own file is checked, a .gltf's external buffers and images aren't
+*/
+static bool getModelSourceFileInfo(const std::string &file, uint64_t &fileSize, int64_t &writeTime)
 {
-	auto materialIt = materialResources.find(materialID);
+	std::error_code fileError;
+	std::filesystem::path sourcePath = FileLoader::instance()->getWorkingDir() + file;
+
+	fileSize = uint64_t(std::filesystem::file_size(sourcePath, fileError));
 
-	return materialIt != materialResources.end() ? materialIt->second : nullptr;
+	if (fileError)
+		return false;
+
+	writeTime = int64_t(std::filesystem::last_write_time(sourcePath, fileError).time_since_epoch().count());
+
+	return !fileError;
 }
 
-ModelResource *ResourceManager::getModel(uint64_t modelID)
+static void flattenModelCacheNodes(const std::vector<ModelMeshNode> &nodes, std::vector<ModelCacheNode> &cacheNodes, std::vector<ModelMeshDrawPrimitive> &drawPrimitives)
 {
-	auto modelIt = modelResources.find(modelID);
+	for (const ModelMeshNode &node : nodes)
+	{
+		ModelCacheNode cacheNode = {};
+		cacheNode.position_scale = node.position_scale;
+		cacheNode.orientation = node.orientation;
+		cacheNode.drawPrimitiveCount = uint32_t(node.drawPrimitives.size());
+		cacheNode.childCount = uint32_t(node.children.size());
 
-	return modelIt != modelResources.end() ? modelIt->second : nullptr;
+		cacheNodes.push_back(cacheNode);
+		drawPrimitives.insert(drawPrimitives.end(), node.drawPrimitives.begin(), node.drawPrimitives.end());
+
+		flattenModelCacheNodes(node.children, cacheNodes, drawPrimitives);
+	}
 }
 
-bool ResourceManager::importGLTFMaterials(MaterialResource *modelMaterialResources, tinygltf::Model &model, const std::string &file)
+/*
+Rebuilds nodeCount nodes and their children, fails if the counts in the nodes run past the end of either array
+*/
+static bool unflattenModelCacheNodes(const std::vector<ModelCacheNode> &cacheNodes, const std::vector<ModelMeshDrawPrimitive> &drawPrimitives, uint32_t nodeCount, size_t &nextNode, size_t &nextDrawPrimitive, std::vector<ModelMeshNode> &nodes)
 {
-	std::vector<uint8_t> blank16x16TextureData(16 * 16 * 4, 1);
-
-	for (int m = 0; m < model.materials.size(); m++)
+	for (uint32_t n = 0; n < nodeCount; n++)
 	{
-		const tinygltf::Material &material = model.materials[m];
+		if (nextNode >= cacheNodes.size())
+			return false;
 
-		printf("Material #%i - %s\n", m, material.name.c_str());
+		const ModelCacheNode &cacheNode = cacheNodes[nextNode++];
 
-		uint8_t *albedoTextureData = nullptr, *normalsTextureData = nullptr, *roughnessMetalnessTextureData = nullptr, *AOTextureData = nullptr;
-		uint8_t albedoTextureComponent = 4, normalsTextureComponent = 4, roughnessMetalnessTextureComponent = 4, AOTextureComponent = 4;
-		glm::uvec2 albedoTextureSize = glm::uvec2(16, 16), normalsTextureSize = glm::uvec2(16, 16), roughnessMetalnessTextureSize = glm::uvec2(16, 16), AOTextureSize = glm::uvec2(16, 16);
+		if (drawPrimitives.size() - nextDrawPrimitive < cacheNode.drawPrimitiveCount)
+			return false;
 
-		for (auto &param : material.values)
-		{
-			if (param.second.TextureTexCoord() != 0)
-				Log::get()->warn("ResourceManager: Multiple texcoord/uv indices aren't supported yet! Your model \"{}\" probably won't render correctly\n", file);
+		nodes.push_back(ModelMeshNode());
+		ModelMeshNode &node = nodes.back();
+		node.position_scale = cacheNode.position_scale;
+		node.orientation = cacheNode.orientation;
+		node.drawPrimitives.assign(drawPrimitives.begin() + nextDrawPrimitive, drawPrimitives.begin() + nextDrawPrimitive + cacheNode.drawPrimitiveCount);
 
-			tinygltf::Image &textureImage = model.images[model.textures[param.second.TextureIndex()].source];
+		nextDrawPrimitive += cacheNode.drawPrimitiveCount;
 
-			if (textureImage.as_is)
-			{
-				Log::get()->error("ResourceManager: Cannot load material for model \"{}\", texture data is provided \"as is\" and is not supported!", file);
-				return false;
-			}
+		if (!unflattenModelCacheNodes(cacheNodes, drawPrimitives, cacheNode.childCount, nextNode, nextDrawPrimitive, node.children))
+			return false;
+	}
 
-			if (textureImage.bits != 8)
-			{
-				Log::get()->error("ResourceManager: Image {} has a bitdepth of {}, must be 8! Model \"{}\"", param.first, textureImage.bits, file);
-				return false;
-			}
+	return true;
+}
 
-			if (param.first == "baseColorTexture")
-			{
-				albedoTextureSize = glm::uvec2(textureImage.width, textureImage.height);
-				albedoTextureData = textureImage.image.data();
-				albedoTextureComponent = textureImage.component;
-			}
-			else if (param.first == "metallicRoughnessTexture")
-			{
-				roughnessMetalnessTextureSize = glm::uvec2(textureImage.width, textureImage.height);
-				roughnessMetalnessTextureData = textureImage.image.data();
-				roughnessMetalnessTextureComponent = textureImage.component;
-			}
-		}
+std::string ResourceManager::getModelCacheFile(const std::string &sourceFile, TextureCompressionTier tier)
+{
+	// The model's textures are compiled w/ the tier, so a model imported w/ another tier refers to other texture cache entries
+	uint32_t cacheKeySettings[] = {RESOURCE_MODEL_CACHE_VERSION, uint32_t(modelVertexFormat), uint32_t(tier), uint32_t(sizeof(ModelMeshDrawPrimitive)), uint32_t(sizeof(ModelMeshlet))};
+	uint64_t cacheKey = hashTextureCacheData(cacheKeySettings, sizeof(cacheKeySettings), hashTextureCacheData(sourceFile.data(), sourceFile.size(), 0));
 
-		for (auto &param : material.additionalValues)
-		{
-			if (param.second.TextureTexCoord() != 0)
-				Log::get()->warn("ResourceManager: Multiple texcoord/uv indices aren't supported yet! Your model \"{}\" probably won't render correctly\n", file);
+	char cacheKeyStr[17];
+	sprintf(cacheKeyStr, "%016llx", (unsigned long long) cacheKey);
 
-			tinygltf::Image &textureImage = model.images[model.textures[param.second.TextureIndex()].source];
+	return FileLoader::instance()->getWorkingDir() + RESOURCE_MODEL_CACHE_DIRECTORY + cacheKeyStr + ".kmc";
+}
 
-			if (textureImage.as_is)
-			{
-				Log::get()->error("ResourceManager: Cannot load material for model \"{}\", texture data is provided \"as is\" and is not supported!", file);
-				return false;
-			}
+bool ResourceManager::loadModelCache(ResourceLoadRequest *request)
+{
+	ModelResource *modelResource = request->model;
+	std::string cacheFile = getModelCacheFile(modelResource->sourceFile, request->textureCompressionTier);
 
-			if (param.first == "normalTexture")
-			{
-				if (textureImage.bits != 8)
-				{
-					Log::get()->error("ResourceManager: Image {} has a bitdepth of {}, must be 8! Model \"{}\"", param.first, textureImage.bits, file);
-					return false;
-				}
+	uint64_t sourceFileSize;
+	int64_t sourceFileWriteTime;
 
-				normalsTextureSize = glm::uvec2(textureImage.width, textureImage.height);
-				normalsTextureData = textureImage.image.data();
-				normalsTextureComponent = textureImage.component;
-			}
-			else if (param.first == "occlusionTexture")
-			{
-				if (textureImage.bits != 8)
-				{
-					Log::get()->error("ResourceManager: Image {} has a bitdepth of {}, must be 8! Model \"{}\"", param.first, textureImage.bits, file);
-					return false;
-				}
+	if (!getModelSourceFileInfo(modelResource->sourceFile, sourceFileSize, sourceFileWriteTime))
+		return false;
 
-				AOTextureSize = glm::uvec2(textureImage.width, textureImage.height);
-				AOTextureData = textureImage.image.data();
-				AOTextureComponent = textureImage.component;
-			}
-		}
+	std::ifstream file(cacheFile, std::ios::in | std::ios::binary | std::ios::ate);
 
-		modelMaterialResources[m] = MaterialResource();
-		MaterialResource *materialResource = &modelMaterialResources[m];
-		materialResource->materialID = 0;
-		materialResource->pipelineID = 0;
+	if (!file.is_open())
+		return false;
 
-		std::string hashString = file + "\\material#" + toString(m);
+	size_t fileSize = size_t(file.tellg());
+	file.seekg(0, std::ios::beg);
 
-		std::vector<uint8_t> hashStringHash(picosha2::k_digest_size);
-		picosha2::hash256(hashString.begin(), hashString.end(), hashStringHash.begin(), hashStringHash.end());
+	ModelCacheHeader header = {};
 
-		for (uint64_t i = 0; i < 8; i++)
-			materialResource->materialID |= uint64_t(hashStringHash[31 - i]) << (i * 8);
+	if (fileSize < sizeof(ModelCacheHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(ModelCacheHeader)))
+		return false;
 
-		auto compressTexture = [&blank16x16TextureData, this, file, m](uint32_t width, uint32_t height, uint32_t component, uint8_t *srcTextureData, CMP_FORMAT dstFormat, std::vector<uint8_t> &outTextureData)
-		{
-			CMP_CompressOptions options = {0};
-			options.dwSize = sizeof(options);
-			options.fquality = 0.05f;
-			options.dwnumThreads = std::thread::hardware_concurrency();
+	if (header.magic != RESOURCE_MODEL_CACHE_MAGIC || header.version != RESOURCE_MODEL_CACHE_VERSION || header.vertexFormat != uint32_t(modelVertexFormat) || header.textureCompressionTier != uint32_t(request->textureCompressionTier))
+		return false;
 
-			CMP_Texture srcTexture;
-			srcTexture.dwSize = sizeof(CMP_Texture);
-			srcTexture.dwWidth = width;
-			srcTexture.dwHeight = height;
-			srcTexture.dwPitch = width * sizeof(uint8_t) * component;
-			srcTexture.dwDataSize = width * height * sizeof(uint8_t) * component;
-			srcTexture.pData = srcTextureData == nullptr ? blank16x16TextureData.data() : srcTextureData;
+	// A stale entry is just a miss, it's overwritten once the model has been imported again
+	if (header.sourceFileSize != sourceFileSize || header.sourceFileWriteTime != sourceFileWriteTime)
+		return false;
 
-			switch (component)
-			{
-				case 1:
-					srcTexture.format = CMP_FORMAT_R_8;
-					break;
-				case 2:
-					srcTexture.format = CMP_FORMAT_RG_8;
-					break;
-				case 3:
-					srcTexture.format = CMP_FORMAT_RGB_888;
-					break;
-				case 4:
-					srcTexture.format = CMP_FORMAT_RGBA_8888;
-					break;
-				default:
-					srcTexture.format = CMP_FORMAT_Unknown;
-			}
+	if (header.lodCount == 0 || header.lodCount > MODEL_MAX_LOD_LEVELS || header.vertexDataOffset > header.meshletDataOffset)
+		return false;
 
-			CMP_Texture dstTexture;
-			dstTexture.dwSize = sizeof(CMP_Texture);
-			dstTexture.dwWidth = width;
-			dstTexture.dwHeight = height;
-			dstTexture.dwPitch = 0;
-			dstTexture.format = dstFormat;
-			dstTexture.nBlockWidth = 4;
-			dstTexture.nBlockHeight = 4;
-			dstTexture.nBlockDepth = 1;
-			dstTexture.dwDataSize = CMP_CalculateBufferSize(&dstTexture);
-			dstTexture.pData = new uint8_t[dstTexture.dwDataSize];
-
-			double sT = engine->getTime();
-			CMP_ERROR   cmp_status;
-			cmp_status = CMP_ConvertTexture(&srcTexture, &dstTexture, &options, nullptr, NULL, NULL);
-			if (cmp_status != CMP_OK)
-			{
-				Log::get()->error("ResourceManager: Couldn't compress texture! Error: {}, Model: {}, Material #{}\n", cmp_status, file, m);
-				return;
-			}
+	size_t arraysSize = size_t(header.nodeCount) * sizeof(ModelCacheNode) + size_t(header.drawPrimitiveCount) * sizeof(ModelMeshDrawPrimitive) + size_t(header.materialCount) * sizeof(ModelCacheMaterial) + size_t(header.meshletCount) * sizeof(ModelMeshlet);
+	arraysSize += size_t(header.occluderVertexCount) * sizeof(glm::vec3) + size_t(header.occluderIndexCount) * sizeof(uint32_t);
 
-			printf("Compression took: %fms\n", (engine->getTime() - sT) * 1000.0);
+	if (fileSize != sizeof(ModelCacheHeader) + arraysSize + header.meshletDataOffset)
+	{
+		Log::get()->warn("ResourceManager: Model cache entry \"{}\" is the wrong size, ignoring it", cacheFile);
 
-			outTextureData.insert(outTextureData.end(), dstTexture.pData, dstTexture.pData + dstTexture.dwDataSize);
+		return false;
+	}
 
-			delete[] dstTexture.pData;
-		};
+	std::vector<ModelCacheNode> cacheNodes(header.nodeCount);
+	std::vector<ModelMeshDrawPrimitive> drawPrimitives(header.drawPrimitiveCount);
+	std::vector<ModelCacheMaterial> cacheMaterials(header.materialCount);
+	std::vector<ModelMeshlet> meshlets(header.meshletCount);
+	std::vector<glm::vec3> occluderVertices(header.occluderVertexCount);
+	std::vector<uint32_t> occluderIndices(header.occluderIndexCount);
 
-		std::vector<std::vector<uint8_t>> inAlbedoTextureData = createImageMipmaps(albedoTextureData, albedoTextureComponent, albedoTextureSize.x, albedoTextureSize.y);
-		std::vector<std::vector<uint8_t>> inNormalTextureData = createImageMipmaps(normalsTextureData, normalsTextureComponent, normalsTextureSize.x, normalsTextureSize.y);
+	if (!file.read(reinterpret_cast<char*>(cacheNodes.data()), cacheNodes.size() * sizeof(ModelCacheNode)) || !file.read(reinterpret_cast<char*>(drawPrimitives.data()), drawPrimitives.size() * sizeof(ModelMeshDrawPrimitive)))
+		return false;
 
-		std::vector<std::vector<uint8_t>> outAlbedoTextureData(inAlbedoTextureData.size()), outNormalsTextureData(inNormalTextureData.size());
+	if (!file.read(reinterpret_cast<char*>(cacheMaterials.data()), cacheMaterials.size() * sizeof(ModelCacheMaterial)) || !file.read(reinterpret_cast<char*>(meshlets.data()), meshlets.size() * sizeof(ModelMeshlet)))
+		return false;
 
-		StagingTexture albedoStagingTexture = renderer->createStagingTexture({albedoTextureSize.x, albedoTextureSize.y, 1}, RESOURCE_FORMAT_BC7_UNORM_BLOCK, (uint32_t)outAlbedoTextureData.size(), 1);
-		StagingTexture normalsStagingTexture = renderer->createStagingTexture({normalsTextureSize.x, normalsTextureSize.y, 1}, RESOURCE_FORMAT_BC7_UNORM_BLOCK, (uint32_t)outNormalsTextureData.size(), 1);
+	if (!file.read(reinterpret_cast<char*>(occluderVertices.data()), occluderVertices.size() * sizeof(glm::vec3)) || !file.read(reinterpret_cast<char*>(occluderIndices.data()), occluderIndices.size() * sizeof(uint32_t)))
+		return false;
 
-		for (size_t m = 0; m < inAlbedoTextureData.size(); m++)
+	for (uint32_t index : occluderIndices)
+	{
+		if (index >= occluderVertices.size())
 		{
-			compressTexture(std::max(albedoTextureSize.x >> m, 1u), std::max(albedoTextureSize.y >> m, 1u), albedoTextureComponent, inAlbedoTextureData[m].data(), CMP_FORMAT_BC7, outAlbedoTextureData[m]);
-			renderer->fillStagingTextureSubresource(albedoStagingTexture, outAlbedoTextureData[m].data(), m, 0);
-		}
+			Log::get()->warn("ResourceManager: Model cache entry \"{}\" has an invalid occluder mesh, ignoring it", cacheFile);
 
-		for (size_t m = 0; m < inNormalTextureData.size(); m++)
-		{
-			compressTexture(std::max(normalsTextureSize.x >> m, 1u), std::max(normalsTextureSize.y >> m, 1u), normalsTextureComponent, inNormalTextureData[m].data(), CMP_FORMAT_BC7, outNormalsTextureData[m]);
-			renderer->fillStagingTextureSubresource(normalsStagingTexture, outNormalsTextureData[m].data(), m, 0);
+			return false;
 		}
+	}
+
+	std::vector<ModelMeshNode> meshNodes;
+	size_t nextNode = 0, nextDrawPrimitive = 0;
 
-		materialResource->materialTextures[0] = renderer->createTexture({albedoTextureSize.x, albedoTextureSize.y, 1}, RESOURCE_FORMAT_BC7_UNORM_BLOCK, TEXTURE_USAGE_SAMPLED_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT, MEMORY_USAGE_GPU_ONLY, false, (uint32_t)outAlbedoTextureData.size(), 1, 1);
-		materialResource->materialTextures[1] = renderer->createTexture({normalsTextureSize.x, normalsTextureSize.y, 1}, RESOURCE_FORMAT_BC7_UNORM_BLOCK, TEXTURE_USAGE_SAMPLED_BIT | TEXTURE_USAGE_TRANSFER_DST_BIT, MEMORY_USAGE_GPU_ONLY, false, (uint32_t)outNormalsTextureData.size(), 1, 1);
+	if (!unflattenModelCacheNodes(cacheNodes, drawPrimitives, header.rootNodeCount, nextNode, nextDrawPrimitive, meshNodes) || nextNode != cacheNodes.size() || nextDrawPrimitive != drawPrimitives.size())
+	{
+		Log::get()->warn("ResourceManager: Model cache entry \"{}\" has an invalid node hierarchy, ignoring it", cacheFile);
 
-		materialResource->materialTextureViews[0] = renderer->createTextureView(materialResource->materialTextures[0], TEXTURE_VIEW_TYPE_2D, {0, (uint32_t)outAlbedoTextureData.size(), 0, 1});
-		materialResource->materialTextureViews[1] = renderer->createTextureView(materialResource->materialTextures[1], TEXTURE_VIEW_TYPE_2D, {0, (uint32_t)outNormalsTextureData.size(), 0, 1});
+		return false;
+	}
 
-		CommandPool tempCmdPool = renderer->createCommandPool(QUEUE_TYPE_GRAPHICS, COMMAND_POOL_TRANSIENT_BIT);
-		Fence tempFence = renderer->createFence();
-		CommandBuffer tempCmdBuffer = tempCmdPool->allocateCommandBuffer();
-		tempCmdBuffer->beginCommands(COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	// The textures are loaded w/ just their smallest mips like any other texture cache hit, a texture that's gone from the texture cache means the model has to be imported again
+	request->textures.resize(cacheMaterials.size() * MATERIAL_MAX_TEXTURE_COUNT);
 
-		for (uint32_t m = 0; m < (uint32_t)inAlbedoTextureData.size(); m++)
-		{
-			ResourceBarrier barrier0 = {};
-			barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
-			barrier0.textureTransition.newLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier0.textureTransition.subresourceRange = {m, 1, 0, 1};
-			barrier0.textureTransition.texture = materialResource->materialTextures[0];
+	bool texturesLoaded = true;
 
-			ResourceBarrier barrier1 = {};
-			barrier1.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier1.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier1.textureTransition.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier1.textureTransition.subresourceRange = {m, 1, 0, 1};
-			barrier1.textureTransition.texture = materialResource->materialTextures[0];
+	for (size_t m = 0; m < cacheMaterials.size() && texturesLoaded; m++)
+		for (uint32_t t = 0; t < MATERIAL_TEXTURE_SLOT_MAX_ENUM && texturesLoaded; t++)
+			texturesLoaded = loadKETTexture(getTextureCacheFile(cacheMaterials[m].textureCacheKeys[t]), ResourceFormat(cacheMaterials[m].textureFormats[t]), request->textures[m * MATERIAL_MAX_TEXTURE_COUNT + t], ~0u);
 
-			tempCmdBuffer->resourceBarriers({barrier0});
-			tempCmdBuffer->stageTextureSubresources(albedoStagingTexture, materialResource->materialTextures[0], {m, 1, 0, 1});
-			tempCmdBuffer->resourceBarriers({barrier1});
-		}
+	// The index and vertex data are read straight into the staging buffer the model buffer is uploaded from, followed by the meshlets
+	size_t meshletDataSize = meshlets.size() * sizeof(ModelMeshlet);
+	uint8_t *modelStagingData = nullptr;
 
-		for (uint32_t m = 0; m < (uint32_t)inNormalTextureData.size() - 2; m++)
-		{
-			ResourceBarrier barrier0 = {};
-			barrier0.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier0.textureTransition.oldLayout = TEXTURE_LAYOUT_INITIAL_STATE;
-			barrier0.textureTransition.newLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier0.textureTransition.subresourceRange = {m, 1, 0, 1};
-			barrier0.textureTransition.texture = materialResource->materialTextures[1];
+	if (texturesLoaded)
+	{
+		request->modelStagingBuffer = renderer->createStagingBuffer(header.meshletDataOffset + meshletDataSize);
+		modelStagingData = reinterpret_cast<uint8_t*>(renderer->mapStagingBuffer(request->modelStagingBuffer));
+	}
 
-			ResourceBarrier barrier1 = {};
-			barrier1.barrierType = RESOURCE_BARRIER_TYPE_TEXTURE_TRANSITION;
-			barrier1.textureTransition.oldLayout = TEXTURE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier1.textureTransition.newLayout = TEXTURE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier1.textureTransition.subresourceRange = {m, 1, 0, 1};
-			barrier1.textureTransition.texture = materialResource->materialTextures[1];
+	if (!texturesLoaded || !file.read(reinterpret_cast<char*>(modelStagingData), header.meshletDataOffset))
+	{
+		for (TextureImportData &textureData : request->textures)
+			freeTextureImportStaging(uploadManager, textureData);
 
-			tempCmdBuffer->resourceBarriers({barrier0});
-			tempCmdBuffer->stageTextureSubresources(normalsStagingTexture, materialResource->materialTextures[1], {m, 1, 0, 1});
-			tempCmdBuffer->resourceBarriers({barrier1});
+		if (request->modelStagingBuffer != nullptr)
+		{
+			renderer->unmapStagingBuffer(request->modelStagingBuffer);
+			renderer->destroyStagingBuffer(request->modelStagingBuffer);
+			request->modelStagingBuffer = nullptr;
 		}
 
-		tempCmdBuffer->endCommands();
-		renderer->submitToQueue(QUEUE_TYPE_GRAPHICS, {tempCmdBuffer}, {}, {}, {}, tempFence);
+		request->textures.clear();
 
-		renderer->waitForFence(tempFence, 5);
+		return false;
+	}
 
-		renderer->destroyFence(tempFence);
-		renderer->destroyCommandPool(tempCmdPool);
+	memcpy(modelStagingData + header.meshletDataOffset, meshlets.data(), meshletDataSize);
 
-		renderer->destroyStagingTexture(albedoStagingTexture);
-		renderer->destroyStagingTexture(normalsStagingTexture);
+	request->materials.resize(cacheMaterials.size());
 
-		materialResources[materialResource->materialID] = materialResource;
+	for (size_t m = 0; m < cacheMaterials.size(); m++)
+		request->materials[m] = createModelMaterial(cacheMaterials[m].materialID, engine->get2DWhiteTextureView());
 
-		//saveKETTexture("GameData/textures/test.ket");
-		//printf("%p %ux%u, %p %ux%u, %p %ux%u, %p %ux%u\n", albedoTextureData, albedoTextureSize.x, albedoTextureSize.y, normalsTextureData, normalsTextureSize.x, normalsTextureSize.y, roughnessMetalnessTextureData, roughnessMetalnessTextureSize.x, roughnessMetalnessTextureSize.y, AOTextureData, AOTextureSize.x, AOTextureSize.y);
-	}
+	request->use32bitIndices = header.uses32BitIndices != 0;
+
+	modelResource->vertexFormat = ModelVertexFormat(header.vertexFormat);
+	modelResource->vertexPositionOffset_scale = header.vertexPositionOffset_scale;
+	modelResource->vertexDataOffset = size_t(header.vertexDataOffset);
+	modelResource->meshletDataOffset = size_t(header.meshletDataOffset);
+	modelResource->lodCount = header.lodCount;
+	memcpy(modelResource->lodScreenCoverages, header.lodScreenCoverages, sizeof(header.lodScreenCoverages));
+	modelResource->meshNodes.swap(meshNodes);
+	modelResource->meshlets.swap(meshlets);
+	modelResource->occluderVertices.swap(occluderVertices);
+	modelResource->occluderIndices.swap(occluderIndices);
 
 	return true;
 }
 
-std::vector<std::vector<uint8_t>> ResourceManager::createImageMipmaps(const uint8_t *imageData, uint32_t component, uint32_t width, uint32_t height)
+void ResourceManager::saveModelCache(ResourceLoadRequest *request)
 {
-	uint32_t mipLevelCount = uint32_t(std::log2(glm::max(width, height))) + 1;
+	ModelResource *modelResource = request->model;
 
-	std::vector<std::vector<uint8_t>> imageMipmaps(mipLevelCount);
+	uint64_t sourceFileSize;
+	int64_t sourceFileWriteTime;
 
-	for (uint32_t m = 0; m < mipLevelCount; m++)
-		imageMipmaps[m].resize(std::max(width >> m, 4u) * std::max(height >> m, 1u) * component);
+	if (!getModelSourceFileInfo(modelResource->sourceFile, sourceFileSize, sourceFileWriteTime))
+		return;
 
-	// Mip 0
-	memcpy(imageMipmaps[0].data(), imageData, width * height * component);
+	std::vector<ModelCacheNode> cacheNodes;
+	std::vector<ModelMeshDrawPrimitive> drawPrimitives;
+	std::vector<ModelCacheMaterial> cacheMaterials(request->materials.size());
 
-	for (uint32_t m = 1; m < mipLevelCount; m++)
-	{
-		uint32_t mipWidth = std::max(width >> m, 1u);
-		uint32_t mipHeight = std::max(height >> m, 1u);
+	flattenModelCacheNodes(modelResource->meshNodes, cacheNodes, drawPrimitives);
 
-		uint32_t higherMipWidth = std::max(width >> (m - 1), 1u);
-		uint32_t higherMipHeight = std::max(height >> (m - 1), 1u);
+	for (size_t m = 0; m < request->materials.size(); m++)
+	{
+		cacheMaterials[m].materialID = request->materials[m]->materialID;
 
-		for (uint32_t y = 0; y < mipHeight; y++)
+		for (uint32_t t = 0; t < MATERIAL_TEXTURE_SLOT_MAX_ENUM; t++)
 		{
-			for (uint32_t x = 0; x < mipWidth; x++)
-			{
-				for (uint32_t c = 0; c < component; c++)
-				{
-					imageMipmaps[m][(y * mipWidth + x) * component + c] = uint32_t(
-						uint32_t(imageMipmaps[m - 1][(std::min(y * 2, higherMipHeight - 1) * higherMipWidth + std::min(x * 2, higherMipWidth - 1)) * component + c]) +
-						uint32_t(imageMipmaps[m - 1][(std::min(y * 2, higherMipHeight - 1) * higherMipWidth + std::min(x * 2 + 1, higherMipWidth - 1)) * component + c]) +
-						uint32_t(imageMipmaps[m - 1][(std::min(y * 2 + 1, higherMipHeight - 1) * higherMipWidth + std::min(x * 2, higherMipWidth - 1)) * component + c]) +
-						uint32_t(imageMipmaps[m - 1][(std::min(y * 2 + 1, higherMipHeight - 1) * higherMipWidth + std::min(x * 2 + 1, higherMipWidth - 1)) * component + c])) / 4;
-				}
-			}
+			cacheMaterials[m].textureCacheKeys[t] = request->textures[m * MATERIAL_MAX_TEXTURE_COUNT + t].cacheKey;
+			cacheMaterials[m].textureFormats[t] = uint32_t(request->textures[m * MATERIAL_MAX_TEXTURE_COUNT + t].format);
 		}
 	}
 
-	return imageMipmaps;
-}
-
-void ResourceManager::saveKETTexture(const std::string &filename, ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevels, uint32_t arrayLayers, const void *textureData, size_t textureDataSize)
-{
-	std::ofstream file(filename, std::ios::out | std::ios::binary);
+	// Laid out the same way recordLoadRequestUploads() lays out the model buffer
+	size_t vertexDataOffset = request->modelIndexBuffer.size();
+	size_t meshletDataOffset = (request->modelIndexBuffer.size() + request->modelVertexBuffer.size() + 15) & ~size_t(15);
+	const uint8_t padding[16] = {};
+
+	ModelCacheHeader header = {};
+	header.magic = RESOURCE_MODEL_CACHE_MAGIC;
+	header.version = RESOURCE_MODEL_CACHE_VERSION;
+	header.sourceFileSize = sourceFileSize;
+	header.sourceFileWriteTime = sourceFileWriteTime;
+	header.vertexFormat = uint32_t(modelResource->vertexFormat);
+	header.textureCompressionTier = uint32_t(request->textureCompressionTier);
+	header.uses32BitIndices = request->use32bitIndices ? 1 : 0;
+	header.lodCount = modelResource->lodCount;
+	memcpy(header.lodScreenCoverages, modelResource->lodScreenCoverages, sizeof(header.lodScreenCoverages));
+	header.vertexPositionOffset_scale = modelResource->vertexPositionOffset_scale;
+	header.rootNodeCount = uint32_t(modelResource->meshNodes.size());
+	header.nodeCount = uint32_t(cacheNodes.size());
+	header.drawPrimitiveCount = uint32_t(drawPrimitives.size());
+	header.materialCount = uint32_t(cacheMaterials.size());
+	header.meshletCount = uint64_t(modelResource->meshlets.size());
+	header.occluderVertexCount = uint32_t(modelResource->occluderVertices.size());
+	header.occluderIndexCount = uint32_t(modelResource->occluderIndices.size());
+	header.vertexDataOffset = uint64_t(vertexDataOffset);
+	header.meshletDataOffset = uint64_t(meshletDataOffset);
+
+	std::string cacheFile = getModelCacheFile(modelResource->sourceFile, request->textureCompressionTier);
+
+	// Written to a temporary file first just like the texture cache, another load of the same model could be reading it
+	std::string tempFilename = cacheFile + ".tmp" + toString(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	std::ofstream file(tempFilename, std::ios::out | std::ios::binary);
 
 	if (!file.is_open())
 	{
-		Log::get()->error("Failed to open file: {} for writing", filename);
+		Log::get()->error("Failed to open file: {} for writing", tempFilename);
 
 		return;
 	}
-	
-	KETHeader header = {};
-	header.magic = 0x2054454b;
-	header.format = uint32_t(format);
-	header.width = width;
-	header.height = height;
-	header.depth = depth;
-	header.mipLevels = mipLevels;
-	header.arrayLayers = arrayLayers;
-	
-	file.write(reinterpret_cast<const char*>(&header), sizeof(KETHeader));
-	file.write(reinterpret_cast<const char*>(textureData), textureDataSize);
 
+	file.write(reinterpret_cast<const char*>(&header), sizeof(ModelCacheHeader));
+	file.write(reinterpret_cast<const char*>(cacheNodes.data()), cacheNodes.size() * sizeof(ModelCacheNode));
+	file.write(reinterpret_cast<const char*>(drawPrimitives.data()), drawPrimitives.size() * sizeof(ModelMeshDrawPrimitive));
+	file.write(reinterpret_cast<const char*>(cacheMaterials.data()), cacheMaterials.size() * sizeof(ModelCacheMaterial));
+	file.write(reinterpret_cast<const char*>(modelResource->meshlets.data()), modelResource->meshlets.size() * sizeof(ModelMeshlet));
+	file.write(reinterpret_cast<const char*>(modelResource->occluderVertices.data()), modelResource->occluderVertices.size() * sizeof(glm::vec3));
+	file.write(reinterpret_cast<const char*>(modelResource->occluderIndices.data()), modelResource->occluderIndices.size() * sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(request->modelIndexBuffer.data()), request->modelIndexBuffer.size());
+	file.write(reinterpret_cast<const char*>(request->modelVertexBuffer.data()), request->modelVertexBuffer.size());
+	file.write(reinterpret_cast<const char*>(padding), meshletDataOffset - vertexDataOffset - request->modelVertexBuffer.size());
+
+	bool writeSucceeded = bool(file);
 	file.close();
-}
 
-bool ResourceManager::gltfImageLoadingFunction(tinygltf::Image *image, const int image_idx, std::string *err, std::string *warn, int req_width, int req_height, const unsigned char *bytes, int size, void *user_data)
-{
-	return tinygltf::LoadImageData(image, image_idx, err, warn, req_width, req_height, bytes, size, user_data);
-}
\ No newline at end of file
+	std::error_code renameError;
+
+	if (writeSucceeded)
+		std::filesystem::rename(tempFilename, cacheFile, renameError);
+
+	if (!writeSucceeded || renameError)
+		std::filesystem::remove(tempFilename, renameError);
+}
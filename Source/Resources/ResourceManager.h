@@ -4,6 +4,7 @@
 #include <common.h>
 #include <RendererCore/RendererEnums.h>
 #include <RendererCore/RendererObjects.h>
+#include <Resources/ResourceSlotArray.h>
 
 struct NonSkinnedVertex
 {
@@ -15,6 +16,82 @@ struct NonSkinnedVertex
 	glm::vec2 uv1;
 };
 
+/*
+NonSkinnedVertex w/ the normal and tangent octahedral encoded into snorm16 pairs and the uvs as half floats, 32 bytes
+*/
+struct CompressedNonSkinnedVertex
+{
+	glm::vec3 vertex;
+	float tangentHandedness;
+	int16_t normal[2];
+	int16_t tangent[2];
+	uint16_t uv0[2];
+	uint16_t uv1[2];
+};
+
+/*
+CompressedNonSkinnedVertex w/ the position quantized to snorm16s in the model's bounds (see ModelResource::vertexPositionOffset_scale), 24
+bytes. The tangent handedness is the position's w, which snorm16 stores exactly as -1 or 1.
+*/
+struct QuantizedNonSkinnedVertex
+{
+	int16_t vertex[4];
+	int16_t normal[2];
+	int16_t tangent[2];
+	uint16_t uv0[2];
+	uint16_t uv1[2];
+};
+
+/*
+Every format uses the same attribute locations: 0 - position (w is the tangent handedness), 1 - uv0, 2 - normal, 3 - tangent. The compressed
+formats only have the octahedral xy of the normal and tangent, which the vertex shaders have to decode.
+*/
+typedef enum ModelVertexFormat
+{
+	MODEL_VERTEX_FORMAT_FULL = 0, // NonSkinnedVertex
+	MODEL_VERTEX_FORMAT_COMPRESSED, // CompressedNonSkinnedVertex
+	MODEL_VERTEX_FORMAT_QUANTIZED, // QuantizedNonSkinnedVertex
+	MODEL_VERTEX_FORMAT_MAX_ENUM
+} ModelVertexFormat;
+
+/*
+Resources loaded w/ the async functions stay RESOURCE_LOAD_STATE_LOADING until ResourceManager::update() sees their upload has finished
+*/
+typedef enum ResourceLoadState
+{
+	RESOURCE_LOAD_STATE_LOADING = 0,
+	RESOURCE_LOAD_STATE_LOADED,
+	RESOURCE_LOAD_STATE_FAILED,
+	RESOURCE_LOAD_STATE_MAX_ENUM
+} ResourceLoadState;
+
+/*
+Where each texture of a material goes in MaterialResource::materialTextures. Model textures are compressed differently for each slot:
+	albedo - BC1 for opaque materials, BC7 for materials that use alpha
+	normals - BC7 w/ the tangent space xyz, it can be BC5 w/ just x and y once the shaders reconstruct z
+	roughness/metalness - BC5 w/ roughness in red and metalness in green (moved from glTF's green and blue)
+	AO - BC4
+*/
+typedef enum MaterialTextureSlot
+{
+	MATERIAL_TEXTURE_SLOT_ALBEDO = 0,
+	MATERIAL_TEXTURE_SLOT_NORMALS,
+	MATERIAL_TEXTURE_SLOT_ROUGHNESS_METALNESS,
+	MATERIAL_TEXTURE_SLOT_AO,
+	MATERIAL_TEXTURE_SLOT_MAX_ENUM
+} MaterialTextureSlot;
+
+/*
+How long Compressonator spends on each model texture, textures compiled w/ each tier get their own texture cache entries
+*/
+typedef enum TextureCompressionTier
+{
+	TEXTURE_COMPRESSION_TIER_FAST = 0,
+	TEXTURE_COMPRESSION_TIER_NORMAL,
+	TEXTURE_COMPRESSION_TIER_HIGH_QUALITY,
+	TEXTURE_COMPRESSION_TIER_MAX_ENUM
+} TextureCompressionTier;
+
 struct MaterialDefinition
 {
 	uint64_t pipelineID;
@@ -26,22 +103,66 @@ struct MaterialResource
 {
 	uint64_t materialID;
 	uint64_t pipelineID;
+	ResourceHandle handle;
+
+	ResourceLoadState loadState;
+	size_t gpuMemorySize; // The size of it's textures, counted against the resource manager's GPU budget
 
 	std::string textureFiles[MATERIAL_MAX_TEXTURE_COUNT];
 
-	Texture materialTextures[MATERIAL_MAX_TEXTURE_COUNT];
-	TextureView materialTextureViews[MATERIAL_MAX_TEXTURE_COUNT];
+	Texture materialTextures[MATERIAL_MAX_TEXTURE_COUNT]; // nullptr until the material is loaded
+	TextureView materialTextureViews[MATERIAL_MAX_TEXTURE_COUNT]; // The engine's white texture until the material is loaded
+
+	/*
+	The most detailed mip of each texture that's resident, 0 if every mip is loaded. Streamed textures only have the mips from it down, so
+	their views never include a mip that isn't resident.
+	*/
+	uint32_t materialTexturesLowestLoadedLevel[MATERIAL_MAX_TEXTURE_COUNT];
 
-	//uint32_t materialTexturesLowestLoadedLevel[MATERIAL_MAX_TEXTURE_COUNT]; // Used to see which mipmaps are loaded, 0 if all mips are loaded, ~0u if none are loaded
-	//uint32_t materialTextureMipLevelReferenceCount[MATERIAL_MAX_TEXTURE_COUNT][16]; // A reference counter for each texture and each LOD to see which mips are being used, lower levels take priority
+	float requestedScreenSize; // In pixels, the biggest the material was asked to be drawn at since the last update, 0 if it wasn't asked for
+};
+
+/*
+An index range for one LOD of a draw primitive, every LOD of a primitive indexes the same vertices
+*/
+struct ModelMeshLODRange
+{
+	uint32_t indexCount;
+	uint32_t firstIndex;
+};
+
+/*
+A run of consecutive triangles from a draw primitive's LOD 0 indices that uses at most MODEL_MESHLET_MAX_VERTICES vertices. The bounds are
+in the same space as the vertex positions (so before ModelResource::vertexPositionOffset_scale), and the cone contains every triangle's
+normal, so every triangle in the meshlet is back facing if dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius.
+*/
+struct ModelMeshlet
+{
+	glm::vec4 boundingSphere; // xyz - center, w - radius
+	glm::vec4 coneAxis_cutoff; // xyz - cone axis, w - cone cutoff, 1 if the normals are too spread out for the meshlet to ever be back facing
+	uint32_t firstIndex; // Into the whole model's index data
+	uint32_t triangleCount;
+	int32_t vertexOffset; // The draw primitive's vertexOffset
+	uint32_t padding;
 };
 
 struct alignas(64) ModelMeshDrawPrimitive
 {
 	uint64_t materialID;
 
-	uint32_t indexCount;
-	uint32_t firstIndex;
+	uint32_t indexCount; // LOD 0
+	uint32_t firstIndex; // Into the whole model's index data
+	int32_t vertexOffset; // Added to each index, the primitive's first vertex in the model's vertex data
+
+	ModelMeshLODRange lodRanges[MODEL_MAX_LOD_LEVELS - 1]; // LODs 1 and up, only the first (ModelResource::lodCount - 1) are valid
+
+	uint32_t firstMeshlet; // Into ModelResource::meshlets, the meshlets cover LOD 0 in index order
+	uint32_t meshletCount;
+
+	inline ModelMeshLODRange getLODRange(uint32_t lod) const
+	{
+		return lod == 0 ? ModelMeshLODRange{indexCount, firstIndex} : lodRanges[lod - 1];
+	}
 };
 
 struct ModelMeshNode
@@ -56,55 +177,319 @@ struct ModelMeshNode
 struct ModelResource
 {
 	uint64_t modelID;
+	ResourceHandle handle;
 	
 	std::string sourceFile; // If empty() then there was no source file
 
-	Buffer modelBuffer;
+	ResourceLoadState loadState;
+	size_t cpuMemorySize; // Counted against the resource manager's budgets once the model is loaded
+	size_t gpuMemorySize;
+
+	Buffer modelBuffer; // The index data for all primitives, followed by all of the vertex data (starting at vertexDataOffset), then the meshlets
+	size_t vertexDataOffset;
+	size_t meshletDataOffset;
+	bool uses32BitIndices;
+
+	ModelVertexFormat vertexFormat;
+	glm::vec4 vertexPositionOffset_scale; // A vertex's position in the model is xyz + position * w, only quantized positions aren't (0, 0, 0, 1)
+
+	/*
+	Every draw primitive in the model has the same number of LODs. The model switches to LOD i once the projected diameter of an object's
+	bounding sphere covers less than lodScreenCoverages[i] of the screen's height, [0] is always 1.
+	*/
+	uint32_t lodCount;
+	float lodScreenCoverages[MODEL_MAX_LOD_LEVELS];
 
 	std::vector<ModelMeshNode> meshNodes;
+	std::vector<ModelMeshlet> meshlets; // Every draw primitive's meshlets, in the same order as the primitives' index data
+
+	/*
+	LOD 0 of every draw primitive in the model's space, kept on the CPU so the model can be rasterized as an occluder by
+	SoftwareOcclusionCuller. Both are empty if the model has more than MODEL_MAX_OCCLUDER_TRIANGLES triangles.
+	*/
+	std::vector<glm::vec3> occluderVertices;
+	std::vector<uint32_t> occluderIndices;
+
+	std::vector<MaterialResource*> materials; // Every material the draw primitives use, set once the model is loaded, the model holds a reference to each
+
+	/*
+	Folds vertexPositionOffset_scale into an object's transform, so shaders can use the vertex positions as they are in every format
+	*/
+	inline glm::vec4 getInstancePositionScale(const glm::vec3 &position, float scale, const glm::quat &orientation) const
+	{
+		return glm::vec4(position + orientation * (glm::vec3(vertexPositionOffset_scale) * scale), scale * vertexPositionOffset_scale.w);
+	}
 };
 
 class KalosEngine;
 class Renderer;
+class UploadManager;
+class ImageDecoder;
 
 namespace tinygltf
 {
-	class TinyGLTF;
 	struct Model;
 	struct Image;
 }
 
+struct ResourceLoadRequest;
+struct TextureImportData;
+struct TextureCompileData;
+struct StreamedTexture;
+struct TextureStreamingLoad;
+
+/*
+A texture that streaming replaced or a buffer of an evicted resource, which is destroyed once the frames that could still be drawing w/
+it have finished. Only some of the members are set.
+*/
+struct RetiredGPUResource
+{
+	Texture texture;
+	TextureView textureView;
+	Buffer buffer;
+	uint64_t retiredFrame;
+};
+
+#define RESOURCE_TEXTURE_CACHE_DIRECTORY "GameData/cache/textures/" // In the working directory
+#define RESOURCE_TEXTURE_CACHE_VERSION 3 // Part of every cache key, so changing how textures are compiled doesn't load old cache entries
+
+#define RESOURCE_MODEL_CACHE_DIRECTORY "GameData/cache/models/" // In the working directory
+#define RESOURCE_MODEL_CACHE_VERSION 2 // Part of every cache key, like RESOURCE_TEXTURE_CACHE_VERSION
+
+#define RESOURCE_TEXTURE_STREAMING_MIN_SIZE 64 // Streamed textures always have every mip this size and smaller, and are first loaded w/ just those
+#define RESOURCE_TEXTURE_STREAMING_DEFAULT_BUDGET (256 * 1024 * 1024) // 256 MB
+#define RESOURCE_TEXTURE_STREAMING_MAX_LOADS 4 // Streaming loads in flight at once
+#define RESOURCE_TEXTURE_STREAMING_REQUEST_FRAMES 60 // A texture that isn't asked for in this many frames is evicted down to it's smallest mips
+
+#define RESOURCE_DEFAULT_CPU_MEMORY_BUDGET (512 * 1024 * 1024) // 512 MB
+#define RESOURCE_DEFAULT_GPU_MEMORY_BUDGET (1024 * 1024 * 1024) // 1 GB
+
 class ResourceManager
 {
 public:
 	ResourceManager(KalosEngine *enginePtr);
 	virtual ~ResourceManager();
 
-	MaterialResource *loadMaterial(const MaterialDefinition &definition);
+	/*
+	Finishes the loads whose upload batch has finished, and records the uploads of every load that's finished decoding into the engine's
+	upload manager. Called once per frame, resources loaded w/ the async functions are only ever finished here. Unreferenced resources are
+	then evicted, the ones released the longest time ago first, for as long as either memory budget is exceeded.
+	*/
+	void update();
 
+	/*
+	The material's handle is acquired for the caller, who has to release it once the material isn't needed anymore
+	*/
+	ResourceHandle loadMaterial(const MaterialDefinition &definition);
 	bool importGLTFModel(const std::string &file);
 
-	MaterialResource *getMaterial(uint64_t materialID);
-	ModelResource *getModel(uint64_t modelID);
+	/*
+	Reads and decodes the files on the job system and returns straight away. The material can be used right away, it's textures are the
+	engine's white texture until it's loaded, getModel() returns nullptr for the model until it's loaded. Like loadMaterial(), the
+	returned handle is acquired for the caller, who has to release it once the resource isn't needed anymore.
+	*/
+	ResourceHandle loadMaterialAsync(const MaterialDefinition &definition);
+	ResourceHandle importGLTFModelAsync(const std::string &file);
+
+	/*
+	Resolving an ID is a hash lookup, anything that uses a resource every frame should keep it's handle instead. Acquiring a handle keeps
+	the resource from being evicted until it's released, a resource that's still loading can be acquired too. A null handle is returned
+	for an ID that was never loaded, or has been evicted since.
+	*/
+	ResourceHandle findMaterial(uint64_t materialID) const;
+	ResourceHandle findModel(uint64_t modelID) const;
+	ResourceHandle acquireMaterial(uint64_t materialID);
+	ResourceHandle acquireModel(uint64_t modelID);
+	void acquireMaterial(ResourceHandle handle);
+	void acquireModel(ResourceHandle handle);
+	void releaseMaterial(ResourceHandle handle);
+	void releaseModel(ResourceHandle handle);
+
+	MaterialResource *getMaterial(ResourceHandle handle) const;
+	ModelResource *getModel(ResourceHandle handle) const; // Only returns loaded models
+	MaterialResource *getMaterial(uint64_t materialID) const;
+	ModelResource *getModel(uint64_t modelID) const;
+	ResourceLoadState getModelLoadState(uint64_t modelID) const;
+
+	uint32_t getPendingLoadCount() const;
+
+	/*
+	Loaded models and materials count against these budgets. Only resources that nothing references are ever evicted, so the usage can go
+	over a budget when too much is referenced at once.
+	*/
+	void setMemoryBudgets(size_t cpuBudget, size_t gpuBudget);
+	size_t getCPUMemoryUsage() const;
+	size_t getGPUMemoryUsage() const;
+
+	/*
+	The format every model is stored in, pipelines that draw models have to be made w/ the matching vertex input from getModelVertexInput().
+	Can only be changed before any models are imported.
+	*/
+	void setModelVertexFormat(ModelVertexFormat format);
+	ModelVertexFormat getModelVertexFormat() const;
+
+	/*
+	The per vertex binding and attributes for the current model vertex format, at locations 0 to 3 (or only location 0 if positionOnly)
+	*/
+	void getModelVertexInput(uint32_t binding, bool positionOnly, VertexInputBinding &vertexBinding, std::vector<VertexInputAttribute> &vertexAttribs) const;
+
+	/*
+	Used for the textures of models imported after it's set. Textures that were cached w/ a different tier are compiled again.
+	*/
+	void setTextureCompressionTier(TextureCompressionTier tier);
+	TextureCompressionTier getTextureCompressionTier() const;
+
+	/*
+	Adds a decoder for material textures and model images. Decoders added later are tried first, so a faster decoder can take over a format
+	from the built in lodepng and stb_image ones. Can't be called while anything is loading, the decode jobs read the list w/o a lock.
+	*/
+	void addImageDecoder(std::unique_ptr<ImageDecoder> decoder);
+
+	/*
+	Asks for the model's streamed textures to have the mips needed to draw it w/ a bounding sphere that covers screenCoverage of the screen's
+	height (see getWorldLODScreenCoverage()), assuming each texture is stretched once across the sphere. Has to be called every frame the
+	model could be visible, textures that stop being asked for are evicted down to their smallest mips.
+	*/
+	void requestModelTextureDetail(ResourceHandle modelHandle, float screenCoverage);
+
+	/*
+	How many bytes the mips of every streamed texture can take up together. When more detailed mips don't fit, the textures that were asked
+	for the longest time ago are evicted to make room, and if that isn't enough the texture is only streamed in as far as it fits.
+	*/
+	void setTextureStreamingBudget(size_t budget);
+	size_t getTextureStreamingBudget() const;
+	size_t getTextureStreamingResidentSize() const;
 
 private:
 	
 	KalosEngine *engine;
 	Renderer *renderer;
 
-	CommandPool importResourceCmdPool;
+	ResourceSlotArray<MaterialResource> materialResources;
+	ResourceSlotArray<ModelResource> modelResources;
+	std::unordered_map<uint64_t, ResourceHandle> materialHandles; // By material/model ID
+	std::unordered_map<uint64_t, ResourceHandle> modelHandles;
+
+	size_t cpuMemoryBudget;
+	size_t gpuMemoryBudget;
+	size_t cpuMemoryUsage;
+	size_t gpuMemoryUsage;
+
+	ModelVertexFormat modelVertexFormat;
+	TextureCompressionTier textureCompressionTier;
+
+	std::vector<std::unique_ptr<ImageDecoder>> imageDecoders;
 
-	std::unique_ptr<tinygltf::TinyGLTF> gltfLoader;
+	UploadManager *uploadManager;
 
-	std::unordered_map<uint64_t, MaterialResource*> materialResources;
-	std::unordered_map<uint64_t, ModelResource *> modelResources;
+	std::vector<ResourceLoadRequest*> pendingLoadRequests; // Waiting on their decode job, in the order they were made
+	std::vector<ResourceLoadRequest*> uploadingLoadRequests; // Waiting on the upload batch they were recorded into
 
-	bool importGLTFMaterials(MaterialResource *modelMaterialResources, tinygltf::Model &model, const std::string &file);
-	std::vector<std::vector<uint8_t>> createImageMipmaps(const uint8_t *imageData, uint32_t component, uint32_t width, uint32_t height);
+	std::vector<StreamedTexture*> streamedTextures;
+	std::vector<TextureStreamingLoad*> textureStreamingLoads; // In the order they were started
+	std::vector<RetiredGPUResource> retiredGPUResources;
 
+	size_t textureStreamingBudget;
+	size_t textureStreamingResidentSize;
+	uint64_t frameIndex; // Counts calls to update()
+
+	ResourceHandle registerMaterial(MaterialResource *material);
+	ResourceHandle registerModel(ModelResource *model);
+
+	/*
+	Deletes the resource and frees it's slot, whether or not anything still has a handle to it. Their textures and buffers are retired, and
+	a model releases it's materials.
+	*/
+	void freeMaterial(MaterialResource *material);
+	void freeModel(ModelResource *model);
+
+	/*
+	Streamed textures w/ a load in flight can't be freed until it's finished
+	*/
+	bool canFreeMaterial(const MaterialResource *material) const;
+
+	void evictUnusedResources();
+	void destroyRetiredGPUResources(bool destroyAll);
+
+	static void loadRequestJobFunction(Job *job);
+	void runLoadRequest(ResourceLoadRequest *request);
+	void waitForLoadRequest(ResourceLoadState *loadState);
+
+	bool decodeMaterial(ResourceLoadRequest *request);
+	bool decodeGLTFModel(ResourceLoadRequest *request);
+
+	/*
+	A model is saved to the model cache the first time it's imported, and is loaded from there until it's source file changes. Loading a
+	cached model skips tinygltf and every step of the import, it's index and vertex data are read straight into staging memory in one read.
+	*/
+	std::string getModelCacheFile(const std::string &sourceFile, TextureCompressionTier tier);
+	bool loadModelCache(ResourceLoadRequest *request);
+	void saveModelCache(ResourceLoadRequest *request);
+
+	/*
+	Every texture of a material, and every image of a model's materials, is decoded by a job of it's own
+	*/
+	static void materialTextureDecodeJobFunction(Job *job);
+	static void gltfTextureImportJobFunction(Job *job);
+
+	const ImageDecoder *getImageDecoder(const uint8_t *fileData, size_t fileSize) const;
+
+	/*
+	Reads a material's texture file and decodes it straight into a staging buffer sized from the image's header
+	*/
+	bool decodeMaterialTexture(const std::string &file, TextureImportData &textureData);
+
+	void recordLoadRequestUploads(ResourceLoadRequest *request);
+	void finishLoadRequest(ResourceLoadRequest *request, bool succeeded);
+
+	/*
+	Swaps in the textures whose streaming loads have finished uploading, decides which mips each streamed texture should have from how big
+	it's material was asked to be drawn, and starts loads for the textures that need more detailed mips or can be evicted to fewer
+	*/
+	void updateTextureStreaming();
+	void registerStreamedTexture(MaterialResource *material, uint32_t slot, const TextureImportData &textureData);
+	void startTextureStreamingLoad(StreamedTexture *texture, uint32_t firstMip);
+	static void textureStreamingLoadJobFunction(Job *job);
+
+	/*
+	Welds, reorders and generates LODs for each of the given draw primitives in parallel on the job system, then rebuilds the model's
+	index and vertex buffers from the results, w/ the LOD indices after every primitive's LOD 0 indices
+	*/
+	void optimizeModelPrimitives(ModelResource *modelResource, ModelMeshNode *meshNodes, const std::vector<std::pair<int, int>> &primitives, const std::vector<size_t> &primitiveVertexCounts, std::vector<uint8_t> &modelIndexBuffer, std::vector<uint8_t> &modelVertexBuffer, bool use32bitIndices);
+
+	/*
+	Converts the model's NonSkinnedVertex data to the current model vertex format, and sets the model's vertex format/position offset and scale
+	*/
+	void encodeModelVertices(ModelResource *modelResource, std::vector<uint8_t> &modelVertexBuffer);
+
+	bool importGLTFMaterials(ResourceLoadRequest *request, tinygltf::Model &model, const std::vector<uint64_t> &imageContentHashes);
+
+	/*
+	Reads one of a model's images (or a blank texture if imageIndex is -1) from the texture cache if the same image has been compiled for the
+	same slot and tier before. Otherwise it's decoded, it's channels are rearranged for the slot, it's mips are generated, and it's added to
+	texturesToCompile.
+	*/
+	bool importGLTFTexture(tinygltf::Model &model, const std::vector<uint64_t> &imageContentHashes, int imageIndex, MaterialTextureSlot slot, bool usesAlpha, TextureCompressionTier tier, TextureImportData &texture, std::vector<TextureCompileData> &texturesToCompile);
+
+	/*
+	Compresses every mip of every texture at once, split into tiles of block rows that run on the job system, then saves them to the texture cache
+	*/
+	bool compileGLTFTextures(std::vector<TextureCompileData> &texturesToCompile);
+
+	/*
+	Doesn't decode anything, it keeps the encoded image and stores a hash of it in the std::vector<uint64_t> given as the user data. Images
+	are only decoded when they aren't in the texture cache.
+	*/
 	static bool gltfImageLoadingFunction(tinygltf::Image *image, const int image_idx, std::string *err, std::string *warn, int req_width, int req_height, const unsigned char *bytes, int size, void *user_data);
 
-	void saveKETTexture(const std::string &filename, ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevels, uint32_t arrayLayers, const void *textureData, size_t textureDataSize);
+	std::string getTextureCacheFile(uint64_t cacheKey);
+	bool saveKETTexture(const std::string &filename, ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevels, uint32_t arrayLayers, const void *textureData, size_t textureDataSize);
+
+	/*
+	Reads the mips from firstMip down straight into staging memory. firstMip is clamped to the least detailed mip a streamed texture is
+	loaded w/, so ~0u reads as few mips as streaming allows. Textures big enough to be streamed get their streaming info filled in.
+	*/
+	bool loadKETTexture(const std::string &filename, ResourceFormat expectedFormat, TextureImportData &texture, uint32_t firstMip);
 };
 
 #endif /* RESOURCES_RESOURCEMANAGER_H_ */
@@ -0,0 +1,234 @@
+#ifndef RESOURCES_RESOURCESLOTARRAY_H_
+#define RESOURCES_RESOURCESLOTARRAY_H_
+
+#include <common.h>
+
+/*
+A reference to a resource that's safe to keep after the resource is freed. Slots are reused, but every reuse bumps the slot's generation,
+so a handle to a freed resource just stops resolving instead of pointing at whatever took it's slot.
+*/
+struct ResourceHandle
+{
+	uint32_t index;
+	uint32_t generation; // Slots start at generation 1, so a zeroed handle is never valid
+
+	inline bool isNull() const
+	{
+		return generation == 0;
+	}
+
+	inline bool operator==(const ResourceHandle &other) const
+	{
+		return index == other.index && generation == other.generation;
+	}
+
+	inline bool operator!=(const ResourceHandle &other) const
+	{
+		return !(*this == other);
+	}
+};
+
+#define RESOURCE_SLOT_NONE 0xFFFFFFFFu // Marks the ends of the released list
+
+/*
+Resources of one type in a dense array of slots, indexed straight by their handles. Each slot counts the references to it's resource, and
+once the last one is released the slot goes to the back of a list of released slots. The front of that list is the resource that's gone
+unused the longest, which is the first one to evict when over budget. Acquiring a released resource again takes it back out of the list.
+*/
+template <typename ResourceType>
+class ResourceSlotArray
+{
+public:
+
+	ResourceSlotArray()
+	{
+		releasedHead = RESOURCE_SLOT_NONE;
+		releasedTail = RESOURCE_SLOT_NONE;
+		resourceCount = 0;
+	}
+
+	/*
+	The new resource starts w/o any references, at the back of the released list
+	*/
+	ResourceHandle allocate(ResourceType *resource, uint64_t frame)
+	{
+		uint32_t index;
+
+		if (freeSlots.size() > 0)
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			index = uint32_t(slots.size());
+			slots.push_back({nullptr, 0, 0, 0, RESOURCE_SLOT_NONE, RESOURCE_SLOT_NONE});
+		}
+
+		Slot &slot = slots[index];
+		slot.resource = resource;
+		slot.generation++;
+		slot.refCount = 0;
+
+		resourceCount++;
+		pushReleased(index, frame);
+
+		return {index, slot.generation};
+	}
+
+	/*
+	The slot's generation is bumped, so every handle to it stops resolving. The resource itself isn't deleted.
+	*/
+	void free(ResourceHandle handle)
+	{
+		if (get(handle) == nullptr)
+			return;
+
+		Slot &slot = slots[handle.index];
+
+		if (slot.refCount == 0)
+			removeReleased(handle.index);
+
+		slot.resource = nullptr;
+		slot.refCount = 0;
+
+		// A slot whose generation would wrap back around to 0 is retired for good instead
+		if (slot.generation != 0xFFFFFFFFu)
+			freeSlots.push_back(handle.index);
+
+		resourceCount--;
+	}
+
+	inline ResourceType *get(ResourceHandle handle) const
+	{
+		return handle.index < slots.size() && slots[handle.index].generation == handle.generation && handle.generation != 0 ? slots[handle.index].resource : nullptr;
+	}
+
+	/*
+	Returns the handle's reference count after the change, or 0 if the handle didn't resolve
+	*/
+	uint32_t acquire(ResourceHandle handle)
+	{
+		if (get(handle) == nullptr)
+			return 0;
+
+		Slot &slot = slots[handle.index];
+
+		if (slot.refCount == 0)
+			removeReleased(handle.index);
+
+		return ++slot.refCount;
+	}
+
+	uint32_t release(ResourceHandle handle, uint64_t frame)
+	{
+		if (get(handle) == nullptr || slots[handle.index].refCount == 0)
+			return 0;
+
+		Slot &slot = slots[handle.index];
+
+		if (--slot.refCount == 0)
+			pushReleased(handle.index, frame);
+
+		return slot.refCount;
+	}
+
+	inline uint32_t getRefCount(ResourceHandle handle) const
+	{
+		return get(handle) != nullptr ? slots[handle.index].refCount : 0;
+	}
+
+	/*
+	Walks the released list from the resource that's gone unused the longest, a null handle is returned past the end
+	*/
+	inline ResourceHandle getLeastRecentlyReleased() const
+	{
+		return getSlotHandle(releasedHead);
+	}
+
+	inline ResourceHandle getNextReleased(ResourceHandle handle) const
+	{
+		return get(handle) != nullptr ? getSlotHandle(slots[handle.index].nextReleased) : ResourceHandle{0, 0};
+	}
+
+	inline uint64_t getReleasedFrame(ResourceHandle handle) const
+	{
+		return get(handle) != nullptr ? slots[handle.index].releasedFrame : 0;
+	}
+
+	/*
+	Calls func(ResourceHandle handle, ResourceType *resource) for every resource in slot order
+	*/
+	template <typename SlotFunction>
+	void forEach(SlotFunction func) const
+	{
+		for (uint32_t i = 0; i < uint32_t(slots.size()); i++)
+			if (slots[i].resource != nullptr)
+				func(ResourceHandle{i, slots[i].generation}, slots[i].resource);
+	}
+
+	inline size_t size() const
+	{
+		return resourceCount;
+	}
+
+private:
+
+	struct Slot
+	{
+		ResourceType *resource; // nullptr if the slot is free
+		uint32_t generation;
+		uint32_t refCount;
+
+		uint64_t releasedFrame; // When the last reference was released
+		uint32_t prevReleased; // Links in the released list, only while refCount is 0
+		uint32_t nextReleased;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+
+	uint32_t releasedHead;
+	uint32_t releasedTail;
+	size_t resourceCount;
+
+	inline ResourceHandle getSlotHandle(uint32_t index) const
+	{
+		return index != RESOURCE_SLOT_NONE ? ResourceHandle{index, slots[index].generation} : ResourceHandle{0, 0};
+	}
+
+	void pushReleased(uint32_t index, uint64_t frame)
+	{
+		Slot &slot = slots[index];
+		slot.releasedFrame = frame;
+		slot.prevReleased = releasedTail;
+		slot.nextReleased = RESOURCE_SLOT_NONE;
+
+		if (releasedTail != RESOURCE_SLOT_NONE)
+			slots[releasedTail].nextReleased = index;
+		else
+			releasedHead = index;
+
+		releasedTail = index;
+	}
+
+	void removeReleased(uint32_t index)
+	{
+		Slot &slot = slots[index];
+
+		if (slot.prevReleased != RESOURCE_SLOT_NONE)
+			slots[slot.prevReleased].nextReleased = slot.nextReleased;
+		else
+			releasedHead = slot.nextReleased;
+
+		if (slot.nextReleased != RESOURCE_SLOT_NONE)
+			slots[slot.nextReleased].prevReleased = slot.prevReleased;
+		else
+			releasedTail = slot.prevReleased;
+
+		slot.prevReleased = RESOURCE_SLOT_NONE;
+		slot.nextReleased = RESOURCE_SLOT_NONE;
+	}
+};
+
+#endif /* RESOURCES_RESOURCESLOTARRAY_H_ */
@@ -0,0 +1,216 @@
+#include "Util/LZ4Block.h"
+
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+constexpr size_t lz4MinMatch = 4;
+constexpr size_t lz4LastLiterals = 5; // The last 5 bytes of a block are always literals
+constexpr size_t lz4MatchFindLimit = 12; // The last match must start at least 12 bytes before the end of a block
+constexpr size_t lz4MaxOffset = 65535;
+constexpr uint32_t lz4HashLog = 16;
+
+inline uint32_t lz4Read32(const uint8_t *ptr)
+{
+	uint32_t value;
+	memcpy(&value, ptr, sizeof(value));
+
+	return value;
+}
+
+inline uint32_t lz4Hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - lz4HashLog);
+}
+
+inline void lz4WriteLength(uint8_t *dst, size_t &op, size_t length)
+{
+	while (length >= 255)
+	{
+		dst[op++] = 255;
+		length -= 255;
+	}
+
+	dst[op++] = uint8_t(length);
+}
+
+size_t lz4BlockCompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity)
+{
+	if (dstCapacity < lz4BlockCompressBound(srcSize))
+		return 0;
+
+	// An empty block is just a token w/ no literals, src can be null
+	if (srcSize == 0)
+	{
+		dst[0] = 0;
+
+		return 1;
+	}
+
+	size_t ip = 0, anchor = 0, op = 0;
+
+	if (srcSize > lz4MatchFindLimit)
+	{
+		std::vector<uint32_t> hashTable(size_t(1) << lz4HashLog, 0);
+
+		const size_t matchLimit = srcSize - lz4LastLiterals;
+		const size_t ipLimit = srcSize - lz4MatchFindLimit;
+
+		while (ip < ipLimit)
+		{
+			uint32_t sequence = lz4Read32(&src[ip]);
+			uint32_t &hashEntry = hashTable[lz4Hash(sequence)];
+			size_t ref = hashEntry;
+			hashEntry = uint32_t(ip);
+
+			if (ref >= ip || ip - ref > lz4MaxOffset || lz4Read32(&src[ref]) != sequence)
+			{
+				ip++;
+				continue;
+			}
+
+			// Catch up on any matching bytes we skipped over
+			while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+			{
+				ip--;
+				ref--;
+			}
+
+			size_t matchLength = lz4MinMatch;
+
+			while (ip + matchLength < matchLimit && src[ip + matchLength] == src[ref + matchLength])
+				matchLength++;
+
+			size_t literalLength = ip - anchor;
+			size_t tokenPos = op++;
+
+			dst[tokenPos] = uint8_t(std::min<size_t>(literalLength, 15) << 4);
+
+			if (literalLength >= 15)
+				lz4WriteLength(dst, op, literalLength - 15);
+
+			memcpy(&dst[op], &src[anchor], literalLength);
+			op += literalLength;
+
+			size_t offset = ip - ref;
+			dst[op++] = uint8_t(offset & 0xFF);
+			dst[op++] = uint8_t(offset >> 8);
+
+			size_t encodedMatchLength = matchLength - lz4MinMatch;
+			dst[tokenPos] |= uint8_t(std::min<size_t>(encodedMatchLength, 15));
+
+			if (encodedMatchLength >= 15)
+				lz4WriteLength(dst, op, encodedMatchLength - 15);
+
+			ip += matchLength;
+			anchor = ip;
+
+			// Seed the table with a position inside the match, helps a lot on repetitive data
+			if (ip - 2 < ipLimit)
+				hashTable[lz4Hash(lz4Read32(&src[ip - 2]))] = uint32_t(ip - 2);
+		}
+	}
+
+	// Everything after the last match is written as one literal run
+	size_t literalLength = srcSize - anchor;
+	size_t tokenPos = op++;
+
+	dst[tokenPos] = uint8_t(std::min<size_t>(literalLength, 15) << 4);
+
+	if (literalLength >= 15)
+		lz4WriteLength(dst, op, literalLength - 15);
+
+	memcpy(&dst[op], &src[anchor], literalLength);
+	op += literalLength;
+
+	return op;
+}
+
+bool lz4BlockDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize)
+{
+	// Nothing to copy, dst can be null. Accepts the single empty token lz4BlockCompress() writes for empty input.
+	if (dstSize == 0)
+		return srcSize == 0 || (srcSize == 1 && src[0] == 0);
+
+	size_t ip = 0, op = 0;
+
+	while (ip < srcSize)
+	{
+		uint8_t token = src[ip++];
+		size_t literalLength = token >> 4;
+
+		if (literalLength == 15)
+		{
+			uint8_t lengthByte;
+
+			do
+			{
+				if (ip >= srcSize)
+					return false;
+
+				lengthByte = src[ip++];
+				literalLength += lengthByte;
+			}
+			while (lengthByte == 255);
+		}
+
+		if (literalLength > srcSize - ip || literalLength > dstSize - op)
+			return false;
+
+		memcpy(&dst[op], &src[ip], literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		// The last sequence of a block has no match
+		if (ip == srcSize)
+			break;
+
+		if (srcSize - ip < 2)
+			return false;
+
+		size_t offset = size_t(src[ip]) | (size_t(src[ip + 1]) << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > op)
+			return false;
+
+		size_t matchLength = token & 15;
+
+		if (matchLength == 15)
+		{
+			uint8_t lengthByte;
+
+			do
+			{
+				if (ip >= srcSize)
+					return false;
+
+				lengthByte = src[ip++];
+				matchLength += lengthByte;
+			}
+			while (lengthByte == 255);
+		}
+
+		matchLength += lz4MinMatch;
+
+		if (matchLength > dstSize - op)
+			return false;
+
+		const uint8_t *match = &dst[op - offset];
+
+		if (offset >= matchLength)
+		{
+			memcpy(&dst[op], match, matchLength);
+		}
+		else
+		{
+			// Overlapping copy, this is how LZ4 encodes runs
+			for (size_t i = 0; i < matchLength; i++)
+				dst[op + i] = match[i];
+		}
+
+		op += matchLength;
+	}
+
+	return op == dstSize;
+}
@@ -0,0 +1,33 @@
+#ifndef UTIL_LZ4BLOCK_H_
+#define UTIL_LZ4BLOCK_H_
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+A small, dependency free implementation of the LZ4 block format (no frame headers or checksums). It's used for
+compressing sections of engine files that need to decompress very fast, so the decoder favors speed and the encoder is
+a simple greedy single-pass matcher. Output is compatible with the reference LZ4_decompress_safe().
+*/
+
+/*
+Returns the max number of bytes lz4BlockCompress() can write for an input of the given size.
+*/
+inline size_t lz4BlockCompressBound(size_t inputSize)
+{
+	return inputSize + inputSize / 255 + 16;
+}
+
+/*
+Compresses srcSize bytes from src into dst. Returns the number of bytes written, or 0 if dstCapacity is less
+than lz4BlockCompressBound(srcSize).
+*/
+size_t lz4BlockCompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstCapacity);
+
+/*
+Decompresses a block into dst, dstSize must be the exact uncompressed size. Returns false if the block is malformed
+or doesn't decode to exactly dstSize bytes, never reads or writes out of bounds.
+*/
+bool lz4BlockDecompress(const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize);
+
+#endif /* UTIL_LZ4BLOCK_H_ */
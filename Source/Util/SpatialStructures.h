@@ -42,6 +42,17 @@ inline bool AABBContainsSphere(const AABB &aabb, const BoundingSphere &sphere)
 		sphere.position.x + sphere.radius <= aabb.aabbMax.x && sphere.position.y + sphere.radius <= aabb.aabbMax.y && sphere.position.z + sphere.radius <= aabb.aabbMax.z;
 }
 
+/*
+Computes the bounding box of one of the 8 octants of an octree node, indexed the same way as Octree::children (z * 4 + y * 2 + x)
+*/
+inline AABB getOctreeChildOctantAABB(const AABB &nodeAABB, int child)
+{
+	float nodeAABBHalfLength = (nodeAABB.aabbMax.x - nodeAABB.aabbMin.x) * 0.5f;
+	int x = child & 1, y = (child >> 1) & 1, z = (child >> 2) & 1;
+
+	return {{nodeAABB.aabbMin.x + nodeAABBHalfLength * float(x), nodeAABB.aabbMin.y + nodeAABBHalfLength * float(y), nodeAABB.aabbMin.z + nodeAABBHalfLength * float(z)}, {nodeAABB.aabbMin.x + nodeAABBHalfLength * float(x + 1), nodeAABB.aabbMin.y + nodeAABBHalfLength * float(y + 1), nodeAABB.aabbMin.z + nodeAABBHalfLength * float(z + 1)}};
+}
+
 template <typename OctreePayload>
 inline void insertItemsIntoOctree(Octree<OctreePayload> *node, const OctreePayload *itemsArray, size_t itemCount, float minOctreeLength = 0.1f)
 {
@@ -52,13 +63,10 @@ inline void insertItemsIntoOctree(Octree<OctreePayload> *node, const OctreePaylo
 		return;
 	}
 
-	float nodeAABBHalfLength = (node->boundingBox.aabbMax.x - node->boundingBox.aabbMin.x) * 0.5f;
 	AABB childOctantBoxes[8];
 
-	for (int x = 0; x < 2; x++)
-		for (int y = 0; y < 2; y++)
-			for (int z = 0; z < 2; z++)
-				childOctantBoxes[z * 4 + y * 2 + x] = {{node->boundingBox.aabbMin.x + nodeAABBHalfLength * float(x), node->boundingBox.aabbMin.y + nodeAABBHalfLength * float(y), node->boundingBox.aabbMin.z + nodeAABBHalfLength * float(z)}, {node->boundingBox.aabbMin.x + nodeAABBHalfLength * float(x + 1), node->boundingBox.aabbMin.y + nodeAABBHalfLength * float(y + 1), node->boundingBox.aabbMin.z + nodeAABBHalfLength * float(z + 1)}};
+	for (int child = 0; child < 8; child++)
+		childOctantBoxes[child] = getOctreeChildOctantAABB(node->boundingBox, child);
 
 	std::vector<OctreePayload> childNodeInsertions[8];
 
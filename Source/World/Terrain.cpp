@@ -0,0 +1,359 @@
+#include "World/Terrain.h"
+
+#include <limits>
+
+/*
+Largest vertical distance between the full res heightmap and a node's patch, w/ the patch approximated as a bilinear surface between it's vertices
+*/
+static float computeTerrainNodeError(const WorldChunkTerrainData &terrain, uint32_t depth, uint32_t nodeX, uint32_t nodeZ)
+{
+	const int32_t nodeSamples = WORLD_TERRAIN_HEIGHTMAP_RESOLUTION >> depth;
+	const int32_t vertexSpacing = nodeSamples / WORLD_TERRAIN_PATCH_RESOLUTION;
+
+	if (vertexSpacing <= 1)
+		return 0.0f;
+
+	const int32_t startX = int32_t(nodeX) * nodeSamples, startZ = int32_t(nodeZ) * nodeSamples;
+	const float invVertexSpacing = 1.0f / float(vertexSpacing);
+	float maxError = 0.0f;
+
+	for (int32_t z = 0; z <= nodeSamples; z++)
+	{
+		int32_t cellZ = std::min(z / vertexSpacing, WORLD_TERRAIN_PATCH_RESOLUTION - 1);
+		float fz = float(z - cellZ * vertexSpacing) * invVertexSpacing;
+
+		for (int32_t x = 0; x <= nodeSamples; x++)
+		{
+			int32_t cellX = std::min(x / vertexSpacing, WORLD_TERRAIN_PATCH_RESOLUTION - 1);
+			float fx = float(x - cellX * vertexSpacing) * invVertexSpacing;
+
+			int32_t x0 = startX + cellX * vertexSpacing, z0 = startZ + cellZ * vertexSpacing;
+			float h00 = getTerrainChunkHeight(terrain, x0, z0);
+			float h10 = getTerrainChunkHeight(terrain, x0 + vertexSpacing, z0);
+			float h01 = getTerrainChunkHeight(terrain, x0, z0 + vertexSpacing);
+			float h11 = getTerrainChunkHeight(terrain, x0 + vertexSpacing, z0 + vertexSpacing);
+
+			float approxHeight = glm::mix(glm::mix(h00, h10, fx), glm::mix(h01, h11, fx), fz);
+
+			maxError = std::max(maxError, std::abs(approxHeight - getTerrainChunkHeight(terrain, startX + x, startZ + z)));
+		}
+	}
+
+	return maxError;
+}
+
+void buildTerrainChunkLODTree(WorldChunkTerrainData &terrain)
+{
+	const uint32_t leafDepth = WORLD_TERRAIN_LOD_LEVELS - 1;
+	const int32_t leafSamples = WORLD_TERRAIN_HEIGHTMAP_RESOLUTION >> leafDepth;
+
+	// Bounds of the deepest level come straight from the heightmap, including the row/column on each node's far edge (which the last nodes share w/ the next chunk)
+	for (uint32_t nodeZ = 0; nodeZ < WORLD_TERRAIN_LOD_LEAF_GRID; nodeZ++)
+	{
+		for (uint32_t nodeX = 0; nodeX < WORLD_TERRAIN_LOD_LEAF_GRID; nodeX++)
+		{
+			uint32_t nodeIndex = getTerrainLODNodeIndex(leafDepth, nodeX, nodeZ);
+			float minHeight = std::numeric_limits<float>::max(), maxHeight = std::numeric_limits<float>::lowest();
+
+			for (int32_t z = 0; z <= leafSamples; z++)
+			{
+				for (int32_t x = 0; x <= leafSamples; x++)
+				{
+					float height = getTerrainChunkHeight(terrain, int32_t(nodeX) * leafSamples + x, int32_t(nodeZ) * leafSamples + z);
+					minHeight = std::min(minHeight, height);
+					maxHeight = std::max(maxHeight, height);
+				}
+			}
+
+			terrain.nodeMinHeight[nodeIndex] = minHeight;
+			terrain.nodeMaxHeight[nodeIndex] = maxHeight;
+			terrain.nodeGeometricError[nodeIndex] = computeTerrainNodeError(terrain, leafDepth, nodeX, nodeZ);
+		}
+	}
+
+	// Parents contain their children, so their bounds and errors are never smaller than any of their children's
+	for (int32_t depth = int32_t(leafDepth) - 1; depth >= 0; depth--)
+	{
+		for (uint32_t nodeZ = 0; nodeZ < (1u << depth); nodeZ++)
+		{
+			for (uint32_t nodeX = 0; nodeX < (1u << depth); nodeX++)
+			{
+				uint32_t nodeIndex = getTerrainLODNodeIndex(depth, nodeX, nodeZ);
+				float minHeight = std::numeric_limits<float>::max(), maxHeight = std::numeric_limits<float>::lowest();
+				float error = computeTerrainNodeError(terrain, depth, nodeX, nodeZ);
+
+				for (uint32_t child = 0; child < 4; child++)
+				{
+					uint32_t childIndex = getTerrainLODNodeIndex(depth + 1, nodeX * 2 + (child & 1), nodeZ * 2 + (child >> 1));
+
+					minHeight = std::min(minHeight, terrain.nodeMinHeight[childIndex]);
+					maxHeight = std::max(maxHeight, terrain.nodeMaxHeight[childIndex]);
+					error = std::max(error, terrain.nodeGeometricError[childIndex]);
+				}
+
+				terrain.nodeMinHeight[nodeIndex] = minHeight;
+				terrain.nodeMaxHeight[nodeIndex] = maxHeight;
+				terrain.nodeGeometricError[nodeIndex] = error;
+			}
+		}
+	}
+}
+
+void buildWorldTerrainLOD(WorldTerrainLOD &terrainLOD, const std::vector<WorldChunkTerrainData> &terrainData, uint32_t terrainSizeX, uint32_t terrainSizeY, int32_t terrainOffsetX, int32_t terrainOffsetY)
+{
+	// Same chunk range as WorldManager::loadWorld()
+	terrainLOD.chunkOffsetX = terrainOffsetX;
+	terrainLOD.chunkOffsetY = terrainOffsetY;
+	terrainLOD.chunkCountX = uint32_t(std::max<int64_t>(int64_t(terrainSizeX) - 2 * int64_t(terrainOffsetX), 0));
+	terrainLOD.chunkCountY = uint32_t(std::max<int64_t>(int64_t(terrainSizeY) - 2 * int64_t(terrainOffsetY), 0));
+
+	terrainLOD.chunkFirstNode.assign(size_t(terrainLOD.chunkCountX) * terrainLOD.chunkCountY, -1);
+	terrainLOD.nodeCenterX.clear();
+	terrainLOD.nodeCenterZ.clear();
+	terrainLOD.nodeHalfSize.clear();
+	terrainLOD.nodeMinHeight.clear();
+	terrainLOD.nodeMaxHeight.clear();
+	terrainLOD.nodeGeometricError.clear();
+
+	for (uint32_t cx = 0; cx < terrainLOD.chunkCountX; cx++)
+	{
+		for (uint32_t cy = 0; cy < terrainLOD.chunkCountY; cy++)
+		{
+			size_t terrainDataIndex = size_t(cx) * terrainSizeY + cy;
+
+			if (terrainDataIndex >= terrainData.size() || terrainData[terrainDataIndex].heightmap.empty())
+				continue;
+
+			const WorldChunkTerrainData &terrain = terrainData[terrainDataIndex];
+			float chunkOriginX = float((int64_t(cx) + terrainOffsetX) * WORLD_CHUNK_SIZE);
+			float chunkOriginZ = float((int64_t(cy) + terrainOffsetY) * WORLD_CHUNK_SIZE);
+
+			terrainLOD.chunkFirstNode[size_t(cx) * terrainLOD.chunkCountY + cy] = int32_t(terrainLOD.nodeCenterX.size());
+
+			for (uint32_t depth = 0; depth < WORLD_TERRAIN_LOD_LEVELS; depth++)
+			{
+				float nodeSize = float(WORLD_CHUNK_SIZE) / float(1u << depth);
+
+				for (uint32_t nodeZ = 0; nodeZ < (1u << depth); nodeZ++)
+				{
+					for (uint32_t nodeX = 0; nodeX < (1u << depth); nodeX++)
+					{
+						uint32_t nodeIndex = getTerrainLODNodeIndex(depth, nodeX, nodeZ);
+
+						terrainLOD.nodeCenterX.push_back(chunkOriginX + (float(nodeX) + 0.5f) * nodeSize);
+						terrainLOD.nodeCenterZ.push_back(chunkOriginZ + (float(nodeZ) + 0.5f) * nodeSize);
+						terrainLOD.nodeHalfSize.push_back(nodeSize * 0.5f);
+						terrainLOD.nodeMinHeight.push_back(terrain.nodeMinHeight[nodeIndex]);
+						terrainLOD.nodeMaxHeight.push_back(terrain.nodeMaxHeight[nodeIndex]);
+						terrainLOD.nodeGeometricError.push_back(terrain.nodeGeometricError[nodeIndex]);
+					}
+				}
+			}
+		}
+	}
+
+	terrainLOD.nodeRefine.resize(terrainLOD.nodeCenterX.size());
+	terrainLOD.leafDepth.resize(size_t(terrainLOD.chunkCountX) * terrainLOD.chunkCountY * WORLD_TERRAIN_LOD_LEAF_GRID * WORLD_TERRAIN_LOD_LEAF_GRID);
+}
+
+void selectTerrainPatches(WorldTerrainLOD &terrainLOD, const TerrainLODSelectionParams &params, std::vector<TerrainPatch> &patches)
+{
+	const uint8_t noTerrain = 0xFF;
+	const size_t nodeCount = terrainLOD.nodeCenterX.size();
+
+	patches.clear();
+
+	if (nodeCount == 0)
+		return;
+
+	// A node gets refined when error * scale / distance > maxError, tested squared so there's no sqrt or divide
+	const float camX = params.cameraPosition.x, camY = params.cameraPosition.y, camZ = params.cameraPosition.z;
+	const float errorToDistance = params.screenSpaceErrorScale / std::max(params.maxScreenSpaceError, 1e-6f);
+
+	const float *centerX = terrainLOD.nodeCenterX.data();
+	const float *centerZ = terrainLOD.nodeCenterZ.data();
+	const float *halfSize = terrainLOD.nodeHalfSize.data();
+	const float *minHeight = terrainLOD.nodeMinHeight.data();
+	const float *maxHeight = terrainLOD.nodeMaxHeight.data();
+	const float *geometricError = terrainLOD.nodeGeometricError.data();
+	uint8_t *refine = terrainLOD.nodeRefine.data();
+
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		float dx = std::max(std::abs(centerX[i] - camX) - halfSize[i], 0.0f);
+		float dz = std::max(std::abs(centerZ[i] - camZ) - halfSize[i], 0.0f);
+		float dy = std::max(std::max(minHeight[i] - camY, camY - maxHeight[i]), 0.0f);
+		float refineDistance = geometricError[i] * errorToDistance;
+
+		refine[i] = uint8_t(refineDistance * refineDistance > dx * dx + dy * dy + dz * dz);
+	}
+
+	const uint32_t leafGrid = WORLD_TERRAIN_LOD_LEAF_GRID;
+	const uint32_t leafDepth = WORLD_TERRAIN_LOD_LEVELS - 1;
+	const uint32_t gridWidth = terrainLOD.chunkCountX * leafGrid;
+	const uint32_t gridHeight = terrainLOD.chunkCountY * leafGrid;
+	uint8_t *depthGrid = terrainLOD.leafDepth.data();
+
+	auto chunkFirstNode = [&](uint32_t gx, uint32_t gz) {
+		return terrainLOD.chunkFirstNode[size_t(gx / leafGrid) * terrainLOD.chunkCountY + gz / leafGrid];
+	};
+
+	// Walk down from each chunk's root to find the depth every leaf cell would be drawn at
+	for (uint32_t gz = 0; gz < gridHeight; gz++)
+	{
+		for (uint32_t gx = 0; gx < gridWidth; gx++)
+		{
+			int32_t firstNode = chunkFirstNode(gx, gz);
+
+			if (firstNode < 0)
+			{
+				depthGrid[size_t(gz) * gridWidth + gx] = noTerrain;
+				continue;
+			}
+
+			uint32_t lx = gx % leafGrid, lz = gz % leafGrid, depth = 0;
+
+			while (depth < leafDepth && refine[firstNode + getTerrainLODNodeIndex(depth, lx >> (leafDepth - depth), lz >> (leafDepth - depth))])
+				depth++;
+
+			depthGrid[size_t(gz) * gridWidth + gx] = uint8_t(depth);
+		}
+	}
+
+	// Balance the selection, any node w/ a neighbour more than one level finer gets split. A node at depth d always
+	// covers an aligned block of cells that all have depth d, and splitting keeps that true, so repeat until nothing changes
+	bool selectionChanged = true;
+
+	while (selectionChanged)
+	{
+		selectionChanged = false;
+
+		for (uint32_t gz = 0; gz < gridHeight; gz++)
+		{
+			for (uint32_t gx = 0; gx < gridWidth; gx++)
+			{
+				uint8_t depth = depthGrid[size_t(gz) * gridWidth + gx];
+
+				if (depth == noTerrain)
+					continue;
+
+				uint8_t maxNeighbourDepth = 0;
+
+				if (gx > 0 && depthGrid[size_t(gz) * gridWidth + gx - 1] != noTerrain)
+					maxNeighbourDepth = std::max(maxNeighbourDepth, depthGrid[size_t(gz) * gridWidth + gx - 1]);
+				if (gx + 1 < gridWidth && depthGrid[size_t(gz) * gridWidth + gx + 1] != noTerrain)
+					maxNeighbourDepth = std::max(maxNeighbourDepth, depthGrid[size_t(gz) * gridWidth + gx + 1]);
+				if (gz > 0 && depthGrid[size_t(gz - 1) * gridWidth + gx] != noTerrain)
+					maxNeighbourDepth = std::max(maxNeighbourDepth, depthGrid[size_t(gz - 1) * gridWidth + gx]);
+				if (gz + 1 < gridHeight && depthGrid[size_t(gz + 1) * gridWidth + gx] != noTerrain)
+					maxNeighbourDepth = std::max(maxNeighbourDepth, depthGrid[size_t(gz + 1) * gridWidth + gx]);
+
+				if (maxNeighbourDepth <= depth + 1)
+					continue;
+
+				uint32_t blockSize = leafGrid >> depth;
+				uint32_t blockX = gx - gx % blockSize, blockZ = gz - gz % blockSize;
+
+				for (uint32_t z = blockZ; z < blockZ + blockSize; z++)
+					for (uint32_t x = blockX; x < blockX + blockSize; x++)
+						depthGrid[size_t(z) * gridWidth + x] = depth + 1;
+
+				selectionChanged = true;
+			}
+		}
+	}
+
+	auto cellDepth = [&](int64_t gx, int64_t gz) {
+		if (gx < 0 || gz < 0 || gx >= int64_t(gridWidth) || gz >= int64_t(gridHeight))
+			return noTerrain;
+
+		return depthGrid[size_t(gz) * gridWidth + size_t(gx)];
+	};
+
+	// Emit one patch per selected node, in chunk order. An edge only needs stitching when the neighbour across it is coarser
+	for (uint32_t cx = 0; cx < terrainLOD.chunkCountX; cx++)
+	{
+		for (uint32_t cy = 0; cy < terrainLOD.chunkCountY; cy++)
+		{
+			if (terrainLOD.chunkFirstNode[size_t(cx) * terrainLOD.chunkCountY + cy] < 0)
+				continue;
+
+			for (uint32_t lz = 0; lz < leafGrid; lz++)
+			{
+				for (uint32_t lx = 0; lx < leafGrid; lx++)
+				{
+					int64_t gx = int64_t(cx) * leafGrid + lx, gz = int64_t(cy) * leafGrid + lz;
+					uint8_t depth = cellDepth(gx, gz);
+					uint32_t blockSize = leafGrid >> depth;
+
+					if (lx % blockSize != 0 || lz % blockSize != 0)
+						continue;
+
+					uint8_t negXDepth = cellDepth(gx - 1, gz), posXDepth = cellDepth(gx + blockSize, gz);
+					uint8_t negZDepth = cellDepth(gx, gz - 1), posZDepth = cellDepth(gx, gz + blockSize);
+
+					TerrainPatch patch = {};
+					patch.chunk = {int32_t(int64_t(cx) + terrainLOD.chunkOffsetX), int32_t(int64_t(cy) + terrainLOD.chunkOffsetY)};
+					patch.depth = depth;
+					patch.nodeX = uint8_t(lx / blockSize);
+					patch.nodeZ = uint8_t(lz / blockSize);
+					patch.edgeFlags = 0;
+
+					if (negXDepth != noTerrain && negXDepth < depth)
+						patch.edgeFlags |= TERRAIN_PATCH_EDGE_NEG_X_BIT;
+					if (posXDepth != noTerrain && posXDepth < depth)
+						patch.edgeFlags |= TERRAIN_PATCH_EDGE_POS_X_BIT;
+					if (negZDepth != noTerrain && negZDepth < depth)
+						patch.edgeFlags |= TERRAIN_PATCH_EDGE_NEG_Z_BIT;
+					if (posZDepth != noTerrain && posZDepth < depth)
+						patch.edgeFlags |= TERRAIN_PATCH_EDGE_POS_Z_BIT;
+
+					patches.push_back(patch);
+				}
+			}
+		}
+	}
+}
+
+void generateTerrainPatchIndices(TerrainPatchEdgeFlags edgeFlags, std::vector<uint16_t> &indices)
+{
+	// The patch is built out of 2x2 cell diamonds, each one a fan of 8 triangles around it's center vertex. On a flagged edge
+	// the diamond's edge midpoint is skipped, which merges it's two triangles into one that matches the coarser neighbour
+	const int32_t ringOffsets[8][2] = {{1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+	const int32_t rowStride = WORLD_TERRAIN_PATCH_RESOLUTION + 1;
+	const int32_t lastDiamond = WORLD_TERRAIN_PATCH_RESOLUTION / 2 - 1;
+
+	indices.clear();
+	indices.reserve(WORLD_TERRAIN_PATCH_RESOLUTION * WORLD_TERRAIN_PATCH_RESOLUTION * 6);
+
+	for (int32_t dz = 0; dz <= lastDiamond; dz++)
+	{
+		for (int32_t dx = 0; dx <= lastDiamond; dx++)
+		{
+			int32_t centerX = dx * 2 + 1, centerZ = dz * 2 + 1;
+
+			bool skipRing[8] = {};
+			skipRing[0] = dx == lastDiamond && (edgeFlags & TERRAIN_PATCH_EDGE_POS_X_BIT);
+			skipRing[2] = dz == 0 && (edgeFlags & TERRAIN_PATCH_EDGE_NEG_Z_BIT);
+			skipRing[4] = dx == 0 && (edgeFlags & TERRAIN_PATCH_EDGE_NEG_X_BIT);
+			skipRing[6] = dz == lastDiamond && (edgeFlags & TERRAIN_PATCH_EDGE_POS_Z_BIT);
+
+			uint16_t centerVertex = uint16_t(centerZ * rowStride + centerX);
+
+			for (int32_t ring = 0; ring < 8; ring++)
+			{
+				if (skipRing[ring])
+					continue;
+
+				int32_t nextRing = (ring + 1) % 8;
+
+				if (skipRing[nextRing])
+					nextRing = (nextRing + 1) % 8;
+
+				indices.push_back(centerVertex);
+				indices.push_back(uint16_t((centerZ + ringOffsets[ring][1]) * rowStride + centerX + ringOffsets[ring][0]));
+				indices.push_back(uint16_t((centerZ + ringOffsets[nextRing][1]) * rowStride + centerX + ringOffsets[nextRing][0]));
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#ifndef WORLD_TERRAIN_H_
+#define WORLD_TERRAIN_H_
+
+#include <common.h>
+
+#define WORLD_TERRAIN_HEIGHTMAP_RESOLUTION 256 // Heightmap cells per chunk along each axis, so with WORLD_CHUNK_SIZE 256 one sample per world unit
+#define WORLD_TERRAIN_HEIGHTMAP_SAMPLES (WORLD_TERRAIN_HEIGHTMAP_RESOLUTION + 1) // Samples along each axis, the last row/column is the first of the next chunk's
+#define WORLD_TERRAIN_PATCH_RESOLUTION 32 // Cells along each axis of a terrain patch, every LOD node is drawn as a (32 + 1) x (32 + 1) vertex grid
+#define WORLD_TERRAIN_LOD_LEVELS 4 // Quadtree levels per chunk, the deepest level's patches are drawn at the full heightmap resolution
+#define WORLD_TERRAIN_LOD_NODES_PER_CHUNK 85 // 1 + 4 + 16 + 64
+#define WORLD_TERRAIN_LOD_LEAF_GRID 8 // Deepest level nodes along each axis of a chunk
+
+#define WORLD_TERRAIN_PATCH_VERTEX_COUNT ((WORLD_TERRAIN_PATCH_RESOLUTION + 1) * (WORLD_TERRAIN_PATCH_RESOLUTION + 1))
+
+/*
+Which edges of a patch border a coarser neighbour, those edges skip every other vertex so they line up w/ the neighbour's edge
+*/
+typedef enum TerrainPatchEdgeBits
+{
+	TERRAIN_PATCH_EDGE_NEG_X_BIT = 0x00000001,
+	TERRAIN_PATCH_EDGE_POS_X_BIT = 0x00000002,
+	TERRAIN_PATCH_EDGE_NEG_Z_BIT = 0x00000004,
+	TERRAIN_PATCH_EDGE_POS_Z_BIT = 0x00000008,
+	TERRAIN_PATCH_EDGE_PATTERN_COUNT = 16
+} TerrainPatchEdgeBits;
+
+typedef uint32_t TerrainPatchEdgeFlags;
+
+/*
+A chunk's heightmap and the bounds/errors of it's LOD quadtree. The quadtree is complete, so nodes are stored level by level, level l
+has 4^l nodes laid out as a (2^l x 2^l) grid, indexed by getTerrainLODNodeIndex(). Chunks w/o terrain have an empty heightmap.
+*/
+struct WorldChunkTerrainData
+{
+	std::vector<uint16_t> heightmap; // Accessed by [z * WORLD_TERRAIN_HEIGHTMAP_SAMPLES + x], height = heightOffset + sample * heightScale
+	float heightOffset;
+	float heightScale;
+
+	float nodeMinHeight[WORLD_TERRAIN_LOD_NODES_PER_CHUNK];
+	float nodeMaxHeight[WORLD_TERRAIN_LOD_NODES_PER_CHUNK];
+	float nodeGeometricError[WORLD_TERRAIN_LOD_NODES_PER_CHUNK]; // Max vertical distance between the node's patch and the full res heightmap, includes all of the node's children
+};
+
+/*
+A terrain patch picked by selectTerrainPatches(). It covers (WORLD_CHUNK_SIZE >> depth) world units along each axis of the chunk, starting at
+(nodeX, nodeZ) * (WORLD_CHUNK_SIZE >> depth). The patch should be drawn w/ the index pattern for it's edgeFlags.
+*/
+struct TerrainPatch
+{
+	sivec2 chunk;
+	uint8_t depth;
+	uint8_t nodeX;
+	uint8_t nodeZ;
+	uint8_t edgeFlags;
+};
+
+typedef struct
+{
+	glm::vec3 cameraPosition; // World space
+	float screenSpaceErrorScale; // viewportHeight / (2 * tan(fovY / 2))
+	float maxScreenSpaceError; // In pixels, nodes w/ a larger projected error get refined
+} TerrainLODSelectionParams;
+
+/*
+Per world LOD data. Node bounds of every chunk w/ terrain are kept in flat world space arrays, so the per frame error test is one branchless
+loop over all of them that the compiler can vectorize, instead of a pointer chasing walk down each quadtree.
+*/
+struct WorldTerrainLOD
+{
+	int32_t chunkOffsetX;
+	int32_t chunkOffsetY;
+	uint32_t chunkCountX;
+	uint32_t chunkCountY;
+
+	std::vector<int32_t> chunkFirstNode; // [(x - chunkOffsetX) * chunkCountY + (y - chunkOffsetY)], -1 if the chunk doesn't have terrain
+
+	// WORLD_TERRAIN_LOD_NODES_PER_CHUNK nodes per chunk w/ terrain
+	std::vector<float> nodeCenterX;
+	std::vector<float> nodeCenterZ;
+	std::vector<float> nodeHalfSize;
+	std::vector<float> nodeMinHeight;
+	std::vector<float> nodeMaxHeight;
+	std::vector<float> nodeGeometricError;
+
+	// Scratch space for selectTerrainPatches()
+	std::vector<uint8_t> nodeRefine;
+	std::vector<uint8_t> leafDepth; // Selected depth of each deepest level node, (chunkCountX * LEAF_GRID) x (chunkCountY * LEAF_GRID)
+};
+
+inline uint32_t getTerrainLODNodeIndex(uint32_t depth, uint32_t nodeX, uint32_t nodeZ)
+{
+	return ((1u << (2 * depth)) - 1) / 3 + nodeZ * (1u << depth) + nodeX;
+}
+
+/*
+Gets a chunk's height sample, clamping to the chunk's edges. Sample WORLD_TERRAIN_HEIGHTMAP_RESOLUTION is on the far edge, the same
+position as the next chunk's sample 0, so patches on either side of a chunk border share their edge heights.
+*/
+inline float getTerrainChunkHeight(const WorldChunkTerrainData &terrain, int32_t x, int32_t z)
+{
+	x = std::max(0, std::min(x, WORLD_TERRAIN_HEIGHTMAP_RESOLUTION));
+	z = std::max(0, std::min(z, WORLD_TERRAIN_HEIGHTMAP_RESOLUTION));
+
+	return terrain.heightOffset + float(terrain.heightmap[z * WORLD_TERRAIN_HEIGHTMAP_SAMPLES + x]) * terrain.heightScale;
+}
+
+/*
+Computes the node bounds and geometric errors of a chunk's LOD quadtree from it's heightmap
+*/
+void buildTerrainChunkLODTree(WorldChunkTerrainData &terrain);
+
+/*
+Builds the world's LOD node arrays, 'terrainData' is arranged the same way as WorldInfo::staticObjectData
+*/
+void buildWorldTerrainLOD(WorldTerrainLOD &terrainLOD, const std::vector<WorldChunkTerrainData> &terrainData, uint32_t terrainSizeX, uint32_t terrainSizeY, int32_t terrainOffsetX, int32_t terrainOffsetY);
+
+/*
+Picks the terrain patches to draw this frame. Every node w/ a projected error over the limit is refined, then the selection is
+balanced so neighbouring patches (including across chunk borders) are never more than one level apart, which is what the edge
+index patterns need to stay crack free. Uses the scratch space in 'terrainLOD', so it can't be called for the same world from multiple threads.
+*/
+void selectTerrainPatches(WorldTerrainLOD &terrainLOD, const TerrainLODSelectionParams &params, std::vector<TerrainPatch> &patches);
+
+/*
+Generates the index list for one edge pattern of a patch. Vertices are indexed [z * (WORLD_TERRAIN_PATCH_RESOLUTION + 1) + x], and triangles
+wind counter-clockwise when looking down at the terrain from +Y w/ +Z towards the viewer. Every pattern has the same vertices, only
+the triangles along the flagged edges change.
+*/
+void generateTerrainPatchIndices(TerrainPatchEdgeFlags edgeFlags, std::vector<uint16_t> &indices);
+
+#endif /* WORLD_TERRAIN_H_ */
@@ -0,0 +1,634 @@
+#include "World/WorldFileFormat.h"
+
+#include <Util/LZ4Block.h>
+
+constexpr uint32_t worldFileMaxPackedOctreeDepth = 32;
+constexpr float worldFilePositionQuantizationMax = 65535.0f;
+
+struct WorldFilePackedSectionReader
+{
+	const uint8_t *data;
+	size_t dataSize;
+	size_t offset;
+	bool ok;
+
+	void read(void *to, size_t size)
+	{
+		if (!ok || size > dataSize - offset)
+		{
+			ok = false;
+			memset(to, 0, size);
+
+			return;
+		}
+
+		memcpy(to, data + offset, size);
+		offset += size;
+	}
+
+	uint64_t readVarint()
+	{
+		uint64_t value = 0;
+
+		for (uint32_t shift = 0; shift < 64 && ok; shift += 7)
+		{
+			if (offset >= dataSize)
+				break;
+
+			uint8_t byte = data[offset++];
+			value |= uint64_t(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+
+		ok = false;
+
+		return 0;
+	}
+};
+
+inline void writeVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+
+	out.push_back(uint8_t(value));
+}
+
+inline void writeBytes(std::vector<uint8_t> &out, const void *data, size_t size)
+{
+	out.insert(out.end(), reinterpret_cast<const uint8_t*>(data), reinterpret_cast<const uint8_t*>(data) + size);
+}
+
+inline uint64_t zigzagEncode(int64_t value)
+{
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value)
+{
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+/*
+Flattens an octree in depth first pre-order, visiting children in index order. Both encodings rely on this ordering.
+*/
+static void flattenOctree(Octree<StaticObjectEntry> *node, std::vector<Octree<StaticObjectEntry>*> &nodeList, std::map<Octree<StaticObjectEntry>*, uint32_t> &nodeIndexMap)
+{
+	nodeIndexMap[node] = uint32_t(nodeList.size());
+	nodeList.push_back(node);
+
+	for (int child = 0; child < 8; child++)
+		if (node->children[child] != nullptr)
+			flattenOctree(node->children[child], nodeList, nodeIndexMap);
+}
+
+static void writeRawSection(std::vector<char> &out, const WorldChunkStaticObjectData &chunkData, const std::vector<Octree<StaticObjectEntry>*> &nodeList, std::map<Octree<StaticObjectEntry>*, uint32_t> &nodeIndexMap)
+{
+	seqwrite(out, &chunkData.chunkAABB, sizeof(chunkData.chunkAABB));
+
+	uint32_t octreeCount = uint32_t(nodeList.size());
+	seqwrite(out, &octreeCount, sizeof(octreeCount));
+
+	for (size_t n = 0; n < nodeList.size(); n++)
+	{
+		Octree<StaticObjectEntry> *node = nodeList[n];
+		uint32_t parentNodeIndex = node->parent == nullptr || n == 0 ? 0xFFFFFFFF : nodeIndexMap[node->parent];
+		seqwrite(out, &parentNodeIndex, sizeof(parentNodeIndex));
+
+		for (int child = 0; child < 8; child++)
+		{
+			uint32_t childNodeIndex = node->children[child] == nullptr ? 0xFFFFFFFF : nodeIndexMap[node->children[child]];
+			seqwrite(out, &childNodeIndex, sizeof(childNodeIndex));
+		}
+
+		seqwrite(out, &node->boundingBox, sizeof(node->boundingBox));
+
+		uint32_t itemCount = uint32_t(node->items.size());
+		seqwrite(out, &itemCount, sizeof(itemCount));
+
+		if (itemCount > 0)
+			seqwrite(out, node->items.data(), itemCount * sizeof(node->items[0]));
+	}
+}
+
+static bool buildPackedSection(std::vector<uint8_t> &packed, const WorldChunkStaticObjectData &chunkData, const std::vector<Octree<StaticObjectEntry>*> &nodeList)
+{
+	uint32_t totalItemCount = 0;
+	svec3 quantizationMin = {chunkData.chunkAABB.aabbMin.x, chunkData.chunkAABB.aabbMin.y, chunkData.chunkAABB.aabbMin.z};
+	svec3 quantizationMax = {chunkData.chunkAABB.aabbMax.x, chunkData.chunkAABB.aabbMax.y, chunkData.chunkAABB.aabbMax.z};
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+	{
+		// Child bounding boxes aren't stored, they're recomputed on load, so they have to match exactly
+		for (int child = 0; child < 8; child++)
+		{
+			if (node->children[child] == nullptr)
+				continue;
+
+			AABB expectedAABB = getOctreeChildOctantAABB(node->boundingBox, child);
+			const AABB &childAABB = node->children[child]->boundingBox;
+
+			if (childAABB.aabbMin.x != expectedAABB.aabbMin.x || childAABB.aabbMin.y != expectedAABB.aabbMin.y || childAABB.aabbMin.z != expectedAABB.aabbMin.z ||
+				childAABB.aabbMax.x != expectedAABB.aabbMax.x || childAABB.aabbMax.y != expectedAABB.aabbMax.y || childAABB.aabbMax.z != expectedAABB.aabbMax.z)
+				return false;
+		}
+
+		for (const StaticObjectEntry &item : node->items)
+		{
+			quantizationMin = {std::min(quantizationMin.x, item.position.x), std::min(quantizationMin.y, item.position.y), std::min(quantizationMin.z, item.position.z)};
+			quantizationMax = {std::max(quantizationMax.x, item.position.x), std::max(quantizationMax.y, item.position.y), std::max(quantizationMax.z, item.position.z)};
+		}
+
+		totalItemCount += uint32_t(node->items.size());
+	}
+
+	svec3 quantizationExtent = {quantizationMax.x - quantizationMin.x, quantizationMax.y - quantizationMin.y, quantizationMax.z - quantizationMin.z};
+	uint32_t nodeCount = uint32_t(nodeList.size());
+
+	writeBytes(packed, &chunkData.chunkAABB, sizeof(chunkData.chunkAABB));
+	writeBytes(packed, &nodeList[0]->boundingBox, sizeof(nodeList[0]->boundingBox));
+	writeBytes(packed, &quantizationMin, sizeof(quantizationMin));
+	writeBytes(packed, &quantizationExtent, sizeof(quantizationExtent));
+	writeBytes(packed, &nodeCount, sizeof(nodeCount));
+	writeBytes(packed, &totalItemCount, sizeof(totalItemCount));
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+	{
+		uint8_t childMask = 0;
+
+		for (int child = 0; child < 8; child++)
+			if (node->children[child] != nullptr)
+				childMask |= uint8_t(1 << child);
+
+		packed.push_back(childMask);
+	}
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		writeVarint(packed, node->items.size());
+
+	// Everything from here on is written column by column, which gives the LZ stage much longer runs to work with
+	uint64_t prevUUID = 0, prevMeshID = 0, prevMaterialID = 0;
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+		{
+			writeVarint(packed, zigzagEncode(int64_t(item.objectUUID - prevUUID)));
+			prevUUID = item.objectUUID;
+		}
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+		{
+			writeVarint(packed, zigzagEncode(int64_t(item.meshID - prevMeshID)));
+			prevMeshID = item.meshID;
+		}
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+		{
+			writeVarint(packed, zigzagEncode(int64_t(item.materialID - prevMaterialID)));
+			prevMaterialID = item.materialID;
+		}
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float axisMin = (&quantizationMin.x)[axis];
+		float axisExtent = (&quantizationExtent.x)[axis];
+
+		for (Octree<StaticObjectEntry> *node : nodeList)
+			for (const StaticObjectEntry &item : node->items)
+			{
+				float normalized = axisExtent > 0.0f ? ((&item.position.x)[axis] - axisMin) / axisExtent : 0.0f;
+				uint16_t quantized = uint16_t(std::min(std::max(std::round(normalized * worldFilePositionQuantizationMax), 0.0f), worldFilePositionQuantizationMax));
+
+				writeBytes(packed, &quantized, sizeof(quantized));
+			}
+	}
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+			writeBytes(packed, &item.scale, sizeof(item.scale));
+
+	for (int component = 0; component < 4; component++)
+		for (Octree<StaticObjectEntry> *node : nodeList)
+			for (const StaticObjectEntry &item : node->items)
+				writeBytes(packed, &(&item.orientation.x)[component], sizeof(float));
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+			writeBytes(packed, &item.boundingSphereRadius, sizeof(item.boundingSphereRadius));
+
+	for (Octree<StaticObjectEntry> *node : nodeList)
+		for (const StaticObjectEntry &item : node->items)
+			writeVarint(packed, item.bitmask);
+
+	return true;
+}
+
+void writeWorldChunkStaticObjectSection(std::vector<char> &out, const WorldChunkStaticObjectData &chunkData, WorldFileSectionEncoding encoding)
+{
+	std::vector<Octree<StaticObjectEntry>*> nodeList;
+	std::map<Octree<StaticObjectEntry>*, uint32_t> nodeIndexMap;
+
+	// A chunk w/o an octree is written as a single empty root node
+	Octree<StaticObjectEntry> emptyRoot;
+	emptyRoot.boundingBox = chunkData.chunkAABB;
+
+	flattenOctree(chunkData.chunkOctree != nullptr ? chunkData.chunkOctree : &emptyRoot, nodeList, nodeIndexMap);
+
+	if (encoding == WORLD_FILE_SECTION_ENCODING_PACKED_LZ4)
+	{
+		std::vector<uint8_t> packed;
+
+		if (buildPackedSection(packed, chunkData, nodeList))
+		{
+			std::vector<uint8_t> compressed(lz4BlockCompressBound(packed.size()));
+			uint32_t packedSize = uint32_t(packed.size());
+			uint32_t compressedSize = uint32_t(lz4BlockCompress(packed.data(), packed.size(), compressed.data(), compressed.size()));
+
+			uint8_t sectionEncoding = WORLD_FILE_SECTION_ENCODING_PACKED_LZ4;
+			seqwrite(out, &sectionEncoding, sizeof(sectionEncoding));
+			seqwrite(out, &packedSize, sizeof(packedSize));
+			seqwrite(out, &compressedSize, sizeof(compressedSize));
+			seqwrite(out, compressed.data(), compressedSize);
+
+			return;
+		}
+
+		Log::get()->warn("WorldFileFormat: Chunk octree can't be packed, writing the chunk's static object section raw instead");
+	}
+
+	uint8_t sectionEncoding = WORLD_FILE_SECTION_ENCODING_RAW;
+	seqwrite(out, &sectionEncoding, sizeof(sectionEncoding));
+
+	writeRawSection(out, chunkData, nodeList, nodeIndexMap);
+}
+
+static bool readRawSection(const char *fileData, size_t fileSize, uint64_t offset, WorldChunkStaticObjectData &chunkData)
+{
+	if (offset + sizeof(chunkData.chunkAABB) + sizeof(uint32_t) > fileSize)
+		return false;
+
+	seqread(&chunkData.chunkAABB, fileData, sizeof(chunkData.chunkAABB), offset);
+
+	uint32_t octreeCount = 0;
+	seqread(&octreeCount, fileData, sizeof(octreeCount), offset);
+
+	const size_t nodeHeaderSize = sizeof(uint32_t) * 9 + sizeof(AABB) + sizeof(uint32_t);
+
+	if (octreeCount == 0 || octreeCount > (fileSize - offset) / nodeHeaderSize)
+		return false;
+
+	Octree<StaticObjectEntry> *octrees = new Octree<StaticObjectEntry>[octreeCount];
+
+	for (uint32_t n = 0; n < octreeCount; n++)
+	{
+		if (offset + nodeHeaderSize > fileSize)
+		{
+			delete[] octrees;
+			return false;
+		}
+
+		Octree<StaticObjectEntry> *node = &octrees[n];
+		uint32_t parentNodeIndex, childNodeIndex[8];
+
+		seqread(&parentNodeIndex, fileData, sizeof(parentNodeIndex), offset);
+		node->parent = parentNodeIndex >= octreeCount ? nullptr : &octrees[parentNodeIndex];
+
+		for (int c = 0; c < 8; c++)
+		{
+			seqread(&childNodeIndex[c], fileData, sizeof(childNodeIndex[c]), offset);
+			node->children[c] = childNodeIndex[c] >= octreeCount ? nullptr : &octrees[childNodeIndex[c]];
+		}
+
+		seqread(&node->boundingBox, fileData, sizeof(node->boundingBox), offset);
+
+		uint32_t itemCount;
+		seqread(&itemCount, fileData, sizeof(itemCount), offset);
+
+		if (itemCount > 0)
+		{
+			if (uint64_t(itemCount) * sizeof(StaticObjectEntry) > fileSize - offset)
+			{
+				delete[] octrees;
+				return false;
+			}
+
+			node->items.resize(itemCount);
+			seqread(node->items.data(), fileData, itemCount * sizeof(node->items[0]), offset);
+		}
+	}
+
+	chunkData.chunkOctree = octrees;
+
+	return true;
+}
+
+static bool linkPackedOctreeChildren(Octree<StaticObjectEntry> *nodes, const std::vector<uint8_t> &childMasks, uint32_t nodeIndex, uint32_t &nextNodeIndex, uint32_t depth)
+{
+	if (depth > worldFileMaxPackedOctreeDepth)
+		return false;
+
+	for (int child = 0; child < 8; child++)
+	{
+		if ((childMasks[nodeIndex] & (1 << child)) == 0)
+			continue;
+
+		if (nextNodeIndex >= uint32_t(childMasks.size()))
+			return false;
+
+		uint32_t childIndex = nextNodeIndex++;
+		nodes[childIndex].parent = &nodes[nodeIndex];
+		nodes[childIndex].boundingBox = getOctreeChildOctantAABB(nodes[nodeIndex].boundingBox, child);
+		nodes[nodeIndex].children[child] = &nodes[childIndex];
+
+		if (!linkPackedOctreeChildren(nodes, childMasks, childIndex, nextNodeIndex, depth + 1))
+			return false;
+	}
+
+	return true;
+}
+
+static bool readPackedSection(const uint8_t *packedData, size_t packedSize, WorldChunkStaticObjectData &chunkData)
+{
+	WorldFilePackedSectionReader reader = {packedData, packedSize, 0, true};
+
+	AABB rootNodeAABB;
+	svec3 quantizationMin, quantizationExtent;
+	uint32_t nodeCount, totalItemCount;
+
+	reader.read(&chunkData.chunkAABB, sizeof(chunkData.chunkAABB));
+	reader.read(&rootNodeAABB, sizeof(rootNodeAABB));
+	reader.read(&quantizationMin, sizeof(quantizationMin));
+	reader.read(&quantizationExtent, sizeof(quantizationExtent));
+	reader.read(&nodeCount, sizeof(nodeCount));
+	reader.read(&totalItemCount, sizeof(totalItemCount));
+
+	// Every node takes at least 2 bytes and every item at least 34, so this rejects garbage counts before allocating anything
+	if (!reader.ok || nodeCount == 0 || nodeCount > packedSize / 2 || totalItemCount > packedSize / 34)
+		return false;
+
+	std::vector<uint8_t> childMasks(nodeCount);
+	reader.read(childMasks.data(), childMasks.size());
+
+	std::vector<uint32_t> nodeItemCounts(nodeCount);
+	uint64_t nodeItemCountSum = 0;
+
+	for (uint32_t n = 0; n < nodeCount; n++)
+	{
+		nodeItemCounts[n] = uint32_t(reader.readVarint());
+		nodeItemCountSum += nodeItemCounts[n];
+	}
+
+	if (!reader.ok || nodeItemCountSum != totalItemCount)
+		return false;
+
+	Octree<StaticObjectEntry> *octrees = new Octree<StaticObjectEntry>[nodeCount];
+	octrees[0].boundingBox = rootNodeAABB;
+
+	uint32_t nextNodeIndex = 1;
+
+	if (!linkPackedOctreeChildren(octrees, childMasks, 0, nextNodeIndex, 0) || nextNodeIndex != nodeCount)
+	{
+		delete[] octrees;
+		return false;
+	}
+
+	std::vector<StaticObjectEntry> items(totalItemCount);
+	uint64_t prevUUID = 0, prevMeshID = 0, prevMaterialID = 0;
+
+	for (StaticObjectEntry &item : items)
+		item.objectUUID = prevUUID = prevUUID + uint64_t(zigzagDecode(reader.readVarint()));
+
+	for (StaticObjectEntry &item : items)
+		item.meshID = prevMeshID = prevMeshID + uint64_t(zigzagDecode(reader.readVarint()));
+
+	for (StaticObjectEntry &item : items)
+		item.materialID = prevMaterialID = prevMaterialID + uint64_t(zigzagDecode(reader.readVarint()));
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float axisMin = (&quantizationMin.x)[axis];
+		float axisStep = (&quantizationExtent.x)[axis] / worldFilePositionQuantizationMax;
+
+		for (StaticObjectEntry &item : items)
+		{
+			uint16_t quantized;
+			reader.read(&quantized, sizeof(quantized));
+
+			(&item.position.x)[axis] = axisMin + float(quantized) * axisStep;
+		}
+	}
+
+	for (StaticObjectEntry &item : items)
+		reader.read(&item.scale, sizeof(item.scale));
+
+	for (int component = 0; component < 4; component++)
+		for (StaticObjectEntry &item : items)
+			reader.read(&(&item.orientation.x)[component], sizeof(float));
+
+	for (StaticObjectEntry &item : items)
+		reader.read(&item.boundingSphereRadius, sizeof(item.boundingSphereRadius));
+
+	for (StaticObjectEntry &item : items)
+		item.bitmask = uint32_t(reader.readVarint());
+
+	if (!reader.ok)
+	{
+		delete[] octrees;
+		return false;
+	}
+
+	size_t itemOffset = 0;
+
+	for (uint32_t n = 0; n < nodeCount; n++)
+	{
+		octrees[n].items.assign(items.begin() + itemOffset, items.begin() + itemOffset + nodeItemCounts[n]);
+		itemOffset += nodeItemCounts[n];
+	}
+
+	chunkData.chunkOctree = octrees;
+
+	return true;
+}
+
+bool readWorldChunkStaticObjectSection(const char *fileData, size_t fileSize, uint64_t offset, uint16_t fileVersion, WorldChunkStaticObjectData &chunkData)
+{
+	chunkData.chunkOctree = nullptr;
+
+	if (offset >= fileSize)
+		return false;
+
+	if (fileVersion == 0)
+		return readRawSection(fileData, fileSize, offset, chunkData);
+
+	uint8_t sectionEncoding;
+	seqread(&sectionEncoding, fileData, sizeof(sectionEncoding), offset);
+
+	switch (sectionEncoding)
+	{
+		case WORLD_FILE_SECTION_ENCODING_RAW:
+			return readRawSection(fileData, fileSize, offset, chunkData);
+		case WORLD_FILE_SECTION_ENCODING_PACKED_LZ4:
+		{
+			uint32_t packedSize, compressedSize;
+
+			if (offset + sizeof(packedSize) + sizeof(compressedSize) > fileSize)
+				return false;
+
+			seqread(&packedSize, fileData, sizeof(packedSize), offset);
+			seqread(&compressedSize, fileData, sizeof(compressedSize), offset);
+
+			if (compressedSize > fileSize - offset || packedSize > uint64_t(compressedSize) * 255 + 16)
+				return false;
+
+			std::vector<uint8_t> packed(packedSize);
+
+			if (!lz4BlockDecompress(reinterpret_cast<const uint8_t*>(fileData) + offset, compressedSize, packed.data(), packed.size()))
+				return false;
+
+			return readPackedSection(packed.data(), packed.size(), chunkData);
+		}
+		default:
+			Log::get()->error("WorldFileFormat: Unknown static object section encoding {}", sectionEncoding);
+			return false;
+	}
+}
+
+/*
+Predicts each sample from the one to it's left (or above it for the first column), terrain is smooth so the deltas are mostly tiny
+*/
+static inline uint16_t predictHeightmapSample(const std::vector<uint16_t> &heightmap, size_t samplesPerAxis, size_t x, size_t z)
+{
+	size_t i = z * samplesPerAxis + x;
+
+	return x > 0 ? heightmap[i - 1] : (z > 0 ? heightmap[i - samplesPerAxis] : 0);
+}
+
+void writeWorldChunkHeightmapSection(std::vector<char> &out, const WorldChunkTerrainData &terrainData, WorldFileSectionEncoding encoding)
+{
+	const size_t sampleCount = WORLD_TERRAIN_HEIGHTMAP_SAMPLES * WORLD_TERRAIN_HEIGHTMAP_SAMPLES;
+	std::vector<uint16_t> heightmap = terrainData.heightmap;
+	heightmap.resize(sampleCount, 0);
+
+	uint8_t sectionEncoding = encoding == WORLD_FILE_SECTION_ENCODING_PACKED_LZ4 ? WORLD_FILE_SECTION_ENCODING_PACKED_LZ4 : WORLD_FILE_SECTION_ENCODING_RAW;
+	seqwrite(out, &sectionEncoding, sizeof(sectionEncoding));
+	seqwrite(out, &terrainData.heightOffset, sizeof(terrainData.heightOffset));
+	seqwrite(out, &terrainData.heightScale, sizeof(terrainData.heightScale));
+
+	if (sectionEncoding == WORLD_FILE_SECTION_ENCODING_RAW)
+	{
+		seqwrite(out, heightmap.data(), sampleCount * sizeof(uint16_t));
+
+		return;
+	}
+
+	std::vector<uint8_t> packed(sampleCount * 2);
+
+	for (size_t z = 0; z < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; z++)
+	{
+		for (size_t x = 0; x < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; x++)
+		{
+			size_t i = z * WORLD_TERRAIN_HEIGHTMAP_SAMPLES + x;
+			uint16_t delta = uint16_t(heightmap[i] - predictHeightmapSample(heightmap, WORLD_TERRAIN_HEIGHTMAP_SAMPLES, x, z));
+
+			packed[i] = uint8_t(delta & 0xFF);
+			packed[sampleCount + i] = uint8_t(delta >> 8);
+		}
+	}
+
+	std::vector<uint8_t> compressed(lz4BlockCompressBound(packed.size()));
+	uint32_t compressedSize = uint32_t(lz4BlockCompress(packed.data(), packed.size(), compressed.data(), compressed.size()));
+
+	seqwrite(out, &compressedSize, sizeof(compressedSize));
+	seqwrite(out, compressed.data(), compressedSize);
+}
+
+/*
+Version 1 heightmaps stop one row/column short, the missing far edge is filled in from the last one there is
+*/
+static void expandVersion1Heightmap(std::vector<uint16_t> &heightmap)
+{
+	std::vector<uint16_t> expanded(WORLD_TERRAIN_HEIGHTMAP_SAMPLES * WORLD_TERRAIN_HEIGHTMAP_SAMPLES);
+
+	for (size_t z = 0; z < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; z++)
+		for (size_t x = 0; x < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; x++)
+			expanded[z * WORLD_TERRAIN_HEIGHTMAP_SAMPLES + x] = heightmap[std::min<size_t>(z, WORLD_TERRAIN_HEIGHTMAP_RESOLUTION - 1) * WORLD_TERRAIN_HEIGHTMAP_RESOLUTION + std::min<size_t>(x, WORLD_TERRAIN_HEIGHTMAP_RESOLUTION - 1)];
+
+	heightmap.swap(expanded);
+}
+
+bool readWorldChunkHeightmapSection(const char *fileData, size_t fileSize, uint64_t offset, uint16_t fileVersion, WorldChunkTerrainData &terrainData)
+{
+	const size_t samplesPerAxis = fileVersion >= 2 ? WORLD_TERRAIN_HEIGHTMAP_SAMPLES : WORLD_TERRAIN_HEIGHTMAP_RESOLUTION;
+	const size_t sampleCount = samplesPerAxis * samplesPerAxis;
+
+	terrainData.heightmap.clear();
+
+	uint8_t sectionEncoding;
+
+	if (offset >= fileSize || offset + sizeof(sectionEncoding) + sizeof(terrainData.heightOffset) + sizeof(terrainData.heightScale) > fileSize)
+		return false;
+
+	seqread(&sectionEncoding, fileData, sizeof(sectionEncoding), offset);
+	seqread(&terrainData.heightOffset, fileData, sizeof(terrainData.heightOffset), offset);
+	seqread(&terrainData.heightScale, fileData, sizeof(terrainData.heightScale), offset);
+
+	switch (sectionEncoding)
+	{
+		case WORLD_FILE_SECTION_ENCODING_RAW:
+		{
+			if (sampleCount * sizeof(uint16_t) > fileSize - offset)
+				return false;
+
+			terrainData.heightmap.resize(sampleCount);
+			seqread(terrainData.heightmap.data(), fileData, sampleCount * sizeof(uint16_t), offset);
+
+			break;
+		}
+		case WORLD_FILE_SECTION_ENCODING_PACKED_LZ4:
+		{
+			uint32_t compressedSize;
+
+			if (offset + sizeof(compressedSize) > fileSize)
+				return false;
+
+			seqread(&compressedSize, fileData, sizeof(compressedSize), offset);
+
+			if (compressedSize > fileSize - offset)
+				return false;
+
+			std::vector<uint8_t> packed(sampleCount * 2);
+
+			if (!lz4BlockDecompress(reinterpret_cast<const uint8_t*>(fileData) + offset, compressedSize, packed.data(), packed.size()))
+				return false;
+
+			terrainData.heightmap.resize(sampleCount);
+
+			for (size_t z = 0; z < samplesPerAxis; z++)
+			{
+				for (size_t x = 0; x < samplesPerAxis; x++)
+				{
+					size_t i = z * samplesPerAxis + x;
+
+					terrainData.heightmap[i] = uint16_t(predictHeightmapSample(terrainData.heightmap, samplesPerAxis, x, z) + (uint16_t(packed[i]) | (uint16_t(packed[sampleCount + i]) << 8)));
+				}
+			}
+
+			break;
+		}
+		default:
+			Log::get()->error("WorldFileFormat: Unknown heightmap section encoding {}", sectionEncoding);
+			return false;
+	}
+
+	if (fileVersion < 2)
+		expandVersion1Heightmap(terrainData.heightmap);
+
+	return true;
+}
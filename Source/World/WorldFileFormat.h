@@ -0,0 +1,39 @@
+#ifndef WORLD_WORLDFILEFORMAT_H_
+#define WORLD_WORLDFILEFORMAT_H_
+
+#include <common.h>
+#include <World/WorldManager.h>
+#include <World/Terrain.h>
+
+/*
+Appends a chunk's static object section to 'out', aka the data a WorldInfoLookupEntry::objectDataFilePosition points to. The section
+is written in the current WORLD_FILE_VERSION layout, so it starts with it's WorldFileSectionEncoding. If the packed encoding can't
+represent the chunk's octree (child nodes w/ bounding boxes that insertItemsIntoOctree wouldn't have made) it falls back to raw.
+
+The packed encoding quantizes object positions to 16 bits per axis relative to the chunk AABB (expanded to fit any objects that lie outside of it),
+so positions can move by up to (chunk size / 131070) when loaded. Everything else round trips exactly.
+*/
+void writeWorldChunkStaticObjectSection(std::vector<char> &out, const WorldChunkStaticObjectData &chunkData, WorldFileSectionEncoding encoding);
+
+/*
+Reads a chunk's static object section starting at 'offset' in a world file. All of the chunk's octree nodes are allocated as one
+array, with chunkData.chunkOctree pointing at the first one (the root), so it should be freed w/ delete[]. Returns false if
+the section is malformed, in which case chunkData.chunkOctree is left as nullptr.
+*/
+bool readWorldChunkStaticObjectSection(const char *fileData, size_t fileSize, uint64_t offset, uint16_t fileVersion, WorldChunkStaticObjectData &chunkData);
+
+/*
+Appends a chunk's heightmap section to 'out', aka the data a WorldInfoLookupEntry::heightmapDataFilePosition points to. Starts w/ it's
+WorldFileSectionEncoding, the packed encoding stores each sample as the difference from the one before it, split into low and high
+byte planes and compressed as one LZ4 block. Both encodings are lossless.
+*/
+void writeWorldChunkHeightmapSection(std::vector<char> &out, const WorldChunkTerrainData &terrainData, WorldFileSectionEncoding encoding);
+
+/*
+Reads a chunk's heightmap section starting at 'offset' in a world file. Only fills the heightmap and height offset/scale, the LOD tree
+is left for buildTerrainChunkLODTree(). Returns false if the section is malformed, in which case the heightmap is left empty. Version 1
+heightmaps don't have the far row/column, it's copied from the last one they do have, so they still crack at chunk borders until rebaked.
+*/
+bool readWorldChunkHeightmapSection(const char *fileData, size_t fileSize, uint64_t offset, uint16_t fileVersion, WorldChunkTerrainData &terrainData);
+
+#endif /* WORLD_WORLDFILEFORMAT_H_ */
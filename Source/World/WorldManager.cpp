@@ -1,7 +1,11 @@
 #include "World/WorldManager.h"
 
+#include <chrono>
+
 #include <Resources/FileLoader.h>
 
+#include <World/WorldFileFormat.h>
+
 WorldManager::WorldManager()
 {
 	DEBUG_ASSERT(sizeof(StaticObjectEntry) == 64);
@@ -14,8 +18,36 @@ WorldManager::~WorldManager()
 
 }
 
+struct WorldChunkLoadJobData
+{
+	const std::vector<char> *file;
+	uint64_t heightmapDataFilePosition;
+	uint64_t objectDataFilePosition;
+	uint16_t fileVersion;
+	WorldChunkTerrainData *terrainData;
+	WorldChunkStaticObjectData *chunkData;
+	bool success;
+};
+
+void worldChunkLoadJobFunction(Job *job)
+{
+	WorldChunkLoadJobData *jobData = reinterpret_cast<WorldChunkLoadJobData*>(job->usrData);
+
+	jobData->success = readWorldChunkStaticObjectSection(jobData->file->data(), jobData->file->size(), jobData->objectDataFilePosition, jobData->fileVersion, *jobData->chunkData);
+
+	if (jobData->heightmapDataFilePosition != 0)
+	{
+		if (readWorldChunkHeightmapSection(jobData->file->data(), jobData->file->size(), jobData->heightmapDataFilePosition, jobData->fileVersion, *jobData->terrainData))
+			buildTerrainChunkLODTree(*jobData->terrainData);
+		else
+			jobData->success = false;
+	}
+}
+
 void WorldManager::loadWorld(const std::string &fileName)
 {
+	auto loadStartTime = std::chrono::steady_clock::now();
+
 	std::vector<char> file = FileLoader::instance()->readFileBuffer(fileName);
 
 	if (file.size() < 4)
@@ -34,9 +66,9 @@ void WorldManager::loadWorld(const std::string &fileName)
 	
 	seqread(&fileVersion, file.data(), sizeof(fileVersion), offset);
 
-	if (fileVersion != 0)
+	if (fileVersion > WORLD_FILE_VERSION)
 	{
-		Log::get()->error("Failed to load {} as a world file, file has outdated version {}", fileVersion);
+		Log::get()->error("Failed to load {} as a world file, file has unsupported version {}", fileName, fileVersion);
 		return;
 	}
 
@@ -52,62 +84,85 @@ void WorldManager::loadWorld(const std::string &fileName)
 	seqread(&worldInfo.terrainOffsetY, file.data(), sizeof(worldInfo.terrainOffsetY), offset);
 
 	// LOOKUP TABLE
-	for (int64_t x = worldInfo.terrainOffsetX; x < int64_t(worldInfo.terrainSizeX) - worldInfo.terrainOffsetX; x++)
+	// Stored in the same x then y order as the per chunk arrays, so each column of chunks can be read in one go
+	int64_t chunkCountX = std::max<int64_t>(int64_t(worldInfo.terrainSizeX) - 2 * int64_t(worldInfo.terrainOffsetX), 0);
+	int64_t chunkCountY = std::max<int64_t>(int64_t(worldInfo.terrainSizeY) - 2 * int64_t(worldInfo.terrainOffsetY), 0);
+	uint64_t lookupTableSize = uint64_t(chunkCountX) * uint64_t(chunkCountY) * sizeof(WorldInfoLookupEntry);
+
+	if (worldInfo.terrainOffsetX < 0 || worldInfo.terrainOffsetY < 0 || lookupTableSize > file.size() - offset)
 	{
-		for (int64_t y = worldInfo.terrainOffsetY; y < int64_t(worldInfo.terrainSizeY) - worldInfo.terrainOffsetY; y++)
-		{
-			WorldInfoLookupEntry entry = {};
-			seqread(&entry.heightmapDataFilePosition, file.data(), sizeof(entry.heightmapDataFilePosition), offset);
-			seqread(&entry.objectDataFilePosition, file.data(), sizeof(entry.objectDataFilePosition), offset);
+		Log::get()->error("Failed to load {} as a world file, it's terrain size/offset is invalid or the file is too small to hold it's lookup table", fileName);
+		delete worldInfoPtr;
 
-			worldInfo.dataLookupTable[{int32_t(x), int32_t(y)}] = entry;
-		}
+		return;
 	}
 
-	// HEIGHTMAP DATA
+	worldInfo.dataLookupTable.resize(size_t(worldInfo.terrainSizeX) * worldInfo.terrainSizeY, {0, 0});
+
+	for (int64_t x = worldInfo.terrainOffsetX; x < int64_t(worldInfo.terrainSizeX) - worldInfo.terrainOffsetX && chunkCountY > 0; x++)
+		seqread(&worldInfo.dataLookupTable[getWorldChunkIndex(worldInfo, int32_t(x), worldInfo.terrainOffsetY)], file.data(), size_t(chunkCountY) * sizeof(WorldInfoLookupEntry), offset);
+
+	// HEIGHTMAP DATA & STATIC OBJECT DATA
+	// Each chunk's sections are independent, so they're all decoded in parallel on the job system. Heightmaps also get their LOD trees built there
+	worldInfo.staticObjectData.resize(size_t(worldInfo.terrainSizeX) * worldInfo.terrainSizeY, {});
+	worldInfo.terrainData.resize(size_t(worldInfo.terrainSizeX) * worldInfo.terrainSizeY, {});
+
+	std::vector<WorldChunkLoadJobData> chunkJobData;
 
-	// STATIC OBJECT DATA
 	for (int64_t x = worldInfo.terrainOffsetX; x < int64_t(worldInfo.terrainSizeX) - worldInfo.terrainOffsetX; x++)
 	{
 		for (int64_t y = worldInfo.terrainOffsetY; y < int64_t(worldInfo.terrainSizeY) - worldInfo.terrainOffsetY; y++)
 		{
-			offset = worldInfo.dataLookupTable[{int32_t(x), int32_t(y)}].objectDataFilePosition;
+			size_t chunkIndex = getWorldChunkIndex(worldInfo, int32_t(x), int32_t(y));
+			const WorldInfoLookupEntry &lookupEntry = worldInfo.dataLookupTable[chunkIndex];
+
+			WorldChunkLoadJobData jobData = {};
+			jobData.file = &file;
+			jobData.heightmapDataFilePosition = worldInfo.hasTerrain ? lookupEntry.heightmapDataFilePosition : 0;
+			jobData.objectDataFilePosition = lookupEntry.objectDataFilePosition;
+			jobData.fileVersion = fileVersion;
+			jobData.terrainData = &worldInfo.terrainData[chunkIndex];
+			jobData.chunkData = &worldInfo.staticObjectData[chunkIndex];
+
+			chunkJobData.push_back(jobData);
+		}
+	}
 
-			WorldChunkStaticObjectData data = {};
-			seqread(&data.chunkAABB, file.data(), sizeof(data.chunkAABB), offset);
+	// Jobs come from a fixed size ring per worker, so don't have too many in flight at once
+	const size_t chunkJobBatchSize = 1024;
 
-			uint32_t octreeCount = 0;
-			seqread(&octreeCount, file.data(), sizeof(octreeCount), offset);
+	for (size_t batchStart = 0; batchStart < chunkJobData.size(); batchStart += chunkJobBatchSize)
+	{
+		Job *batchJob = JobSystem::get()->allocateJob(nullptr);
+		std::vector<Job*> chunkJobs;
+
+		for (size_t i = batchStart; i < std::min(batchStart + chunkJobBatchSize, chunkJobData.size()); i++)
+		{
+			Job *chunkJob = JobSystem::get()->allocateJobAsChild(batchJob, worldChunkLoadJobFunction);
+			chunkJob->usrData = &chunkJobData[i];
+
+			chunkJobs.push_back(chunkJob);
+		}
 
-			Octree<StaticObjectEntry> *octrees = new Octree<StaticObjectEntry>[octreeCount];
+		JobSystem::get()->runJobs(chunkJobs);
+		JobSystem::get()->runJob(batchJob);
+		JobSystem::get()->waitForJob(batchJob);
+	}
 
-			for (uint32_t n = 0; n < octreeCount; n++)
-			{
-				Octree<StaticObjectEntry> *node = &octrees[n];
-				uint32_t parentNodeIndex, childNodeIndex[8];
+	size_t failedChunkCount = 0;
 
-				seqread(&parentNodeIndex, file.data(), sizeof(parentNodeIndex), offset);
-				node->parent = parentNodeIndex == 0xFFFFFFFF ? nullptr : &octrees[parentNodeIndex];
+	for (const WorldChunkLoadJobData &jobData : chunkJobData)
+		if (!jobData.success)
+			failedChunkCount++;
 
-				for (int c = 0; c < 8; c++)
-				{
-					seqread(&childNodeIndex[c], file.data(), sizeof(childNodeIndex[c]), offset);
-					node->children[c] = childNodeIndex[c] == 0xFFFFFFFF ? nullptr : &octrees[childNodeIndex[c]];
-				}
+	if (failedChunkCount > 0)
+		Log::get()->error("Failed to load the heightmap or static object data of {} chunk(s) in world file {}, it's probably corrupt", failedChunkCount, fileName);
 
-				seqread(&node->boundingBox, file.data(), sizeof(node->boundingBox), offset);
+	buildWorldTerrainLOD(worldInfo.terrainLOD, worldInfo.terrainData, worldInfo.terrainSizeX, worldInfo.terrainSizeY, worldInfo.terrainOffsetX, worldInfo.terrainOffsetY);
 
-				uint32_t itemCount;
-				seqread(&itemCount, file.data(), sizeof(itemCount), offset);
+	double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStartTime).count();
 
-				if (itemCount > 0)
-				{
-					node->items.resize(itemCount);
-					seqread(node->items.data(), file.data(), itemCount * sizeof(node->items[0]), offset);
-				}
-			}
-		}
-	}
+	Log::get()->info("Loaded world \"{}\" (version {}) from {}: {} chunks, {:.2f} MB on disk, took {:.2f} ms ({:.1f} MB/s)", worldInfo.uniqueName, fileVersion, fileName, chunkJobData.size(), file.size() / 1048576.0, loadTime * 1000.0, file.size() / 1048576.0 / std::max(loadTime, 1e-9));
 
 	loadedWorlds[worldInfo.uniqueName] = worldInfoPtr;
 }
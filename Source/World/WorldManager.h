@@ -3,6 +3,7 @@
 
 #include <common.h>
 #include <Util/SpatialStructures.h>
+#include <World/Terrain.h>
 
 struct alignas(64) StaticObjectEntry
 {
@@ -21,9 +22,24 @@ struct alignas(64) StaticObjectEntry
 	}
 };
 
+/*
+KEW file versions:
+ - 0: Static object sections are stored as raw octree node tables and StaticObjectEntry arrays
+ - 1: Every chunk's static object section is prefixed by a WorldFileSectionEncoding byte
+ - 2: Heightmap sections have WORLD_TERRAIN_HEIGHTMAP_SAMPLES samples along each axis instead of WORLD_TERRAIN_HEIGHTMAP_RESOLUTION
+*/
+#define WORLD_FILE_VERSION 2
+
+typedef enum WorldFileSectionEncoding
+{
+	WORLD_FILE_SECTION_ENCODING_RAW = 0, // Same layout as a version 0 section
+	WORLD_FILE_SECTION_ENCODING_PACKED_LZ4 = 1, // Quantized/delta-encoded columns, compressed as a single LZ4 block
+	WORLD_FILE_SECTION_ENCODING_MAX_ENUM = 0xFF
+} WorldFileSectionEncoding;
+
 typedef struct
 {
-	uint64_t heightmapDataFilePosition;
+	uint64_t heightmapDataFilePosition; // 0 if the chunk doesn't have a heightmap
 	uint64_t objectDataFilePosition;
 } WorldInfoLookupEntry;
 
@@ -43,11 +59,96 @@ typedef struct
 	int32_t terrainOffsetX;
 	int32_t terrainOffsetY;
 
-	std::map<sivec2, WorldInfoLookupEntry> dataLookupTable;
+	// All per chunk arrays are arranged by terrain sizes, aka size = terrainSizeX * terrainSizeY, accessed by getWorldChunkIndex()
+	std::vector<WorldInfoLookupEntry> dataLookupTable;
+	std::vector<WorldChunkStaticObjectData> staticObjectData;
+	std::vector<WorldChunkTerrainData> terrainData;
 
-	std::vector<WorldChunkStaticObjectData> staticObjectData; // Arranged by terrain sizes, aka size = terrainSizeX * terrainSizeY, accessed by [x * terrainSizeX + y]
+	WorldTerrainLOD terrainLOD;
 } WorldInfo;
 
+/*
+A world has chunks for x in [terrainOffsetX, terrainSizeX - terrainOffsetX) and y in [terrainOffsetY, terrainSizeY - terrainOffsetY),
+which is the order they're stored in a KEW file's lookup table. Chunk (x, y) covers [x, x + 1) * WORLD_CHUNK_SIZE on the world X axis
+and [y, y + 1) * WORLD_CHUNK_SIZE on the world Z axis.
+*/
+inline bool isWorldChunkInBounds(const WorldInfo &world, int32_t x, int32_t y)
+{
+	return x >= world.terrainOffsetX && int64_t(x) < int64_t(world.terrainSizeX) - world.terrainOffsetX && y >= world.terrainOffsetY && int64_t(y) < int64_t(world.terrainSizeY) - world.terrainOffsetY;
+}
+
+/*
+Index of a chunk in the WorldInfo per chunk arrays, the chunk must be in bounds
+*/
+inline size_t getWorldChunkIndex(const WorldInfo &world, int32_t x, int32_t y)
+{
+	return size_t(int64_t(x) - world.terrainOffsetX) * world.terrainSizeY + size_t(int64_t(y) - world.terrainOffsetY);
+}
+
+inline sivec2 getWorldChunkAtPosition(const glm::vec3 &worldPosition)
+{
+	return {int32_t(std::floor(worldPosition.x / float(WORLD_CHUNK_SIZE))), int32_t(std::floor(worldPosition.z / float(WORLD_CHUNK_SIZE)))};
+}
+
+/*
+Calls func(int32_t x, int32_t y, size_t chunkIndex) for each in bounds chunk sharing an edge w/ chunk (x, y), or also a corner if includeDiagonals is set
+*/
+template <typename ChunkFunction>
+inline void forEachWorldChunkNeighbour(const WorldInfo &world, int32_t x, int32_t y, bool includeDiagonals, ChunkFunction func)
+{
+	for (int32_t dy = -1; dy <= 1; dy++)
+	{
+		for (int32_t dx = -1; dx <= 1; dx++)
+		{
+			if ((dx == 0 && dy == 0) || (!includeDiagonals && dx != 0 && dy != 0))
+				continue;
+
+			if (isWorldChunkInBounds(world, x + dx, y + dy))
+				func(x + dx, y + dy, getWorldChunkIndex(world, x + dx, y + dy));
+		}
+	}
+}
+
+/*
+Calls func(int32_t x, int32_t y, size_t chunkIndex) for each in bounds chunk that's at least partially within 'radius' world units of 'center'
+on the XZ plane, visiting them in storage order
+*/
+template <typename ChunkFunction>
+inline void forEachWorldChunkInRadius(const WorldInfo &world, const glm::vec2 &center, float radius, ChunkFunction func)
+{
+	const float chunkSize = float(WORLD_CHUNK_SIZE);
+
+	int64_t minX = std::max<int64_t>(int64_t(std::floor((center.x - radius) / chunkSize)), world.terrainOffsetX);
+	int64_t maxX = std::min<int64_t>(int64_t(std::floor((center.x + radius) / chunkSize)), int64_t(world.terrainSizeX) - world.terrainOffsetX - 1);
+	int64_t minY = std::max<int64_t>(int64_t(std::floor((center.y - radius) / chunkSize)), world.terrainOffsetY);
+	int64_t maxY = std::min<int64_t>(int64_t(std::floor((center.y + radius) / chunkSize)), int64_t(world.terrainSizeY) - world.terrainOffsetY - 1);
+
+	for (int64_t x = minX; x <= maxX; x++)
+	{
+		float dx = std::max(std::max(float(x) * chunkSize - center.x, center.x - float(x + 1) * chunkSize), 0.0f);
+
+		for (int64_t y = minY; y <= maxY; y++)
+		{
+			float dy = std::max(std::max(float(y) * chunkSize - center.y, center.y - float(y + 1) * chunkSize), 0.0f);
+
+			if (dx * dx + dy * dy <= radius * radius)
+				func(int32_t(x), int32_t(y), getWorldChunkIndex(world, int32_t(x), int32_t(y)));
+		}
+	}
+}
+
+/*
+Calls func(int32_t x, int32_t y, size_t chunkIndex) for each in bounds chunk w/in WORLD_VIEW_DISTANCE of the center of the chunk the camera is in
+*/
+template <typename ChunkFunction>
+inline void forEachWorldChunkInView(const WorldInfo &world, const glm::vec3 &cameraPosition, ChunkFunction func)
+{
+	sivec2 cameraChunk = getWorldChunkAtPosition(cameraPosition);
+	glm::vec2 cameraChunkCenter = (glm::vec2(float(cameraChunk.x), float(cameraChunk.y)) + 0.5f) * float(WORLD_CHUNK_SIZE);
+
+	forEachWorldChunkInRadius(world, cameraChunkCenter, float(WORLD_VIEW_DISTANCE), func);
+}
+
 class WorldManager
 {
 public:
@@ -27,8 +27,13 @@
 #define ENGINE_VERSION_REVISION 0
 
 #define WORLD_CHUNK_SIZE 256
+#define WORLD_VIEW_DISTANCE 2048 // How far from the center of the camera's chunk static objects are drawn, in world units
 
 #define MATERIAL_MAX_TEXTURE_COUNT 8
+#define MODEL_MAX_LOD_LEVELS 5
+#define MODEL_MESHLET_MAX_VERTICES 64
+#define MODEL_MESHLET_MAX_TRIANGLES 124
+#define MODEL_MAX_OCCLUDER_TRIANGLES 4096 // Models w/ more LOD 0 triangles than this keep no occluder mesh, they're too expensive to rasterize on the CPU
 
 #ifndef M_PI
 #define M_PI 3.1415926535897932384
@@ -254,6 +259,11 @@ inline void seqread(void *to, const void *from, size_t size, size_t &offset)
 	offset += size;
 }
 
+inline void seqwrite(std::vector<char> &to, const void *from, size_t size)
+{
+	to.insert(to.end(), reinterpret_cast<const char*>(from), reinterpret_cast<const char*>(from) + size);
+}
+
 inline void seqreadstr(std::string &to, const void *from, size_t &offset)
 {
 	uint32_t strLen = 0;
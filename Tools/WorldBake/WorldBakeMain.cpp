@@ -0,0 +1,215 @@
+/*
+
+kalos-worldbake, bakes KEW world files offline
+
+Usage: kalos-worldbake -out <file.kew> (-scene <scene.json> | -synthetic) [options]
+
+Recognized args:
+
+-out <file>                 Output KEW file
+-scene <file>               Bake the objects from a JSON scene description, see loadWorldBakeScene()
+-synthetic                  Bake a generated stress test world
+
+-name <name>                World unique name (synthetic only, scenes have their own)
+-size <x> <y>               Terrain size in chunks (synthetic only)
+-offset <x> <y>             Terrain offset in chunks (synthetic only)
+-objects <count>            Total object count
+-seed <seed>
+-distribution <uniform|clustered>
+-clusters <count>           Clusters per chunk w/ the clustered distribution
+-cluster_radius <radius>
+-meshes <count>             Number of distinct mesh IDs
+-materials <count>          Number of distinct material IDs
+-radius <min> <max>         Bounding sphere radius range
+-scale <min> <max>
+-random_orientation
+-terrain <height> <wavelength> Give every chunk a generated heightmap w/ hills up to <height> tall
+
+-raw                        Write raw (version 0 layout) chunk sections instead of packed ones
+-workers <count>            Job system worker count, defaults to the hardware thread count
+
+Building:
+
+The tool has it's own main(), so it lives outside of Source/ and isn't part of the engine's sources. It's built as a separate console
+program w/ the same include paths (Source/ and libraries/include) and defines as the engine, from:
+
+	Tools/WorldBake/WorldBakeMain.cpp
+	Tools/WorldBake/WorldBaker.cpp
+	Source/World/WorldFileFormat.cpp
+	Source/Util/LZ4Block.cpp
+	Source/Util/Log.cpp
+	Source/Util/JobSystem.cpp
+	Source/Util/JobSystemWorker.cpp
+
+*/
+
+#include <iostream>
+#include <thread>
+
+#include <common.h>
+
+#include "WorldBaker.h"
+
+int main(int argc, char *argv[]);
+
+void printUsage();
+
+int main(int argc, char *argv[])
+{
+	setvbuf(stdout, NULL, _IONBF, 0);
+	setvbuf(stderr, NULL, _IONBF, 0);
+
+	std::vector<std::string> launchArgs;
+
+	for (int i = 1; i < argc; i++)
+	{
+		launchArgs.push_back(argv[i]);
+	}
+
+	Log::setInstance(new Log());
+
+	WorldBakeSettings settings = getDefaultWorldBakeSettings();
+	WorldBakeSyntheticParams syntheticParams = getDefaultWorldBakeSyntheticParams();
+
+	std::string outputFile = "";
+	std::string sceneFile = "";
+	bool synthetic = false;
+	unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (size_t i = 0; i < launchArgs.size(); i++)
+	{
+		const std::string &arg = launchArgs[i];
+		size_t valuesLeft = launchArgs.size() - i - 1;
+
+		try
+		{
+			if (arg == "-out" && valuesLeft >= 1)
+				outputFile = launchArgs[++i];
+			else if (arg == "-scene" && valuesLeft >= 1)
+				sceneFile = launchArgs[++i];
+			else if (arg == "-synthetic")
+				synthetic = true;
+			else if (arg == "-name" && valuesLeft >= 1)
+				settings.uniqueName = launchArgs[++i];
+			else if (arg == "-size" && valuesLeft >= 2)
+			{
+				settings.terrainSizeX = uint32_t(std::stoul(launchArgs[++i]));
+				settings.terrainSizeY = uint32_t(std::stoul(launchArgs[++i]));
+			}
+			else if (arg == "-offset" && valuesLeft >= 2)
+			{
+				settings.terrainOffsetX = int32_t(std::stol(launchArgs[++i]));
+				settings.terrainOffsetY = int32_t(std::stol(launchArgs[++i]));
+			}
+			else if (arg == "-objects" && valuesLeft >= 1)
+				syntheticParams.objectCount = std::stoull(launchArgs[++i]);
+			else if (arg == "-seed" && valuesLeft >= 1)
+				syntheticParams.seed = std::stoull(launchArgs[++i]);
+			else if (arg == "-distribution" && valuesLeft >= 1)
+			{
+				std::string distribution = launchArgs[++i];
+
+				if (distribution == "uniform")
+					syntheticParams.distribution = WORLD_BAKE_OBJECT_DISTRIBUTION_UNIFORM;
+				else if (distribution == "clustered")
+					syntheticParams.distribution = WORLD_BAKE_OBJECT_DISTRIBUTION_CLUSTERED;
+				else
+				{
+					Log::get()->error("Unknown object distribution \"{}\"", distribution);
+					return 1;
+				}
+			}
+			else if (arg == "-clusters" && valuesLeft >= 1)
+				syntheticParams.clustersPerChunk = uint32_t(std::stoul(launchArgs[++i]));
+			else if (arg == "-cluster_radius" && valuesLeft >= 1)
+				syntheticParams.clusterRadius = std::stof(launchArgs[++i]);
+			else if (arg == "-meshes" && valuesLeft >= 1)
+				syntheticParams.meshCount = uint32_t(std::stoul(launchArgs[++i]));
+			else if (arg == "-materials" && valuesLeft >= 1)
+				syntheticParams.materialCount = uint32_t(std::stoul(launchArgs[++i]));
+			else if (arg == "-radius" && valuesLeft >= 2)
+			{
+				syntheticParams.minBoundingSphereRadius = std::stof(launchArgs[++i]);
+				syntheticParams.maxBoundingSphereRadius = std::stof(launchArgs[++i]);
+			}
+			else if (arg == "-scale" && valuesLeft >= 2)
+			{
+				syntheticParams.minScale = std::stof(launchArgs[++i]);
+				syntheticParams.maxScale = std::stof(launchArgs[++i]);
+			}
+			else if (arg == "-random_orientation")
+				syntheticParams.randomOrientation = true;
+			else if (arg == "-terrain" && valuesLeft >= 2)
+			{
+				syntheticParams.terrainHeight = std::stof(launchArgs[++i]);
+				syntheticParams.terrainWavelength = std::stof(launchArgs[++i]);
+			}
+			else if (arg == "-raw")
+				settings.encoding = WORLD_FILE_SECTION_ENCODING_RAW;
+			else if (arg == "-workers" && valuesLeft >= 1)
+				workerCount = std::max(uint32_t(std::stoul(launchArgs[++i])), 1u);
+			else
+			{
+				Log::get()->error("Unrecognized or incomplete arg \"{}\"", arg);
+				printUsage();
+				return 1;
+			}
+		}
+		catch (const std::exception &)
+		{
+			Log::get()->error("Invalid value for arg \"{}\"", arg);
+			return 1;
+		}
+	}
+
+	if (outputFile.empty() || sceneFile.empty() == !synthetic)
+	{
+		printUsage();
+		return 1;
+	}
+
+	JobSystem::setInstance(new JobSystem(workerCount));
+
+	bool success = false;
+
+	if (synthetic)
+	{
+		Log::get()->info("Generating {} objects w/ seed {} for world \"{}\"", syntheticParams.objectCount, syntheticParams.seed, settings.uniqueName);
+
+		success = bakeWorldFile(outputFile, settings, [&](int32_t chunkX, int32_t chunkY, std::vector<StaticObjectEntry> &objects) {
+			generateSyntheticWorldChunkObjects(settings, syntheticParams, chunkX, chunkY, objects);
+		}, [&](int32_t chunkX, int32_t chunkY, WorldChunkTerrainData &terrainData) {
+			return generateSyntheticWorldChunkHeightmap(syntheticParams, chunkX, chunkY, terrainData);
+		});
+	}
+	else
+	{
+		WorldBakeScene scene = {};
+
+		if (loadWorldBakeScene(sceneFile, scene))
+		{
+			scene.settings.encoding = settings.encoding;
+
+			Log::get()->info("Read {} objects for world \"{}\" from {}", scene.objectCount, scene.settings.uniqueName, sceneFile);
+
+			// Every chunk was added to the map when the scene was loaded, so the workers only ever read from it
+			success = bakeWorldFile(outputFile, scene.settings, [&](int32_t chunkX, int32_t chunkY, std::vector<StaticObjectEntry> &objects) {
+				objects = scene.chunkObjects.at({chunkX, chunkY});
+			});
+		}
+	}
+
+	delete JobSystem::get();
+	delete Log::getInstance();
+
+	return success ? 0 : 1;
+}
+
+void printUsage()
+{
+	std::cout << "Usage: kalos-worldbake -out <file.kew> (-scene <scene.json> | -synthetic) [options]" << std::endl;
+	std::cout << "Synthetic options: -name <name> -size <x> <y> -offset <x> <y> -objects <count> -seed <seed> -distribution <uniform|clustered>" << std::endl;
+	std::cout << "                   -clusters <count> -cluster_radius <radius> -meshes <count> -materials <count> -radius <min> <max> -scale <min> <max> -random_orientation" << std::endl;
+	std::cout << "                   -terrain <height> <wavelength>" << std::endl;
+	std::cout << "Other options: -raw -workers <count>" << std::endl;
+}
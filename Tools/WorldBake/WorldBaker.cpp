@@ -0,0 +1,530 @@
+#include "WorldBaker.h"
+
+#include <chrono>
+
+#include <json.hpp>
+
+#include <World/WorldFileFormat.h>
+
+WorldBakeSettings getDefaultWorldBakeSettings()
+{
+	WorldBakeSettings settings = {};
+	settings.uniqueName = "testworld";
+	settings.hasTerrain = true;
+	settings.terrainSizeX = 4;
+	settings.terrainSizeY = 4;
+	settings.terrainOffsetX = 0;
+	settings.terrainOffsetY = 0;
+	settings.encoding = WORLD_FILE_SECTION_ENCODING_PACKED_LZ4;
+	settings.minOctreeLength = 0.1f;
+
+	return settings;
+}
+
+WorldBakeSyntheticParams getDefaultWorldBakeSyntheticParams()
+{
+	WorldBakeSyntheticParams params = {};
+	params.objectCount = 65536;
+	params.seed = 0;
+	params.distribution = WORLD_BAKE_OBJECT_DISTRIBUTION_UNIFORM;
+	params.clustersPerChunk = 8;
+	params.clusterRadius = 24.0f;
+	params.meshCount = 64;
+	params.materialCount = 32;
+	params.minBoundingSphereRadius = 0.5f;
+	params.maxBoundingSphereRadius = 8.0f;
+	params.minScale = 1.0f;
+	params.maxScale = 1.0f;
+	params.randomOrientation = false;
+	params.terrainHeight = 0.0f;
+	params.terrainWavelength = 512.0f;
+
+	return params;
+}
+
+/*
+Lists the chunk coordinates in the same order WorldManager::loadWorld() reads them
+*/
+inline std::vector<sivec2> getWorldBakeChunkCoords(const WorldBakeSettings &settings)
+{
+	std::vector<sivec2> chunkCoords;
+
+	for (int64_t x = settings.terrainOffsetX; x < int64_t(settings.terrainSizeX) - settings.terrainOffsetX; x++)
+		for (int64_t y = settings.terrainOffsetY; y < int64_t(settings.terrainSizeY) - settings.terrainOffsetY; y++)
+			chunkCoords.push_back({int32_t(x), int32_t(y)});
+
+	return chunkCoords;
+}
+
+/*
+splitmix64, small and fast, and unlike rand() it gives the same sequence on every platform
+*/
+struct WorldBakeRandom
+{
+	uint64_t state;
+
+	inline uint64_t next()
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+		return z ^ (z >> 31);
+	}
+
+	// Uniform in [0, 1)
+	inline float nextFloat()
+	{
+		return float(next() >> 40) * (1.0f / 16777216.0f);
+	}
+
+	inline float nextFloat(float min, float max)
+	{
+		return min + (max - min) * nextFloat();
+	}
+
+	inline uint32_t nextUInt(uint32_t count)
+	{
+		return count == 0 ? 0 : uint32_t(next() % count);
+	}
+};
+
+void generateSyntheticWorldChunkObjects(const WorldBakeSettings &settings, const WorldBakeSyntheticParams &params, int32_t chunkX, int32_t chunkY, std::vector<StaticObjectEntry> &objects)
+{
+	uint64_t chunkCountY = uint64_t(int64_t(settings.terrainSizeY) - 2 * int64_t(settings.terrainOffsetY));
+	uint64_t chunkCount = uint64_t(int64_t(settings.terrainSizeX) - 2 * int64_t(settings.terrainOffsetX)) * chunkCountY;
+	uint64_t chunkIndex = uint64_t(chunkX - settings.terrainOffsetX) * chunkCountY + uint64_t(chunkY - settings.terrainOffsetY);
+
+	// The first (objectCount % chunkCount) chunks get one extra object, UUIDs are handed out in chunk order starting from 1
+	uint64_t baseObjectCount = params.objectCount / chunkCount;
+	uint64_t remainderObjectCount = params.objectCount % chunkCount;
+	uint64_t chunkObjectCount = baseObjectCount + (chunkIndex < remainderObjectCount ? 1 : 0);
+	uint64_t firstObjectUUID = 1 + chunkIndex * baseObjectCount + std::min(chunkIndex, remainderObjectCount);
+
+	WorldBakeRandom random = {params.seed};
+	random.state ^= WorldBakeRandom{(uint64_t(uint32_t(chunkX)) << 32) | uint64_t(uint32_t(chunkY))}.next();
+
+	const float chunkSize = float(WORLD_CHUNK_SIZE);
+	std::vector<svec3> clusterCenters;
+
+	if (params.distribution == WORLD_BAKE_OBJECT_DISTRIBUTION_CLUSTERED)
+		for (uint32_t i = 0; i < std::max(params.clustersPerChunk, 1u); i++)
+			clusterCenters.push_back({random.nextFloat() * chunkSize, random.nextFloat() * chunkSize, random.nextFloat() * chunkSize});
+
+	objects.reserve(objects.size() + chunkObjectCount);
+
+	for (uint64_t i = 0; i < chunkObjectCount; i++)
+	{
+		StaticObjectEntry entry = {};
+		entry.objectUUID = firstObjectUUID + i;
+		entry.meshID = 1 + random.nextUInt(params.meshCount);
+		entry.materialID = 1 + random.nextUInt(params.materialCount);
+
+		if (params.distribution == WORLD_BAKE_OBJECT_DISTRIBUTION_CLUSTERED)
+		{
+			const svec3 &center = clusterCenters[random.nextUInt(uint32_t(clusterCenters.size()))];
+
+			// Sum of 3 uniforms is a cheap bell curve, that's close enough for test data
+			float offset[3];
+			for (int a = 0; a < 3; a++)
+				offset[a] = (random.nextFloat() + random.nextFloat() + random.nextFloat() - 1.5f) * params.clusterRadius;
+
+			entry.position = {glm::clamp(center.x + offset[0], 0.0f, chunkSize), glm::clamp(center.y + offset[1], 0.0f, chunkSize), glm::clamp(center.z + offset[2], 0.0f, chunkSize)};
+		}
+		else
+		{
+			entry.position = {random.nextFloat() * chunkSize, random.nextFloat() * chunkSize, random.nextFloat() * chunkSize};
+		}
+
+		entry.scale = random.nextFloat(params.minScale, params.maxScale);
+
+		if (params.randomOrientation)
+		{
+			// Uniformly distributed unit quaternion (Shoemake)
+			float u0 = random.nextFloat(), u1 = random.nextFloat() * float(M_2PI), u2 = random.nextFloat() * float(M_2PI);
+			float r0 = std::sqrt(1.0f - u0), r1 = std::sqrt(u0);
+
+			entry.orientation = {r0 * std::sin(u1), r0 * std::cos(u1), r1 * std::sin(u2), r1 * std::cos(u2)};
+		}
+		else
+		{
+			entry.orientation = {0, 0, 0, 1};
+		}
+
+		entry.boundingSphereRadius = random.nextFloat(params.minBoundingSphereRadius, params.maxBoundingSphereRadius);
+		entry.bitmask = 0;
+
+		objects.push_back(entry);
+	}
+}
+
+/*
+Value noise lattice value in [0, 1], only depends on the seed and lattice coordinates
+*/
+inline float worldBakeLatticeValue(uint64_t seed, int64_t x, int64_t z)
+{
+	WorldBakeRandom random = {seed ^ (uint64_t(x) * 0x9E3779B97F4A7C15ull) ^ (uint64_t(z) * 0xC2B2AE3D27D4EB4Full)};
+
+	return random.nextFloat();
+}
+
+inline float worldBakeValueNoise(uint64_t seed, float x, float z)
+{
+	float floorX = std::floor(x), floorZ = std::floor(z);
+	int64_t x0 = int64_t(floorX), z0 = int64_t(floorZ);
+	float fx = x - floorX, fz = z - floorZ;
+
+	// Smoothstep the weights so there aren't any creases along the lattice lines
+	fx = fx * fx * (3.0f - 2.0f * fx);
+	fz = fz * fz * (3.0f - 2.0f * fz);
+
+	float v00 = worldBakeLatticeValue(seed, x0, z0), v10 = worldBakeLatticeValue(seed, x0 + 1, z0);
+	float v01 = worldBakeLatticeValue(seed, x0, z0 + 1), v11 = worldBakeLatticeValue(seed, x0 + 1, z0 + 1);
+
+	return glm::mix(glm::mix(v00, v10, fx), glm::mix(v01, v11, fx), fz);
+}
+
+bool generateSyntheticWorldChunkHeightmap(const WorldBakeSyntheticParams &params, int32_t chunkX, int32_t chunkY, WorldChunkTerrainData &terrainData)
+{
+	if (params.terrainHeight <= 0.0f)
+		return false;
+
+	const uint32_t octaveCount = 5;
+	const float sampleSpacing = float(WORLD_CHUNK_SIZE) / float(WORLD_TERRAIN_HEIGHTMAP_RESOLUTION);
+
+	terrainData.heightOffset = 0.0f;
+	terrainData.heightScale = params.terrainHeight / 65535.0f;
+	terrainData.heightmap.resize(WORLD_TERRAIN_HEIGHTMAP_SAMPLES * WORLD_TERRAIN_HEIGHTMAP_SAMPLES);
+
+	// The far row/column lands on the next chunk's first one, and since the noise is in world space it gets the exact same height
+	for (uint32_t z = 0; z < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; z++)
+	{
+		for (uint32_t x = 0; x < WORLD_TERRAIN_HEIGHTMAP_SAMPLES; x++)
+		{
+			float worldX = float(int64_t(chunkX) * WORLD_CHUNK_SIZE) + float(x) * sampleSpacing;
+			float worldZ = float(int64_t(chunkY) * WORLD_CHUNK_SIZE) + float(z) * sampleSpacing;
+			float height = 0.0f, amplitude = 0.5f, frequency = 1.0f / std::max(params.terrainWavelength, 1.0f), amplitudeSum = 0.0f;
+
+			for (uint32_t octave = 0; octave < octaveCount; octave++)
+			{
+				height += worldBakeValueNoise(params.seed + octave, worldX * frequency, worldZ * frequency) * amplitude;
+				amplitudeSum += amplitude;
+				amplitude *= 0.5f;
+				frequency *= 2.0f;
+			}
+
+			terrainData.heightmap[z * WORLD_TERRAIN_HEIGHTMAP_SAMPLES + x] = uint16_t(glm::clamp(height / amplitudeSum, 0.0f, 1.0f) * 65535.0f + 0.5f);
+		}
+	}
+
+	return true;
+}
+
+bool loadWorldBakeScene(const std::string &sceneFile, WorldBakeScene &scene)
+{
+	std::ifstream file(sceneFile, std::ios::in);
+
+	if (!file.is_open())
+	{
+		Log::get()->error("Failed to open scene description {}", sceneFile);
+		return false;
+	}
+
+	nlohmann::json sceneJson = nlohmann::json::parse(file, nullptr, false);
+
+	if (sceneJson.is_discarded() || !sceneJson.is_object())
+	{
+		Log::get()->error("Failed to parse scene description {}, it isn't a valid JSON object", sceneFile);
+		return false;
+	}
+
+	// Values of the wrong type throw, field is whatever was being read at the time so the error can say where
+	std::string field;
+	uint64_t skippedObjectCount = 0;
+
+	try
+	{
+		scene.settings = getDefaultWorldBakeSettings();
+		field = "uniqueName";
+		scene.settings.uniqueName = sceneJson.value("uniqueName", scene.settings.uniqueName);
+		field = "hasTerrain";
+		scene.settings.hasTerrain = sceneJson.value("hasTerrain", scene.settings.hasTerrain);
+		field = "terrainSizeX";
+		scene.settings.terrainSizeX = sceneJson.value("terrainSizeX", scene.settings.terrainSizeX);
+		field = "terrainSizeY";
+		scene.settings.terrainSizeY = sceneJson.value("terrainSizeY", scene.settings.terrainSizeY);
+		field = "terrainOffsetX";
+		scene.settings.terrainOffsetX = sceneJson.value("terrainOffsetX", scene.settings.terrainOffsetX);
+		field = "terrainOffsetY";
+		scene.settings.terrainOffsetY = sceneJson.value("terrainOffsetY", scene.settings.terrainOffsetY);
+
+		scene.chunkObjects.clear();
+		scene.objectCount = 0;
+
+		if (!sceneJson.count("objects"))
+			return true;
+
+		const nlohmann::json &objectsJson = sceneJson["objects"];
+
+		if (!objectsJson.is_array())
+		{
+			Log::get()->error("Failed to parse scene description {}, \"objects\" must be an array", sceneFile);
+			return false;
+		}
+
+		uint64_t maxObjectUUID = 0;
+
+		for (size_t i = 0; i < objectsJson.size(); i++)
+		{
+			field = "objects[" + toString(i) + "].uuid";
+
+			if (objectsJson[i].is_object())
+				maxObjectUUID = std::max(maxObjectUUID, objectsJson[i].value("uuid", uint64_t(0)));
+		}
+
+		std::vector<sivec2> chunkCoords = getWorldBakeChunkCoords(scene.settings);
+		uint64_t nextObjectUUID = maxObjectUUID + 1;
+
+		for (const sivec2 &chunkCoord : chunkCoords)
+			scene.chunkObjects[chunkCoord] = {};
+
+		for (size_t i = 0; i < objectsJson.size(); i++)
+		{
+			const nlohmann::json &objectJson = objectsJson[i];
+
+			if (!objectJson.is_object() || !objectJson.count("position") || !objectJson["position"].is_array() || objectJson["position"].size() != 3)
+			{
+				Log::get()->error("Failed to parse scene description {}, object {} needs a \"position\" array w/ 3 elements", sceneFile, i);
+				return false;
+			}
+
+			std::string objectField = "objects[" + toString(i) + "].";
+
+			field = objectField + "position";
+			std::vector<float> position = objectJson["position"].get<std::vector<float>>();
+			field = objectField + "orientation";
+			std::vector<float> orientation = objectJson.value("orientation", std::vector<float>({0, 0, 0, 1}));
+
+			if (orientation.size() != 4)
+			{
+				Log::get()->error("Failed to parse scene description {}, object {} has an \"orientation\" that isn't 4 elements", sceneFile, i);
+				return false;
+			}
+
+			sivec2 chunkCoord = getWorldChunkAtPosition(glm::vec3(position[0], position[1], position[2]));
+			auto chunkIt = scene.chunkObjects.find(chunkCoord);
+
+			if (chunkIt == scene.chunkObjects.end())
+			{
+				skippedObjectCount++;
+				continue;
+			}
+
+			StaticObjectEntry entry = {};
+			field = objectField + "uuid";
+			entry.objectUUID = objectJson.count("uuid") ? objectJson["uuid"].get<uint64_t>() : nextObjectUUID++;
+			field = objectField + "meshID";
+			entry.meshID = objectJson.value("meshID", uint64_t(0));
+			field = objectField + "materialID";
+			entry.materialID = objectJson.value("materialID", uint64_t(0));
+			field = objectField + "scale";
+			entry.scale = objectJson.value("scale", 1.0f);
+			field = objectField + "boundingSphereRadius";
+			entry.boundingSphereRadius = objectJson.value("boundingSphereRadius", 1.0f);
+			field = objectField + "bitmask";
+			entry.bitmask = objectJson.value("bitmask", uint32_t(0));
+			entry.position = {position[0] - float(chunkCoord.x * WORLD_CHUNK_SIZE), position[1], position[2] - float(chunkCoord.y * WORLD_CHUNK_SIZE)};
+			entry.orientation = {orientation[0], orientation[1], orientation[2], orientation[3]};
+
+			chunkIt->second.push_back(entry);
+			scene.objectCount++;
+		}
+	}
+	catch (const nlohmann::json::exception &e)
+	{
+		Log::get()->error("Failed to parse scene description {}, field \"{}\" is invalid: {}", sceneFile, field, e.what());
+		return false;
+	}
+
+	if (skippedObjectCount > 0)
+		Log::get()->warn("Skipped {} object(s) in scene description {} that are outside of the world's chunks", skippedObjectCount, sceneFile);
+
+	return true;
+}
+
+struct WorldBakeChunkJobData
+{
+	const WorldBakeSettings *settings;
+	const WorldBakeChunkObjectsFunction *chunkObjectsFunction;
+	const WorldBakeChunkHeightmapFunction *chunkHeightmapFunction;
+	sivec2 chunkCoord;
+
+	uint64_t objectCount;
+	std::vector<char> heightmapSectionData;
+	std::vector<char> sectionData;
+};
+
+template <typename OctreePayload>
+inline void deleteOctreeChildren(Octree<OctreePayload> *node)
+{
+	for (int child = 0; child < 8; child++)
+	{
+		if (node->children[child] != nullptr)
+		{
+			deleteOctreeChildren(node->children[child]);
+			delete node->children[child];
+			node->children[child] = nullptr;
+		}
+	}
+}
+
+void worldBakeChunkJobFunction(Job *job)
+{
+	WorldBakeChunkJobData *jobData = reinterpret_cast<WorldBakeChunkJobData*>(job->usrData);
+
+	if (*jobData->chunkHeightmapFunction)
+	{
+		WorldChunkTerrainData terrainData = {};
+
+		if ((*jobData->chunkHeightmapFunction)(jobData->chunkCoord.x, jobData->chunkCoord.y, terrainData))
+			writeWorldChunkHeightmapSection(jobData->heightmapSectionData, terrainData, jobData->settings->encoding);
+	}
+
+	std::vector<StaticObjectEntry> objects;
+	(*jobData->chunkObjectsFunction)(jobData->chunkCoord.x, jobData->chunkCoord.y, objects);
+
+	WorldChunkStaticObjectData chunkData = {};
+	chunkData.chunkAABB = {{0, 0, 0, 0}, {float(WORLD_CHUNK_SIZE), float(WORLD_CHUNK_SIZE), float(WORLD_CHUNK_SIZE), 0}};
+
+	Octree<StaticObjectEntry> chunkOctree;
+	chunkOctree.boundingBox = chunkData.chunkAABB;
+	chunkData.chunkOctree = &chunkOctree;
+
+	insertItemsIntoOctree(&chunkOctree, objects, jobData->settings->minOctreeLength);
+
+	jobData->objectCount = objects.size();
+	objects = std::vector<StaticObjectEntry>();
+
+	writeWorldChunkStaticObjectSection(jobData->sectionData, chunkData, jobData->settings->encoding);
+
+	deleteOctreeChildren(&chunkOctree);
+}
+
+bool bakeWorldFile(const std::string &outputFile, const WorldBakeSettings &settings, const WorldBakeChunkObjectsFunction &chunkObjectsFunction, const WorldBakeChunkHeightmapFunction &chunkHeightmapFunction)
+{
+	auto bakeStartTime = std::chrono::steady_clock::now();
+
+	if (settings.terrainOffsetX < 0 || settings.terrainOffsetY < 0 || int64_t(settings.terrainSizeX) - 2 * int64_t(settings.terrainOffsetX) <= 0 || int64_t(settings.terrainSizeY) - 2 * int64_t(settings.terrainOffsetY) <= 0)
+	{
+		Log::get()->error("Can't bake world \"{}\", terrain size {}x{} w/ offset {},{} doesn't have any chunks the loader can read", settings.uniqueName, settings.terrainSizeX, settings.terrainSizeY, settings.terrainOffsetX, settings.terrainOffsetY);
+		return false;
+	}
+
+	std::ofstream file(outputFile, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		Log::get()->error("Failed to open file: {} for writing", outputFile);
+		return false;
+	}
+
+	uint16_t fileVersion = WORLD_FILE_VERSION;
+	uint32_t uniqueNameStrLen = uint32_t(settings.uniqueName.size());
+	uint8_t hasTerrain = settings.hasTerrain ? 1 : 0;
+
+	std::vector<char> headerData;
+
+	// HEADER
+	seqwrite(headerData, "KEW|", 4);
+	seqwrite(headerData, &fileVersion, sizeof(fileVersion));
+
+	// WORLD INFO
+	seqwrite(headerData, &uniqueNameStrLen, sizeof(uniqueNameStrLen));
+	seqwrite(headerData, settings.uniqueName.c_str(), uniqueNameStrLen);
+	seqwrite(headerData, &hasTerrain, sizeof(hasTerrain));
+	seqwrite(headerData, &settings.terrainSizeX, sizeof(settings.terrainSizeX));
+	seqwrite(headerData, &settings.terrainSizeY, sizeof(settings.terrainSizeY));
+	seqwrite(headerData, &settings.terrainOffsetX, sizeof(settings.terrainOffsetX));
+	seqwrite(headerData, &settings.terrainOffsetY, sizeof(settings.terrainOffsetY));
+
+	// LOOKUP TABLE, filled in once all of the sections have been written
+	std::vector<sivec2> chunkCoords = getWorldBakeChunkCoords(settings);
+	std::vector<WorldInfoLookupEntry> lookupTable(chunkCoords.size(), {0, 0});
+	uint64_t lookupTableFilePosition = headerData.size();
+
+	file.write(headerData.data(), headerData.size());
+	file.write(reinterpret_cast<const char*>(lookupTable.data()), lookupTable.size() * sizeof(WorldInfoLookupEntry));
+
+	uint64_t filePosition = lookupTableFilePosition + lookupTable.size() * sizeof(WorldInfoLookupEntry);
+	uint64_t totalObjectCount = 0;
+	uint64_t heightmapCount = 0;
+
+	// HEIGHTMAP DATA & STATIC OBJECT DATA
+	// Each chunk's heightmap section is written right before it's static object section. Chunks are built in batches, a few per worker, so the whole world never has to be in memory at once. Sections are written in
+	// chunk order no matter which worker finishes first, which keeps the output deterministic
+	const size_t chunkJobBatchSize = std::min<size_t>(JobSystem::get()->getWorkerCount() * 4, 1024);
+
+	for (size_t batchStart = 0; batchStart < chunkCoords.size(); batchStart += chunkJobBatchSize)
+	{
+		size_t batchEnd = std::min(batchStart + chunkJobBatchSize, chunkCoords.size());
+		std::vector<WorldBakeChunkJobData> chunkJobData(batchEnd - batchStart);
+
+		Job *batchJob = JobSystem::get()->allocateJob(nullptr);
+		std::vector<Job*> chunkJobs;
+
+		for (size_t i = batchStart; i < batchEnd; i++)
+		{
+			WorldBakeChunkJobData &jobData = chunkJobData[i - batchStart];
+			jobData.settings = &settings;
+			jobData.chunkObjectsFunction = &chunkObjectsFunction;
+			jobData.chunkHeightmapFunction = &chunkHeightmapFunction;
+			jobData.chunkCoord = chunkCoords[i];
+			jobData.objectCount = 0;
+
+			Job *chunkJob = JobSystem::get()->allocateJobAsChild(batchJob, worldBakeChunkJobFunction);
+			chunkJob->usrData = &jobData;
+
+			chunkJobs.push_back(chunkJob);
+		}
+
+		JobSystem::get()->runJobs(chunkJobs);
+		JobSystem::get()->runJob(batchJob);
+		JobSystem::get()->waitForJob(batchJob);
+
+		for (size_t i = batchStart; i < batchEnd; i++)
+		{
+			const WorldBakeChunkJobData &jobData = chunkJobData[i - batchStart];
+
+			if (!jobData.heightmapSectionData.empty())
+			{
+				lookupTable[i].heightmapDataFilePosition = filePosition;
+				file.write(jobData.heightmapSectionData.data(), jobData.heightmapSectionData.size());
+
+				filePosition += jobData.heightmapSectionData.size();
+				heightmapCount++;
+			}
+
+			lookupTable[i].objectDataFilePosition = filePosition;
+			file.write(jobData.sectionData.data(), jobData.sectionData.size());
+
+			filePosition += jobData.sectionData.size();
+			totalObjectCount += jobData.objectCount;
+		}
+	}
+
+	file.seekp(std::streamoff(lookupTableFilePosition));
+	file.write(reinterpret_cast<const char*>(lookupTable.data()), lookupTable.size() * sizeof(WorldInfoLookupEntry));
+	file.close();
+
+	if (file.fail())
+	{
+		Log::get()->error("Failed while writing world file {}", outputFile);
+		return false;
+	}
+
+	double bakeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - bakeStartTime).count();
+
+	Log::get()->info("Baked world \"{}\" to {}: {} chunks, {} heightmaps, {} objects, {:.2f} MB, took {:.2f} s ({:.0f} objects/s)", settings.uniqueName, outputFile, chunkCoords.size(), heightmapCount, totalObjectCount, filePosition / 1048576.0, bakeTime, totalObjectCount / std::max(bakeTime, 1e-9));
+
+	return true;
+}
@@ -0,0 +1,109 @@
+#ifndef TOOLS_WORLDBAKE_WORLDBAKER_H_
+#define TOOLS_WORLDBAKE_WORLDBAKER_H_
+
+#include <common.h>
+
+#include <World/WorldManager.h>
+
+typedef enum WorldBakeObjectDistribution
+{
+	WORLD_BAKE_OBJECT_DISTRIBUTION_UNIFORM = 0, // Objects are spread evenly through each chunk
+	WORLD_BAKE_OBJECT_DISTRIBUTION_CLUSTERED = 1, // Objects are grouped around a few random points in each chunk
+	WORLD_BAKE_OBJECT_DISTRIBUTION_MAX_ENUM = 0x7FFFFFFF
+} WorldBakeObjectDistribution;
+
+typedef struct
+{
+	std::string uniqueName;
+	bool hasTerrain;
+	uint32_t terrainSizeX;
+	uint32_t terrainSizeY;
+	int32_t terrainOffsetX;
+	int32_t terrainOffsetY;
+
+	WorldFileSectionEncoding encoding;
+	float minOctreeLength;
+} WorldBakeSettings;
+
+typedef struct
+{
+	uint64_t objectCount; // Total across the whole world, split evenly between the chunks
+	uint64_t seed;
+	WorldBakeObjectDistribution distribution;
+
+	uint32_t clustersPerChunk;
+	float clusterRadius;
+
+	uint32_t meshCount; // Mesh & material IDs are picked from [1, count]
+	uint32_t materialCount;
+
+	float minBoundingSphereRadius;
+	float maxBoundingSphereRadius;
+	float minScale;
+	float maxScale;
+	bool randomOrientation;
+
+	float terrainHeight; // Max height of the generated terrain, 0 to not give chunks heightmaps
+	float terrainWavelength; // Size of the largest hills
+} WorldBakeSyntheticParams;
+
+/*
+Objects read from a scene description, already sorted into the chunks they belong to. Positions are local to their chunk.
+*/
+typedef struct
+{
+	WorldBakeSettings settings;
+
+	std::map<sivec2, std::vector<StaticObjectEntry>> chunkObjects;
+	uint64_t objectCount;
+} WorldBakeScene;
+
+/*
+Fills a chunk's object list, called from job system workers so it has to be safe to call for different chunks at the same time. The
+objects it produces must only depend on the chunk coordinates, otherwise the baked file won't be deterministic.
+*/
+typedef std::function<void(int32_t chunkX, int32_t chunkY, std::vector<StaticObjectEntry> &objects)> WorldBakeChunkObjectsFunction;
+
+/*
+Fills a chunk's heightmap, w/ the same rules as WorldBakeChunkObjectsFunction. Returns false if the chunk shouldn't have a heightmap.
+*/
+typedef std::function<bool(int32_t chunkX, int32_t chunkY, WorldChunkTerrainData &terrainData)> WorldBakeChunkHeightmapFunction;
+
+WorldBakeSettings getDefaultWorldBakeSettings();
+WorldBakeSyntheticParams getDefaultWorldBakeSyntheticParams();
+
+/*
+Reads a JSON scene description, looks like:
+{
+	"uniqueName": "testworld", "hasTerrain": true,
+	"terrainSizeX": 4, "terrainSizeY": 4, "terrainOffsetX": 0, "terrainOffsetY": 0,
+	"objects": [
+		{"uuid": 1, "meshID": 12, "materialID": 34, "position": [10, 0, 300], "scale": 1, "orientation": [0, 0, 0, 1], "boundingSphereRadius": 2, "bitmask": 0}
+	]
+}
+Object positions are in world space, chunk (x, y) covers [x * WORLD_CHUNK_SIZE, (x + 1) * WORLD_CHUNK_SIZE) on the X and Z axes. Everything
+except the object position is optional, objects w/o a uuid get one assigned after the largest uuid in the file. Returns false if the file couldn't
+be read or parsed.
+*/
+bool loadWorldBakeScene(const std::string &sceneFile, WorldBakeScene &scene);
+
+/*
+Deterministically generates a chunk's objects from the synthetic params, the same params and chunk coordinates always give the same objects.
+UUIDs are unique across the whole world.
+*/
+void generateSyntheticWorldChunkObjects(const WorldBakeSettings &settings, const WorldBakeSyntheticParams &params, int32_t chunkX, int32_t chunkY, std::vector<StaticObjectEntry> &objects);
+
+/*
+Deterministically generates a chunk's heightmap as a few octaves of value noise. The noise is sampled in world space so heights line up
+across chunk borders. Returns false if the params don't ask for terrain.
+*/
+bool generateSyntheticWorldChunkHeightmap(const WorldBakeSyntheticParams &params, int32_t chunkX, int32_t chunkY, WorldChunkTerrainData &terrainData);
+
+/*
+Bakes a KEW world file. Chunks are built and encoded in parallel on the job system, in batches so that only a bounded number of objects
+are in memory at a time, and then written out in the same order the loader reads them. 'chunkHeightmapFunction' can be empty if the
+world has no terrain. Returns false if the output file couldn't be written.
+*/
+bool bakeWorldFile(const std::string &outputFile, const WorldBakeSettings &settings, const WorldBakeChunkObjectsFunction &chunkObjectsFunction, const WorldBakeChunkHeightmapFunction &chunkHeightmapFunction = nullptr);
+
+#endif /* TOOLS_WORLDBAKE_WORLDBAKER_H_ */